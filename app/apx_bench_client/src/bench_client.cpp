@@ -0,0 +1,670 @@
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstdlib>
+#include <cstring>
+#include <iomanip>
+#include <iostream>
+#include <mutex>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "cpp-apx/client.h"
+#include "cpp-apx/server.h"
+#include "cpp-apx/trace.h"
+
+#ifdef _WIN32
+static int init_wsa(void);
+#endif
+
+using Clock = std::chrono::steady_clock;
+
+static char const* provide_node_name = "BenchProvideNode";
+static char const* require_node_name = "BenchRequireNode";
+
+enum class ElementType
+{
+   UInt8,
+   UInt16,
+   UInt32,
+   Int8,
+   Int16,
+   Int32
+};
+
+struct Options
+{
+   std::size_t num_ports{ 16u };
+   ElementType element_type{ ElementType::UInt8 };
+   std::size_t depth{ 0u }; //0 gives scalar ports, N gives records nested N levels deep
+   double rate{ 1000.0 }; //writes per second, 0 means as fast as possible
+   double duration{ 5.0 }; //seconds
+   std::size_t warmup_rounds{ 10u };
+   std::string trace_file{}; //Written when the library is built with APX_TRACE
+#ifndef UNIT_TEST
+   std::string server_address{};
+   std::uint16_t tcp_port{ 5100u };
+#endif
+};
+
+struct LatencySummary
+{
+   double min{ 0.0 };
+   double mean{ 0.0 };
+   double p50{ 0.0 };
+   double p99{ 0.0 };
+   double p999{ 0.0 };
+   double max{ 0.0 };
+};
+
+/*
+* Records time from write_port_value on the provide side until the matching require port is
+* written on the receiving side. Each port has at most one write in flight so that the
+* reception can be matched with its write without embedding timestamps in the port data.
+*/
+class LatencyRecorder : public apx::ClientEventListener
+{
+public:
+   LatencyRecorder(std::size_t num_ports) : m_pending(num_ports), m_is_pending(num_ports, false) {}
+
+   void connected1(apx::ClientConnection* connection) override
+   {
+      (void)connection;
+      m_connected = true;
+   }
+
+   void disconnected1(apx::ClientConnection* connection) override
+   {
+      (void)connection;
+      m_connected = false;
+   }
+
+   void require_port_written1(apx::PortInstance* port_instance) override
+   {
+      auto const now = Clock::now();
+      std::scoped_lock lock(m_mutex);
+      auto const port_id = static_cast<std::size_t>(port_instance->port_id());
+      if ((port_id < m_is_pending.size()) && m_is_pending[port_id])
+      {
+         m_is_pending[port_id] = false;
+         m_num_in_flight--;
+         m_samples.push_back(std::chrono::duration<double, std::micro>(now - m_pending[port_id]).count());
+      }
+   }
+
+   bool begin(std::size_t port_id)
+   {
+      std::scoped_lock lock(m_mutex);
+      if (m_is_pending[port_id])
+      {
+         return false;
+      }
+      m_is_pending[port_id] = true;
+      m_num_in_flight++;
+      m_pending[port_id] = Clock::now();
+      return true;
+   }
+
+   void cancel(std::size_t port_id)
+   {
+      std::scoped_lock lock(m_mutex);
+      if (m_is_pending[port_id])
+      {
+         m_is_pending[port_id] = false;
+         m_num_in_flight--;
+      }
+   }
+
+   std::size_t num_in_flight()
+   {
+      std::scoped_lock lock(m_mutex);
+      return m_num_in_flight;
+   }
+
+   std::vector<double> take_samples()
+   {
+      std::scoped_lock lock(m_mutex);
+      std::vector<double> result;
+      result.swap(m_samples);
+      return result;
+   }
+
+   bool is_connected() const { return m_connected; }
+
+protected:
+   std::mutex m_mutex;
+   std::vector<Clock::time_point> m_pending;
+   std::vector<bool> m_is_pending;
+   std::vector<double> m_samples;
+   std::size_t m_num_in_flight{ 0u };
+   std::atomic<bool> m_connected{ false };
+};
+
+struct BenchContext
+{
+   apx::Client writer;
+   apx::Client reader;
+   LatencyRecorder writer_events;
+   LatencyRecorder reader_events;
+   std::vector<apx::PortInstance*> provide_ports;
+   std::vector<std::uint32_t> counters;
+   ElementType element_type;
+   std::size_t depth;
+#ifdef UNIT_TEST
+   apx::Server server;
+#else
+   std::unique_ptr<apx::Server> server;
+#endif
+
+   BenchContext(Options const& options) :
+      writer_events{ 0u },
+      reader_events{ options.num_ports },
+      counters(options.num_ports, 0u),
+      element_type{ options.element_type },
+      depth{ options.depth }
+   {
+      writer.register_event_listener(&writer_events);
+      reader.register_event_listener(&reader_events);
+   }
+};
+
+static char const* type_code(ElementType element_type)
+{
+   switch (element_type)
+   {
+   case ElementType::UInt8: return "C";
+   case ElementType::UInt16: return "S";
+   case ElementType::UInt32: return "L";
+   case ElementType::Int8: return "c";
+   case ElementType::Int16: return "s";
+   case ElementType::Int32: return "l";
+   }
+   return "C";
+}
+
+static char const* type_name(ElementType element_type)
+{
+   switch (element_type)
+   {
+   case ElementType::UInt8: return "u8";
+   case ElementType::UInt16: return "u16";
+   case ElementType::UInt32: return "u32";
+   case ElementType::Int8: return "i8";
+   case ElementType::Int16: return "i16";
+   case ElementType::Int32: return "i32";
+   }
+   return "u8";
+}
+
+static bool parse_type(std::string const& text, ElementType& element_type)
+{
+   for (auto candidate : { ElementType::UInt8, ElementType::UInt16, ElementType::UInt32,
+      ElementType::Int8, ElementType::Int16, ElementType::Int32 })
+   {
+      if (text == type_name(candidate))
+      {
+         element_type = candidate;
+         return true;
+      }
+   }
+   return false;
+}
+
+/*
+* Each record level has a "Value" field and, except for the innermost one, a "Nested" record.
+*/
+static void append_port_type(std::ostringstream& ss, ElementType element_type, std::size_t depth)
+{
+   if (depth == 0u)
+   {
+      ss << type_code(element_type);
+      return;
+   }
+   ss << "{\"Value\"" << type_code(element_type);
+   if (depth > 1u)
+   {
+      ss << "\"Nested\"";
+      append_port_type(ss, element_type, depth - 1u);
+   }
+   ss << "}";
+}
+
+static void append_init_value(std::ostringstream& ss, std::size_t depth)
+{
+   if (depth == 0u)
+   {
+      ss << "0";
+      return;
+   }
+   ss << "{0";
+   if (depth > 1u)
+   {
+      ss << ", ";
+      append_init_value(ss, depth - 1u);
+   }
+   ss << "}";
+}
+
+static std::string create_node_text(char const* node_name, char port_kind, std::size_t num_ports, ElementType element_type, std::size_t depth)
+{
+   std::ostringstream ss;
+   ss << "APX/1.3\n" << "N\"" << node_name << "\"\n";
+   for (std::size_t i = 0u; i < num_ports; i++)
+   {
+      ss << port_kind << "\"Signal" << i << "\"";
+      append_port_type(ss, element_type, depth);
+      ss << ":=";
+      append_init_value(ss, depth);
+      ss << "\n";
+   }
+   return ss.str();
+}
+
+static dtl::ScalarValue next_scalar(ElementType element_type, std::uint32_t counter)
+{
+   switch (element_type)
+   {
+   case ElementType::UInt8: return dtl::make_sv<std::uint32_t>(counter & 0xFFu);
+   case ElementType::UInt16: return dtl::make_sv<std::uint32_t>(counter & 0xFFFFu);
+   case ElementType::UInt32: return dtl::make_sv<std::uint32_t>(counter);
+   case ElementType::Int8: return dtl::make_sv<std::int32_t>(static_cast<std::int8_t>(counter));
+   case ElementType::Int16: return dtl::make_sv<std::int32_t>(static_cast<std::int16_t>(counter));
+   case ElementType::Int32: return dtl::make_sv<std::int32_t>(static_cast<std::int32_t>(counter));
+   }
+   return dtl::make_sv<std::uint32_t>(0u);
+}
+
+static dtl::DynamicValue next_value(ElementType element_type, std::size_t depth, std::uint32_t counter)
+{
+   if (depth == 0u)
+   {
+      return dtl::dv_cast(next_scalar(element_type, counter));
+   }
+   dtl::DynamicValue nested;
+   for (std::size_t level = 0u; level < depth; level++)
+   {
+      auto hv = dtl::make_hv();
+      hv->set("Value", dtl::dv_cast(next_scalar(element_type, counter)));
+      if (nested)
+      {
+         hv->set("Nested", nested);
+      }
+      nested = dtl::dv_cast(hv);
+   }
+   return nested;
+}
+
+static void print_usage(char const* program_name)
+{
+   std::cout << "Usage: " << program_name << " [options]\n"
+      "  --ports N         Number of ports in the synthetic nodes (default 16)\n"
+      "  --type T          Port element type: u8, u16, u32, i8, i16, i32 (default u8)\n"
+      "  --depth D         Make each port a record nested D levels deep, 0 for scalar ports (default 0)\n"
+      "  --rate R          Port writes per second, 0 for as fast as possible (default 1000)\n"
+      "  --duration S      Measurement duration in seconds (default 5)\n"
+      "  --warmup N        Warm-up rounds over all ports before measuring (default 10)\n"
+      "  --trace FILE      Write recorded trace events as Chrome trace JSON (requires -DAPX_TRACE=ON)\n"
+#ifndef UNIT_TEST
+      "  --port P          TCP port (default 5100)\n"
+      "  --server ADDRESS  Use an already running server instead of starting one in-process\n"
+#endif
+      ;
+}
+
+static bool parse_options(int argc, char** argv, Options& options)
+{
+   for (int i = 1; i < argc; i++)
+   {
+      std::string const arg{ argv[i] };
+      if (arg == "--help" || arg == "-h")
+      {
+         return false;
+      }
+      if (i + 1 >= argc)
+      {
+         std::cerr << "Missing value for " << arg << std::endl;
+         return false;
+      }
+      std::string const value{ argv[++i] };
+      if (arg == "--ports")
+      {
+         options.num_ports = static_cast<std::size_t>(std::strtoul(value.c_str(), nullptr, 10));
+      }
+      else if (arg == "--type")
+      {
+         if (!parse_type(value, options.element_type))
+         {
+            std::cerr << "Unknown type: " << value << std::endl;
+            return false;
+         }
+      }
+      else if (arg == "--depth")
+      {
+         options.depth = static_cast<std::size_t>(std::strtoul(value.c_str(), nullptr, 10));
+      }
+      else if (arg == "--rate")
+      {
+         options.rate = std::strtod(value.c_str(), nullptr);
+      }
+      else if (arg == "--duration")
+      {
+         options.duration = std::strtod(value.c_str(), nullptr);
+      }
+      else if (arg == "--warmup")
+      {
+         options.warmup_rounds = static_cast<std::size_t>(std::strtoul(value.c_str(), nullptr, 10));
+      }
+      else if (arg == "--trace")
+      {
+         options.trace_file = value;
+      }
+#ifndef UNIT_TEST
+      else if (arg == "--port")
+      {
+         options.tcp_port = static_cast<std::uint16_t>(std::strtoul(value.c_str(), nullptr, 10));
+      }
+      else if (arg == "--server")
+      {
+         options.server_address = value;
+      }
+#endif
+      else
+      {
+         std::cerr << "Unknown option: " << arg << std::endl;
+         return false;
+      }
+   }
+   if ((options.num_ports == 0u) || (options.rate < 0.0) || (options.duration <= 0.0))
+   {
+      std::cerr << "Invalid option value" << std::endl;
+      return false;
+   }
+   return true;
+}
+
+/*
+* Processes pending socket events. Test sockets are synchronous and need to be driven
+* from the main loop, real sockets are serviced by their own worker threads.
+*/
+static void poll(BenchContext& context)
+{
+#ifdef UNIT_TEST
+   context.writer.run();
+   context.server.run();
+   context.reader.run();
+#else
+   (void)context;
+   std::this_thread::yield();
+#endif
+}
+
+static apx::error_t connect(BenchContext& context, Options const& options)
+{
+#ifdef UNIT_TEST
+   (void)options;
+   auto* writer_socket = testsocket_new();
+   auto* reader_socket = testsocket_new();
+   context.server.accept_test_socket(writer_socket);
+   context.server.accept_test_socket(reader_socket);
+   auto result = context.writer.connect(writer_socket);
+   if (result == APX_NO_ERROR)
+   {
+      result = context.reader.connect(reader_socket);
+   }
+#else
+   std::string address{ options.server_address };
+   if (address.empty())
+   {
+      address = "127.0.0.1";
+      context.server = std::make_unique<apx::Server>();
+      auto result = context.server->start_tcp(options.tcp_port);
+      if (result != APX_NO_ERROR)
+      {
+         return result;
+      }
+   }
+   auto result = context.writer.connect_tcp(address, options.tcp_port);
+   if (result == APX_NO_ERROR)
+   {
+      result = context.reader.connect_tcp(address, options.tcp_port);
+   }
+#endif
+   return result;
+}
+
+static bool wait_for(BenchContext& context, std::chrono::milliseconds timeout, bool (*condition)(BenchContext&))
+{
+   auto const deadline = Clock::now() + timeout;
+   while (!condition(context))
+   {
+      if (Clock::now() > deadline)
+      {
+         return false;
+      }
+      poll(context);
+#ifndef UNIT_TEST
+      std::this_thread::sleep_for(std::chrono::milliseconds(1));
+#endif
+   }
+   return true;
+}
+
+static bool is_connected(BenchContext& context)
+{
+   return context.writer_events.is_connected() && context.reader_events.is_connected();
+}
+
+static bool is_idle(BenchContext& context)
+{
+   return context.reader_events.num_in_flight() == 0u;
+}
+
+/*
+* Writes a new value to the port unless its previous write is still in flight.
+*/
+static bool write_port(BenchContext& context, std::size_t port_index, std::size_t& num_errors)
+{
+   if (!context.reader_events.begin(port_index))
+   {
+      return false;
+   }
+   auto const dv = next_value(context.element_type, context.depth, ++context.counters[port_index]);
+   auto const result = context.writer.write_port_value(context.provide_ports[port_index], dv);
+   if (result != APX_NO_ERROR)
+   {
+      context.reader_events.cancel(port_index);
+      num_errors++;
+      return false;
+   }
+   return true;
+}
+
+static double percentile(std::vector<double> const& sorted_samples, double fraction)
+{
+   auto const n = sorted_samples.size();
+   auto rank = static_cast<std::size_t>(fraction * static_cast<double>(n) + 0.999999);
+   rank = std::clamp<std::size_t>(rank, 1u, n);
+   return sorted_samples[rank - 1];
+}
+
+static LatencySummary summarize(std::vector<double>& samples)
+{
+   LatencySummary summary;
+   if (samples.empty())
+   {
+      return summary;
+   }
+   std::sort(samples.begin(), samples.end());
+   double sum{ 0.0 };
+   for (auto sample : samples)
+   {
+      sum += sample;
+   }
+   summary.min = samples.front();
+   summary.max = samples.back();
+   summary.mean = sum / static_cast<double>(samples.size());
+   summary.p50 = percentile(samples, 0.50);
+   summary.p99 = percentile(samples, 0.99);
+   summary.p999 = percentile(samples, 0.999);
+   return summary;
+}
+
+static void print_stage(char const* name, apx::LatencyHistogramSnapshot const& histogram)
+{
+   std::cout << "  " << name << " (us): p50 " << static_cast<double>(histogram.percentile(50.0)) / 1000.0
+      << ", p99 " << static_cast<double>(histogram.percentile(99.0)) / 1000.0
+      << ", max " << static_cast<double>(histogram.max_ns) / 1000.0
+      << ", mean " << static_cast<double>(histogram.mean()) / 1000.0 << " (" << histogram.count << " samples)\n";
+}
+
+int main(int argc, char** argv)
+{
+   Options options;
+   if (!parse_options(argc, argv, options))
+   {
+      print_usage(argv[0]);
+      return 1;
+   }
+#ifdef _WIN32
+   init_wsa();
+#endif
+   BenchContext context{ options };
+   auto result = context.writer.build_node(create_node_text(provide_node_name, 'P', options.num_ports, options.element_type, options.depth));
+   if (result == APX_NO_ERROR)
+   {
+      result = context.reader.build_node(create_node_text(require_node_name, 'R', options.num_ports, options.element_type, options.depth));
+   }
+   if (result != APX_NO_ERROR)
+   {
+      std::cerr << "build_node failed with error " << static_cast<int>(result) << std::endl;
+      return 1;
+   }
+   std::size_t port_data_size{ 0u };
+   for (std::size_t i = 0u; i < options.num_ports; i++)
+   {
+      auto* port = context.writer.get_port(provide_node_name, "Signal" + std::to_string(i));
+      context.provide_ports.push_back(port);
+      port_data_size = port->data_size();
+   }
+   result = connect(context, options);
+   if (result != APX_NO_ERROR)
+   {
+      std::cerr << "Connect failed with error " << static_cast<int>(result) << std::endl;
+      return 1;
+   }
+   if (!wait_for(context, std::chrono::milliseconds(5000), is_connected))
+   {
+      std::cerr << "Timeout while connecting to server" << std::endl;
+      return 1;
+   }
+
+   //Warm-up also verifies that every provide port is routed to the reader
+   std::size_t num_errors{ 0u };
+   for (std::size_t round = 0u; round < options.warmup_rounds; round++)
+   {
+      for (std::size_t i = 0u; i < options.num_ports; i++)
+      {
+         write_port(context, i, num_errors);
+      }
+      if (!wait_for(context, std::chrono::milliseconds(5000), is_idle))
+      {
+         std::cerr << "Timeout during warm-up, " << context.reader_events.num_in_flight() << " ports never received data" << std::endl;
+         return 1;
+      }
+   }
+   (void)context.reader_events.take_samples();
+   apx::trace::clear();
+   context.writer.set_latency_tracing(true);
+   context.reader.set_latency_tracing(true);
+
+   std::size_t num_writes{ 0u };
+   std::size_t num_skipped{ 0u };
+   num_errors = 0u;
+   std::size_t port_index{ 0u };
+   auto const interval = (options.rate > 0.0) ?
+      std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(1.0 / options.rate)) : Clock::duration::zero();
+   auto const start_time = Clock::now();
+   auto const end_time = start_time + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(options.duration));
+   auto next_write = start_time;
+   while (Clock::now() < end_time)
+   {
+      if (Clock::now() >= next_write)
+      {
+         if (write_port(context, port_index, num_errors))
+         {
+            num_writes++;
+         }
+         else
+         {
+            num_skipped++;
+         }
+         port_index = (port_index + 1) % options.num_ports;
+         next_write += interval;
+      }
+      poll(context);
+#ifndef UNIT_TEST
+      if (interval > Clock::duration::zero())
+      {
+         std::this_thread::sleep_until(std::min(next_write, end_time));
+      }
+#endif
+   }
+   (void)wait_for(context, std::chrono::milliseconds(1000), is_idle);
+   auto const elapsed = std::chrono::duration<double>(Clock::now() - start_time).count();
+   std::size_t const num_lost = context.reader_events.num_in_flight();
+   auto samples = context.reader_events.take_samples();
+   auto const summary = summarize(samples);
+
+   std::cout << std::fixed << std::setprecision(1);
+   std::cout << "ports: " << options.num_ports << " x " << type_name(options.element_type);
+   if (options.depth > 0u)
+   {
+      std::cout << ", record depth " << options.depth;
+   }
+   std::cout << " (" << port_data_size << " bytes)\n";
+   std::cout << "writes: " << num_writes << ", received: " << samples.size() << ", skipped (port busy): " << num_skipped
+      << ", write errors: " << num_errors << ", lost: " << num_lost << "\n";
+   std::cout << "throughput: " << static_cast<double>(samples.size()) / elapsed << " msg/s, "
+      << static_cast<double>(samples.size() * port_data_size) / elapsed << " bytes/s\n";
+   std::cout << "latency (us): min " << summary.min << ", p50 " << summary.p50 << ", p99 " << summary.p99
+      << ", p999 " << summary.p999 << ", max " << summary.max << ", mean " << summary.mean << std::endl;
+   apx::LatencySnapshot writer_latency;
+   apx::LatencySnapshot reader_latency;
+   context.writer.get_latency(writer_latency);
+   context.reader.get_latency(reader_latency);
+   print_stage("write_to_queue", writer_latency.write_to_queue);
+   print_stage("queue_to_send", writer_latency.queue_to_send);
+   print_stage("receive_to_notify", reader_latency.receive_to_notify);
+   if (!options.trace_file.empty())
+   {
+#if APX_TRACE_ENABLE
+      if (apx::trace::write_chrome_trace(options.trace_file.c_str()) != APX_NO_ERROR)
+      {
+         std::cerr << "Failed to write " << options.trace_file << std::endl;
+      }
+#else
+      std::cerr << "Tracing is not compiled in, rebuild with -DAPX_TRACE=ON" << std::endl;
+#endif
+   }
+#ifndef UNIT_TEST
+   if (context.server)
+   {
+      context.server->stop();
+   }
+#endif
+   return 0;
+}
+
+#ifdef _WIN32
+static int init_wsa(void)
+{
+   WORD wVersionRequested;
+   WSADATA wsaData;
+   int err;
+   wVersionRequested = MAKEWORD(2, 2);
+   err = WSAStartup(wVersionRequested, &wsaData);
+   return err;
+}
+#endif
@@ -0,0 +1,181 @@
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "cpp-apx/client.h"
+#include "cpp-apx/capture.h"
+
+/*
+* Replays a capture recorded with Client::start_capture into a new client connected to a test socket.
+* Only available in UNIT_TEST builds since it needs the synchronous test socket.
+*/
+
+struct Options
+{
+   std::string capture_file{};
+   std::vector<std::string> node_files{};
+   apx::ReplaySpeed speed{ apx::ReplaySpeed::Maximum };
+   std::size_t repeat{ 1u };
+};
+
+class NotificationCounter : public apx::ClientEventListener
+{
+public:
+   void connected1(apx::ClientConnection* connection) override { (void)connection; }
+   void disconnected1(apx::ClientConnection* connection) override { (void)connection; }
+   void require_port_written1(apx::PortInstance* port_instance) override
+   {
+      (void)port_instance;
+      m_count++;
+   }
+   std::size_t count() const { return m_count; }
+protected:
+   std::size_t m_count{ 0u };
+};
+
+static void print_usage(char const* program_name)
+{
+   std::cout << "Usage: " << program_name << " [options] CAPTURE_FILE\n"
+      "  --node FILE       APX definition of a node in the captured client, repeat for each node\n"
+      "  --speed S         original or max (default max)\n"
+      "  --repeat N        Number of times to replay the capture (default 1)\n";
+}
+
+static bool parse_options(int argc, char** argv, Options& options)
+{
+   for (int i = 1; i < argc; i++)
+   {
+      std::string const arg{ argv[i] };
+      if (arg == "--help" || arg == "-h")
+      {
+         return false;
+      }
+      if (arg.rfind("--", 0) != 0)
+      {
+         options.capture_file = arg;
+         continue;
+      }
+      if (i + 1 >= argc)
+      {
+         std::cerr << "Missing value for " << arg << std::endl;
+         return false;
+      }
+      std::string const value{ argv[++i] };
+      if (arg == "--node")
+      {
+         options.node_files.push_back(value);
+      }
+      else if (arg == "--speed")
+      {
+         if (value == "original")
+         {
+            options.speed = apx::ReplaySpeed::Original;
+         }
+         else if (value == "max")
+         {
+            options.speed = apx::ReplaySpeed::Maximum;
+         }
+         else
+         {
+            std::cerr << "Unknown speed: " << value << std::endl;
+            return false;
+         }
+      }
+      else if (arg == "--repeat")
+      {
+         options.repeat = static_cast<std::size_t>(std::strtoul(value.c_str(), nullptr, 10));
+      }
+      else
+      {
+         std::cerr << "Unknown option: " << arg << std::endl;
+         return false;
+      }
+   }
+   if (options.capture_file.empty() || options.node_files.empty() || (options.repeat == 0u))
+   {
+      std::cerr << "A capture file, at least one --node and a non-zero --repeat are required" << std::endl;
+      return false;
+   }
+   return true;
+}
+
+static bool read_text_file(std::string const& path, std::string& text)
+{
+   std::ifstream file{ path };
+   if (!file.is_open())
+   {
+      return false;
+   }
+   std::ostringstream ss;
+   ss << file.rdbuf();
+   text = ss.str();
+   return true;
+}
+
+int main(int argc, char** argv)
+{
+   Options options;
+   if (!parse_options(argc, argv, options))
+   {
+      print_usage(argv[0]);
+      return 1;
+   }
+   std::vector<std::string> definitions;
+   for (auto const& path : options.node_files)
+   {
+      std::string text;
+      if (!read_text_file(path, text))
+      {
+         std::cerr << "Failed to read " << path << std::endl;
+         return 1;
+      }
+      definitions.push_back(std::move(text));
+   }
+   std::size_t total_frames{ 0u };
+   std::size_t total_bytes{ 0u };
+   std::size_t total_notifications{ 0u };
+   std::chrono::steady_clock::duration total_elapsed{};
+   for (std::size_t i = 0u; i < options.repeat; i++)
+   {
+      apx::Client client;
+      NotificationCounter counter;
+      client.register_event_listener(&counter);
+      for (auto const& definition : definitions)
+      {
+         auto result = client.build_node(definition);
+         if (result != APX_NO_ERROR)
+         {
+            std::cerr << "build_node failed with error " << static_cast<int>(result) << std::endl;
+            return 1;
+         }
+      }
+      auto* socket = testsocket_new();
+      client.connect(socket);
+      client.run();
+      apx::ReplayResult replay_result;
+      auto result = apx::replay_capture(options.capture_file.c_str(), client, socket, options.speed, replay_result);
+      if (result != APX_NO_ERROR)
+      {
+         std::cerr << "Replay failed with error " << static_cast<int>(result) << std::endl;
+         return 1;
+      }
+      total_frames += replay_result.num_frames;
+      total_bytes += replay_result.num_bytes;
+      total_notifications += counter.count();
+      total_elapsed += replay_result.elapsed;
+   }
+   auto const seconds = std::chrono::duration<double>(total_elapsed).count();
+   std::cout << std::fixed << std::setprecision(1);
+   std::cout << "replays: " << options.repeat << ", frames: " << total_frames << ", bytes: " << total_bytes
+      << ", require port notifications: " << total_notifications << "\n";
+   if (seconds > 0.0)
+   {
+      std::cout << "elapsed: " << seconds * 1000.0 << " ms, " << static_cast<double>(total_frames) / seconds << " frames/s, "
+         << static_cast<double>(total_bytes) / seconds / 1e6 << " MB/s" << std::endl;
+   }
+   return 0;
+}
@@ -0,0 +1,146 @@
+#include <array>
+#include <chrono>
+#include <memory>
+#include <string>
+#include <benchmark/benchmark.h>
+#include "cpp-apx/node_manager.h"
+#include "cpp-apx/parser.h"
+#include "cpp-apx/sha256.h"
+#include "definition_generator.h"
+
+using namespace apx;
+
+namespace apx_bench
+{
+   using Clock = std::chrono::steady_clock;
+
+   /*
+   * Gives the benchmark access to the individual steps of NodeManager::build_node.
+   */
+   class PhaseNodeManager : public NodeManager
+   {
+   public:
+      using NodeManager::create_ports_on_node_instance;
+      using NodeManager::create_init_data_on_node_instance;
+   };
+
+   enum BuildPhase
+   {
+      PHASE_PARSE,
+      PHASE_FINALIZE,
+      PHASE_COMPILE,
+      PHASE_INIT_DATA,
+      PHASE_NODE_DATA,
+      PHASE_BYTE_MAP,
+      PHASE_SHA256,
+      NUM_PHASES
+   };
+
+   static char const* phase_names[NUM_PHASES] = { "parse", "finalize", "compile", "init_data", "node_data", "byte_map", "sha256" };
+
+   static DefinitionOptions make_options(benchmark::State const& state)
+   {
+      DefinitionOptions options;
+      options.num_provide_ports = static_cast<std::size_t>(state.range(0)) / 2;
+      options.num_require_ports = static_cast<std::size_t>(state.range(0)) - options.num_provide_ports;
+      options.num_types = static_cast<std::size_t>(state.range(1));
+      return options;
+   }
+
+   /*
+   * Runs the same steps as NodeManager::build_node (plus the SHA256 digest calculated on connect)
+   * and reports the average time of each step as a counter.
+   */
+   static void BM_BuildNodePhases(benchmark::State& state)
+   {
+      std::string const definition = generate_definition("BenchNode", make_options(state));
+      auto const* definition_data = reinterpret_cast<std::uint8_t const*>(definition.data());
+      std::array<double, NUM_PHASES> phase_total{};
+      for (auto _ : state)
+      {
+         std::array<Clock::time_point, NUM_PHASES + 1> t;
+         Parser parser;
+         PhaseNodeManager manager;
+         t[PHASE_PARSE] = Clock::now();
+         auto result = parser.parse_declarations(definition);
+         t[PHASE_FINALIZE] = Clock::now();
+         auto node = parser.take_last_node();
+         if (node == nullptr)
+         {
+            state.SkipWithError("parse failed");
+            break;
+         }
+         if (result == APX_NO_ERROR)
+         {
+            result = node->finalize();
+         }
+         t[PHASE_COMPILE] = Clock::now();
+         auto node_instance = std::make_unique<NodeInstance>(node->get_name());
+         std::size_t provide_port_data_size{ 0u };
+         std::size_t require_port_data_size{ 0u };
+         if (result == APX_NO_ERROR)
+         {
+            result = manager.create_ports_on_node_instance(node_instance.get(), node.get(), provide_port_data_size, require_port_data_size);
+         }
+         t[PHASE_INIT_DATA] = Clock::now();
+         if (result == APX_NO_ERROR)
+         {
+            result = manager.create_init_data_on_node_instance(node_instance.get(), node.get(), provide_port_data_size, require_port_data_size);
+         }
+         t[PHASE_NODE_DATA] = Clock::now();
+         if (result == APX_NO_ERROR)
+         {
+            result = node_instance->create_node_data(definition_data, definition.size());
+         }
+         t[PHASE_BYTE_MAP] = Clock::now();
+         if (result == APX_NO_ERROR)
+         {
+            node_instance->create_require_port_byte_map();
+         }
+         t[PHASE_SHA256] = Clock::now();
+         std::array<std::uint8_t, 32> digest;
+         sha256::calc(digest.data(), digest.size(), definition_data, definition.size());
+         benchmark::DoNotOptimize(digest);
+         t[NUM_PHASES] = Clock::now();
+         if (result != APX_NO_ERROR)
+         {
+            state.SkipWithError("build_node failed");
+            break;
+         }
+         for (std::size_t i = 0u; i < NUM_PHASES; i++)
+         {
+            phase_total[i] += std::chrono::duration<double, std::milli>(t[i + 1] - t[i]).count();
+         }
+         state.SetIterationTime(std::chrono::duration<double>(t[NUM_PHASES] - t[PHASE_PARSE]).count()); //Excludes teardown
+      }
+      for (std::size_t i = 0u; i < NUM_PHASES; i++)
+      {
+         state.counters[std::string(phase_names[i]) + "_ms"] = benchmark::Counter(phase_total[i], benchmark::Counter::kAvgIterations);
+      }
+      state.counters["ports"] = static_cast<double>(state.range(0));
+      state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * static_cast<std::int64_t>(definition.size()));
+   }
+   BENCHMARK(BM_BuildNodePhases)->Args({ 1000, 10 })->Args({ 10000, 100 })->Args({ 100000, 1000 })
+      ->UseManualTime()->Unit(benchmark::kMillisecond);
+
+   static void BM_BuildNode(benchmark::State& state)
+   {
+      std::string const definition = generate_definition("BenchNode", make_options(state));
+      for (auto _ : state)
+      {
+         state.PauseTiming();
+         auto manager = std::make_unique<NodeManager>();
+         state.ResumeTiming();
+         if (manager->build_node(definition) != APX_NO_ERROR)
+         {
+            state.SkipWithError("build_node failed");
+            break;
+         }
+         state.PauseTiming();
+         manager.reset();
+         state.ResumeTiming();
+      }
+      state.SetBytesProcessed(static_cast<std::int64_t>(state.iterations()) * static_cast<std::int64_t>(definition.size()));
+   }
+   BENCHMARK(BM_BuildNode)->Args({ 1000, 10 })->Args({ 10000, 100 })->Args({ 100000, 1000 })->Unit(benchmark::kMillisecond);
+}
@@ -0,0 +1,162 @@
+#include <atomic>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "cpp-apx/server.h"
+
+using namespace apx;
+
+namespace apx_bench
+{
+   /*
+   * Server side connection that only counts transmitted data messages.
+   */
+   class BenchServerConnection : public ServerConnection
+   {
+   public:
+      BenchServerConnection(Server* parent_server) : ServerConnection{ parent_server } {}
+      std::int32_t transmit_max_bytes_avaiable() const override { return INT32_MAX; }
+      std::int32_t transmit_current_bytes_avaiable() const override { return INT32_MAX; }
+      void transmit_begin() override {}
+      void transmit_end() override {}
+      error_t transmit_data_message(std::uint32_t write_address, bool more_bit, std::uint8_t const* data, std::int32_t size, std::int32_t& bytes_available) override
+      {
+         (void)more_bit;
+         (void)data;
+         if (write_address < rmf::CMD_AREA_START_ADDRESS)
+         {
+            m_bytes_received.fetch_add(static_cast<std::size_t>(size), std::memory_order_relaxed);
+            m_messages_received.fetch_add(1u, std::memory_order_release);
+         }
+         bytes_available = INT32_MAX;
+         return APX_NO_ERROR;
+      }
+      error_t transmit_direct_message(std::uint8_t const* data, std::int32_t size, std::int32_t& bytes_available) override
+      {
+         (void)data;
+         (void)size;
+         bytes_available = INT32_MAX;
+         return APX_NO_ERROR;
+      }
+      /*
+      * Does what the connection would do after receiving the greeting and definition of a node
+      * from the client, followed by an open request for its require port data file.
+      */
+      NodeInstance* attach_node(std::string const& definition_text)
+      {
+         m_file_manager.connected();
+         auto& node_files = m_node_files["BenchNode"];
+         if (build_node_instance(node_files, definition_text) != APX_NO_ERROR)
+         {
+            return nullptr;
+         }
+         if (node_files.require_port_data_file != nullptr)
+         {
+            node_files.require_port_data_file->open();
+         }
+         return node_files.node_instance;
+      }
+      std::size_t messages_received() const { return m_messages_received.load(std::memory_order_acquire); }
+
+   protected:
+      std::atomic<std::size_t> m_bytes_received{ 0u };
+      std::atomic<std::size_t> m_messages_received{ 0u };
+   };
+
+   /*
+   * One publisher node whose single provide port is required by fan_out subscriber nodes, each on its own connection.
+   */
+   class FanOutFixture
+   {
+   public:
+      FanOutFixture(std::size_t fan_out, std::size_t data_size)
+      {
+         std::string const signature = "\"Payload\"C[" + std::to_string(data_size) + "]";
+         m_publisher = create_connection();
+         m_publisher_node = m_publisher->attach_node("APX/1.2\nN\"Publisher\"\nP" + signature + "\n");
+         for (std::size_t i = 0u; i < fan_out; i++)
+         {
+            auto* subscriber = create_connection();
+            subscriber->attach_node("APX/1.2\nN\"Subscriber" + std::to_string(i) + "\"\nR" + signature + "\n");
+            m_subscribers.push_back(subscriber);
+         }
+#ifndef UNIT_TEST
+         m_publisher->start();
+         for (auto* subscriber : m_subscribers)
+         {
+            subscriber->start();
+         }
+#endif
+      }
+      bool is_valid() const { return m_publisher_node != nullptr; }
+      void write(std::uint8_t const* data, std::size_t size)
+      {
+         m_server.provide_port_data_written(m_publisher, m_publisher_node, 0u, data, size);
+      }
+      void wait_for_delivery(std::size_t expected)
+      {
+         for (auto* subscriber : m_subscribers)
+         {
+#ifdef UNIT_TEST
+            subscriber->run();
+#endif
+            while (subscriber->messages_received() < expected)
+            {
+               std::this_thread::yield();
+            }
+         }
+      }
+
+   protected:
+      BenchServerConnection* create_connection()
+      {
+         return static_cast<BenchServerConnection*>(m_server.attach_connection(std::make_unique<BenchServerConnection>(&m_server)));
+      }
+
+      Server m_server;
+      BenchServerConnection* m_publisher{ nullptr };
+      NodeInstance* m_publisher_node{ nullptr };
+      std::vector<BenchServerConnection*> m_subscribers;
+   };
+
+   /*
+   * One provide port write routed by the server to all subscribers, measured until every subscriber connection has transmitted it.
+   * Writes up to COMMAND_INLINE_DATA_MAX_SIZE bytes are copied into each command queue, larger writes share one buffer.
+   */
+   static void BM_RouteProvidePortData(benchmark::State& state)
+   {
+      std::size_t const fan_out = static_cast<std::size_t>(state.range(0));
+      std::size_t const data_size = static_cast<std::size_t>(state.range(1));
+      std::vector<std::uint8_t> payload(data_size, 0x55u);
+      FanOutFixture fixture(fan_out, data_size);
+      if (!fixture.is_valid())
+      {
+         state.SkipWithError("Failed to build publisher node");
+         return;
+      }
+      std::size_t expected = 0u;
+      for (auto _ : state)
+      {
+         payload[0]++;
+         fixture.write(payload.data(), payload.size());
+         fixture.wait_for_delivery(++expected);
+      }
+      state.SetItemsProcessed(state.iterations() * static_cast<std::int64_t>(fan_out));
+      state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(fan_out * data_size));
+   }
+
+   static void fan_out_arguments(benchmark::internal::Benchmark* bench)
+   {
+      for (std::int64_t fan_out : { 1, 10, 100, 1000 })
+      {
+         for (std::int64_t data_size : { 32, 256, 4096 })
+         {
+            bench->Args({ fan_out, data_size });
+         }
+      }
+   }
+
+   BENCHMARK(BM_RouteProvidePortData)->Apply(fan_out_arguments)->ArgNames({ "fan_out", "bytes" })->UseRealTime();
+}
@@ -0,0 +1,394 @@
+#include <array>
+#include <cstring>
+#include <memory>
+#include <string>
+#include <vector>
+#include <benchmark/benchmark.h>
+#include "cpp-apx/node_manager.h"
+#include "cpp-apx/vm.h"
+
+using namespace apx;
+
+namespace apx_bench
+{
+   /*
+   * Compiles a node with a single provide port named "Port" and prepares a write buffer for it.
+   * This gives the same pack program as a client would use when writing the port.
+   */
+   class PackFixture
+   {
+   public:
+      PackFixture(std::string const& data_signature)
+      {
+         std::string const apx_text = "APX/1.2\nN\"BenchNode\"\nP\"Port\"" + data_signature + "\n";
+         m_result = m_manager.build_node(apx_text);
+         if (m_result == APX_NO_ERROR)
+         {
+            m_port = m_manager.get_last_attached()->find("Port");
+            m_buffer.resize(m_port->data_size());
+         }
+      }
+      error_t result() const { return m_result; }
+      std::size_t data_size() const { return m_buffer.size(); }
+      template <typename T>
+      error_t pack(T const& value)
+      {
+         auto retval = m_vm.select_program(m_port->pack_program());
+         if (retval == APX_NO_ERROR)
+         {
+            retval = m_vm.set_write_buffer(m_buffer.data(), m_buffer.size());
+         }
+         if (retval == APX_NO_ERROR)
+         {
+            retval = m_vm.pack_value(value);
+         }
+         return retval;
+      }
+
+   protected:
+      NodeManager m_manager;
+      PortInstance* m_port{ nullptr };
+      std::vector<std::uint8_t> m_buffer;
+      VirtualMachine m_vm;
+      error_t m_result{ APX_NO_ERROR };
+   };
+
+   template <typename T>
+   static void run_pack_benchmark(benchmark::State& state, char const* data_signature, T const& value)
+   {
+      PackFixture fixture{ data_signature };
+      if (fixture.result() != APX_NO_ERROR)
+      {
+         state.SkipWithError("build_node failed");
+         return;
+      }
+      if (fixture.pack(value) != APX_NO_ERROR)
+      {
+         state.SkipWithError("pack_value failed");
+         return;
+      }
+      for (auto _ : state)
+      {
+         benchmark::DoNotOptimize(fixture.pack(value));
+      }
+      state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(fixture.data_size()));
+   }
+
+   static dtl::ArrayValue make_u32_array(std::size_t length, std::uint32_t value)
+   {
+      auto av = dtl::make_av();
+      for (std::size_t i = 0u; i < length; i++)
+      {
+         av->push(dtl::make_sv<std::uint32_t>(value));
+      }
+      return av;
+   }
+
+   static void BM_VmPackUInt8(benchmark::State& state)
+   {
+      run_pack_benchmark(state, "C", dtl::make_sv<std::uint32_t>(7u));
+   }
+
+   static void BM_VmPackUInt8WithRange(benchmark::State& state)
+   {
+      run_pack_benchmark(state, "C(0,250)", dtl::make_sv<std::uint32_t>(7u));
+   }
+
+   static void BM_VmPackUInt16(benchmark::State& state)
+   {
+      run_pack_benchmark(state, "S", dtl::make_sv<std::uint32_t>(0x1234u));
+   }
+
+   static void BM_VmPackUInt32(benchmark::State& state)
+   {
+      run_pack_benchmark(state, "L", dtl::make_sv<std::uint32_t>(0x12345678u));
+   }
+
+   static void BM_VmPackInt32(benchmark::State& state)
+   {
+      run_pack_benchmark(state, "l(-1000,1000)", dtl::make_sv<std::int32_t>(-100));
+   }
+
+   static void BM_VmPackUInt64(benchmark::State& state)
+   {
+      run_pack_benchmark(state, "Q", dtl::make_sv<std::uint64_t>(0x123456789ull));
+   }
+
+   static void BM_VmPackUInt8Array(benchmark::State& state)
+   {
+      auto av = make_u32_array(32u, 0x12u);
+      run_pack_benchmark(state, "C[32]", av.get());
+   }
+
+   static void BM_VmPackUInt32Array(benchmark::State& state)
+   {
+      auto av = make_u32_array(16u, 0x12345678u);
+      run_pack_benchmark(state, "L[16]", av.get());
+   }
+
+   static void BM_VmPackUInt8DynamicArray(benchmark::State& state)
+   {
+      auto av = make_u32_array(48u, 0x12u);
+      run_pack_benchmark(state, "C[64*]", av.get());
+   }
+
+   static void BM_VmPackUInt16DynamicArray(benchmark::State& state)
+   {
+      auto av = make_u32_array(24u, 0x1234u);
+      run_pack_benchmark(state, "S[32*]", av.get());
+   }
+
+   static void BM_VmPackString(benchmark::State& state)
+   {
+      run_pack_benchmark(state, "a[32]", dtl::make_sv<std::string>("The quick brown fox"));
+   }
+
+   static void BM_VmPackDynamicString(benchmark::State& state)
+   {
+      run_pack_benchmark(state, "a[32*]", dtl::make_sv<std::string>("The quick brown fox"));
+   }
+
+   static void BM_VmPackRecord(benchmark::State& state)
+   {
+      auto hv = dtl::make_hv({
+         std::make_pair("First", dtl::make_sv_dv<std::uint32_t>(0x12u)),
+         std::make_pair("Second", dtl::make_sv_dv<std::uint32_t>(0x1234u)),
+         std::make_pair("Third", dtl::make_sv_dv<std::uint32_t>(0x12345678u))
+         });
+      run_pack_benchmark(state, "{\"First\"C\"Second\"S\"Third\"L}", hv.get());
+   }
+
+   static void BM_VmPackNestedRecord(benchmark::State& state)
+   {
+      auto hv = dtl::make_hv({
+         std::make_pair("First", dtl::make_hv_dv({
+            std::make_pair("Inner1", dtl::make_sv_dv<std::uint32_t>(0x12u)),
+            std::make_pair("Inner2", dtl::make_sv_dv<std::uint32_t>(0x1234u))
+            })),
+         std::make_pair("Second", dtl::make_hv_dv({
+            std::make_pair("Inner3", dtl::make_sv_dv<std::uint32_t>(0x1234u)),
+            std::make_pair("Inner4", dtl::make_sv_dv<std::string>("Name"))
+            }))
+         });
+      run_pack_benchmark(state, "{\"First\"{\"Inner1\"C\"Inner2\"S}\"Second\"{\"Inner3\"S\"Inner4\"a[8]}}", hv.get());
+   }
+
+   static void BM_VmPackArrayOfRecord(benchmark::State& state)
+   {
+      auto av = dtl::make_av();
+      for (std::uint32_t i = 0u; i < 8u; i++)
+      {
+         av->push(dtl::make_hv_dv({
+            std::make_pair("Id", dtl::make_sv_dv<std::uint32_t>(i)),
+            std::make_pair("Value", dtl::make_sv_dv<std::uint32_t>(i * 1000u))
+            }));
+      }
+      run_pack_benchmark(state, "{\"Id\"C\"Value\"L}[8]", av.get());
+   }
+
+   /*
+   * Queued ports are not yet supported by the VM pack program, this measures the serializer part directly.
+   */
+   static void BM_SerializerPackQueuedUInt8(benchmark::State& state)
+   {
+      constexpr std::size_t queue_length = 10u;
+      std::vector<std::uint8_t> buffer(vm::UINT8_SIZE + vm::UINT8_SIZE * queue_length);
+      vm::Serializer serializer;
+      auto sv = dtl::make_sv<std::uint32_t>(7u);
+      for (auto _ : state)
+      {
+         serializer.set_write_buffer(buffer.data(), buffer.size());
+         serializer.queued_write_begin(vm::UINT8_SIZE, queue_length, true);
+         serializer.set_value(sv);
+         benchmark::DoNotOptimize(serializer.pack_uint8(0u, SizeType::UInt8));
+         serializer.queued_write_end();
+      }
+      state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(vm::UINT8_SIZE));
+   }
+
+   /*
+   * Compiles a node with a single require port named "Port". Unpacking uses the same program as
+   * a client does when it reads the port.
+   */
+   class UnpackFixture
+   {
+   public:
+      UnpackFixture(std::string const& data_signature)
+      {
+         std::string const apx_text = "APX/1.2\nN\"BenchNode\"\nR\"Port\"" + data_signature + "\n";
+         m_result = m_manager.build_node(apx_text);
+         if (m_result == APX_NO_ERROR)
+         {
+            m_port = m_manager.get_last_attached()->find("Port");
+         }
+      }
+      error_t result() const { return m_result; }
+      error_t unpack(std::uint8_t const* data, std::size_t size)
+      {
+         auto retval = m_vm.select_program(m_port->unpack_program());
+         if (retval == APX_NO_ERROR)
+         {
+            retval = m_vm.set_read_buffer(data, size);
+         }
+         if (retval == APX_NO_ERROR)
+         {
+            retval = m_vm.unpack_value(m_value);
+         }
+         return retval;
+      }
+
+   protected:
+      NodeManager m_manager;
+      PortInstance* m_port{ nullptr };
+      VirtualMachine m_vm;
+      dtl::DynamicValue m_value; //Reused between iterations, like a client reading the same port repeatedly
+      error_t m_result{ APX_NO_ERROR };
+   };
+
+   template <std::size_t N>
+   static void run_unpack_benchmark(benchmark::State& state, char const* data_signature, std::array<std::uint8_t, N> const& data)
+   {
+      UnpackFixture fixture{ data_signature };
+      if (fixture.result() != APX_NO_ERROR)
+      {
+         state.SkipWithError("build_node failed");
+         return;
+      }
+      if (fixture.unpack(data.data(), data.size()) != APX_NO_ERROR)
+      {
+         state.SkipWithError("unpack_value failed");
+         return;
+      }
+      for (auto _ : state)
+      {
+         benchmark::DoNotOptimize(fixture.unpack(data.data(), data.size()));
+      }
+      state.SetBytesProcessed(state.iterations() * static_cast<std::int64_t>(data.size()));
+   }
+
+   static void BM_VmUnpackUInt8(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::UINT8_SIZE> const data{ 0x12u };
+      run_unpack_benchmark(state, "C", data);
+   }
+
+   static void BM_VmUnpackUInt8WithRange(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::UINT8_SIZE> const data{ 0x12u };
+      run_unpack_benchmark(state, "C(0,250)", data);
+   }
+
+   static void BM_VmUnpackUInt16(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::UINT16_SIZE> const data{ 0x34u, 0x12u };
+      run_unpack_benchmark(state, "S", data);
+   }
+
+   static void BM_VmUnpackUInt32(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::UINT32_SIZE> const data{ 0x78u, 0x56u, 0x34u, 0x12u };
+      run_unpack_benchmark(state, "L", data);
+   }
+
+   static void BM_VmUnpackInt32(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::INT32_SIZE> const data{ 0x9Cu, 0xFFu, 0xFFu, 0xFFu };
+      run_unpack_benchmark(state, "l(-1000,1000)", data);
+   }
+
+   static void BM_VmUnpackUInt64(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::UINT64_SIZE> const data{ 0x89u, 0x67u, 0x45u, 0x23u, 0x01u, 0u, 0u, 0u };
+      run_unpack_benchmark(state, "Q", data);
+   }
+
+   static void BM_VmUnpackUInt8Array(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::UINT8_SIZE * 32> data;
+      data.fill(0x12u);
+      run_unpack_benchmark(state, "C[32]", data);
+   }
+
+   static void BM_VmUnpackUInt32Array(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::UINT32_SIZE * 16> data;
+      data.fill(0x12u);
+      run_unpack_benchmark(state, "L[16]", data);
+   }
+
+   static void BM_VmUnpackUInt8DynamicArray(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::UINT8_SIZE + vm::UINT8_SIZE * 64> data;
+      data.fill(0x12u);
+      data[0] = 48u;
+      run_unpack_benchmark(state, "C[64*]", data);
+   }
+
+   static void BM_VmUnpackUInt16DynamicArray(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::UINT8_SIZE + vm::UINT16_SIZE * 32> data;
+      data.fill(0x12u);
+      data[0] = 24u;
+      run_unpack_benchmark(state, "S[32*]", data);
+   }
+
+   static void BM_VmUnpackString(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::CHAR_SIZE * 32> data;
+      data.fill(0u);
+      std::memcpy(data.data(), "The quick brown fox", 19);
+      run_unpack_benchmark(state, "a[32]", data);
+   }
+
+   static void BM_VmUnpackDynamicString(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::UINT8_SIZE + vm::CHAR_SIZE * 32> data;
+      data.fill(0u);
+      data[0] = 19u;
+      std::memcpy(data.data() + 1, "The quick brown fox", 19);
+      run_unpack_benchmark(state, "a[32*]", data);
+   }
+
+   static void BM_VmUnpackRecord(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::UINT8_SIZE + vm::UINT16_SIZE + vm::UINT32_SIZE> const data{ 0x12u, 0x34u, 0x12u, 0x78u, 0x56u, 0x34u, 0x12u };
+      run_unpack_benchmark(state, "{\"First\"C\"Second\"S\"Third\"L}", data);
+   }
+
+   static void BM_VmUnpackNestedRecord(benchmark::State& state)
+   {
+      std::array<std::uint8_t, vm::UINT8_SIZE + vm::UINT16_SIZE + vm::UINT16_SIZE + vm::UINT32_SIZE> const data{ 0x12, 0x34, 0x12, 0x34, 0x12, 0x78, 0x56, 0x34, 0x12 };
+      run_unpack_benchmark(state, "{\"First\"{\"Inner1\"C\"Inner2\"S}\"Second\"{\"Inner3\"S\"Inner4\"L}}", data);
+   }
+
+   BENCHMARK(BM_VmPackUInt8);
+   BENCHMARK(BM_VmPackUInt8WithRange);
+   BENCHMARK(BM_VmPackUInt16);
+   BENCHMARK(BM_VmPackUInt32);
+   BENCHMARK(BM_VmPackInt32);
+   BENCHMARK(BM_VmPackUInt64);
+   BENCHMARK(BM_VmPackUInt8Array);
+   BENCHMARK(BM_VmPackUInt32Array);
+   BENCHMARK(BM_VmPackUInt8DynamicArray);
+   BENCHMARK(BM_VmPackUInt16DynamicArray);
+   BENCHMARK(BM_VmPackString);
+   BENCHMARK(BM_VmPackDynamicString);
+   BENCHMARK(BM_VmPackRecord);
+   BENCHMARK(BM_VmPackNestedRecord);
+   BENCHMARK(BM_VmPackArrayOfRecord);
+   BENCHMARK(BM_SerializerPackQueuedUInt8);
+   BENCHMARK(BM_VmUnpackUInt8);
+   BENCHMARK(BM_VmUnpackUInt8WithRange);
+   BENCHMARK(BM_VmUnpackUInt16);
+   BENCHMARK(BM_VmUnpackUInt32);
+   BENCHMARK(BM_VmUnpackInt32);
+   BENCHMARK(BM_VmUnpackUInt64);
+   BENCHMARK(BM_VmUnpackUInt8Array);
+   BENCHMARK(BM_VmUnpackUInt32Array);
+   BENCHMARK(BM_VmUnpackUInt8DynamicArray);
+   BENCHMARK(BM_VmUnpackUInt16DynamicArray);
+   BENCHMARK(BM_VmUnpackString);
+   BENCHMARK(BM_VmUnpackDynamicString);
+   BENCHMARK(BM_VmUnpackRecord);
+   BENCHMARK(BM_VmUnpackNestedRecord);
+}
@@ -0,0 +1,136 @@
+#include <sstream>
+#include "definition_generator.h"
+
+namespace apx_bench
+{
+   enum class TypeKind
+   {
+      ValueTable,
+      RationalScaling,
+      Array,
+      Record,
+      Scalar
+   };
+
+   static constexpr std::size_t NUM_TYPE_KINDS = 5u;
+
+   static TypeKind type_kind(std::size_t type_index)
+   {
+      return static_cast<TypeKind>(type_index % NUM_TYPE_KINDS);
+   }
+
+   static void write_record_signature(std::ostringstream& ss, DefinitionOptions const& options, std::size_t level)
+   {
+      static char const* field_types[] = { "C", "S", "L" };
+      ss << '{';
+      for (std::size_t i = 0u; i < options.record_fields; i++)
+      {
+         ss << "\"Field" << level << '_' << i << '"' << field_types[i % 3];
+      }
+      if (level + 1 < options.record_depth)
+      {
+         ss << "\"Inner" << level << '"';
+         write_record_signature(ss, options, level + 1);
+      }
+      ss << '}';
+   }
+
+   static void write_record_init_value(std::ostringstream& ss, DefinitionOptions const& options, std::size_t level)
+   {
+      ss << '{';
+      for (std::size_t i = 0u; i < options.record_fields; i++)
+      {
+         ss << (i > 0u ? ", " : "") << '0';
+      }
+      if (level + 1 < options.record_depth)
+      {
+         ss << (options.record_fields > 0u ? ", " : "");
+         write_record_init_value(ss, options, level + 1);
+      }
+      ss << '}';
+   }
+
+   static void write_type_declaration(std::ostringstream& ss, DefinitionOptions const& options, std::size_t type_index)
+   {
+      ss << "T\"Type" << type_index << "_T\"";
+      switch (type_kind(type_index))
+      {
+      case TypeKind::ValueTable:
+         ss << "C(0,3):VT(\"Off\",\"On\",\"Error\",\"NotAvailable\")";
+         break;
+      case TypeKind::RationalScaling:
+         ss << "S:RS(0,0xFDFF,0,1,64,\"km/h\"),VT(0xFE00,0xFEFF,\"Error\"),VT(0xFF00,0xFFFF,\"NotAvailable\")";
+         break;
+      case TypeKind::Array:
+         ss << "C[" << options.array_length << ']';
+         break;
+      case TypeKind::Record:
+         write_record_signature(ss, options, 0u);
+         break;
+      case TypeKind::Scalar:
+         ss << 'L';
+         break;
+      }
+      ss << '\n';
+   }
+
+   static void write_init_value(std::ostringstream& ss, DefinitionOptions const& options, std::size_t type_index)
+   {
+      switch (type_kind(type_index))
+      {
+      case TypeKind::ValueTable:
+         ss << '3';
+         break;
+      case TypeKind::RationalScaling:
+         ss << "0xFFFF";
+         break;
+      case TypeKind::Array:
+         ss << '{';
+         for (std::size_t i = 0u; i < options.array_length; i++)
+         {
+            ss << (i > 0u ? ", " : "") << '0';
+         }
+         ss << '}';
+         break;
+      case TypeKind::Record:
+         write_record_init_value(ss, options, 0u);
+         break;
+      case TypeKind::Scalar:
+         ss << '0';
+         break;
+      }
+   }
+
+   static void write_port_declarations(std::ostringstream& ss, DefinitionOptions const& options, char port_kind, std::size_t num_ports)
+   {
+      for (std::size_t i = 0u; i < num_ports; i++)
+      {
+         std::size_t const type_index = (options.num_types > 0u) ? (i % options.num_types) : NUM_TYPE_KINDS - 1;
+         ss << port_kind << "\"" << (port_kind == 'P' ? "Provide" : "Require") << "Port" << i << '"';
+         if (options.num_types > 0u)
+         {
+            ss << "T[\"Type" << type_index << "_T\"]";
+         }
+         else
+         {
+            ss << 'L';
+         }
+         ss << ":=";
+         write_init_value(ss, options, type_index);
+         ss << '\n';
+      }
+   }
+
+   std::string generate_definition(char const* node_name, DefinitionOptions const& options)
+   {
+      std::ostringstream ss;
+      ss << "APX/1.3\n" << "N\"" << node_name << "\"\n";
+      for (std::size_t i = 0u; i < options.num_types; i++)
+      {
+         write_type_declaration(ss, options, i);
+      }
+      write_port_declarations(ss, options, 'P', options.num_provide_ports);
+      write_port_declarations(ss, options, 'R', options.num_require_ports);
+      return ss.str();
+   }
+}
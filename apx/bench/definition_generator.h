@@ -0,0 +1,25 @@
+#pragma once
+
+#include <cstddef>
+#include <string>
+
+namespace apx_bench
+{
+   struct DefinitionOptions
+   {
+      std::size_t num_provide_ports{ 100u };
+      std::size_t num_require_ports{ 100u };
+      std::size_t num_types{ 10u };
+      std::size_t record_depth{ 2u }; //Nesting level of generated record types
+      std::size_t record_fields{ 3u }; //Scalar fields on each record level
+      std::size_t array_length{ 4u };
+   };
+
+   /*
+   * Generates an APX definition that resembles production nodes.
+   * Type declarations cycle through value tables, rational scaling with value tables,
+   * arrays, nested records and plain scalars. Ports refer to the types in round-robin order
+   * and all ports have init values.
+   */
+   std::string generate_definition(char const* node_name, DefinitionOptions const& options);
+}
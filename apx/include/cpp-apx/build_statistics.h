@@ -0,0 +1,65 @@
+/*****************************************************************************
+* \file      build_statistics.h
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Statistics collected while building nodes
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#pragma once
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+namespace apx
+{
+   struct BuildNodeStatistics
+   {
+      using Duration = std::chrono::nanoseconds;
+
+      //Time spent in each phase of NodeManager::build_node
+      Duration parse_time{ 0 };
+      Duration type_derivation_time{ 0 };
+      Duration element_expansion_time{ 0 };
+      Duration init_value_derivation_time{ 0 };
+      Duration compile_time{ 0 };
+      Duration init_data_time{ 0 };
+      Duration total_time{ 0 };
+
+      //Size of the result
+      std::size_t definition_size{ 0u };
+      std::size_t num_ports{ 0u };
+      std::size_t num_programs{ 0u };
+      std::size_t program_bytes{ 0u };
+      std::size_t init_data_size{ 0u };
+
+      void add(BuildNodeStatistics const& other);
+      std::string to_string() const;
+   };
+
+   struct NodeManagerStatistics
+   {
+      std::size_t num_builds{ 0u };
+      std::size_t num_failed_builds{ 0u };
+      BuildNodeStatistics total; //Sum over all builds, including failed ones
+      BuildNodeStatistics::Duration max_total_time{ 0 };
+
+      std::string to_string() const;
+   };
+}
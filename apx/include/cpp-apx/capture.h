@@ -0,0 +1,116 @@
+/*****************************************************************************
+* \file      capture.h
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Record and replay of raw RMF traffic
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <fstream>
+#include <mutex>
+#include "cpp-apx/types.h"
+#include "cpp-apx/error.h"
+
+#ifdef UNIT_TEST
+#include "testsocket.h"
+#endif
+
+namespace apx
+{
+   /*
+   * Capture file format (all integers little endian):
+   *   File header: the 8 bytes "APXCAP01"
+   *   Frame:       u64 nanoseconds since capture start, u8 direction, u32 data size, data
+   * Received frames contain exactly the bytes consumed by the connection parser, so concatenating them reproduces the incoming stream.
+   * Sent frames contain one send_packet call each.
+   */
+   constexpr std::size_t CAPTURE_HEADER_SIZE = 8u;
+   constexpr std::size_t CAPTURE_FRAME_HEADER_SIZE = 8u + 1u + 4u;
+   constexpr std::size_t CAPTURE_FRAME_MAX_SIZE = MAX_FILE_SIZE;
+   constexpr char CAPTURE_MAGIC[CAPTURE_HEADER_SIZE + 1] = "APXCAP01";
+
+   enum class CaptureDirection : std::uint8_t
+   {
+      Received = 0u,
+      Sent = 1u
+   };
+
+   struct CaptureFrame
+   {
+      std::uint64_t timestamp_ns{ 0u };
+      CaptureDirection direction{ CaptureDirection::Received };
+      apx::ByteArray data;
+   };
+
+   /*
+   * Appends frames to a capture file. Frames can be written from any thread.
+   */
+   class CaptureWriter
+   {
+   public:
+      ~CaptureWriter() { close(); }
+      error_t open(char const* path);
+      void close();
+      bool is_open();
+      void write_frame(CaptureDirection direction, std::uint8_t const* data, std::size_t size);
+      std::size_t num_frames();
+   protected:
+      std::mutex m_mutex;
+      std::ofstream m_file;
+      std::chrono::steady_clock::time_point m_start_time;
+      std::size_t m_num_frames{ 0u };
+   };
+
+   class CaptureReader
+   {
+   public:
+      error_t open(char const* path);
+      error_t read_next(CaptureFrame& frame, bool& has_frame); //has_frame is false at the end of the file
+   protected:
+      std::ifstream m_file;
+      std::uint64_t m_file_size{ 0u };
+   };
+
+#ifdef UNIT_TEST
+   class Client;
+
+   enum class ReplaySpeed
+   {
+      Original, //Keeps the time between received frames
+      Maximum
+   };
+
+   struct ReplayResult
+   {
+      std::size_t num_frames{ 0u };
+      std::size_t num_bytes{ 0u };
+      std::chrono::steady_clock::duration elapsed{};
+   };
+
+   /*
+   * Feeds the received frames of a capture into client through the server side of its test socket.
+   * The client must have built the same nodes as the captured client and be connected to socket.
+   * Frames the captured client sent are skipped; the replayed client produces its own responses.
+   */
+   error_t replay_capture(char const* path, Client& client, testsocket_t* socket, ReplaySpeed speed, ReplayResult& result);
+#endif
+}
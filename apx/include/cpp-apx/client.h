@@ -23,8 +23,12 @@
 ******************************************************************************/
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <span>
+#include <string_view>
+#include <vector>
 #include "cpp-apx/socket_client_connection.h"
 #include "cpp-apx/event_listener.h"
 #include "cpp-apx/vm.h"
@@ -39,17 +43,40 @@ namespace apx
    {
    public:
       friend class ClientConnection;
-      error_t build_node(char const* apx_text);
-      error_t build_node(std::string const& apx_text);
+      error_t build_node(char const* apx_text, BuildNodeStatistics* statistics = nullptr);
+      error_t build_node(std::string const& apx_text, BuildNodeStatistics* statistics = nullptr);
+      NodeManagerStatistics const& get_build_statistics() const { return m_node_manager.get_statistics(); }
       void register_event_listener(ClientEventListener* listener) { m_event_listener = listener; }
       void unregister_event_listener() { m_event_listener = nullptr; }
 
       //Port API
       error_t read_port_value(PortInstance* port_instance, dtl::ScalarValue& sv);
       error_t write_port_value(PortInstance* port_instance, dtl::ScalarValue& sv);
+      //Reads scalars, arrays and records. An existing value of matching type is updated in place (including record fields),
+      //so repeated reads into the same dv do not allocate after the first one. On error dv may be partially updated.
+      //New values are allocated from resource when given (e.g. a std::pmr::monotonic_buffer_resource released between reads).
+      //Such values must be released before the resource is.
+      error_t read_port_value(PortInstance* port_instance, dtl::DynamicValue& dv, std::pmr::memory_resource* resource = nullptr);
+      error_t write_port_value(PortInstance* port_instance, dtl::DynamicValue const& dv);
+      //Zero-copy reads of byte array (B[n]) and string (a[n]) ports. The port data is copied once into snapshot
+      //(reusing its capacity) and the returned view points into it. The view stays valid until snapshot is modified.
+      error_t read_port_bytes(PortInstance* port_instance, apx::ByteArray& snapshot, std::span<std::uint8_t const>& bytes);
+      error_t read_port_string(PortInstance* port_instance, apx::ByteArray& snapshot, std::string_view& str);
       PortInstance* get_port(char const* node_name, char const* port_name);
       PortInstance* get_port(std::string const& node_name, std::string const& port_name);
 
+      //Flow control API
+      void set_transmit_high_water_mark(std::size_t num_bytes); //0 means unlimited. write_port_value returns APX_QUEUE_FULL_ERROR while saturated
+
+      //Metrics API
+      void get_metrics(MetricsSnapshot& snapshot); //Safe to call from any thread. Takes neither the client nor the node manager lock, snapshot memory is reused
+      void set_latency_tracing(bool enabled); //Timestamps port data on its way through the library. Disabled by default
+      void get_latency(LatencySnapshot& snapshot); //Histograms are empty until a connection exists and tracing has been enabled
+
+      //Capture API
+      error_t start_capture(char const* path); //Start before connecting to be able to replay the capture later
+      void stop_capture();
+
       //Connect API
 #ifndef UNIT_TEST
       error_t connect_tcp(char const* address, std::uint16_t port);
@@ -58,6 +85,7 @@ namespace apx
       error_t connect_unix(std::string const& path);
 #else
       error_t connect(testsocket_t* test_socket);
+      error_t reconnect(testsocket_t* test_socket);
       void run();
       void receive_accepted_cmd();
       void receive_file_info_cmd(std::uint32_t address, char const* file_name, std::size_t file_size);
@@ -70,10 +98,15 @@ namespace apx
       void on_require_port_written(PortInstance* port_instance);
 
       NodeManager m_node_manager;
-      std::unique_ptr<SocketClientConnection> m_connection{ nullptr };
+      std::unique_ptr<CaptureWriter> m_capture{ nullptr }; //Declared before m_connection so it outlives the connection threads
+      std::vector<std::unique_ptr<SocketClientConnection>> m_connections; //Replaced connections are kept until the client is destroyed since other threads may still use them
+      std::atomic<SocketClientConnection*> m_connection{ nullptr }; //Current connection, always read through load()
       ClientEventListener* m_event_listener{ nullptr }; //TODO: Replace with list to allow parellell event listeners
       std::uint8_t* acquire_buffer(std::size_t required_size, std::uint8_t* suggested_buffer, std::size_t& buffer_size);
-      std::mutex m_mutex;
+      std::mutex m_mutex; //Protects m_vm
+      error_t read_port_view(PortInstance* port_instance, apx::ByteArray& snapshot, std::uint8_t const*& data, std::size_t& size, TypeCode& type_code);
       VirtualMachine m_vm;
+      std::atomic<std::size_t> m_transmit_high_water_mark{ 0u };
+      std::atomic<bool> m_latency_tracing{ false };
    };
 }
@@ -45,6 +45,15 @@ namespace apx
       error_t remote_file_published_notification(File* file) override;
       error_t remote_file_write_notification(File* file, std::uint32_t offset, std::uint8_t const* data, std::size_t size);
       void require_port_data_written(NodeInstance* node_instance, std::size_t offset, std::size_t size);
+      void set_transmit_high_water_mark(std::size_t num_bytes) { m_file_manager.set_transmit_high_water_mark(num_bytes); }
+      std::size_t transmit_queued_bytes() { return m_file_manager.transmit_queued_bytes(); }
+      ConnectionMetrics const& get_metrics() const { return m_metrics; }
+      FileManagerMetrics const& get_file_manager_metrics() const { return m_file_manager.get_metrics(); }
+      FileManagerWorkerMetrics const& get_worker_metrics() const { return m_file_manager.get_worker_metrics(); }
+      void set_latency_tracing(bool enabled);
+      bool is_latency_tracing() const { return m_latency_tracing.load(std::memory_order_relaxed); }
+      void record_write_to_queue_latency(std::chrono::steady_clock::duration elapsed) { m_metrics.write_to_queue.record(elapsed); }
+      void get_latency(LatencySnapshot& snapshot) const;
 #ifdef UNIT_TEST
       virtual void run();
 #else
@@ -64,6 +73,9 @@ namespace apx
       FileManager m_file_manager;
       NodeManager* m_node_manager;
       Client* m_parent_client{ nullptr };
+      ConnectionMetrics m_metrics;
+      std::atomic<bool> m_latency_tracing{ false };
+      std::chrono::steady_clock::time_point m_receive_time{}; //Set while on_data_received is running with latency tracing enabled
 
    };
 }
\ No newline at end of file
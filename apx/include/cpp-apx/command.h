@@ -23,6 +23,8 @@
 ******************************************************************************/
 #pragma once
 
+#include <chrono>
+#include <vector>
 #include "cpp-apx/types.h"
 
 namespace apx
@@ -34,29 +36,74 @@ namespace apx
       PublishLocalFile,
       RevokeLocalFile,
       OpenRemoteFile,
+      ResumeRemoteFile,
       CloseRemoteFile,
       SendLocalConstData,
       SendLocalData,
+      SendLocalSharedData,
    };
 
+   constexpr std::size_t COMMAND_INLINE_DATA_MAX_SIZE = 64u; //Data up to this size is copied directly into the command queue
+   constexpr std::size_t COMMAND_QUEUE_DEFAULT_CAPACITY = 4096u;
+
    struct Command
    {
       Command(CmdType ct, std::uint32_t d1, std::uint32_t d2, void* d3, void* d4)
-         :cmd_type(ct), data1(d1), data2(d2), data4{d4}
-      {
-         data3.ptr = d3;
-      }
-      Command(CmdType ct, std::uint32_t d1, std::uint32_t d2, std::uint8_t const* b, void* d4);
+         :cmd_type(ct), data1(d1), data2(d2), data3{ d3 }, data4{ d4 } {}
       CmdType cmd_type;
       std::uint32_t data1; //generic uint32 value
       std::uint32_t data2; //generic uint32 value
-      union {
-         void* ptr; //This is used when data size is bigger than SMALL_DATA_SIZE
-         std::uint8_t bytes[SMALL_DATA_SIZE]; //This is used when data size is less than or equal to SMALL_DATA_SIZE
-      } data3;
+      std::uint32_t inline_size{ 0u }; //Number of data bytes stored directly after this command inside the CommandQueue
+      void* data3; //generic pointer value. Not used when inline_size > 0
       void* data4; //generic pointer value
+      std::chrono::steady_clock::time_point queued_time{}; //Only set for port data while latency tracing is enabled
+
+      bool has_inline_data() const { return inline_size > 0u; }
+      std::uint8_t const* inline_data() const { return has_inline_data() ? reinterpret_cast<std::uint8_t const*>(this + 1) : nullptr; }
+      std::uint8_t* inline_data() { return has_inline_data() ? reinterpret_cast<std::uint8_t*>(this + 1) : nullptr; }
+   };
+
+   /*
+   * Remembers where the latest write of a port was stored inside a queue owned by a FileManagerWorker.
+   * While the record is still waiting in the queue, new writes of the same port overwrite it instead of adding a new record.
+   */
+   struct CoalesceSlot
+   {
+      void const* owner{ nullptr };
+      std::uint64_t generation{ 0u };
+      std::size_t record_offset{ 0u };
    };
 
    constexpr std::size_t COMMAND_SIZE = sizeof(Command);
 
+   /*
+   * FIFO of variable-sized command records stored in a single pre-allocated buffer.
+   * Each record consists of a Command followed by its inline data (if any), padded to the alignment of Command.
+   * The buffer only grows when the queue is pushed beyond its current capacity. Memory is reused once the queue becomes empty.
+   */
+   class CommandQueue
+   {
+   public:
+      CommandQueue(std::size_t capacity = COMMAND_QUEUE_DEFAULT_CAPACITY) : m_buffer(capacity) {}
+      std::size_t push(Command const& cmd);
+      std::size_t push(Command const& cmd, std::uint8_t const* data, std::uint32_t size);
+      Command const& front() const;
+      Command* at(std::size_t record_offset);
+      void pop();
+      void clear();
+      void swap(CommandQueue& other) noexcept;
+      bool empty() const { return m_length == 0u; }
+      std::size_t size() const { return m_length; }
+      std::size_t capacity() const { return m_buffer.size(); }
+      std::size_t bytes_used() const { return m_write_pos - m_read_pos; }
+
+   protected:
+      std::vector<std::uint8_t> m_buffer;
+      std::size_t m_read_pos{ 0u };
+      std::size_t m_write_pos{ 0u };
+      std::size_t m_length{ 0u };
+
+      static std::size_t record_size(std::size_t data_size);
+      std::uint8_t* reserve(std::size_t size);
+   };
 }
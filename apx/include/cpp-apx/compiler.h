@@ -34,5 +34,9 @@ namespace apx
       std::unique_ptr<apx::vm::Program> m_program;
       apx::error_t m_last_error{ APX_NO_ERROR };
       bool m_is_dynamic = false;
+      std::uint32_t m_nesting_depth = 0u; //Current number of nested VM states while compiling record data
+      std::uint32_t m_max_nesting_depth = 0u;
+      void enter_nested_state();
+      void leave_nested_state() { m_nesting_depth--; }
    };
 }
\ No newline at end of file
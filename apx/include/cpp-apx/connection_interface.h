@@ -26,6 +26,7 @@
 #include "cpp-apx/types.h"
 #include "cpp-apx/error.h"
 #include "cpp-apx/file.h"
+#include "cpp-apx/shared_buffer.h"
 
 namespace apx
 {
@@ -39,6 +40,12 @@ namespace apx
       virtual void transmit_end() = 0;
       virtual error_t transmit_data_message(std::uint32_t write_address, bool more_bit, std::uint8_t const* data, std::int32_t size, std::int32_t& bytes_available) = 0;
       virtual error_t transmit_direct_message(std::uint8_t const* data, std::int32_t size, std::int32_t& bytes_available) = 0;
+      //data points inside buffer. Implementations that transmit asynchronously may call buffer->acquire() to keep the data alive instead of copying it.
+      virtual error_t transmit_shared_data_message(std::uint32_t write_address, bool more_bit, SharedBuffer* buffer, std::uint8_t const* data, std::int32_t size, std::int32_t& bytes_available)
+      {
+         (void)buffer;
+         return transmit_data_message(write_address, more_bit, data, size, bytes_available);
+      }
 
       // Notification callbacks
       virtual error_t remote_file_published_notification(File* file) = 0;
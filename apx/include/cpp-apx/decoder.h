@@ -24,6 +24,7 @@
 #pragma once
 
 #include <string>
+#include <string_view>
 #include "cpp-apx/vmdefs.h"
 #include "cpp-apx/error.h"
 #include "cpp-apx/program.h"
@@ -43,7 +44,8 @@ namespace apx
          RangeCheckInt32OperationInfo const& get_range_check_int32() { return m_range_check_int32_info; }
          RangeCheckUInt64OperationInfo const& get_range_check_uint64() { return m_range_check_uint64_info; }
          RangeCheckInt64OperationInfo const& get_range_check_int64() { return m_range_check_int64_info; }
-         std::string const& get_field_name() { return m_field_name; }
+         std::string_view get_field_name() { return m_field_name; } //Refers to the program bytes
+         std::uint32_t get_field_hash() { return m_field_hash; }
          bool is_last_field() { return m_is_last_field; }
          void save_program_position();
          void recall_program_position();
@@ -54,13 +56,15 @@ namespace apx
          std::uint8_t const* m_program_next{ nullptr };
          std::uint8_t const* m_program_end{ nullptr };
          std::uint8_t const* m_program_mark{ nullptr }; //TODO: Perhaps create a stack out of this?
+         std::uint8_t m_minor_version{ MINOR_VERSION }; //Taken from the program header when it has been parsed
          OperationType m_operation_type{ OperationType::ProgramEnd };
          PackUnpackOperationInfo m_pack_unpack_info{ TypeCode::None, 0u, false };
          RangeCheckUInt32OperationInfo m_range_check_uint32_info{ 0u, 0u };
          RangeCheckInt32OperationInfo m_range_check_int32_info{ 0, 0 };
          RangeCheckUInt64OperationInfo m_range_check_uint64_info{ 0u, 0u };
          RangeCheckInt64OperationInfo m_range_check_int64_info{ 0, 0 };
-         std::string m_field_name;
+         std::string_view m_field_name;
+         std::uint32_t m_field_hash{ 0u };
          bool m_is_last_field{ false };
 
          apx::error_t decode_next_instruction_internal();
@@ -70,7 +74,7 @@ namespace apx
          apx::error_t decode_range_check_uint64(std::uint8_t variant);
          apx::error_t decode_range_check_int32(std::uint8_t variant);
          apx::error_t decode_range_check_int64(std::uint8_t variant);
-         apx::error_t decode_record_select(bool is_last_field);
+         apx::error_t decode_record_select(bool is_last_field, bool has_hash);
 
       };
    }
@@ -1,9 +1,11 @@
 #pragma once
 
-#include <stack>
+#include <memory_resource>
 #include <string>
+#include <string_view>
 #include <iterator>
 #include <variant>
+#include <vector>
 #include "cpp-apx/vmdefs.h"
 #include "cpp-apx/error.h"
 #include "dtl/dtl.hpp"
@@ -18,7 +20,6 @@ namespace apx
          struct State
          {
             State() {}
-            ~State() {}
 
             std::variant<
                std::int32_t,             //index 0
@@ -32,9 +33,11 @@ namespace apx
             dtl::ScalarValue sv; //Valid when value_type==ValueType::Scalar
             dtl::ArrayValue av;  //Valid when value_type==ValueType::Array
             dtl::HashValue hv;   //Valid when value_type==ValueType::Hash
-            State* parent{ nullptr };
-            std::string field_name;
-            std::size_t index{ 0u };
+            dtl::TypedArrayValue ta; //Valid when value_type==ValueType::TypedArray
+            dtl::DynamicValue reuse; //Previous value at this position, updated in place when its type matches
+            std::pmr::memory_resource* resource{ nullptr }; //Allocates new values when set
+            dtl::HashedKey field_key; //Refers to the program bytes (or the caller's key)
+            std::size_t index{ 0u }; //Array element index, or field position when value_type==ValueType::Hash
             std::size_t array_len{ 0u };
             std::size_t max_array_len{ 0u }; //Needed for dynamic arrays
             TypeCode type_code{ TypeCode::None };
@@ -53,14 +56,16 @@ namespace apx
                   (type_code == TypeCode::Char32);
             }
             bool is_byte_type() { return type_code == TypeCode::Byte; }
-            void set_field_name(const char* name, bool is_last) { field_name = name;  is_last_field = is_last; }
+            void set_field_key(dtl::HashedKey const& key, bool is_last) { field_key = key;  is_last_field = is_last; }
             void init_scalar_value();
             void init_array_value();
+            void init_typed_array_value();
             void init_hash_value();
             apx::error_t read_scalar_value(TypeCode type_code_arg);
             apx::error_t read_scalar_value(std::size_t index_arg, TypeCode type_code_arg);
             apx::error_t create_child_value_from_state(State* child_state);
             apx::error_t push_value_from_state(State* child_state);
+            dtl::DynamicValue child_reuse_value();
          protected:
             apx::error_t read_scalar_value(dtl::Scalar const* sv_arg, TypeCode type_code_arg);
          };
@@ -72,15 +77,21 @@ namespace apx
             std::uint8_t const* next{ nullptr };
             std::uint8_t const* padded_next{ nullptr }; //Needed for dynamic arrays
          };
-         Deserializer() { m_state = new State(); }
-         ~Deserializer();
+         Deserializer() : m_states(1u) { m_state = m_states.data(); }
+         Deserializer(Deserializer const&) = delete;
+         Deserializer& operator=(Deserializer const&) = delete;
 
          apx::error_t set_read_buffer(std::uint8_t const* buf, std::size_t len);
+         void set_reuse_value(dtl::DynamicValue value);
+         void set_memory_resource(std::pmr::memory_resource* resource);
+         void reserve_nesting_depth(std::size_t nesting_depth);
          std::size_t bytes_read() { return std::distance(m_buffer.begin, m_buffer.next); }
          dtl::ValueType value_type() { return m_state->value_type; }
          dtl::ScalarValue take_sv();
          dtl::ArrayValue take_av();
          dtl::HashValue take_hv();
+         dtl::TypedArrayValue take_ta();
+         dtl::DynamicValue take_dv();
          void clear_value();
          apx::error_t unpack_uint8(std::size_t array_len, apx::SizeType dynamic_size_type);
          apx::error_t unpack_uint16(std::size_t array_len, apx::SizeType dynamic_size_type);
@@ -94,17 +105,20 @@ namespace apx
          apx::error_t unpack_bool(std::size_t array_len, apx::SizeType dynamic_size_type);
          apx::error_t unpack_byte_array(std::size_t array_len, apx::SizeType dynamic_size_type);
          apx::error_t unpack_record(std::size_t array_len, apx::SizeType dynamic_size_type);
+         apx::error_t view_array_data(TypeCode type_code, std::size_t array_len, apx::SizeType dynamic_size_type, std::uint8_t const*& data, std::size_t& size);
          apx::error_t check_value_range_int32(std::int32_t lower_limit, std::int32_t upper_limit);
          apx::error_t check_value_range_uint32(std::uint32_t lower_limit, std::uint32_t upper_limit);
          apx::error_t check_value_range_int64(std::int64_t lower_limit, std::int64_t upper_limit);
          apx::error_t check_value_range_uint64(std::uint64_t lower_limit, std::uint64_t upper_limit);
-         apx::error_t record_select(const char* key, bool is_last_field);
+         apx::error_t record_select(dtl::HashedKey const& key, bool is_last_field);
+         apx::error_t record_select(std::string_view key, bool is_last_field) { return record_select(dtl::HashedKey{ key }, is_last_field); }
          apx::error_t array_next(bool &is_last);
 
       protected:
          ReadBuffer m_buffer;
+         std::vector<State> m_states; //m_states[0] holds the top-level value, m_states[m_depth] is the current state
+         std::size_t m_depth{ 0u };
          State* m_state{ nullptr };
-         std::stack<State*> m_stack;
          void reset_buffer(std::uint8_t const* buf, std::size_t len);
          bool is_valid_buffer();
          void reset_state();
@@ -122,6 +136,7 @@ namespace apx
          apx::error_t prepare_for_buffer_read();
          apx::error_t read_array_size_from_buffer(SizeType size_type, std::size_t& array_size);
          void enter_new_child_state();
+         void release_state(State* state);
          apx::error_t pop_state();
       };
    }
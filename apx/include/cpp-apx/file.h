@@ -23,8 +23,10 @@
 ******************************************************************************/
 #pragma once
 
+#include <atomic>
 #include <memory>
 #include <mutex>
+#include <vector>
 #include "cpp-apx/remotefile.h"
 #include "cpp-apx/file_info.h"
 #include "cpp-apx/types.h"
@@ -43,6 +45,14 @@ namespace apx
 
    std::string const& file_type_to_extension(FileType file_type);
 
+   struct ByteRange
+   {
+      std::uint32_t offset;
+      std::uint32_t size;
+   };
+
+   constexpr std::size_t FILE_DIRTY_RANGES_MAX = 16u; //Ranges are merged into one once this limit is reached
+
    class File;
    class FileManager;
 
@@ -52,6 +62,7 @@ namespace apx
       virtual error_t file_open_notify(File* file) = 0;
       virtual error_t file_close_notify(File* file) = 0;
       virtual error_t file_write_notify(File* file, std::uint32_t offset, std::uint8_t const* data, std::size_t size) = 0;
+      virtual error_t file_resume_notify(File* file, std::vector<ByteRange> const& dirty_ranges) = 0;
    };
 
 
@@ -59,7 +70,8 @@ namespace apx
    {
    public:
       File() = delete;
-      File(File const& other) = default;
+      File(File const& other);
+      File& operator=(File const& other);
       File(rmf::FileInfo const& file_info);
       bool is_local() { return (m_file_info.address_without_flags() != rmf::INVALID_ADDRESS) && ((m_file_info.address & rmf::REMOTE_ADDRESS_BIT) == 0); }
       bool is_remote() { return (m_file_info.address_without_flags() != rmf::INVALID_ADDRESS) && ((m_file_info.address & rmf::REMOTE_ADDRESS_BIT) != 0); }
@@ -77,11 +89,15 @@ namespace apx
       bool address_in_range(std::uint32_t address) const { return m_file_info.address_in_range(address); }
       rmf::FileInfo const& get_file_info() const { return m_file_info; }
       rmf::FileInfo* clone_file_info() const { return new rmf::FileInfo(m_file_info); }
-      bool is_open() const { return m_is_file_open; }
-      void open() { m_is_file_open = true; }
-      void close() { m_is_file_open = false; }
+      bool is_open() const { return m_is_file_open.load(std::memory_order_acquire); }
+      void open() { m_is_file_open.store(true, std::memory_order_release); }
+      void close() { m_is_file_open.store(false, std::memory_order_release); }
       void open_notify();
       void close_notify();
+      error_t resume_notify(std::vector<ByteRange> const& dirty_ranges);
+      void mark_dirty(std::uint32_t offset, std::uint32_t size);
+      bool has_dirty_ranges() const { return !m_dirty_ranges.empty(); }
+      void take_dirty_ranges(std::vector<ByteRange>& dest);
       error_t write_notify(std::uint32_t offset, std::uint8_t const* data, std::size_t size);
       void set_file_manager(FileManager* file_manager) { m_file_manager = file_manager; }
       FileManager* get_file_manager() { return m_file_manager; }
@@ -89,13 +105,14 @@ namespace apx
       FileNotificationHandler* get_notification_handler() { return m_notification_handler; }
 
    protected:
-      bool m_is_file_open{ false };
+      std::atomic<bool> m_is_file_open{ false }; //Written by the receive thread, read by writers and the worker thread
       bool m_has_first_write{ false }; //only applies to remotely openend files
 
       FileType m_apx_file_type { FileType::Unknown };
       rmf::FileInfo m_file_info;
       FileManager* m_file_manager{ nullptr };
       FileNotificationHandler* m_notification_handler{ nullptr };
+      std::vector<ByteRange> m_dirty_ranges; //Local data not yet received by the remote side. Sorted by offset, never overlapping
 
    };
 
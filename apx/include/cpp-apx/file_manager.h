@@ -27,6 +27,7 @@
 #include "cpp-apx/file_manager_worker.h"
 #include "cpp-apx/file_manager_receiver.h"
 #include "cpp-apx/error.h"
+#include "cpp-apx/metrics.h"
 
 namespace apx
 {
@@ -41,12 +42,23 @@ namespace apx
       void connected();
       void disconnected();
       File* create_local_file(rmf::FileInfo const& file_info);
+      error_t publish_local_file(File* file);
       File* find_file_by_address(std::uint32_t address) { return m_shared.find_file_by_address(address); }
       File* find_local_file_by_name(char const* name) { return m_shared.find_local_file_by_name(name); }
       error_t message_received(uint8_t const* msg_data, std::size_t msg_len);
       error_t send_local_const_data(std::uint32_t address, std::uint8_t const* data, std::size_t size);
       error_t send_local_data(std::uint32_t address, std::uint8_t* data, std::size_t size);
+      error_t send_local_data_copy(std::uint32_t address, std::uint8_t const* data, std::size_t size, CoalesceSlot* slot = nullptr);
+      error_t send_local_shared_data(std::uint32_t address, SharedBuffer* buffer, std::uint8_t const* data, std::size_t size);
       error_t send_open_file_request(std::uint32_t address);
+      error_t send_resume_file_request(std::uint32_t address);
+      void mark_local_data_dirty(std::uint32_t address, std::size_t size);
+      void set_transmit_high_water_mark(std::size_t num_bytes) { m_worker.set_high_water_mark(num_bytes); }
+      std::size_t transmit_high_water_mark() { return m_worker.high_water_mark(); }
+      void set_latency_tracing(bool enabled) { m_worker.set_latency_tracing(enabled); }
+      std::size_t transmit_queued_bytes() { return m_worker.queued_bytes(); }
+      FileManagerMetrics const& get_metrics() const { return m_metrics; }
+      FileManagerWorkerMetrics const& get_worker_metrics() const { return m_worker.get_metrics(); }
 
 #ifdef UNIT_TEST
       bool run();
@@ -59,11 +71,14 @@ namespace apx
       error_t process_file_write_message(std::uint32_t address, std::uint8_t const* data, std::size_t size);
       error_t process_open_file_request(std::uint32_t start_address);
       error_t process_close_file_request(std::uint32_t start_address);
+      error_t process_resume_file_request(std::uint32_t start_address);
       error_t process_remote_file_published(rmf::FileInfo const& file_info);
 
       FileManagerReceiver m_receiver;
       FileManagerShared m_shared;
       FileManagerWorker m_worker;
+      FileManagerMetrics m_metrics;
+      bool m_is_reassembling{ false }; //Only accessed from the receiving thread
    };
 
 }
\ No newline at end of file
@@ -44,14 +44,19 @@ namespace apx
       FileManagerReceiver();
       void reset();
       void reserve(std::size_t size);
+      void set_max_buffer_size(std::size_t size);
       FileManagerReceptionResult write(std::uint32_t address, std::uint8_t const* data, std::size_t size, bool more_bit);
       std::size_t buffer_size() const { return m_receive_buffer.size(); }
+      std::size_t max_buffer_size() const { return m_max_buffer_size; }
    protected:
 
+      bool grow_buffer(std::size_t required_size);
+
       void start_new_reception(FileManagerReceptionResult& result, std::uint32_t address, std::uint8_t const* data, std::size_t size, bool more_bit);
       void continue_reception(FileManagerReceptionResult& result, std::uint32_t address, std::uint8_t const* data, std::size_t size, bool more_bit);
       void process_more_bit(FileManagerReceptionResult& result, bool more_bit);
       apx::ByteArray m_receive_buffer;
+      std::size_t m_max_buffer_size{ 0u }; //The buffer grows up to this size as data arrives
       std::size_t m_buf_pos{ 0u };
       std::uint32_t m_start_address{ rmf::INVALID_ADDRESS };
       bool m_is_complete{ false };
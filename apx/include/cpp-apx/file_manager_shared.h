@@ -48,6 +48,9 @@ namespace apx
       void disconnected();
       bool is_connected();
       void copy_local_file_info(std::vector<rmf::FileInfo*>& dest);
+      void mark_local_data_dirty(std::uint32_t address, std::uint32_t size);
+      void take_dirty_ranges(File* file, std::vector<ByteRange>& dest);
+      void list_dirty_open_local_files(std::vector<File*>& dest);
       ConnectionInterface* connection() const { return m_parent_connection; }
 
    protected:
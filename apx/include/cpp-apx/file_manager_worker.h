@@ -23,15 +23,18 @@
 ******************************************************************************/
 #pragma once
 
-#include <queue>
+#include <chrono>
 #include <mutex>
 #include <condition_variable>
 #include <thread>
+#include <vector>
 #include "cpp-apx/types.h"
 #include "cpp-apx/error.h"
 #include "cpp-apx/file_info.h"
 #include "cpp-apx/command.h"
+#include "cpp-apx/shared_buffer.h"
 #include "cpp-apx/file_manager_shared.h"
+#include "cpp-apx/metrics.h"
 
 namespace apx
 {
@@ -39,11 +42,21 @@ namespace apx
    {
    public:
       FileManagerWorker() = delete;
-      FileManagerWorker(FileManagerShared& shared) :m_shared{ shared } {}
+      FileManagerWorker(FileManagerShared& shared) :m_queue_generation{ next_queue_generation() }, m_shared{ shared } {}
+      ~FileManagerWorker();
       void prepare_publish_local_file(rmf::FileInfo* file_info);
       void prepare_send_local_const_data(std::uint32_t address, std::uint8_t const* data, std::uint32_t size);
       void prepare_send_local_data(std::uint32_t address, std::uint8_t* data, std::uint32_t size);
+      error_t prepare_send_local_data_copy(std::uint32_t address, std::uint8_t const* data, std::uint32_t size, CoalesceSlot* slot = nullptr);
+      error_t prepare_send_local_shared_data(std::uint32_t address, SharedBuffer* buffer, std::uint8_t const* data, std::uint32_t size);
       void prepare_send_open_file_request(std::uint32_t address);
+      void prepare_send_resume_file_request(std::uint32_t address);
+      void set_high_water_mark(std::size_t num_bytes);
+      std::size_t high_water_mark();
+      std::size_t queued_bytes();
+      void discard_pending_commands();
+      void set_latency_tracing(bool enabled);
+      FileManagerWorkerMetrics const& get_metrics() const { return m_metrics; }
 
 #ifdef UNIT_TEST
       bool run();
@@ -54,17 +67,49 @@ namespace apx
 #endif
 
    protected:
-      std::queue<apx::Command> m_queue;
+      apx::CommandQueue m_queue; //Producers only hold m_mutex while pushing, the worker swaps out the entire queue
+      apx::CommandQueue m_pending; //Only accessed by worker
+      std::size_t m_queued_bytes{ 0u }; //Data bytes waiting in m_queue
+      std::size_t m_in_flight_bytes{ 0u }; //Data bytes in m_pending currently being processed by worker
+      std::size_t m_high_water_mark{ 0u }; //0 means unlimited
+      std::uint64_t m_queue_generation; //Renewed each time m_queue is swapped out. Used to invalidate CoalesceSlot
       std::condition_variable m_cond;
       std::mutex m_mutex;
       std::thread m_worker_thread;
       FileManagerShared& m_shared;
+      FileManagerWorkerMetrics m_metrics;
+      std::chrono::steady_clock::time_point m_first_queued_time; //When the oldest command in m_queue was pushed
+      bool m_latency_tracing{ false };
+      std::vector<std::chrono::steady_clock::time_point> m_transmitted_queue_times; //Only accessed by worker. Recorded once the batch has been sent
+      bool m_has_rejected_writes{ false }; //Set when a write was rejected by the high-water mark. Its range was marked dirty in its file
+      std::vector<File*> m_dirty_files; //Only accessed by worker
+      std::vector<ByteRange> m_dirty_ranges; //Only accessed by worker
 
+      static std::uint64_t next_queue_generation();
+      void push_command(apx::Command const& cmd);
+      void push_command(apx::Command const& cmd, std::uint8_t const* data, std::uint32_t size);
+      void swap_queues(); //Caller must hold m_mutex
+      void command_queued(); //Caller must hold m_mutex
+      Command make_data_command(CmdType cmd_type, std::uint32_t address, std::uint32_t size, void* data3, void* data4) const; //Caller must hold m_mutex
+      void processing_complete();
+      bool is_above_high_water_mark(std::uint32_t size) const; //Caller must hold m_mutex
+      void reject_write(std::uint32_t address, std::uint32_t size); //Caller must hold m_mutex
+      void flush_rejected_writes();
+      bool try_coalesce(CoalesceSlot const* slot, std::uint8_t const* data, std::uint32_t size); //Caller must hold m_mutex
+      static std::size_t command_data_size(apx::Command const& cmd);
+      bool process_commands(apx::CommandQueue& queue);
       bool process_single_command(apx::Command const& cmd);
+      void record_queue_to_send_latency();
+      void dispose_command(apx::Command const& cmd);
+      void discard_command(apx::Command const& cmd);
       error_t run_publish_local_file(rmf::FileInfo* file);
       error_t run_send_local_const_data(std::uint32_t address, std::uint8_t const* data, std::uint32_t size);
       error_t run_send_local_data(std::uint32_t address, std::uint8_t* data, std::uint32_t size);
+      error_t run_send_local_shared_data(std::uint32_t address, SharedBuffer* buffer, std::uint8_t const* data, std::uint32_t size);
       error_t run_open_remote_file(std::uint32_t address);
+      error_t run_resume_remote_file(std::uint32_t address);
+      error_t transmit_command(std::uint8_t const* data, std::size_t size);
+      error_t transmit_file_data(ConnectionInterface* connection, std::uint32_t address, SharedBuffer* buffer, std::uint8_t const* data, std::uint32_t size);
       void worker_main();
 
    };
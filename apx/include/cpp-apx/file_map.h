@@ -40,6 +40,7 @@ namespace apx
       File* find_by_address(std::uint32_t address);
       File* find_by_name(char const* name);
       File* find_by_name(std::string const& name);
+      void clear();
 
       std::list<apx::File*>& list() { return m_list; }
    protected:
@@ -0,0 +1,184 @@
+/*****************************************************************************
+* \file      metrics.h
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Lock-free runtime counters and gauges
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+namespace apx
+{
+   /*
+   * Monotonic counter. Updates and reads use relaxed atomics so they can be done from any thread
+   * without locking. Values read from different counters are not guaranteed to be consistent with each other.
+   */
+   class MetricCounter
+   {
+   public:
+      void add(std::uint64_t value = 1u) { m_value.fetch_add(value, std::memory_order_relaxed); }
+      std::uint64_t get() const { return m_value.load(std::memory_order_relaxed); }
+   protected:
+      std::atomic<std::uint64_t> m_value{ 0u };
+   };
+
+   /*
+   * Last set value together with the highest value ever set.
+   */
+   class MetricGauge
+   {
+   public:
+      void set(std::uint64_t value)
+      {
+         m_value.store(value, std::memory_order_relaxed);
+         auto max = m_max.load(std::memory_order_relaxed);
+         while ( (value > max) && !m_max.compare_exchange_weak(max, value, std::memory_order_relaxed) ) {}
+      }
+      std::uint64_t get() const { return m_value.load(std::memory_order_relaxed); }
+      std::uint64_t max() const { return m_max.load(std::memory_order_relaxed); }
+   protected:
+      std::atomic<std::uint64_t> m_value{ 0u };
+      std::atomic<std::uint64_t> m_max{ 0u };
+   };
+
+   struct LatencyHistogramSnapshot;
+
+   /*
+   * HDR-style histogram of latencies in nanoseconds.
+   * Each power of two is split into LATENCY_SUB_BUCKETS linear buckets, giving a relative error below 1/16 across the whole range.
+   * Values at or above 2^LATENCY_MAX_BITS ns (about 18 minutes) are counted in the last bucket.
+   * Recording is lock-free and never allocates.
+   */
+   class LatencyHistogram
+   {
+   public:
+      static constexpr unsigned SUB_BUCKET_BITS = 4u;
+      static constexpr unsigned SUB_BUCKETS = 1u << SUB_BUCKET_BITS;
+      static constexpr unsigned MAX_BITS = 40u;
+      static constexpr std::size_t NUM_BUCKETS = (MAX_BITS - SUB_BUCKET_BITS + 1u) * SUB_BUCKETS;
+
+      void record(std::uint64_t value_ns);
+      void record(std::chrono::steady_clock::duration elapsed);
+      void read(LatencyHistogramSnapshot& snapshot) const;
+      static std::size_t bucket_index(std::uint64_t value_ns);
+      static std::uint64_t bucket_lower_bound(std::size_t index);
+      static std::uint64_t bucket_upper_bound(std::size_t index);
+   protected:
+      std::array<std::atomic<std::uint64_t>, NUM_BUCKETS> m_buckets{};
+      MetricCounter m_count;
+      MetricCounter m_sum;
+      MetricGauge m_max;
+   };
+
+   struct LatencyHistogramSnapshot
+   {
+      std::array<std::uint64_t, LatencyHistogram::NUM_BUCKETS> buckets{};
+      std::uint64_t count{ 0u };
+      std::uint64_t sum_ns{ 0u };
+      std::uint64_t max_ns{ 0u };
+
+      std::uint64_t percentile(double p) const; //p in range [0, 100]. Returns the upper bound of the bucket, never more than max_ns
+      std::uint64_t mean() const { return count > 0u ? sum_ns / count : 0u; }
+   };
+
+   struct ConnectionMetrics
+   {
+      MetricCounter bytes_sent;
+      MetricCounter bytes_received;
+      MetricCounter messages_sent;
+      MetricCounter messages_received;
+      MetricCounter send_packet_calls;
+      MetricCounter parse_errors;
+      LatencyHistogram write_to_queue; //From Client::write_port_value until the data has been queued for the worker
+      LatencyHistogram receive_to_notify; //From socket_data_received until the require port listener is called
+   };
+
+   struct FileManagerMetrics
+   {
+      MetricCounter fragments_received; //Messages received with the more-bit set
+      MetricCounter reassembled_messages; //Messages that were received in more than one fragment
+      MetricCounter reception_errors;
+   };
+
+   struct FileManagerWorkerMetrics
+   {
+      MetricGauge queue_depth; //Commands waiting for the worker
+      MetricCounter commands_processed; //Commands picked up by the worker
+      MetricCounter queue_wait_ns; //Sum over all batches of the time the oldest command waited before the worker picked up the batch
+      MetricGauge last_queue_wait_ns;
+      MetricCounter coalesced_writes;
+      MetricCounter rejected_writes; //Writes rejected by the transmit high-water mark
+      LatencyHistogram queue_to_send; //From a port write being queued until send_packet returned
+   };
+
+   struct NodeDataMetrics
+   {
+      MetricCounter provide_port_writes;
+      MetricCounter require_port_writes;
+   };
+
+   /*
+   * Time spent in each stage between the application and the socket. Only recorded while latency tracing is enabled.
+   */
+   struct LatencySnapshot
+   {
+      LatencyHistogramSnapshot write_to_queue;
+      LatencyHistogramSnapshot queue_to_send;
+      LatencyHistogramSnapshot receive_to_notify;
+   };
+
+   struct NodeMetricsSnapshot
+   {
+      std::string name;
+      std::uint64_t provide_port_writes{ 0u };
+      std::uint64_t require_port_writes{ 0u };
+   };
+
+   struct MetricsSnapshot
+   {
+      //Connection
+      std::uint64_t bytes_sent{ 0u };
+      std::uint64_t bytes_received{ 0u };
+      std::uint64_t messages_sent{ 0u };
+      std::uint64_t messages_received{ 0u };
+      std::uint64_t send_packet_calls{ 0u };
+      std::uint64_t parse_errors{ 0u };
+      //File manager
+      std::uint64_t fragments_received{ 0u };
+      std::uint64_t reassembled_messages{ 0u };
+      std::uint64_t reception_errors{ 0u };
+      //File manager worker
+      std::uint64_t queue_depth{ 0u };
+      std::uint64_t max_queue_depth{ 0u };
+      std::uint64_t commands_processed{ 0u };
+      std::uint64_t queue_wait_ns{ 0u };
+      std::uint64_t max_queue_wait_ns{ 0u };
+      std::uint64_t coalesced_writes{ 0u };
+      std::uint64_t rejected_writes{ 0u };
+      //Nodes
+      std::vector<NodeMetricsSnapshot> nodes;
+   };
+}
@@ -0,0 +1,60 @@
+/*****************************************************************************
+* \file      mock_server_connection.h
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     A server connection used for unit testing
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#pragma once
+
+#include <atomic>
+#include "cpp-apx/server_connection.h"
+
+namespace apx
+{
+   /*
+   * Server connection without a socket. Transmitted messages are counted and then dropped.
+   */
+   class MockServerConnection : public apx::ServerConnection
+   {
+   public:
+      MockServerConnection() = default;
+      MockServerConnection(Server* parent_server) : ServerConnection{ parent_server } {}
+
+      //Transmit API
+      std::int32_t transmit_max_bytes_avaiable() const override;
+      std::int32_t transmit_current_bytes_avaiable() const override;
+      void transmit_begin() override {}
+      void transmit_end() override {}
+      error_t transmit_data_message(std::uint32_t write_address, bool more_bit, std::uint8_t const* msg_data, std::int32_t msg_size, std::int32_t& bytes_available) override;
+      error_t transmit_direct_message(std::uint8_t const* msg_data, std::int32_t msg_size, std::int32_t& bytes_available) override;
+
+      //Mock API
+      void accept_greeting();
+      FileManager* get_file_manager() { return &m_file_manager; }
+      error_t request_open_local_file(char const* file_name);
+      error_t publish_remote_file(std::uint32_t address, char const* file_name, std::size_t file_size);
+      error_t write_remote_data(std::uint32_t address, std::uint8_t const* data, std::size_t size, bool more_bit = false);
+      std::size_t num_transmitted_messages() const { return m_num_transmitted_messages.load(); }
+
+   protected:
+      std::size_t const m_default_buffer_size{ 1024u };
+      std::atomic<std::size_t> m_num_transmitted_messages{ 0u };
+   };
+}
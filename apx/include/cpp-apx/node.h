@@ -3,6 +3,7 @@
 #include <vector>
 #include <memory>
 #include <map>
+#include "cpp-apx/build_statistics.h"
 #include "cpp-apx/data_type.h"
 #include "cpp-apx/port.h"
 #include "cpp-apx/error.h"
@@ -27,7 +28,7 @@ namespace apx
       apx::DataType* get_last_data_type() const;
       apx::Port* get_last_require_port() const;
       apx::Port* get_last_provide_port() const;
-      apx::error_t finalize();
+      apx::error_t finalize(BuildNodeStatistics* statistics = nullptr);
       int get_last_error_line() const { return m_last_error_line; }
    protected:
       apx::error_t derive_types_on_ports(std::vector<std::unique_ptr<apx::Port>>& ports);
@@ -27,6 +27,7 @@
 #include <mutex>
 #include "cpp-apx/types.h"
 #include "cpp-apx/error.h"
+#include "cpp-apx/metrics.h"
 
 namespace apx
 {
@@ -50,6 +51,7 @@ namespace apx
       std::uint8_t const* get_provide_port_data() const { return m_provide_port_data.get(); }
       std::uint8_t const* get_require_port_data() const { return m_require_port_data.get(); }
       std::uint8_t* take_provide_port_data_snapshot();
+      NodeDataMetrics const& get_metrics() const { return m_metrics; }
 
    protected:
       std::unique_ptr<std::uint8_t[]> m_definition_data{ nullptr };
@@ -61,6 +63,7 @@ namespace apx
       std::size_t m_num_provide_ports{ 0u };
       std::size_t m_num_require_ports{ 0u };
       std::mutex m_mutex;
+      NodeDataMetrics m_metrics;
    };
 }
 
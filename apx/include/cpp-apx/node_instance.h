@@ -79,9 +79,11 @@ namespace apx
       void create_computation_lists(std::vector<std::unique_ptr<ComputationList>>& computation_lists);
       void create_require_port_byte_map();
       error_t attach_to_file_manager(FileManager* file_manager);
+      error_t write_provide_port_data(std::uint32_t offset, std::uint8_t const* data, std::size_t size, CoalesceSlot* slot = nullptr);
       error_t file_open_notify(File* file) override;
       error_t file_close_notify(File* file) override;
       error_t file_write_notify(File* file, std::uint32_t offset, std::uint8_t const* data, std::size_t size) override;
+      error_t file_resume_notify(File* file, std::vector<ByteRange> const& dirty_ranges) override;
       PortDataState get_require_port_data_state() const { return m_require_port_data_state; }
       PortDataState get_provide_port_data_state() const{ return m_provide_port_data_state; }
       void set_require_port_data_state(PortDataState state) { m_require_port_data_state = state; }
@@ -89,9 +91,13 @@ namespace apx
       BytePortMap const* get_require_port_map() { return const_cast<const BytePortMap*>(m_require_port_byte_map.get()); }
       void set_node_manager(NodeManager* node_manager) { m_node_manager = node_manager; }
       NodeManager* get_node_manager() const { return m_node_manager; }
+      void set_next_attached(NodeInstance* node_instance) { m_next_attached = node_instance; }
+      NodeInstance* get_next_attached() const { return m_next_attached; }
       port_id_t lookup_require_port_id(std::size_t byte_offset);
       PortInstance* find(char const* name);
       PortInstance* find(std::string const& name);
+      void set_require_port_data_file(File* file) { m_require_port_data_file = file; }
+      File* get_require_port_data_file() const { return m_require_port_data_file; }
 
 
    protected:
@@ -113,6 +119,9 @@ namespace apx
       PortDataState m_require_port_data_state{ PortDataState::Init };
       PortDataState m_provide_port_data_state{ PortDataState::Init };
       NodeManager* m_node_manager{ nullptr };
+      NodeInstance* m_next_attached{ nullptr }; //Link in the node manager's attach list, never changed once the node is attached
+      File* m_provide_port_data_file{ nullptr };
+      File* m_require_port_data_file{ nullptr }; //Used by APX servers
 
       apx::error_t calc_init_data_size(PortInstance **port_list, std::size_t num_ports, std::size_t & total_size);
       error_t fill_definition_file_info(rmf::FileInfo& file_info);
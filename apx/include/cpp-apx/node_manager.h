@@ -23,12 +23,15 @@
 ******************************************************************************/
 #pragma once
 
+#include <atomic>
 #include <memory>
+#include <mutex>
 #include <unordered_map>
 #include <string>
 #include <vector>
 #include <map>
 #include "cpp-apx/types.h"
+#include "cpp-apx/build_statistics.h"
 #include "cpp-apx/node_instance.h"
 #include "cpp-apx/parser.h"
 #include "cpp-apx/compiler.h"
@@ -42,11 +45,17 @@ namespace apx
    class NodeManager
    {
    public:
-      apx::error_t build_node(char const* definition_text);
-      apx::error_t build_node(std::string const& definition_text);
+      apx::error_t build_node(char const* definition_text, BuildNodeStatistics* statistics = nullptr);
+      apx::error_t build_node(std::string const& definition_text, BuildNodeStatistics* statistics = nullptr);
+      NodeManagerStatistics const& get_statistics() const { return m_statistics; }
+      void reset_statistics();
       apx::NodeInstance* get_last_attached() { return m_last_attached; }
-      std::size_t size() { return m_instance_map.size(); }
+      std::size_t size();
       std::vector<apx::NodeInstance*> get_nodes();
+      template <typename Fn>
+      void for_each_node(Fn&& fn); //fn is called with the node manager locked, it must not attach or find nodes
+      template <typename Fn>
+      void for_each_attached_node(Fn&& fn) const; //Lock-free, most recently attached node first. Safe while other threads build nodes
       apx::NodeInstance* find(char const* name);
       apx::NodeInstance* find(std::string const& name);
       void set_connection(ClientConnection* connection) { m_parent_connection = connection; }
@@ -55,16 +64,23 @@ namespace apx
    protected:
       apx::Parser m_parser;
       apx::Compiler m_compiler;
+      std::mutex m_mutex; //Protects m_instance_map, nodes can be attached while another thread reads metrics
       std::unordered_map<std::string, std::unique_ptr<apx::NodeInstance>> m_instance_map;
+      std::atomic<apx::NodeInstance*> m_attached_list{ nullptr }; //Nodes are never detached, so the list only grows at its head
       apx::NodeInstance* m_last_attached{ nullptr };
       ClientConnection* m_parent_connection{ nullptr };
+      NodeManagerStatistics m_statistics;
       using DataElementMap = std::map<std::string, DataElement const*>;
       using ComputationListMap = std::map<std::string, ComputationList const*>;
       using DataElementList = std::vector<std::unique_ptr<apx::DataElement>>;
       using ComputationListOfLists = std::vector<std::unique_ptr<apx::ComputationList>>;
 
+      using Clock = std::chrono::steady_clock;
+
       void reset();
-      apx::error_t create_node_instance(Node const* node, std::uint8_t const* definition_data, std::size_t definition_size);
+      apx::error_t finalize_and_create_node_instance(std::uint8_t const* definition_data, std::size_t definition_size, BuildNodeStatistics& statistics);
+      void update_statistics(BuildNodeStatistics& build_statistics, Clock::time_point start_time, apx::error_t result, BuildNodeStatistics* statistics);
+      apx::error_t create_node_instance(Node const* node, std::uint8_t const* definition_data, std::size_t definition_size, BuildNodeStatistics* statistics = nullptr);
       void attach_node(apx::NodeInstance* node_instance);
       apx::error_t create_ports_on_node_instance(apx::NodeInstance* node_instance, Node const* node,
          std::size_t &expected_provide_port_data_size, std::size_t& expected_require_port_data_size);
@@ -76,4 +92,23 @@ namespace apx
       apx::error_t create_computation_list_on_node_instance(apx::NodeInstance* node_instance, Node const* node);
       apx::error_t update_computation_list_on_port(ComputationListOfLists& list, ComputationListMap& map, apx::PortInstance* port_instance, apx::Port const* parsed_port);
    };
+
+   template <typename Fn>
+   void NodeManager::for_each_node(Fn&& fn)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      for (auto& it : m_instance_map)
+      {
+         fn(it.second.get());
+      }
+   }
+
+   template <typename Fn>
+   void NodeManager::for_each_attached_node(Fn&& fn) const
+   {
+      for (auto* node_instance = m_attached_list.load(std::memory_order_acquire); node_instance != nullptr; node_instance = node_instance->get_next_attached())
+      {
+         fn(node_instance);
+      }
+   }
 }
\ No newline at end of file
@@ -29,6 +29,7 @@
 #include <version>
 #include <limits>
 #include <iostream>
+#include <type_traits>
 #if __has_include(<bit>) && __cpp_lib_endian
 #include <bit>
 constexpr bool _is_big_endian = std::endian::native == std::endian::big;
@@ -149,4 +150,82 @@ namespace apx
    {
       return *p;
    }
+
+   template<typename T> constexpr T byteSwap(T value)
+   {
+      static_assert(std::is_integral<T>::value, "Value type must be integer");
+      using U = std::make_unsigned_t<T>;
+      U in = static_cast<U>(value);
+      U out = 0u;
+      for (std::size_t i = 0u; i < sizeof(T); i++)
+      {
+         out = static_cast<U>((out << 8) | (in & 0xffu));
+         in = static_cast<U>(in >> 8);
+      }
+      return static_cast<T>(out);
+   }
+
+   /*
+   * Writes n elements from src to dst in little-endian byte order.
+   * Little-endian hosts copy the whole array with one memcpy, big-endian hosts byte-swap each element
+   * in a loop the compiler can vectorize. The swap_bytes parameter selects the kernel and is only
+   * meant to be overridden by tests which exercise the big-endian kernel on little-endian hosts.
+   */
+   template<typename T, bool swap_bytes = _is_big_endian> void pack_array_le(std::uint8_t* dst, T const* src, std::size_t n)
+   {
+      static_assert(std::is_integral<T>::value, "Value type must be integer");
+      if constexpr (swap_bytes && (sizeof(T) > 1u))
+      {
+         for (std::size_t i = 0u; i < n; i++)
+         {
+            T const value = byteSwap(src[i]);
+            std::memcpy(dst + i * sizeof(T), &value, sizeof(T));
+         }
+      }
+      else if constexpr (swap_bytes || _is_little_endian)
+      {
+         if (n > 0u)
+         {
+            std::memcpy(dst, src, n * sizeof(T));
+         }
+      }
+      else
+      {
+         for (std::size_t i = 0u; i < n; i++)
+         {
+            packLE<T>(dst + i * sizeof(T), src[i]);
+         }
+      }
+   }
+
+   /*
+   * Reads n little-endian elements from src into dst. Same kernel selection as pack_array_le.
+   */
+   template<typename T, bool swap_bytes = _is_big_endian> void unpack_array_le(T* dst, std::uint8_t const* src, std::size_t n)
+   {
+      static_assert(std::is_integral<T>::value, "Value type must be integer");
+      if constexpr (swap_bytes && (sizeof(T) > 1u))
+      {
+         for (std::size_t i = 0u; i < n; i++)
+         {
+            T value;
+            std::memcpy(&value, src + i * sizeof(T), sizeof(T));
+            dst[i] = byteSwap(value);
+         }
+      }
+      else if constexpr (swap_bytes || _is_little_endian)
+      {
+         if (n > 0u)
+         {
+            std::memcpy(dst, src, n * sizeof(T));
+         }
+      }
+      else
+      {
+         for (std::size_t i = 0u; i < n; i++)
+         {
+            dst[i] = unpackLE<T>(src + i * sizeof(T));
+         }
+      }
+   }
 }
\ No newline at end of file
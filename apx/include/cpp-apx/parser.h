@@ -35,6 +35,9 @@ namespace apx
       bool parse(std::basic_istream<char> &is);
       apx::error_t parse(char const* str);
       apx::error_t parse(std::string const& str);
+      bool parse_declarations(std::basic_istream<char>& is);
+      apx::error_t parse_declarations(char const* str);
+      apx::error_t parse_declarations(std::string const& str);
       std::unique_ptr<apx::Node> take_last_node() { return std::move(m_state.node); }
       apx::error_t get_last_error() const { return m_last_error; }
       const std::string& get_parse_error_str() const { return m_parse_error_guide; }
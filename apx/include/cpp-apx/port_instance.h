@@ -31,6 +31,7 @@
 #include "cpp-apx/program.h"
 #include "cpp-apx/data_element.h"
 #include "cpp-apx/computation.h"
+#include "cpp-apx/command.h"
 
 namespace apx
 {
@@ -67,6 +68,9 @@ namespace apx
       computation_id_t get_computation_list_id() const;
       port_id_t port_id() const { return m_port_id; }
       NodeInstance* node_instance() const { return m_parent; }
+      void set_write_policy(WritePolicy policy) { m_write_policy = policy; }
+      WritePolicy write_policy() const { return m_write_policy; }
+      CoalesceSlot* coalesce_slot() { return m_write_policy == WritePolicy::LatestValueWins ? &m_coalesce_slot : nullptr; }
    protected:
 
       //Members that requires serialization
@@ -84,6 +88,9 @@ namespace apx
       std::uint32_t m_element_size = 0u; //Only used when m_queue_length > 0
       bool m_is_dynamic_data = false;
       ComputationList const* m_computation_list{ nullptr };
+      //Members used for outgoing data
+      WritePolicy m_write_policy{ WritePolicy::QueueAll };
+      CoalesceSlot m_coalesce_slot; //Only accessed while holding the FileManagerWorker lock
       apx::error_t process_info_from_program_header(apx::vm::Program const* program);
    };
 }
\ No newline at end of file
@@ -42,6 +42,7 @@ namespace apx
          std::uint32_t element_size{ 0u };
          std::uint32_t queue_length{ 0u };
          bool is_dynamic_data{ false };
+         std::uint32_t nesting_depth{ 0u }; //Number of nested states required by record data
       };
 
       std::uint8_t const* parse_uint32_by_variant(std::uint8_t const* begin, std::uint8_t const* end, std::uint8_t variant, std::uint32_t& number);
@@ -49,7 +50,7 @@ namespace apx
       std::uint8_t const* parse_int32_by_variant(std::uint8_t const* begin, std::uint8_t const* end, std::uint8_t variant, std::int32_t& number);
       std::uint8_t const* parse_int64_by_variant(std::uint8_t const* begin, std::uint8_t const* end, std::uint8_t variant, std::int64_t& number);
       std::uint8_t const* parse_uint32_by_size_type(std::uint8_t const* begin, std::uint8_t const* end, apx::SizeType size_type, std::uint32_t& number);
-      apx::error_t create_program_header(apx::vm::Program& header, apx::ProgramType program_type, std::uint32_t element_size, std::uint32_t queue_size, bool is_dynamic);
+      apx::error_t create_program_header(apx::vm::Program& header, apx::ProgramType program_type, std::uint32_t element_size, std::uint32_t queue_size, bool is_dynamic, std::uint32_t nesting_depth = 0u);
       apx::error_t decode_program_header(std::uint8_t const* begin, std::uint8_t const* end, std::uint8_t const*& next, ProgramHeader &header);
       apx::error_t decode_program_header(apx::vm::Program const& program, ProgramHeader& header);
       std::uint8_t encode_instruction(std::uint8_t opcode, std::uint8_t variant, bool flag);
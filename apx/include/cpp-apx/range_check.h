@@ -0,0 +1,62 @@
+/*****************************************************************************
+* \file      range_check.h
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Range checks over contiguous integer arrays
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+
+namespace apx
+{
+   namespace vm
+   {
+      /*
+      * Returns true when every element of data is within [lower_limit, upper_limit].
+      * Uses AVX2 when the CPU supports it (detected at runtime), otherwise SSE2 on x86-64 or plain C++.
+      */
+      bool elements_in_range(std::uint8_t const* data, std::size_t length, std::uint8_t lower_limit, std::uint8_t upper_limit);
+      bool elements_in_range(std::uint16_t const* data, std::size_t length, std::uint16_t lower_limit, std::uint16_t upper_limit);
+      bool elements_in_range(std::uint32_t const* data, std::size_t length, std::uint32_t lower_limit, std::uint32_t upper_limit);
+      bool elements_in_range(std::uint64_t const* data, std::size_t length, std::uint64_t lower_limit, std::uint64_t upper_limit);
+      bool elements_in_range(std::int8_t const* data, std::size_t length, std::int8_t lower_limit, std::int8_t upper_limit);
+      bool elements_in_range(std::int16_t const* data, std::size_t length, std::int16_t lower_limit, std::int16_t upper_limit);
+      bool elements_in_range(std::int32_t const* data, std::size_t length, std::int32_t lower_limit, std::int32_t upper_limit);
+      bool elements_in_range(std::int64_t const* data, std::size_t length, std::int64_t lower_limit, std::int64_t upper_limit);
+
+#ifdef UNIT_TEST
+      enum class RangeCheckKernel
+      {
+         Auto,
+         Scalar,
+         Sse2, //64-bit elements fall back to Scalar since SSE2 has no 64-bit compare
+         Avx2
+      };
+
+      /*
+      * Forces elements_in_range to use the given kernel (not thread-safe, tests only).
+      * Returns false and keeps the current kernel when the CPU does not support it.
+      */
+      bool set_range_check_kernel(RangeCheckKernel kernel);
+#endif
+   }
+}
@@ -71,8 +71,10 @@ namespace rmf
    constexpr std::uint32_t CMD_REVOKE_FILE_MSG = 4u;
    constexpr std::uint32_t CMD_OPEN_FILE_MSG = 10u;
    constexpr std::uint32_t CMD_CLOSE_FILE_MSG = 11u;
+   constexpr std::uint32_t CMD_RESUME_FILE_MSG = 12u; //Reopens a file whose content the receiver kept from previous connection
    constexpr std::size_t FILE_OPEN_CMD_SIZE = sizeof(std::uint32_t);
    constexpr std::size_t FILE_CLOSE_CMD_SIZE = sizeof(std::uint32_t);
+   constexpr std::size_t FILE_RESUME_CMD_SIZE = sizeof(std::uint32_t);
    constexpr std::size_t CMD_TYPE_SIZE = sizeof(std::uint32_t);
 
    constexpr std::uint16_t FILE_TYPE_FIXED     = 0u;
@@ -89,6 +91,7 @@ namespace rmf
    std::size_t address_encode(std::uint8_t* buf, std::size_t buf_size, std::uint32_t address, bool more_bit);
    std::size_t address_decode(std::uint8_t const* begin, std::uint8_t const* end, std::uint32_t& address, bool& more_bit);
    std::size_t encode_open_file_cmd(std::uint8_t* buf, std::size_t buf_size, std::uint32_t address);
+   std::size_t encode_resume_file_cmd(std::uint8_t* buf, std::size_t buf_size, std::uint32_t address);
    std::size_t encode_acknowledge_cmd(std::uint8_t* buf, std::size_t buf_size);
    std::size_t decode_cmd_type(std::uint8_t const* begin, std::uint8_t const* end, std::uint32_t& cmd_type);
 }
\ No newline at end of file
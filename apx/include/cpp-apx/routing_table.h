@@ -0,0 +1,121 @@
+/*****************************************************************************
+* \file      routing_table.h
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Precomputed port data routing for APX servers
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#pragma once
+
+#include <algorithm>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "cpp-apx/node_instance.h"
+
+namespace apx
+{
+   class ServerConnection;
+
+   struct RouteAction
+   {
+      ServerConnection* connection;
+      NodeInstance* node_instance; //Destination node
+      std::uint32_t offset; //Destination offset in require port data
+      std::uint32_t size;
+   };
+
+   struct PortRoutes
+   {
+      std::uint32_t offset; //Source offset in provide port data
+      std::uint32_t size;
+      std::vector<RouteAction> actions;
+   };
+
+   bool is_connectable(PortInstance const* provide_port, PortInstance const* require_port);
+
+   /*
+   * Maps provide port byte ranges to lists of copy actions.
+   * Name lookups are only made when nodes attach or detach. Forwarding a write only needs
+   * a lookup of the source node followed by a binary search among its provide ports.
+   * When several nodes provide the same port, each require port is connected to the provider that was attached first.
+   * It moves on to the next provider in attach order when that node detaches.
+   */
+   class RoutingTable
+   {
+   public:
+      void attach(ServerConnection* connection, NodeInstance* node_instance);
+      void detach(NodeInstance* node_instance);
+      void detach_connection(ServerConnection* connection);
+      std::size_t num_nodes() const { return m_nodes.size(); }
+      bool is_attached(NodeInstance const* node_instance) const { return m_nodes.find(node_instance) != m_nodes.end(); }
+      PortInstance* find_provider(PortInstance const* require_port) const;
+      std::vector<PortRoutes> const* get_routes(NodeInstance const* node_instance) const;
+      /*
+      * Calls fn(action, dest_offset, data_offset, size) for each destination of the written byte range.
+      * data_offset is relative to the start of the written range.
+      */
+      template <typename Fn>
+      void for_each_route(NodeInstance const* source, std::uint32_t offset, std::size_t size, Fn&& fn) const;
+
+   protected:
+      struct PortRef
+      {
+         NodeInstance* node_instance;
+         PortInstance* port_instance;
+         PortInstance* provider; //Connected provide port, only used in m_requirers
+      };
+      struct NodeEntry
+      {
+         ServerConnection* connection;
+         std::vector<PortRoutes> provide_routes; //index: port_id
+      };
+      void add_route(PortRoutes& routes, ServerConnection* connection, NodeInstance* node_instance, PortInstance const* require_port);
+      void connect_to_first_provider(PortRef& requirer);
+      static void remove_port_ref(std::vector<PortRef>& refs, NodeInstance const* node_instance);
+
+      std::unordered_map<NodeInstance const*, NodeEntry> m_nodes;
+      std::unordered_map<std::string, std::vector<PortRef>> m_providers; //key: port name
+      std::unordered_map<std::string, std::vector<PortRef>> m_requirers; //key: port name
+   };
+
+   template <typename Fn>
+   void RoutingTable::for_each_route(NodeInstance const* source, std::uint32_t offset, std::size_t size, Fn&& fn) const
+   {
+      auto const* routes = get_routes(source);
+      if ( (routes == nullptr) || routes->empty() )
+      {
+         return;
+      }
+      std::uint32_t const end_offset = offset + static_cast<std::uint32_t>(size);
+      //Find the first port that ends after offset. Provide ports are laid out in port_id order.
+      auto it = std::upper_bound(routes->begin(), routes->end(), offset,
+         [](std::uint32_t value, PortRoutes const& item) { return value < item.offset + item.size; });
+      for (; (it != routes->end()) && (it->offset < end_offset); ++it)
+      {
+         std::uint32_t const write_begin = std::max(it->offset, offset);
+         std::uint32_t const write_end = std::min(it->offset + it->size, end_offset);
+         for (auto const& action : it->actions)
+         {
+            fn(action, action.offset + (write_begin - it->offset), static_cast<std::size_t>(write_begin - offset), write_end - write_begin);
+         }
+      }
+   }
+}
@@ -1,9 +1,10 @@
 #pragma once
 
-#include <stack>
 #include <string>
+#include <string_view>
 #include <iterator>
 #include <variant>
+#include <vector>
 #include "cpp-apx/vmdefs.h"
 #include "cpp-apx/error.h"
 #include "dtl/dtl.hpp"
@@ -18,7 +19,6 @@ namespace apx
          struct State
          {
             State() { reset(dtl::ValueType::NoneType); }
-            ~State() {}
             dtl::ValueType value_type{ dtl::ValueType::NoneType };
 
             std::variant<
@@ -35,11 +35,11 @@ namespace apx
                dtl::Scalar const* sv;
                dtl::Array const* av;
                dtl::Hash const* hv;
+               dtl::TypedArrayBase const* ta;
             } value;
 
-            State* parent{ nullptr };
             ScalarStorageType scalar_type{ ScalarStorageType::None };
-            std::string field_name;
+            dtl::HashedKey field_key; //Refers to the program bytes (or the caller's key)
             std::size_t index{ 0u };
             std::size_t array_len{ 0u };
             std::size_t max_array_len{ 0u }; //Needed for dynamic arrays
@@ -61,8 +61,8 @@ namespace apx
                (type_code == TypeCode::Char32); }
             bool is_bytes_type() { return type_code == TypeCode::Byte; }
             bool is_record_type() { return type_code == TypeCode::Record; }
-            dtl::Value const* get_child_value(const char* key);
-            void set_field_name(const char* name, bool is_last) { field_name = name;  is_last_field = is_last; }
+            dtl::Value const* get_child_value(dtl::HashedKey const& key);
+            void set_field_key(dtl::HashedKey const& key, bool is_last) { field_key = key;  is_last_field = is_last; }
             apx::error_t determine_array_length_from_value();
          protected:
             apx::error_t read_scalar_value(dtl::Scalar const* sv, TypeCode type_code_arg);
@@ -87,15 +87,18 @@ namespace apx
             bool is_enabled{ false };
          };
 
-         Serializer() { m_state = new Serializer::State(); }
-         ~Serializer();
+         Serializer() : m_states(1u) { m_state = m_states.data(); }
+         Serializer(Serializer const&) = delete;
+         Serializer& operator=(Serializer const&) = delete;
          void reset();
+         void reserve_nesting_depth(std::size_t nesting_depth);
          apx::error_t set_write_buffer(std::uint8_t* buf, std::size_t len);
          std::size_t bytes_written() { return std::distance(m_buffer.begin, m_buffer.next); }
          apx::error_t set_value(dtl::Value const* dv);
          apx::error_t set_value(dtl::ScalarValue sv);
          apx::error_t set_value(dtl::ArrayValue av);
          apx::error_t set_value(dtl::HashValue hv);
+         apx::error_t set_value(dtl::TypedArrayValue ta);
          void clear_value();
          apx::error_t pack_uint8(std::size_t array_len, apx::SizeType dynamic_size_type);
          apx::error_t pack_uint16(std::size_t array_len, apx::SizeType dynamic_size_type);
@@ -114,7 +117,8 @@ namespace apx
          apx::error_t check_value_range_uint32(std::uint32_t lower_limit, std::uint32_t upper_limit);
          apx::error_t check_value_range_int64(std::int64_t lower_limit, std::int64_t upper_limit);
          apx::error_t check_value_range_uint64(std::uint64_t lower_limit, std::uint64_t upper_limit);
-         apx::error_t record_select(const char* key, bool is_last_field);
+         apx::error_t record_select(dtl::HashedKey const& key, bool is_last_field);
+         apx::error_t record_select(std::string_view key, bool is_last_field) { return record_select(dtl::HashedKey{ key }, is_last_field); }
          apx::error_t queued_write_begin(std::uint32_t element_size, std::uint32_t max_length, bool clear_queue);
          apx::error_t queued_write_end();
          apx::error_t array_next(bool& is_last);
@@ -122,14 +126,16 @@ namespace apx
       protected:
          WriteBuffer m_buffer;
          QueuedWriteState m_queued_write;
+         std::vector<State> m_states; //m_states[0] holds the top-level value, m_states[m_depth] is the current state
+         std::size_t m_depth{ 0u };
          State* m_state{ nullptr };
-         std::stack<State*> m_stack;
          void reset_buffer(std::uint8_t* buf, std::size_t len);
          bool is_valid_buffer();
          apx::error_t prepare_for_array(std::size_t array_size, apx::SizeType dynamic_size_type);
          apx::error_t pack_value();
          apx::error_t pack_scalar_value();
          apx::error_t pack_array_of_scalar();
+         apx::error_t pack_typed_array();
          apx::error_t pack_scalar_value_internal();
          apx::error_t pack_string();
          apx::error_t pack_char_string(std::string const& str, std::size_t max_target_size);
@@ -137,6 +143,7 @@ namespace apx
          apx::error_t pack_record_value(bool& do_pop_state);
          apx::error_t default_range_check_value();
          apx::error_t default_range_check_scalar();
+         apx::error_t default_range_check_typed_array();
          apx::error_t value_in_range_i32(std::int32_t value, std::int32_t lower_limit, std::int32_t upper_limit);
          apx::error_t value_in_range_u32(std::uint32_t value, std::uint32_t lower_limit, std::uint32_t upper_limit);
          apx::error_t value_in_range_i64(std::int64_t value, std::int64_t lower_limit, std::int64_t upper_limit);
@@ -0,0 +1,115 @@
+/*****************************************************************************
+* \file      server.h
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     APX server
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#pragma once
+
+#include <array>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+#include "cpp-apx/socket_server_connection.h"
+#include "cpp-apx/routing_table.h"
+#ifdef UNIT_TEST
+#include "testsocket.h"
+#else
+#include "msocket_server.h"
+#endif
+
+namespace apx
+{
+   constexpr std::size_t SERVER_RESUME_CACHE_MAX_NODES = 1024u; //The oldest entry is dropped when the cache is full
+   constexpr std::chrono::milliseconds SERVER_HOUSEKEEPING_INTERVAL{ 1000 };
+
+   /*
+   * What the server kept from a node after its connection closed.
+   * A client reconnecting with an identical definition (same SHA256 digest) resumes from this data.
+   */
+   struct NodeResumeData
+   {
+      std::array<std::uint8_t, rmf::SHA256_SIZE> definition_digest;
+      std::string definition_text;
+      apx::ByteArray provide_port_data;
+   };
+
+   class Server
+   {
+   public:
+      Server() {}
+      ~Server();
+      ServerConnection* attach_connection(std::unique_ptr<ServerConnection> connection);
+      std::size_t num_connections();
+      std::size_t num_attached_nodes();
+
+      //Connect API
+#ifdef UNIT_TEST
+      SocketServerConnection* accept_test_socket(testsocket_t* test_socket);
+      void run();
+#else
+      error_t start_tcp(std::uint16_t port);
+# ifndef _WIN32
+      error_t start_unix(char const* path);
+      error_t start_unix(std::string const& path);
+# endif
+      void stop();
+#endif
+
+      //Callbacks from ServerConnection
+      void connection_disconnected(ServerConnection* connection);
+      void node_attached(ServerConnection* connection, NodeInstance* node_instance);
+      void provide_port_data_written(ServerConnection* connection, NodeInstance* node_instance, std::uint32_t offset, std::uint8_t const* data, std::size_t size);
+      void store_resume_data(std::string const& node_name, NodeResumeData&& data);
+      bool take_resume_data(std::string const& node_name, std::uint8_t const* definition_digest, NodeResumeData& data);
+      std::size_t num_resume_entries();
+
+   protected:
+      void route_provide_port_data(NodeInstance const* source, std::uint32_t offset, std::uint8_t const* data, std::size_t size);
+#ifndef UNIT_TEST
+      static void on_new_connection(void* arg, msocket_t* socket);
+      void accept_socket(msocket_t* socket);
+      void start_housekeeping();
+      void housekeeping_main();
+      void delete_closed_connections(std::unique_lock<std::mutex>& lock);
+#endif
+
+      std::mutex m_mutex;
+      std::vector<std::unique_ptr<ServerConnection>> m_connections;
+      std::vector<std::unique_ptr<ServerConnection>> m_closed_connections; //Deleted when it's safe to do so
+      RoutingTable m_routing_table;
+      std::unordered_map<std::string, NodeResumeData> m_resume_cache; //key: node name
+      std::deque<std::string> m_resume_cache_order; //Oldest first
+      apx::ByteArray m_attach_buffer; //Port data copied out of node data in node_attached
+      std::uint32_t m_next_connection_id{ 0u };
+#ifndef UNIT_TEST
+      std::vector<msocket_server_t*> m_socket_servers;
+      std::thread m_housekeeping_thread; //Deletes closed connections outside of their own socket threads
+      std::condition_variable m_housekeeping_cond;
+      bool m_is_housekeeping_running{ false };
+#endif
+   };
+}
@@ -0,0 +1,107 @@
+/*****************************************************************************
+* \file      server_connection.h
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Server connection (abstract) base class
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#pragma once
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include "cpp-apx/file_manager.h"
+#include "cpp-apx/connection_interface.h"
+#include "cpp-apx/node_manager.h"
+
+namespace apx
+{
+   class Server;
+   struct NodeResumeData;
+
+   class ServerConnection : public ConnectionInterface, public FileNotificationHandler
+   {
+   public:
+      ServerConnection() :m_file_manager{ this } {}
+      ServerConnection(Server* parent_server) : m_file_manager{ this }, m_parent_server{ parent_server } {}
+      virtual ~ServerConnection() {}
+      void connected();
+      void disconnected();
+      bool is_greeting_accepted() const { return m_is_greeting_accepted; }
+      void set_connection_id(std::uint32_t connection_id) { m_connection_id = connection_id; }
+      std::uint32_t get_connection_id() const { return m_connection_id; }
+      NodeManager& get_node_manager() { return m_node_manager; }
+      NodeInstance* find_node(char const* name) { return m_node_manager.find(name); }
+      NodeInstance* find_node(std::string const& name) { return m_node_manager.find(name); }
+      error_t write_require_port_data(NodeInstance* node_instance, std::uint32_t offset, std::uint8_t const* data, std::size_t size);
+      error_t write_require_port_data(NodeInstance* node_instance, std::uint32_t offset, SharedBuffer* buffer, std::uint8_t const* data, std::size_t size);
+
+      //ConnectionInterface API
+      error_t remote_file_published_notification(File* file) override;
+      error_t remote_file_write_notification(File* file, std::uint32_t offset, std::uint8_t const* data, std::size_t size) override;
+
+      //FileNotificationHandler API (used for local require port data files)
+      error_t file_open_notify(File* file) override;
+      error_t file_close_notify(File* file) override;
+      error_t file_write_notify(File* file, std::uint32_t offset, std::uint8_t const* data, std::size_t size) override;
+      error_t file_resume_notify(File* file, std::vector<ByteRange> const& dirty_ranges) override;
+#ifdef UNIT_TEST
+      virtual void run();
+#else
+      void start();
+      void stop();
+#endif
+   protected:
+      struct NodeFiles
+      {
+         File* definition_file{ nullptr };
+         File* provide_port_data_file{ nullptr };
+         File* require_port_data_file{ nullptr };
+         NodeInstance* node_instance{ nullptr };
+         apx::ByteArray definition_data;
+         std::size_t definition_bytes_received{ 0u };
+         bool is_resumed{ false }; //Server kept this node from a previous connection, files are resumed instead of opened
+         apx::ByteArray resumed_provide_port_data;
+      };
+
+      int on_data_received(std::uint8_t const* data, std::size_t data_size, std::size_t& parse_len);
+      std::uint8_t const* parse_message(std::uint8_t const* begin, std::uint8_t const* end, apx::error_t& error_code);
+      void set_data_reception_error(apx::error_t error_code);
+      error_t process_greeting(std::uint8_t const* msg_data, std::size_t msg_size);
+      void send_acknowledge();
+      error_t resume_definition_file(NodeFiles& node_files, NodeResumeData&& resume_data);
+      error_t process_definition_data(NodeFiles& node_files, std::uint32_t offset, std::uint8_t const* data, std::size_t size);
+      error_t build_node_instance(NodeFiles& node_files, std::string const& definition_text);
+      error_t process_provide_port_data(NodeInstance* node_instance, std::uint32_t offset, std::uint8_t const* data, std::size_t size);
+      error_t attach_node_instance(NodeFiles& node_files);
+      error_t open_provide_port_data_file(NodeFiles& node_files);
+      error_t create_require_port_data_file(NodeFiles& node_files);
+      void store_resume_data();
+      void register_node_file(File const* file, NodeFiles* node_files);
+      NodeFiles* find_node_files(File const* file);
+
+      bool m_is_greeting_accepted{ false };
+      FileManager m_file_manager;
+      NodeManager m_node_manager;
+      Server* m_parent_server{ nullptr };
+      std::uint32_t m_connection_id{ 0u };
+      std::unordered_map<std::string, NodeFiles> m_node_files; //key: node name
+      std::unordered_map<File const*, NodeFiles*> m_file_lookup; //key: remote or local file belonging to a node
+      std::mutex m_file_lookup_mutex; //File notifications also arrive from the file manager worker thread while the receive thread adds files
+   };
+}
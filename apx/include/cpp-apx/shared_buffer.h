@@ -0,0 +1,57 @@
+/*****************************************************************************
+* \file      shared_buffer.h
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Reference counted immutable byte buffer
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#pragma once
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+namespace apx
+{
+   /*
+   * Immutable byte buffer with an intrusive reference count.
+   * Lets one payload be queued to many connections without making one copy per connection.
+   * The creator holds the first reference. Each additional holder calls acquire() before storing the pointer
+   * and release() when it no longer needs the data. The last release() frees the buffer.
+   */
+   class SharedBuffer
+   {
+   public:
+      static SharedBuffer* create(std::uint8_t const* data, std::size_t size);
+      SharedBuffer(SharedBuffer const&) = delete;
+      SharedBuffer& operator=(SharedBuffer const&) = delete;
+      void acquire() noexcept { m_ref_count.fetch_add(1u, std::memory_order_relaxed); }
+      void release() noexcept;
+      std::uint8_t const* data() const noexcept { return reinterpret_cast<std::uint8_t const*>(this + 1); }
+      std::size_t size() const noexcept { return m_size; }
+      std::uint32_t use_count() const noexcept { return m_ref_count.load(std::memory_order_relaxed); }
+
+   protected:
+      SharedBuffer(std::size_t size) : m_size{ size } {}
+      ~SharedBuffer() = default;
+
+      std::atomic<std::uint32_t> m_ref_count{ 1u };
+      std::size_t m_size;
+   };
+}
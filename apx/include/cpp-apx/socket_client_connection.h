@@ -1,6 +1,8 @@
 #pragma once
+#include <atomic>
 #include <mutex>
 #include "cpp-apx/client_connection.h"
+#include "cpp-apx/capture.h"
 #include "msocket_adapter.h"
 #ifdef UNIT_TEST
 #include "testsocket.h"
@@ -34,6 +36,7 @@ namespace apx
       //connection API
 #ifdef UNIT_TEST
       error_t connect();
+      error_t reconnect(SOCKET_TYPE* socket);
       void run() override;
       void receive_accepted_cmd();
       void receive_file_info_cmd(std::uint32_t address, char const* file_name, std::size_t file_size);
@@ -59,6 +62,9 @@ namespace apx
       REQUIRES_LOCK_HELD(m_mutex) error_t transmit_data_message(std::uint32_t write_address, bool more_bit, std::uint8_t const* msg_data, std::int32_t msg_size, std::int32_t& bytes_available) override;
       error_t transmit_direct_message(std::uint8_t const* data, std::int32_t size, std::int32_t& bytes_available) override;
 
+      //Capture API
+      void set_capture(CaptureWriter* writer) { m_capture.store(writer, std::memory_order_release); } //writer must outlive the connection or be detached first
+
    protected:
       void send_packet();
 
@@ -67,6 +73,7 @@ namespace apx
       apx::ByteArray m_transmit_buffer;
       std::size_t const m_default_buffer_size{ 2048u };
       std::size_t m_pending_bytes{ 0u };
+      std::atomic<CaptureWriter*> m_capture{ nullptr };
    };
 }
 
@@ -0,0 +1,48 @@
+#pragma once
+#include <array>
+#include "cpp-apx/numheader.h"
+#include "cpp-apx/remotefile.h"
+#include "cpp-apx/server_connection.h"
+#include "cpp-apx/socket_client_connection.h"
+
+namespace apx
+{
+   constexpr std::size_t SOCKET_DIRECT_SEND_MIN_SIZE = 512u; //Shared data of at least this size is sent without copying it into the transmit buffer
+
+   class SocketServerConnection : public msocket::Handler, public apx::ServerConnection
+   {
+   public:
+      SocketServerConnection(SOCKET_TYPE* socket);
+      SocketServerConnection(SOCKET_TYPE* socket, Server* parent_server);
+      ~SocketServerConnection();
+#ifdef UNIT_TEST
+      void run() override;
+#endif
+      SOCKET_TYPE* get_socket() const { return m_socket; }
+
+      //msocket::Handler API
+      void socket_connected(const std::string& address, std::uint16_t port) override;
+      void socket_disconnected() override;
+      int socket_data_received(const std::uint8_t* data, std::size_t data_size, std::size_t& parse_len) override;
+
+      //apx::TransmitHandler API
+      std::int32_t transmit_max_bytes_avaiable() const override;
+      std::int32_t transmit_current_bytes_avaiable() const override;
+      ACQUIRES_LOCK(m_mutex) void transmit_begin() override;
+      RELEASES_LOCK(m_mutex) void transmit_end() override;
+      REQUIRES_LOCK_HELD(m_mutex) error_t transmit_data_message(std::uint32_t write_address, bool more_bit, std::uint8_t const* msg_data, std::int32_t msg_size, std::int32_t& bytes_available) override;
+      error_t transmit_direct_message(std::uint8_t const* data, std::int32_t size, std::int32_t& bytes_available) override;
+      REQUIRES_LOCK_HELD(m_mutex) error_t transmit_shared_data_message(std::uint32_t write_address, bool more_bit, SharedBuffer* buffer, std::uint8_t const* msg_data, std::int32_t msg_size, std::int32_t& bytes_available) override;
+
+   protected:
+      using DataMessageHeader = std::array<std::uint8_t, numheader::LONG32_SIZE + rmf::HIGH_ADDR_SIZE>;
+      std::size_t encode_data_message_header(DataMessageHeader& header, std::uint32_t write_address, bool more_bit, std::int32_t msg_size) const;
+      void send_packet();
+
+      SOCKET_TYPE* m_socket;
+      std::mutex m_mutex;
+      apx::ByteArray m_transmit_buffer;
+      std::size_t const m_default_buffer_size{ 2048u };
+      std::size_t m_pending_bytes{ 0u };
+   };
+}
@@ -0,0 +1,88 @@
+/*****************************************************************************
+* \file      trace.h
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Begin/end trace events in per-thread ring buffers, exported as Chrome trace JSON
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#pragma once
+
+#include <chrono>
+#include <cstdint>
+#include <ostream>
+#include "cpp-apx/error.h"
+
+/*
+* Tracing is compiled in with -DAPX_TRACE=ON (defines APX_TRACE_ENABLE=1).
+* Without it the APX_TRACE_* macros expand to nothing and traced functions run unchanged.
+*/
+#if APX_TRACE_ENABLE
+#define APX_TRACE_CONCAT_(a, b) a##b
+#define APX_TRACE_CONCAT(a, b) APX_TRACE_CONCAT_(a, b)
+#define APX_TRACE_SCOPE(name) apx::trace::Scope APX_TRACE_CONCAT(apx_trace_scope_, __LINE__){ name }
+#define APX_TRACE_SCOPE_ARG(name, arg) apx::trace::Scope APX_TRACE_CONCAT(apx_trace_scope_, __LINE__){ name, static_cast<std::uint64_t>(arg) }
+#define APX_TRACE_THREAD_NAME(name) apx::trace::set_thread_name(name)
+#else
+#define APX_TRACE_SCOPE(name) ((void)0)
+#define APX_TRACE_SCOPE_ARG(name, arg) ((void)0)
+#define APX_TRACE_THREAD_NAME(name) ((void)0)
+#endif
+
+namespace apx
+{
+   namespace trace
+   {
+      using Clock = std::chrono::steady_clock;
+
+      constexpr std::size_t THREAD_BUFFER_CAPACITY = 8192u; //Events kept per thread. The oldest events are overwritten first
+      constexpr std::size_t RETIRED_THREAD_BUFFERS_MAX = 16u; //Buffers of exited threads kept for export. The oldest are released first
+
+      struct Event
+      {
+         char const* name{ nullptr }; //Must point to a string literal
+         std::uint64_t begin_ns{ 0u }; //Relative to the first traced event of the process
+         std::uint64_t duration_ns{ 0u };
+         std::uint64_t arg{ 0u };
+      };
+
+      /*
+      * Records a completed operation into the ring buffer of the calling thread.
+      * Each thread only contends with write_chrome_trace and clear, never with other traced threads.
+      */
+      void record(char const* name, Clock::time_point begin, Clock::time_point end, std::uint64_t arg = 0u);
+      void set_thread_name(char const* name);
+      void clear(); //Also releases the buffers of exited threads
+      std::size_t num_thread_buffers();
+      void write_chrome_trace(std::ostream& os);
+      error_t write_chrome_trace(char const* path);
+
+      class Scope
+      {
+      public:
+         explicit Scope(char const* name, std::uint64_t arg = 0u) : m_name{ name }, m_arg{ arg }, m_begin{ Clock::now() } {}
+         Scope(Scope const&) = delete;
+         Scope& operator=(Scope const&) = delete;
+         ~Scope() { record(m_name, m_begin, Clock::now(), m_arg); }
+      protected:
+         char const* m_name;
+         std::uint64_t m_arg;
+         Clock::time_point m_begin;
+      };
+   }
+}
@@ -0,0 +1,154 @@
+/*****************************************************************************
+* \file      typed_array.h
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Bulk pack, unpack and range check of dtl typed arrays
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#pragma once
+
+#include <cstdint>
+#include <cstddef>
+#include <limits>
+#include <type_traits>
+#include <utility>
+#include "cpp-apx/pack.h"
+#include "cpp-apx/range_check.h"
+#include "cpp-apx/vmdefs.h"
+#include "dtl/dtl.hpp"
+
+namespace apx
+{
+   namespace vm
+   {
+      /*
+      * Returns the element type of typed arrays created for type_code (ElementType::None for non-integer types).
+      */
+      inline dtl::ElementType element_type_from_type_code(TypeCode type_code)
+      {
+         switch (type_code)
+         {
+         case TypeCode::UInt8:
+            return dtl::ElementType::UInt8;
+         case TypeCode::UInt16:
+            return dtl::ElementType::UInt16;
+         case TypeCode::UInt32:
+            return dtl::ElementType::UInt32;
+         case TypeCode::UInt64:
+            return dtl::ElementType::UInt64;
+         case TypeCode::Int8:
+            return dtl::ElementType::Int8;
+         case TypeCode::Int16:
+            return dtl::ElementType::Int16;
+         case TypeCode::Int32:
+            return dtl::ElementType::Int32;
+         case TypeCode::Int64:
+            return dtl::ElementType::Int64;
+         case TypeCode::Bool:
+            return dtl::ElementType::Bool;
+         default:
+            break;
+         }
+         return dtl::ElementType::None;
+      }
+
+      /*
+      * Writes length elements from src to dst as little-endian W, where W is the wire type of the port.
+      * Bool ports (bool_port=true) write 1 for every non-zero element.
+      * Elements of the same width as W are written with the bulk kernel since the cast keeps their bit pattern.
+      */
+      template <typename W, bool bool_port = false, typename T> void pack_typed_elements(std::uint8_t* dst, T const* src, std::size_t length)
+      {
+         if constexpr (!bool_port && (sizeof(T) == sizeof(W)))
+         {
+            pack_array_le<T>(dst, src, length);
+         }
+         else
+         {
+            for (std::size_t i = 0u; i < length; i++)
+            {
+               if constexpr (bool_port)
+               {
+                  *dst = (src[i] != 0) ? 1u : 0u;
+               }
+               else
+               {
+                  packLE<W>(dst, static_cast<W>(src[i]));
+               }
+               dst += sizeof(W);
+            }
+         }
+      }
+
+      /*
+      * Reads length little-endian elements from src into ta, replacing its previous contents.
+      */
+      template <typename T> void unpack_typed_elements(dtl::TypedArray<T>& ta, std::uint8_t const* src, std::size_t length)
+      {
+         using storage_type = typename dtl::TypedArray<T>::storage_type;
+         ta.resize(length);
+         storage_type* dst = ta.data();
+         if constexpr (std::is_same_v<T, bool>)
+         {
+            for (std::size_t i = 0u; i < length; i++)
+            {
+               dst[i] = (src[i] != 0u) ? 1u : 0u;
+            }
+         }
+         else
+         {
+            unpack_array_le<storage_type>(dst, src, length);
+         }
+      }
+
+      /*
+      * Clamps the limits to the range of element type E before handing the buffer to elements_in_range.
+      * Comparisons are made on the actual values so elements of any signedness can be checked against any limit type.
+      */
+      template <typename E, typename L> bool elements_in_range_clamped(E const* data, std::size_t length, L lower_limit, L upper_limit)
+      {
+         constexpr E element_min = std::numeric_limits<E>::min();
+         constexpr E element_max = std::numeric_limits<E>::max();
+         if (length == 0u)
+         {
+            return true;
+         }
+         if (std::cmp_greater(lower_limit, element_max) || std::cmp_less(upper_limit, element_min) || (lower_limit > upper_limit))
+         {
+            return false;
+         }
+         E const lower = std::cmp_less(lower_limit, element_min) ? element_min : static_cast<E>(lower_limit);
+         E const upper = std::cmp_greater(upper_limit, element_max) ? element_max : static_cast<E>(upper_limit);
+         return elements_in_range(data, length, lower, upper);
+      }
+
+      /*
+      * Returns true when every element of ta is within [lower_limit, upper_limit].
+      */
+      template <typename L> bool typed_array_in_range(dtl::TypedArrayBase const* ta, L lower_limit, L upper_limit)
+      {
+         bool in_range{ true };
+         bool const is_known_type = dtl::visit_ta(ta, [&](auto const& array)
+            {
+               in_range = elements_in_range_clamped(array.data(), array.length(), lower_limit, upper_limit);
+            });
+         return is_known_type && in_range;
+      }
+   }
+}
@@ -96,6 +96,11 @@ namespace apx
       Disconnected,
    };
 
+   enum class WritePolicy : unsigned char {
+      QueueAll,         //Every write is transmitted
+      LatestValueWins,  //Writes not yet transmitted are replaced by newer writes of the same port
+   };
+
    using ByteArray = std::vector<std::uint8_t>;
    using type_id_t = std::uint32_t;
    using port_id_t = std::uint32_t;
@@ -120,7 +125,6 @@ namespace apx
    constexpr std::uint32_t USER_DEFINED_ADDRESS_START     = 0x20000000u; //128MB
    constexpr std::uint32_t USER_DEFINED_ADDRESS_ALIGNMENT = 0x1000u;     //4KB
 
-   constexpr std::size_t SMALL_DATA_SIZE = sizeof(std::uint32_t);
    constexpr std::size_t MAX_FILE_SIZE = 0x4000000; //64MB
    constexpr std::size_t MAX_STACK_BUFFER_SIZE = 256u;
 }
\ No newline at end of file
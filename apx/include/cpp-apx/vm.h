@@ -49,7 +49,11 @@ namespace apx
 #else
       apx::error_t pack_value(dtl::Value const* value);
       apx::error_t pack_value(dtl::ScalarValue const& value);
+      apx::error_t pack_value(dtl::DynamicValue const& value);
       apx::error_t unpack_value(dtl::ScalarValue& value);
+      apx::error_t unpack_value(dtl::DynamicValue& value);
+      apx::error_t unpack_view(std::uint8_t const*& data, std::size_t& size, TypeCode& type_code);
+      void set_memory_resource(std::pmr::memory_resource* resource) { m_deserializer.set_memory_resource(resource); }
 #endif
    protected:
 
@@ -31,10 +31,10 @@ namespace apx
    namespace vm
    {
       /*
-      * APX VM 2.0 PROGRAM HEADER (Varies between 6 and 14 bytes)
+      * APX VM 2.1 PROGRAM HEADER (Varies between 6 and 15 bytes)
       * bytes 0-1: Magic numbers 'V','M'
       * Byte 2: VM_MAJOR_VERSION
-      * Byte 3: VM_MINOR_VERSION
+      * Byte 3: VM_MINOR_VERSION (programs with a lower minor version are still accepted)
       * Byte 4 (bits 4-7): program flags
       * Byte 4 (bit 3): pack or unpack program (0-1)
       * Byte 4 (bits 0-2): data size variant (VARIANT_U8, VARIANT_U16, VARIANT_U32)
@@ -55,13 +55,18 @@ namespace apx
       * Number of queued elements = (DataSize-QueueStorageSize)/ElementSize
       *
       * where QueueStorageSize is either 1, 2, or 4 (which can be determined from the variant on the DATA_SIZE instruction).
+      *
+      * If HEADER_FLAG_NESTING_DEPTH was set among program flags the header ends with one additional byte:
+      * Byte M: NestingDepth (uint8). Maximum number of nested states (record fields and record array elements) the VM needs
+      *         below the top-level value, saturated at 255. Programs without record data leave this flag cleared.
+      *         This flag was added in VM 2.1.
       */
 
       constexpr std::uint8_t HEADER_MAGIC_NUMBER_0 = ((uint8_t)'V');
       constexpr std::uint8_t HEADER_MAGIC_NUMBER_1 = ((uint8_t)'M');
       constexpr std::uint32_t MAGIC_NUMBER_SIZE = 2u;
       constexpr std::uint8_t MAJOR_VERSION = 2u;
-      constexpr std::uint8_t MINOR_VERSION = 0u;
+      constexpr std::uint8_t MINOR_VERSION = 1u;
       constexpr std::uint32_t VERSION_SIZE = 2u;
       constexpr std::uint32_t INITIAL_HEADER_SIZE = 4u;
       constexpr std::uint32_t FIXED_HEADER_SIZE = INITIAL_HEADER_SIZE + 1u;
@@ -71,6 +76,7 @@ namespace apx
 
       constexpr std::uint8_t HEADER_FLAG_DYNAMIC_DATA = 0x10; //This is just an indicator if any dynamic arrays are present inside the data.
       constexpr std::uint8_t HEADER_FLAG_QUEUED_DATA = 0x20; //When this is active, the very next instruction must be OPCODE_DATA_SIZE.
+      constexpr std::uint8_t HEADER_FLAG_NESTING_DEPTH = 0x40; //When this is active, the header ends with the nesting depth byte.
 
 
       /* APX VM 2.0 Instruction Format
@@ -130,7 +136,7 @@ namespace apx
          11: ELEMENT_SIZE_U32_QUEUE_SIZE_U16
          12: ELEMENT_SIZE_U32_QUEUE_SIZE_U32
 
-      3: DATA_CTRL  : 9 variants
+      3: DATA_CTRL  : 10 variants
          0: RECORD_SELECT
          1: LIMIT_CHECK_U8
          2: LIMIT_CHECK_U16
@@ -140,7 +146,8 @@ namespace apx
          6: LIMIT_CHECK_S16
          7: LIMIT_CHECK_S32
          8: LIMIT_CHECK_S64
-         FLAG(variant 0): When true: This is the last record field.
+         9: RECORD_SELECT_HASHED (VM 2.1 and later, same as RECORD_SELECT followed by the 32-bit key hash of the field name (little endian))
+         FLAG(variant 0, 9): When true: This is the last record field.
               When false: More record fields to follow
          FLAG (variant 1..8): When true, the limit check applies to non-scalar value (such as array of u8, u16 etc.)
       4: FLOW_CTRL     : 1 variant
@@ -209,6 +216,8 @@ namespace apx
       constexpr std::uint8_t VARIANT_LIMIT_CHECK_S32 = 7;
       constexpr std::uint8_t VARIANT_LIMIT_CHECK_S64 = 8;
       constexpr std::uint8_t VARIANT_LIMIT_CHECK_LAST = VARIANT_LIMIT_CHECK_S64;
+      constexpr std::uint8_t VARIANT_RECORD_SELECT_HASHED = 9; //Hash is calculated using dtl::key_hash
+      constexpr std::uint8_t RECORD_SELECT_HASHED_MINOR_VERSION = 1u; //First minor version that emits VARIANT_RECORD_SELECT_HASHED
 
       constexpr std::uint8_t OPCODE_FLOW_CTRL = 4;
       constexpr std::uint8_t VARIANT_ARRAY_NEXT = 0;
@@ -0,0 +1,74 @@
+/*****************************************************************************
+* \file      build_statistics.cpp
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Statistics collected while building nodes
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#include <iomanip>
+#include <sstream>
+#include "cpp-apx/build_statistics.h"
+
+namespace apx
+{
+   static double to_ms(BuildNodeStatistics::Duration duration)
+   {
+      return std::chrono::duration<double, std::milli>(duration).count();
+   }
+
+   void BuildNodeStatistics::add(BuildNodeStatistics const& other)
+   {
+      parse_time += other.parse_time;
+      type_derivation_time += other.type_derivation_time;
+      element_expansion_time += other.element_expansion_time;
+      init_value_derivation_time += other.init_value_derivation_time;
+      compile_time += other.compile_time;
+      init_data_time += other.init_data_time;
+      total_time += other.total_time;
+      definition_size += other.definition_size;
+      num_ports += other.num_ports;
+      num_programs += other.num_programs;
+      program_bytes += other.program_bytes;
+      init_data_size += other.init_data_size;
+   }
+
+   std::string BuildNodeStatistics::to_string() const
+   {
+      std::ostringstream ss;
+      ss << std::fixed << std::setprecision(3);
+      ss << "total " << to_ms(total_time) << " ms (parse " << to_ms(parse_time)
+         << ", type derivation " << to_ms(type_derivation_time)
+         << ", element expansion " << to_ms(element_expansion_time)
+         << ", init value derivation " << to_ms(init_value_derivation_time)
+         << ", compile " << to_ms(compile_time)
+         << ", init data " << to_ms(init_data_time) << ")";
+      ss << ", definition " << definition_size << " bytes, " << num_ports << " ports, "
+         << num_programs << " programs (" << program_bytes << " bytes), init data " << init_data_size << " bytes";
+      return ss.str();
+   }
+
+   std::string NodeManagerStatistics::to_string() const
+   {
+      std::ostringstream ss;
+      ss << std::fixed << std::setprecision(3);
+      ss << num_builds << " builds (" << num_failed_builds << " failed), slowest " << to_ms(max_total_time) << " ms, "
+         << total.to_string();
+      return ss.str();
+   }
+}
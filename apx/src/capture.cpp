@@ -0,0 +1,186 @@
+/*****************************************************************************
+* \file      capture.cpp
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Record and replay of raw RMF traffic
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#include <array>
+#include <cstring>
+#include <thread>
+#include "cpp-apx/capture.h"
+#include "cpp-apx/pack.h"
+#ifdef UNIT_TEST
+#include "cpp-apx/client.h"
+#endif
+
+namespace apx
+{
+   error_t CaptureWriter::open(char const* path)
+   {
+      std::scoped_lock lock{ m_mutex };
+      if (m_file.is_open())
+      {
+         m_file.close();
+      }
+      m_file.open(path, std::ios::out | std::ios::binary | std::ios::trunc);
+      if (!m_file.is_open())
+      {
+         return APX_FILE_CREATE_ERROR;
+      }
+      m_file.write(CAPTURE_MAGIC, CAPTURE_HEADER_SIZE);
+      m_start_time = std::chrono::steady_clock::now();
+      m_num_frames = 0u;
+      return m_file.good() ? APX_NO_ERROR : APX_FILE_CREATE_ERROR;
+   }
+
+   void CaptureWriter::close()
+   {
+      std::scoped_lock lock{ m_mutex };
+      if (m_file.is_open())
+      {
+         m_file.close();
+      }
+   }
+
+   bool CaptureWriter::is_open()
+   {
+      std::scoped_lock lock{ m_mutex };
+      return m_file.is_open();
+   }
+
+   void CaptureWriter::write_frame(CaptureDirection direction, std::uint8_t const* data, std::size_t size)
+   {
+      auto const now = std::chrono::steady_clock::now();
+      std::array<std::uint8_t, CAPTURE_FRAME_HEADER_SIZE> header;
+      std::scoped_lock lock{ m_mutex };
+      if (!m_file.is_open())
+      {
+         return;
+      }
+      auto const timestamp = std::chrono::duration_cast<std::chrono::nanoseconds>(now - m_start_time).count();
+      packLE<std::uint64_t>(header.data(), static_cast<std::uint64_t>(timestamp > 0 ? timestamp : 0));
+      packLE<std::uint8_t>(header.data() + 8u, static_cast<std::uint8_t>(direction));
+      packLE<std::uint32_t>(header.data() + 9u, static_cast<std::uint32_t>(size));
+      m_file.write(reinterpret_cast<char const*>(header.data()), header.size());
+      m_file.write(reinterpret_cast<char const*>(data), static_cast<std::streamsize>(size));
+      m_num_frames++;
+   }
+
+   std::size_t CaptureWriter::num_frames()
+   {
+      std::scoped_lock lock{ m_mutex };
+      return m_num_frames;
+   }
+
+   error_t CaptureReader::open(char const* path)
+   {
+      m_file.open(path, std::ios::in | std::ios::binary);
+      if (!m_file.is_open())
+      {
+         return APX_FILE_NOT_FOUND_ERROR;
+      }
+      m_file.seekg(0, std::ios::end);
+      m_file_size = static_cast<std::uint64_t>(m_file.tellg());
+      m_file.seekg(0, std::ios::beg);
+      std::array<char, CAPTURE_HEADER_SIZE> header;
+      if (!m_file.read(header.data(), header.size()) || (std::memcmp(header.data(), CAPTURE_MAGIC, CAPTURE_HEADER_SIZE) != 0))
+      {
+         m_file.close();
+         return APX_INVALID_HEADER_ERROR;
+      }
+      return APX_NO_ERROR;
+   }
+
+   error_t CaptureReader::read_next(CaptureFrame& frame, bool& has_frame)
+   {
+      has_frame = false;
+      std::array<std::uint8_t, CAPTURE_FRAME_HEADER_SIZE> header;
+      m_file.read(reinterpret_cast<char*>(header.data()), header.size());
+      if (m_file.gcount() == 0)
+      {
+         return APX_NO_ERROR;
+      }
+      if (static_cast<std::size_t>(m_file.gcount()) != header.size())
+      {
+         return APX_UNEXPECTED_END_ERROR;
+      }
+      auto const direction = unpackLE<std::uint8_t>(header.data() + 8u);
+      if (direction > static_cast<std::uint8_t>(CaptureDirection::Sent))
+      {
+         return APX_INVALID_MSG_ERROR;
+      }
+      frame.timestamp_ns = unpackLE<std::uint64_t>(header.data());
+      frame.direction = static_cast<CaptureDirection>(direction);
+      auto const data_size = unpackLE<std::uint32_t>(header.data() + 9u);
+      if (data_size > CAPTURE_FRAME_MAX_SIZE)
+      {
+         return APX_MSG_TOO_LARGE_ERROR;
+      }
+      if (data_size > m_file_size - static_cast<std::uint64_t>(m_file.tellg()))
+      {
+         return APX_UNEXPECTED_END_ERROR;
+      }
+      frame.data.resize(data_size);
+      if (!m_file.read(reinterpret_cast<char*>(frame.data.data()), static_cast<std::streamsize>(frame.data.size())))
+      {
+         return APX_UNEXPECTED_END_ERROR;
+      }
+      has_frame = true;
+      return APX_NO_ERROR;
+   }
+
+#ifdef UNIT_TEST
+   error_t replay_capture(char const* path, Client& client, testsocket_t* socket, ReplaySpeed speed, ReplayResult& result)
+   {
+      CaptureReader reader;
+      auto retval = reader.open(path);
+      if (retval != APX_NO_ERROR)
+      {
+         return retval;
+      }
+      result = ReplayResult();
+      CaptureFrame frame;
+      bool has_frame{ false };
+      auto const start_time = std::chrono::steady_clock::now();
+      for (;;)
+      {
+         retval = reader.read_next(frame, has_frame);
+         if ((retval != APX_NO_ERROR) || !has_frame)
+         {
+            break;
+         }
+         if (frame.direction != CaptureDirection::Received)
+         {
+            continue;
+         }
+         if (speed == ReplaySpeed::Original)
+         {
+            std::this_thread::sleep_until(start_time + std::chrono::nanoseconds(frame.timestamp_ns));
+         }
+         testsocket_serverSend(socket, frame.data.data(), static_cast<std::uint32_t>(frame.data.size()));
+         client.run();
+         result.num_frames++;
+         result.num_bytes += frame.data.size();
+      }
+      result.elapsed = std::chrono::steady_clock::now() - start_time;
+      return retval;
+   }
+#endif
+}
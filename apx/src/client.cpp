@@ -26,17 +26,33 @@
 
 namespace apx
 {
-   error_t Client::build_node(char const* apx_text)
+   error_t Client::build_node(char const* apx_text, BuildNodeStatistics* statistics)
    {
-      return m_node_manager.build_node(apx_text);
+      return m_node_manager.build_node(apx_text, statistics);
    }
 
-   error_t Client::build_node(std::string const& apx_text)
+   error_t Client::build_node(std::string const& apx_text, BuildNodeStatistics* statistics)
    {
-      return m_node_manager.build_node(apx_text);
+      return m_node_manager.build_node(apx_text, statistics);
    }
    //Port API
    error_t Client::read_port_value(PortInstance* port_instance, dtl::ScalarValue& sv)
+   {
+      dtl::DynamicValue dv;
+      error_t retval = read_port_value(port_instance, dv);
+      if (retval == APX_NO_ERROR)
+      {
+         auto tmp = dtl::sv_cast(dv);
+         if (tmp == nullptr)
+         {
+            return APX_VALUE_TYPE_ERROR;
+         }
+         sv = std::move(tmp);
+      }
+      return retval;
+   }
+
+   error_t Client::read_port_value(PortInstance* port_instance, dtl::DynamicValue& dv, std::pmr::memory_resource* resource)
    {
       if ( (port_instance == nullptr) || (port_instance->port_type() != PortType::RequirePort) )
       {
@@ -76,18 +92,69 @@ namespace apx
          }
          if (retval == APX_NO_ERROR)
          {
-            retval = m_vm.unpack_value(sv);
+            m_vm.set_memory_resource(resource);
+            retval = m_vm.unpack_value(dv);
+            m_vm.set_memory_resource(nullptr);
+         }
+      }
+      return retval;
+   }
+
+   error_t Client::read_port_bytes(PortInstance* port_instance, apx::ByteArray& snapshot, std::span<std::uint8_t const>& bytes)
+   {
+      std::uint8_t const* data{ nullptr };
+      std::size_t size{ 0u };
+      TypeCode type_code{ TypeCode::None };
+      error_t retval = read_port_view(port_instance, snapshot, data, size, type_code);
+      if (retval == APX_NO_ERROR)
+      {
+         if (type_code != TypeCode::Byte)
+         {
+            return APX_VALUE_TYPE_ERROR;
          }
+         bytes = std::span<std::uint8_t const>{ data, size };
+      }
+      return retval;
+   }
+
+   error_t Client::read_port_string(PortInstance* port_instance, apx::ByteArray& snapshot, std::string_view& str)
+   {
+      std::uint8_t const* data{ nullptr };
+      std::size_t size{ 0u };
+      TypeCode type_code{ TypeCode::None };
+      error_t retval = read_port_view(port_instance, snapshot, data, size, type_code);
+      if (retval == APX_NO_ERROR)
+      {
+         if ((type_code != TypeCode::Char) && (type_code != TypeCode::Char8))
+         {
+            return APX_VALUE_TYPE_ERROR;
+         }
+         str = std::string_view{ reinterpret_cast<char const*>(data), size };
       }
       return retval;
    }
 
    error_t Client::write_port_value(PortInstance* port_instance, dtl::ScalarValue& sv)
+   {
+      return write_port_value(port_instance, dtl::dv_cast(sv));
+   }
+
+   error_t Client::write_port_value(PortInstance* port_instance, dtl::DynamicValue const& dv)
    {
       if ((port_instance == nullptr) || (port_instance->port_type() != PortType::ProvidePort))
       {
          return APX_INVALID_ARGUMENT_ERROR;
       }
+      std::chrono::steady_clock::time_point start_time{};
+      SocketClientConnection* connection{ nullptr };
+      if (m_latency_tracing.load(std::memory_order_relaxed))
+      {
+         connection = m_connection.load();
+         if ( (connection != nullptr) && connection->is_latency_tracing() )
+         {
+            start_time = std::chrono::steady_clock::now();
+         }
+      }
       std::array<std::uint8_t, apx::MAX_STACK_BUFFER_SIZE> stack_buffer;
       std::size_t const data_size = port_instance->data_size();
       std::size_t buffer_size = stack_buffer.size();
@@ -122,16 +189,139 @@ namespace apx
          }
          if (retval == APX_NO_ERROR)
          {
-            retval = m_vm.pack_value(sv);
+            retval = m_vm.pack_value(dv);
          }
          if (retval == APX_NO_ERROR)
          {
-            retval = node_data->write_provide_port_data(port_instance->data_offset(), write_buffer, data_size);
+            retval = node_instance->write_provide_port_data(port_instance->data_offset(), write_buffer, data_size, port_instance->coalesce_slot());
          }
+         if ( (retval == APX_NO_ERROR) && (start_time != std::chrono::steady_clock::time_point{}) )
+         {
+            connection->record_write_to_queue_latency(std::chrono::steady_clock::now() - start_time);
+         }
+      }
+      return retval;
+   }
+
+   void Client::set_transmit_high_water_mark(std::size_t num_bytes)
+   {
+      m_transmit_high_water_mark.store(num_bytes);
+      auto* connection = m_connection.load();
+      if (connection != nullptr)
+      {
+         connection->set_transmit_high_water_mark(num_bytes);
+      }
+   }
+
+   void Client::set_latency_tracing(bool enabled)
+   {
+      m_latency_tracing.store(enabled);
+      auto* connection = m_connection.load();
+      if (connection != nullptr)
+      {
+         connection->set_latency_tracing(enabled);
+      }
+   }
+
+   void Client::get_latency(LatencySnapshot& snapshot)
+   {
+      auto* connection = m_connection.load();
+      if (connection != nullptr)
+      {
+         connection->get_latency(snapshot);
+      }
+      else
+      {
+         snapshot = LatencySnapshot();
+      }
+   }
+
+   error_t Client::start_capture(char const* path)
+   {
+      if (m_capture == nullptr)
+      {
+         m_capture = std::make_unique<CaptureWriter>();
+      }
+      auto retval = m_capture->open(path);
+      auto* connection = m_connection.load();
+      if ( (retval == APX_NO_ERROR) && (connection != nullptr) )
+      {
+         connection->set_capture(m_capture.get());
       }
       return retval;
    }
 
+   /*
+   * The writer is kept until the client is destroyed since connection threads may still hold a pointer to it.
+   */
+   void Client::stop_capture()
+   {
+      auto* connection = m_connection.load();
+      if (connection != nullptr)
+      {
+         connection->set_capture(nullptr);
+      }
+      if (m_capture != nullptr)
+      {
+         m_capture->close();
+      }
+   }
+
+   void Client::get_metrics(MetricsSnapshot& snapshot)
+   {
+      auto* current_connection = m_connection.load();
+      if (current_connection != nullptr)
+      {
+         auto const& connection = current_connection->get_metrics();
+         auto const& file_manager = current_connection->get_file_manager_metrics();
+         auto const& worker = current_connection->get_worker_metrics();
+         snapshot.bytes_sent = connection.bytes_sent.get();
+         snapshot.bytes_received = connection.bytes_received.get();
+         snapshot.messages_sent = connection.messages_sent.get();
+         snapshot.messages_received = connection.messages_received.get();
+         snapshot.send_packet_calls = connection.send_packet_calls.get();
+         snapshot.parse_errors = connection.parse_errors.get();
+         snapshot.fragments_received = file_manager.fragments_received.get();
+         snapshot.reassembled_messages = file_manager.reassembled_messages.get();
+         snapshot.reception_errors = file_manager.reception_errors.get();
+         snapshot.queue_depth = worker.queue_depth.get();
+         snapshot.max_queue_depth = worker.queue_depth.max();
+         snapshot.commands_processed = worker.commands_processed.get();
+         snapshot.queue_wait_ns = worker.queue_wait_ns.get();
+         snapshot.max_queue_wait_ns = worker.last_queue_wait_ns.max();
+         snapshot.coalesced_writes = worker.coalesced_writes.get();
+         snapshot.rejected_writes = worker.rejected_writes.get();
+      }
+      else
+      {
+         auto nodes = std::move(snapshot.nodes);
+         snapshot = MetricsSnapshot();
+         snapshot.nodes = std::move(nodes);
+      }
+      std::size_t num_nodes{ 0u };
+      m_node_manager.for_each_attached_node([&snapshot, &num_nodes](NodeInstance* node_instance)
+         {
+            if (num_nodes == snapshot.nodes.size())
+            {
+               snapshot.nodes.emplace_back();
+            }
+            auto& node_snapshot = snapshot.nodes[num_nodes++];
+            node_snapshot.name = node_instance->get_name();
+            auto const* node_data = node_instance->get_node_data();
+            if (node_data != nullptr)
+            {
+               node_snapshot.provide_port_writes = node_data->get_metrics().provide_port_writes.get();
+               node_snapshot.require_port_writes = node_data->get_metrics().require_port_writes.get();
+            }
+            else
+            {
+               node_snapshot.provide_port_writes = 0u;
+               node_snapshot.require_port_writes = 0u;
+            }
+         });
+      snapshot.nodes.resize(num_nodes);
+   }
+
    PortInstance* Client::get_port(char const* node_name, char const* port_name)
    {
       auto* node_instance = m_node_manager.find(node_name);
@@ -156,15 +346,28 @@ namespace apx
 #ifndef UNIT_TEST
    error_t Client::connect_tcp(char const* address, std::uint16_t port)
    {
+      auto* existing_connection = m_connection.load();
+      if (existing_connection != nullptr)
+      {
+         //Reconnect using existing connection. This keeps local files and definition digests from previous connection.
+         return existing_connection->connect_tcp(address, port);
+      }
       auto* msocket = msocket_new(AF_INET);
       if (msocket == nullptr)
       {
          return APX_MEM_ERROR;
       }
-      m_connection = std::make_unique<SocketClientConnection>(msocket, this);
-      m_connection->start();
-      m_connection->attach_node_manager(&m_node_manager);
-      return m_connection->connect_tcp(address, port);
+      auto* connection = m_connections.emplace_back(std::make_unique<SocketClientConnection>(msocket, this)).get();
+      connection->set_transmit_high_water_mark(m_transmit_high_water_mark.load());
+      connection->set_latency_tracing(m_latency_tracing.load());
+      if ( (m_capture != nullptr) && m_capture->is_open() )
+      {
+         connection->set_capture(m_capture.get());
+      }
+      m_connection.store(connection);
+      connection->start();
+      connection->attach_node_manager(&m_node_manager);
+      return connection->connect_tcp(address, port);
    }
 
    error_t Client::connect_tcp(std::string const& address, std::uint16_t port)
@@ -186,36 +389,57 @@ namespace apx
 #else
    error_t Client::connect(testsocket_t* test_socket)
    {
-      m_connection = std::make_unique<SocketClientConnection>(test_socket, this);
-      m_connection->attach_node_manager(&m_node_manager);
-      return m_connection->connect();
+      auto* connection = m_connections.emplace_back(std::make_unique<SocketClientConnection>(test_socket, this)).get();
+      connection->set_transmit_high_water_mark(m_transmit_high_water_mark.load());
+      connection->set_latency_tracing(m_latency_tracing.load());
+      if ( (m_capture != nullptr) && m_capture->is_open() )
+      {
+         connection->set_capture(m_capture.get());
+      }
+      m_connection.store(connection); //The previous connection (if any) stays in m_connections
+      connection->attach_node_manager(&m_node_manager);
+      return connection->connect();
+   }
+
+   error_t Client::reconnect(testsocket_t* test_socket)
+   {
+      auto* connection = m_connection.load();
+      if (connection == nullptr)
+      {
+         return connect(test_socket);
+      }
+      return connection->reconnect(test_socket);
    }
    void Client::run()
    {
-      if (m_connection != nullptr)
+      auto* connection = m_connection.load();
+      if (connection != nullptr)
       {
-         m_connection->run();
+         connection->run();
       }
    }
    void Client::receive_accepted_cmd()
    {
-      if (m_connection != 0)
+      auto* connection = m_connection.load();
+      if (connection != nullptr)
       {
-         m_connection->receive_accepted_cmd();
+         connection->receive_accepted_cmd();
       }
    }
    void Client::receive_file_info_cmd(std::uint32_t address, char const* file_name, std::size_t file_size)
    {
-      if (m_connection != 0)
+      auto* connection = m_connection.load();
+      if (connection != nullptr)
       {
-         m_connection->receive_file_info_cmd(address, file_name, file_size);
+         connection->receive_file_info_cmd(address, file_name, file_size);
       }
    }
    void Client::receive_data_messsage(std::uint32_t address, std::uint8_t const* data, std::size_t size)
    {
-      if (m_connection != 0)
+      auto* connection = m_connection.load();
+      if (connection != nullptr)
       {
-         m_connection->receive_data_messsage(address, data, size);
+         connection->receive_data_messsage(address, data, size);
       }
    }
 #endif
@@ -251,4 +475,39 @@ namespace apx
       }
       return suggested_buffer;
    }
+
+   error_t Client::read_port_view(PortInstance* port_instance, apx::ByteArray& snapshot, std::uint8_t const*& data, std::size_t& size, TypeCode& type_code)
+   {
+      if ((port_instance == nullptr) || (port_instance->port_type() != PortType::RequirePort))
+      {
+         return APX_INVALID_ARGUMENT_ERROR;
+      }
+      auto* node_instance = port_instance->node_instance();
+      if (node_instance == nullptr)
+      {
+         return APX_NULL_PTR_ERROR;
+      }
+      auto* node_data = node_instance->get_node_data();
+      if (node_data == nullptr)
+      {
+         return APX_NULL_PTR_ERROR;
+      }
+      std::size_t const data_size = port_instance->data_size();
+      snapshot.resize(data_size);
+      error_t retval = node_data->read_require_port_data(port_instance->data_offset(), snapshot.data(), data_size);
+      if (retval == APX_NO_ERROR)
+      {
+         std::scoped_lock lock(m_mutex);
+         retval = m_vm.set_read_buffer(snapshot.data(), data_size);
+         if (retval == APX_NO_ERROR)
+         {
+            retval = m_vm.select_program(port_instance->unpack_program());
+         }
+         if (retval == APX_NO_ERROR)
+         {
+            retval = m_vm.unpack_view(data, size, type_code);
+         }
+      }
+      return retval;
+   }
 }
\ No newline at end of file
@@ -4,6 +4,7 @@
 #include "cpp-apx/client_connection.h"
 #include "cpp-apx/client.h"
 #include "cpp-apx/numheader.h"
+#include "cpp-apx/trace.h"
 
 namespace apx
 {
@@ -23,8 +24,23 @@ namespace apx
       }
    }
 
+   /*
+   * Local files, node data and definition digests are kept so that the next connection can be resumed.
+   */
    void ClientConnection::disconnected()
    {
+      m_is_greeting_accepted = false;
+      m_file_manager.disconnected();
+      if (m_node_manager != nullptr)
+      {
+         for (auto& node_instance : m_node_manager->get_nodes())
+         {
+            if (node_instance->has_require_port_data())
+            {
+               node_instance->set_require_port_data_state(PortDataState::WaitingForFileInfo);
+            }
+         }
+      }
       if (m_parent_client != nullptr)
       {
          m_parent_client->on_connection_disconnected(this);
@@ -102,11 +118,28 @@ namespace apx
             }
             PortInstance* port_instance = node_instance->get_require_port(port_id);
             offset += port_instance->data_size();
+            if (m_receive_time != std::chrono::steady_clock::time_point{})
+            {
+               m_metrics.receive_to_notify.record(std::chrono::steady_clock::now() - m_receive_time);
+            }
             m_parent_client->on_require_port_written(port_instance);
          }
       }
    }
 
+   void ClientConnection::set_latency_tracing(bool enabled)
+   {
+      m_latency_tracing.store(enabled, std::memory_order_relaxed);
+      m_file_manager.set_latency_tracing(enabled);
+   }
+
+   void ClientConnection::get_latency(LatencySnapshot& snapshot) const
+   {
+      m_metrics.write_to_queue.read(snapshot.write_to_queue);
+      m_file_manager.get_worker_metrics().queue_to_send.read(snapshot.queue_to_send);
+      m_metrics.receive_to_notify.read(snapshot.receive_to_notify);
+   }
+
    error_t ClientConnection::attach_node_instance(NodeInstance* node_instance)
    {
       return node_instance->attach_to_file_manager(&m_file_manager);
@@ -134,6 +167,10 @@ namespace apx
          return -1;
       }
       std::size_t total_parse_len = 0u;
+      if (is_latency_tracing())
+      {
+         m_receive_time = std::chrono::steady_clock::now();
+      }
       std::uint8_t const* next = data;
       std::uint8_t const* end = data + data_size;
       while (next < end)
@@ -154,19 +191,25 @@ namespace apx
             next = result;
             total_parse_len = next - data;
             assert(total_parse_len <= data_size);
+            m_metrics.messages_received.add();
          }
          else
          {
+            m_metrics.parse_errors.add();
+            m_receive_time = std::chrono::steady_clock::time_point{};
             set_data_reception_error(error_code);
             return -1;
          }
       }
       parse_len = total_parse_len;
+      m_receive_time = std::chrono::steady_clock::time_point{};
+      m_metrics.bytes_received.add(total_parse_len);
       return 0;
    }
 
    std::uint8_t const* ClientConnection::parse_message(std::uint8_t const* begin, std::uint8_t const* end, apx::error_t& error_code)
    {
+      APX_TRACE_SCOPE_ARG("ClientConnection::parse_message", end - begin);
       std::uint8_t const* msg_end = nullptr;
       error_code = APX_NO_ERROR;
       if (begin < end)
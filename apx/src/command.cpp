@@ -22,14 +22,103 @@
 *
 ******************************************************************************/
 
+#include <cassert>
 #include <cstring>
+#include <new>
+#include <utility>
 #include "cpp-apx/command.h"
 
 namespace apx
 {
-   Command::Command(CmdType ct, std::uint32_t d1, std::uint32_t d2, std::uint8_t const* b, void* d4) :
-      cmd_type(ct), data1(d1), data2(d2), data4{ d4 }
+   /*
+   * Returns offset of the stored record. The offset stays valid until the queue is emptied, cleared or swapped.
+   */
+   std::size_t CommandQueue::push(Command const& cmd)
    {
-      std::memcpy(&data3.bytes[0], b, apx::SMALL_DATA_SIZE);
+      std::size_t const record_offset = m_write_pos;
+      auto* record = reserve(record_size(0u));
+      auto* stored = new (record) Command(cmd);
+      stored->inline_size = 0u;
+      m_length++;
+      return record_offset;
+   }
+
+   std::size_t CommandQueue::push(Command const& cmd, std::uint8_t const* data, std::uint32_t size)
+   {
+      std::size_t const record_offset = m_write_pos;
+      auto* record = reserve(record_size(size));
+      auto* stored = new (record) Command(cmd);
+      stored->inline_size = size;
+      if (size > 0u)
+      {
+         std::memcpy(record + sizeof(Command), data, size);
+      }
+      m_length++;
+      return record_offset;
+   }
+
+   Command const& CommandQueue::front() const
+   {
+      assert(!empty());
+      return *reinterpret_cast<Command const*>(m_buffer.data() + m_read_pos);
+   }
+
+   Command* CommandQueue::at(std::size_t record_offset)
+   {
+      if ( (record_offset < m_read_pos) || (record_offset >= m_write_pos) )
+      {
+         return nullptr;
+      }
+      return reinterpret_cast<Command*>(m_buffer.data() + record_offset);
+   }
+
+   void CommandQueue::pop()
+   {
+      if (!empty())
+      {
+         m_read_pos += record_size(front().inline_size);
+         if (--m_length == 0u)
+         {
+            m_read_pos = 0u;
+            m_write_pos = 0u;
+         }
+      }
+   }
+
+   void CommandQueue::clear()
+   {
+      m_read_pos = 0u;
+      m_write_pos = 0u;
+      m_length = 0u;
+   }
+
+   void CommandQueue::swap(CommandQueue& other) noexcept
+   {
+      std::swap(m_buffer, other.m_buffer);
+      std::swap(m_read_pos, other.m_read_pos);
+      std::swap(m_write_pos, other.m_write_pos);
+      std::swap(m_length, other.m_length);
+   }
+
+   std::size_t CommandQueue::record_size(std::size_t data_size)
+   {
+      constexpr std::size_t alignment = alignof(Command);
+      return (sizeof(Command) + data_size + alignment - 1u) & ~(alignment - 1u);
+   }
+
+   std::uint8_t* CommandQueue::reserve(std::size_t size)
+   {
+      if (m_write_pos + size > m_buffer.size())
+      {
+         std::size_t new_capacity = m_buffer.empty() ? COMMAND_QUEUE_DEFAULT_CAPACITY : m_buffer.size() * 2u;
+         while (new_capacity < m_write_pos + size)
+         {
+            new_capacity *= 2u;
+         }
+         m_buffer.resize(new_capacity);
+      }
+      auto* record = m_buffer.data() + m_write_pos;
+      m_write_pos += size;
+      return record;
    }
 }
\ No newline at end of file
@@ -1,6 +1,7 @@
 #include "cpp-apx/compiler.h"
 #include "cpp-apx/vmdefs.h"
 #include "cpp-apx/pack.h"
+#include "dtl/dtl.hpp"
 #include <cassert>
 #include <array>
 #include <iterator>
@@ -43,7 +44,7 @@ namespace apx
       }
       std::uint32_t const queue_length = port->get_queue_length();
       apx::vm::Program header;
-      m_last_error = apx::vm::create_program_header(header, program_type, element_size, queue_length, m_is_dynamic);
+      m_last_error = apx::vm::create_program_header(header, program_type, element_size, queue_length, m_is_dynamic, m_max_nesting_depth);
       if (m_last_error != APX_NO_ERROR)
       {
          return std::unique_ptr<vm::Program>();
@@ -56,6 +57,16 @@ namespace apx
    {
       m_last_error = APX_NO_ERROR;
       m_is_dynamic = false;
+      m_nesting_depth = 0u;
+      m_max_nesting_depth = 0u;
+   }
+
+   void Compiler::enter_nested_state()
+   {
+      if (++m_nesting_depth > m_max_nesting_depth)
+      {
+         m_max_nesting_depth = m_nesting_depth;
+      }
    }
 
    apx::error_t Compiler::compile_data_element(apx::DataElement const* data_element, apx::ProgramType program_type, std::uint32_t& elem_size)
@@ -162,7 +173,15 @@ namespace apx
                   m_is_dynamic = true;
                }
             }
+            if (is_array)
+            {
+               enter_nested_state(); //Each array element is unpacked in its own state
+            }
             retval = compile_record_fields(data_element, program_type, elem_size);
+            if (is_array)
+            {
+               leave_nested_state();
+            }
             if ((retval == APX_NO_ERROR) && (is_array))
             {
                retval = compile_array_next_instruction();
@@ -447,7 +466,9 @@ namespace apx
             return result;
          }
          assert(derived_element != nullptr);
+         enter_nested_state();
          result = compile_data_element(derived_element, program_type, child_size);
+         leave_nested_state();
          if (result != APX_NO_ERROR)
          {
             return result;
@@ -469,10 +490,13 @@ namespace apx
       {
          return APX_NAME_MISSING_ERROR;
       }
-      std::uint8_t const instruction = vm::encode_instruction(vm::OPCODE_DATA_CTRL, vm::VARIANT_RECORD_SELECT, is_last_field);
+      std::uint8_t const instruction = vm::encode_instruction(vm::OPCODE_DATA_CTRL, vm::VARIANT_RECORD_SELECT_HASHED, is_last_field);
       m_program->push_back(instruction);
       m_program->insert(m_program->end(), name.begin(), name.end());
       m_program->push_back(0u); //null-terminator;
+      std::array<std::uint8_t, vm::UINT32_SIZE> encoded_hash;
+      packLE<std::uint32_t>(encoded_hash.data(), dtl::key_hash(name)); //Saves hashing the field name each time the VM selects it
+      m_program->insert(m_program->end(), encoded_hash.begin(), encoded_hash.end());
       return APX_NO_ERROR;
    }
 
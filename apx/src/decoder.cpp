@@ -1,5 +1,6 @@
 #include "cpp-apx/decoder.h"
 #include "bstr/bstr.hpp"
+#include "dtl/dtl.hpp"
 
 namespace apx
 {
@@ -15,12 +16,18 @@ namespace apx
          }
          m_program_begin = m_program_next = begin;
          m_program_end = end;
+         m_minor_version = MINOR_VERSION;
          return APX_NO_ERROR;
       }
 
       apx::error_t Decoder::parse_program_header(ProgramHeader& header)
       {
-         return apx::vm::decode_program_header(m_program_begin, m_program_end, m_program_next, header);
+         apx::error_t const result = apx::vm::decode_program_header(m_program_begin, m_program_end, m_program_next, header);
+         if (result == APX_NO_ERROR)
+         {
+            m_minor_version = header.minor_version;
+         }
+         return result;
       }
 
       apx::error_t Decoder::parse_next_operation(OperationType& operation_type)
@@ -90,7 +97,15 @@ namespace apx
          case OPCODE_DATA_CTRL:
             if (variant == VARIANT_RECORD_SELECT)
             {
-               return decode_record_select(flag);
+               return decode_record_select(flag, false);
+            }
+            else if (variant == VARIANT_RECORD_SELECT_HASHED)
+            {
+               if (m_minor_version < RECORD_SELECT_HASHED_MINOR_VERSION)
+               {
+                  return APX_INVALID_INSTRUCTION_ERROR;
+               }
+               return decode_record_select(flag, true);
             }
             else if (variant <= VARIANT_LIMIT_CHECK_LAST)
             {
@@ -319,14 +334,27 @@ namespace apx
          }
          return APX_UNEXPECTED_END_ERROR;
       }
-      apx::error_t Decoder::decode_record_select(bool is_last_field)
+      apx::error_t Decoder::decode_record_select(bool is_last_field, bool has_hash)
       {
          m_operation_type = OperationType::RecordSelect;
          std::uint8_t const* result = bstr::while_predicate(m_program_next, m_program_end, not_zero_predicate);
          if ((result > m_program_next) && (m_program_next <= m_program_end))
          {
-            m_field_name.assign(m_program_next, result);
+            m_field_name = std::string_view{ reinterpret_cast<char const*>(m_program_next), static_cast<std::size_t>(result - m_program_next) };
             m_program_next = result + UINT8_SIZE; //Skip past null-terminator
+            if (has_hash)
+            {
+               result = parse_uint32_by_variant(m_program_next, m_program_end, VARIANT_U32, m_field_hash);
+               if (result == nullptr)
+               {
+                  return APX_INVALID_INSTRUCTION_ERROR;
+               }
+               m_program_next = result;
+            }
+            else
+            {
+               m_field_hash = dtl::key_hash(m_field_name);
+            }
             m_is_last_field = is_last_field;
             return APX_NO_ERROR;
          }
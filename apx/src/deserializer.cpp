@@ -1,13 +1,20 @@
 #include <cassert>
+#include <cstring>
 #include <typeinfo>
 #include "cpp-apx/deserializer.h"
 #include "cpp-apx/pack.h"
 #include "cpp-apx/program.h"
+#include "cpp-apx/typed_array.h"
 
 namespace apx
 {
    namespace vm
    {
+      template <typename T> static dtl::TypedArrayValue make_typed_array(std::pmr::memory_resource* resource)
+      {
+         return (resource != nullptr) ? dtl::make_ta<T>(0u, resource) : dtl::make_ta<T>();
+      }
+
       void Deserializer::State::clear()
       {
          switch (value_type)
@@ -23,9 +30,12 @@ namespace apx
          case dtl::ValueType::Hash:
             hv.reset();
             break;
+         case dtl::ValueType::TypedArray:
+            ta.reset();
+            break;
          }
          value_type = dtl::ValueType::NoneType;
-         field_name.clear();
+         field_key = dtl::HashedKey{};
          index = 0u;
          array_len = 0u;
          max_array_len = 0u;
@@ -39,19 +49,86 @@ namespace apx
 
       void Deserializer::State::init_scalar_value()
       {
-         sv = dtl::make_sv();
+         if ((reuse != nullptr) && (reuse->dv_type() == dtl::ValueType::Scalar))
+         {
+            sv = dtl::sv_cast(reuse);
+         }
+         else
+         {
+            sv = (resource != nullptr) ? dtl::make_sv(resource) : dtl::make_sv();
+         }
          value_type = dtl::ValueType::Scalar;
       }
 
       void Deserializer::State::init_array_value()
       {
-         av = dtl::make_av();
+         if ((reuse != nullptr) && (reuse->dv_type() == dtl::ValueType::Array))
+         {
+            av = dtl::av_cast(reuse);
+         }
+         else
+         {
+            av = (resource != nullptr) ? dtl::make_av(0u, resource) : dtl::make_av();
+         }
          value_type = dtl::ValueType::Array;
       }
 
+      void Deserializer::State::init_typed_array_value()
+      {
+         value_type = dtl::ValueType::TypedArray;
+         if ((reuse != nullptr) && (reuse->dv_type() == dtl::ValueType::TypedArray))
+         {
+            auto reuse_ta = dtl::ta_cast(reuse);
+            if (reuse_ta->element_type() == element_type_from_type_code(type_code))
+            {
+               ta = reuse_ta;
+               return;
+            }
+         }
+         switch (type_code)
+         {
+         case TypeCode::UInt8:
+            ta = make_typed_array<std::uint8_t>(resource);
+            break;
+         case TypeCode::UInt16:
+            ta = make_typed_array<std::uint16_t>(resource);
+            break;
+         case TypeCode::UInt32:
+            ta = make_typed_array<std::uint32_t>(resource);
+            break;
+         case TypeCode::UInt64:
+            ta = make_typed_array<std::uint64_t>(resource);
+            break;
+         case TypeCode::Int8:
+            ta = make_typed_array<std::int8_t>(resource);
+            break;
+         case TypeCode::Int16:
+            ta = make_typed_array<std::int16_t>(resource);
+            break;
+         case TypeCode::Int32:
+            ta = make_typed_array<std::int32_t>(resource);
+            break;
+         case TypeCode::Int64:
+            ta = make_typed_array<std::int64_t>(resource);
+            break;
+         case TypeCode::Bool:
+            ta = make_typed_array<bool>(resource);
+            break;
+         default:
+            ta.reset();
+         }
+      }
+
       void Deserializer::State::init_hash_value()
       {
-         hv = dtl::make_hv();
+         if ((reuse != nullptr) && (reuse->dv_type() == dtl::ValueType::Hash))
+         {
+            hv = dtl::hv_cast(reuse);
+         }
+         else
+         {
+            hv = (resource != nullptr) ? dtl::make_hv(resource) : dtl::make_hv();
+         }
          value_type = dtl::ValueType::Hash;
       }
 
@@ -87,7 +164,7 @@ namespace apx
       apx::error_t Deserializer::State::create_child_value_from_state(State* child_state)
       {
          assert(value_type == dtl::ValueType::Hash);
-         if (field_name.empty())
+         if (field_key.key.empty())
          {
             return APX_NAME_MISSING_ERROR;
          }
@@ -96,38 +173,70 @@ namespace apx
          case dtl::ValueType::NoneType:
             return APX_VALUE_TYPE_ERROR;
          case dtl::ValueType::Scalar:
-            hv->set(field_name, dtl::dv_cast(child_state->sv));
+            hv->set(field_key, dtl::dv_cast(child_state->sv), index);
             break;
          case dtl::ValueType::Array:
-            hv->set(field_name, dtl::dv_cast(child_state->av));
+            hv->set(field_key, dtl::dv_cast(child_state->av), index);
             break;
          case dtl::ValueType::Hash:
-            hv->set(field_name, dtl::dv_cast(child_state->hv));
+            hv->set(field_key, dtl::dv_cast(child_state->hv), index);
+            break;
+         case dtl::ValueType::TypedArray:
+            hv->set(field_key, dtl::dv_cast(child_state->ta), index);
             break;
          }
+         index++; //Fields arrive in program order, the next one is expected at the following position
          return APX_NO_ERROR;
       }
 
       apx::error_t Deserializer::State::push_value_from_state(State* child_state)
       {
          assert(value_type == dtl::ValueType::Array);
+         dtl::DynamicValue dv;
          switch (child_state->value_type)
          {
          case dtl::ValueType::NoneType:
             return APX_VALUE_TYPE_ERROR;
          case dtl::ValueType::Scalar:
-            av->push(dtl::dv_cast(child_state->sv));
+            dv = dtl::dv_cast(child_state->sv);
             break;
          case dtl::ValueType::Array:
-            av->push(dtl::dv_cast(child_state->av));
+            dv = dtl::dv_cast(child_state->av);
             break;
          case dtl::ValueType::Hash:
-            av->push(dtl::dv_cast(child_state->hv));
+            dv = dtl::dv_cast(child_state->hv);
             break;
+         case dtl::ValueType::TypedArray:
+            dv = dtl::dv_cast(child_state->ta);
+            break;
+         }
+         if (index < av->length())
+         {
+            av->set(index, dv);
+         }
+         else
+         {
+            av->push(dv);
          }
          return APX_NO_ERROR;
       }
 
+      /*
+      * Returns the value previously stored at the position of the next child state (or nullptr).
+      */
+      dtl::DynamicValue Deserializer::State::child_reuse_value()
+      {
+         if ((value_type == dtl::ValueType::Hash) && (hv != nullptr))
+         {
+            return hv->get(field_key, index);
+         }
+         else if ((value_type == dtl::ValueType::Array) && (av != nullptr) && (index < av->length()))
+         {
+            return av->at(index);
+         }
+         return nullptr;
+      }
+
       apx::error_t Deserializer::State::read_scalar_value(dtl::Scalar const* sv_arg, TypeCode type_code_arg)
       {
          apx::error_t retval = APX_NO_ERROR;
@@ -200,15 +309,6 @@ namespace apx
          return retval;
       }
 
-      Deserializer::~Deserializer()
-      {
-         reset_state();
-         if (m_state != nullptr)
-         {
-            delete m_state;
-         }
-      }
-
       dtl::ScalarValue Deserializer::take_sv()
       {
          assert(m_state != nullptr);
@@ -245,6 +345,37 @@ namespace apx
          return tmp;
       }
 
+      dtl::TypedArrayValue Deserializer::take_ta()
+      {
+         assert(m_state != nullptr);
+         if (m_state->value_type != dtl::ValueType::TypedArray)
+         {
+            throw std::bad_typeid();
+         }
+         dtl::TypedArrayValue tmp;
+         tmp.swap(m_state->ta);
+         return tmp;
+      }
+
+      dtl::DynamicValue Deserializer::take_dv()
+      {
+         assert(m_state != nullptr);
+         switch (m_state->value_type)
+         {
+         case dtl::ValueType::Scalar:
+            return dtl::dv_cast(take_sv());
+         case dtl::ValueType::Array:
+            return dtl::dv_cast(take_av());
+         case dtl::ValueType::Hash:
+            return dtl::dv_cast(take_hv());
+         case dtl::ValueType::TypedArray:
+            return dtl::dv_cast(take_ta());
+         default:
+            break;
+         }
+         return nullptr;
+      }
+
       void Deserializer::clear_value()
       {
          assert(m_state != nullptr);
@@ -261,6 +392,9 @@ namespace apx
          case dtl::ValueType::Hash:
             m_state->hv.reset();
             break;
+         case dtl::ValueType::TypedArray:
+            m_state->ta.reset();
+            break;
          }
          m_state->value_type = dtl::ValueType::NoneType;
       }
@@ -397,6 +531,54 @@ namespace apx
          return unpack_value(array_len, dynamic_size_type);
       }
 
+      /*
+      * Returns the bytes of a byte array or character string without creating a value.
+      * data points into the read buffer. Strings of fixed length end at the first null character.
+      */
+      apx::error_t Deserializer::view_array_data(TypeCode type_code, std::size_t array_len, apx::SizeType dynamic_size_type, std::uint8_t const*& data, std::size_t& size)
+      {
+         if ((type_code != TypeCode::Byte) && (type_code != TypeCode::Char) && (type_code != TypeCode::Char8))
+         {
+            return APX_VALUE_TYPE_ERROR;
+         }
+         auto result = prepare_for_buffer_read();
+         if (result != APX_NO_ERROR)
+         {
+            return result;
+         }
+         m_state->type_code = type_code;
+         m_state->element_size = UINT8_SIZE;
+         if (array_len > 0u)
+         {
+            result = prepare_for_array(array_len, dynamic_size_type);
+            if (result != APX_NO_ERROR)
+            {
+               return result;
+            }
+         }
+         else
+         {
+            m_state->array_len = 1u;
+         }
+         std::size_t const data_size = m_state->array_len;
+         if (m_buffer.next + data_size > m_buffer.end)
+         {
+            return APX_BUFFER_BOUNDARY_ERROR;
+         }
+         data = m_buffer.next;
+         size = data_size;
+         if ((type_code != TypeCode::Byte) && (m_state->dynamic_size_type == apx::SizeType::None))
+         {
+            auto const* terminator = static_cast<std::uint8_t const*>(std::memchr(data, '\0', data_size));
+            if (terminator != nullptr)
+            {
+               size = static_cast<std::size_t>(terminator - data);
+            }
+         }
+         m_buffer.next += data_size;
+         return APX_NO_ERROR;
+      }
+
       apx::error_t Deserializer::unpack_record(std::size_t array_len, apx::SizeType dynamic_size_type)
       {
          auto result = prepare_for_buffer_read();
@@ -414,6 +596,10 @@ namespace apx
                return result;
             }
             m_state->init_array_value();
+            if (m_state->av->length() > m_state->array_len)
+            {
+               m_state->av->resize(m_state->array_len);
+            }
             if (m_state->array_len > 0u)
             {
                enter_new_child_state();
@@ -452,6 +638,18 @@ namespace apx
                m_state->range_check_state = RangeCheckState::CheckFail;
             }
          }
+         else if (m_state->value_type == dtl::ValueType::TypedArray)
+         {
+            if (typed_array_in_range(m_state->ta.get(), lower_limit, upper_limit))
+            {
+               m_state->range_check_state = RangeCheckState::CheckOK;
+            }
+            else
+            {
+               m_state->range_check_state = RangeCheckState::CheckFail;
+               retval = APX_VALUE_RANGE_ERROR;
+            }
+         }
          else if (m_state->value_type == dtl::ValueType::Array)
          {
             std::size_t length = m_state->av->length();
@@ -507,6 +705,18 @@ namespace apx
                m_state->range_check_state = RangeCheckState::CheckFail;
             }
          }
+         else if (m_state->value_type == dtl::ValueType::TypedArray)
+         {
+            if (typed_array_in_range(m_state->ta.get(), lower_limit, upper_limit))
+            {
+               m_state->range_check_state = RangeCheckState::CheckOK;
+            }
+            else
+            {
+               m_state->range_check_state = RangeCheckState::CheckFail;
+               retval = APX_VALUE_RANGE_ERROR;
+            }
+         }
          else if (m_state->value_type == dtl::ValueType::Array)
          {
             std::size_t length = m_state->av->length();
@@ -563,6 +773,18 @@ namespace apx
                m_state->range_check_state = RangeCheckState::CheckFail;
             }
          }
+         else if (m_state->value_type == dtl::ValueType::TypedArray)
+         {
+            if (typed_array_in_range(m_state->ta.get(), lower_limit, upper_limit))
+            {
+               m_state->range_check_state = RangeCheckState::CheckOK;
+            }
+            else
+            {
+               m_state->range_check_state = RangeCheckState::CheckFail;
+               retval = APX_VALUE_RANGE_ERROR;
+            }
+         }
          else if (m_state->value_type == dtl::ValueType::Array)
          {
             std::size_t length = m_state->av->length();
@@ -619,6 +841,18 @@ namespace apx
                m_state->range_check_state = RangeCheckState::CheckFail;
             }
          }
+         else if (m_state->value_type == dtl::ValueType::TypedArray)
+         {
+            if (typed_array_in_range(m_state->ta.get(), lower_limit, upper_limit))
+            {
+               m_state->range_check_state = RangeCheckState::CheckOK;
+            }
+            else
+            {
+               m_state->range_check_state = RangeCheckState::CheckFail;
+               retval = APX_VALUE_RANGE_ERROR;
+            }
+         }
          else if (m_state->value_type == dtl::ValueType::Array)
          {
             std::size_t length = m_state->av->length();
@@ -650,13 +884,13 @@ namespace apx
          return retval;
       }
 
-      apx::error_t Deserializer::record_select(const char* key, bool is_last_field)
+      apx::error_t Deserializer::record_select(dtl::HashedKey const& key, bool is_last_field)
       {
-         if (key != nullptr)
+         if (!key.key.empty())
          {
             if (m_state->value_type == dtl::ValueType::Hash)
             {
-               m_state->set_field_name(key, is_last_field);
+               m_state->set_field_key(key, is_last_field);
                enter_new_child_state();
                return APX_NO_ERROR;
             }
@@ -704,14 +938,13 @@ namespace apx
 
       void Deserializer::reset_state()
       {
-         while (m_stack.size() > 0)
+         while (m_depth > 0u)
          {
-            delete m_state;
-            m_state = m_stack.top();
-            assert(m_state != nullptr);
-            m_stack.pop();
+            release_state(m_state);
+            m_state = &m_states[--m_depth];
          }
          clear_state();
+         m_state->reuse.reset();
       }
 
       void Deserializer::clear_state()
@@ -731,6 +964,26 @@ namespace apx
          return APX_INVALID_ARGUMENT_ERROR;
       }
 
+      /*
+      * Makes the next unpacked value update value (and its children) in place wherever the types match.
+      * Call after set_read_buffer.
+      */
+      void Deserializer::set_reuse_value(dtl::DynamicValue value)
+      {
+         assert(m_state != nullptr);
+         m_state->reuse = value;
+      }
+
+      /*
+      * Allocates all values created by following unpack operations from resource (nullptr selects the global heap).
+      * Values allocated from resource must be released before the resource is reset.
+      */
+      void Deserializer::set_memory_resource(std::pmr::memory_resource* resource)
+      {
+         assert(m_state != nullptr);
+         m_state->resource = resource;
+      }
+
       void Deserializer::reset_buffer(std::uint8_t const* buf, std::size_t len)
       {
          m_buffer.begin = buf;
@@ -797,7 +1050,7 @@ namespace apx
             }
             else
             {
-               m_state->init_array_value();
+               m_state->init_typed_array_value();
                result = unpack_array_of_scalar();
             }
          }
@@ -823,7 +1076,6 @@ namespace apx
             std::uint64_t u64;
             char char_value;
             bool bool_value;
-            dtl::ByteArray byte_array;
             switch (m_state->type_code)
             {
             case apx::TypeCode::UInt8:
@@ -867,9 +1119,7 @@ namespace apx
                sv->set(bool_value);
                break;
             case apx::TypeCode::Byte:
-               byte_array.resize(m_state->element_size);
-               byte_array[0] = *m_buffer.next;
-               sv->set(byte_array);
+               sv->set(m_buffer.next, m_buffer.next + m_state->element_size);
                break;
             default:
                return APX_UNSUPPORTED_ERROR;
@@ -885,49 +1135,72 @@ namespace apx
 
       apx::error_t Deserializer::unpack_array_of_scalar()
       {
-         if (m_state->value_type != dtl::ValueType::Array)
+         if ( (m_state->value_type != dtl::ValueType::TypedArray) || (m_state->ta == nullptr) )
          {
             return APX_VALUE_TYPE_ERROR;
          }
-         for (std::size_t i = 0; i < m_state->array_len; i++)
+         std::size_t const data_size = m_state->array_len * m_state->element_size;
+         if ((m_buffer.next + data_size) > m_buffer.end)
          {
-            auto sv = dtl::make_sv();
-            auto result = unpack_scalar_value(sv.get());
-            if (result != APX_NO_ERROR)
-            {
-               return result;
-            }
-            m_state->av->push(dtl::dv_cast(sv));
+            return APX_BUFFER_BOUNDARY_ERROR;
          }
+         auto* ta = m_state->ta.get();
+         switch (m_state->type_code)
+         {
+         case apx::TypeCode::UInt8:
+            unpack_typed_elements(static_cast<dtl::TypedArray<std::uint8_t>&>(*ta), m_buffer.next, m_state->array_len);
+            break;
+         case apx::TypeCode::UInt16:
+            unpack_typed_elements(static_cast<dtl::TypedArray<std::uint16_t>&>(*ta), m_buffer.next, m_state->array_len);
+            break;
+         case apx::TypeCode::UInt32:
+            unpack_typed_elements(static_cast<dtl::TypedArray<std::uint32_t>&>(*ta), m_buffer.next, m_state->array_len);
+            break;
+         case apx::TypeCode::UInt64:
+            unpack_typed_elements(static_cast<dtl::TypedArray<std::uint64_t>&>(*ta), m_buffer.next, m_state->array_len);
+            break;
+         case apx::TypeCode::Int8:
+            unpack_typed_elements(static_cast<dtl::TypedArray<std::int8_t>&>(*ta), m_buffer.next, m_state->array_len);
+            break;
+         case apx::TypeCode::Int16:
+            unpack_typed_elements(static_cast<dtl::TypedArray<std::int16_t>&>(*ta), m_buffer.next, m_state->array_len);
+            break;
+         case apx::TypeCode::Int32:
+            unpack_typed_elements(static_cast<dtl::TypedArray<std::int32_t>&>(*ta), m_buffer.next, m_state->array_len);
+            break;
+         case apx::TypeCode::Int64:
+            unpack_typed_elements(static_cast<dtl::TypedArray<std::int64_t>&>(*ta), m_buffer.next, m_state->array_len);
+            break;
+         case apx::TypeCode::Bool:
+            unpack_typed_elements(static_cast<dtl::TypedArray<bool>&>(*ta), m_buffer.next, m_state->array_len);
+            break;
+         default:
+            return APX_UNSUPPORTED_ERROR;
+         }
+         m_buffer.next += data_size;
          return APX_NO_ERROR;
       }
 
       apx::error_t Deserializer::unpack_char_string(dtl::Scalar* sv)
       {
          bool is_dynamic = (m_state->dynamic_size_type != apx::SizeType::None);
-         std::string s;
-         std::uint8_t const* adjusted_next = m_buffer.next + CHAR_SIZE * m_state->array_len;
-         for (std::size_t i = 0u; i < m_state->array_len; i++)
+         std::size_t const data_size = CHAR_SIZE * m_state->array_len;
+         if (m_buffer.next + data_size > m_buffer.end)
          {
-            if (m_buffer.next + CHAR_SIZE <= m_buffer.end)
-            {
-               char c = static_cast<char>(*m_buffer.next++);
-               if (!is_dynamic && c == '\0')
-               {
-                  m_buffer.next = adjusted_next;
-                  break;
-               }
-               else
-               {
-                  s.push_back(c);
-               }
-            }
-            else
+            return APX_BUFFER_BOUNDARY_ERROR;
+         }
+         auto const* begin = reinterpret_cast<char const*>(m_buffer.next);
+         auto const* end = begin + data_size;
+         if (!is_dynamic)
+         {
+            auto const* terminator = static_cast<char const*>(std::memchr(begin, '\0', data_size));
+            if (terminator != nullptr)
             {
-               return APX_BUFFER_BOUNDARY_ERROR;
+               end = terminator;
             }
          }
-         sv->set(s);
+         sv->set(begin, end);
+         m_buffer.next += data_size;
          return APX_NO_ERROR;
       }
 
@@ -935,14 +1208,8 @@ namespace apx
       {
          if (m_buffer.next + m_state->array_len <= m_buffer.end)
          {
-            dtl::ByteArray array;
-            if (m_state->array_len > 0u)
-            {
-               array.resize(m_state->array_len);
-               std::memcpy(array.data(), m_buffer.next, m_state->array_len);
-               m_buffer.next += m_state->array_len;
-            }
-            sv->set(array);
+            sv->set(m_buffer.next, m_buffer.next + m_state->array_len);
+            m_buffer.next += m_state->array_len;
          }
          else
          {
@@ -1035,36 +1302,59 @@ namespace apx
 
       void Deserializer::enter_new_child_state()
       {
-         auto child_state = new Deserializer::State();
-         child_state->parent = m_state;
-         m_stack.push(m_state);
-         m_state = child_state;
+         if (++m_depth == m_states.size())
+         {
+            m_states.resize(m_depth + 1u); //Only needed when the program header did not reserve enough states
+         }
+         State* parent_state = &m_states[m_depth - 1u];
+         m_state = &m_states[m_depth];
+         m_state->reuse = parent_state->child_reuse_value();
+         m_state->resource = parent_state->resource;
+      }
+
+      /*
+      * Preallocates states for nesting_depth nested records (see ProgramHeader::nesting_depth).
+      */
+      void Deserializer::reserve_nesting_depth(std::size_t nesting_depth)
+      {
+         if (m_states.size() <= nesting_depth)
+         {
+            m_states.resize(nesting_depth + 1u);
+            m_state = &m_states[m_depth];
+         }
+      }
+
+      void Deserializer::release_state(State* state)
+      {
+         assert(state != nullptr);
+         state->clear();
+         state->reuse.reset();
+         state->resource = nullptr;
       }
 
       apx::error_t Deserializer::pop_state()
       {
          assert(m_state != nullptr);
-         while (m_stack.size() > 0)
+         while (m_depth > 0u)
          {
-            std::unique_ptr<Deserializer::State> child_state{ m_state };
-            m_state = m_stack.top();
-            assert(m_state != nullptr);
-            m_stack.pop();
+            State* child_state = m_state;
+            m_state = &m_states[--m_depth];
             if (m_state->type_code == apx::TypeCode::Record)
             {
                apx::error_t result = APX_NO_ERROR;
                if (m_state->value_type == dtl::ValueType::Hash)
                {
-                  result = m_state->create_child_value_from_state(child_state.get());
+                  result = m_state->create_child_value_from_state(child_state);
                }
                else if (m_state->value_type == dtl::ValueType::Array)
                {
-                  result = m_state->push_value_from_state(child_state.get());
+                  result = m_state->push_value_from_state(child_state);
                }
                else
                {
                   result = APX_NOT_IMPLEMENTED_ERROR;
                }
+               release_state(child_state);
                if (result != APX_NO_ERROR)
                {
                   return result;
@@ -1072,6 +1362,7 @@ namespace apx
             }
             else
             {
+               release_state(child_state);
                return APX_NOT_IMPLEMENTED_ERROR;
             }
             if (!m_state->is_last_field)
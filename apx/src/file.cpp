@@ -21,6 +21,7 @@
 * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 *
 ******************************************************************************/
+#include <algorithm>
 #include "cpp-apx/file.h"
 
 namespace apx
@@ -77,6 +78,32 @@ namespace apx
          //m_apx_file_type is already set to Unknown in declaration
       }
    }
+   File::File(File const& other) :
+      m_is_file_open{ other.m_is_file_open.load() },
+      m_has_first_write{ other.m_has_first_write },
+      m_apx_file_type{ other.m_apx_file_type },
+      m_file_info{ other.m_file_info },
+      m_file_manager{ other.m_file_manager },
+      m_notification_handler{ other.m_notification_handler },
+      m_dirty_ranges{ other.m_dirty_ranges }
+   {
+   }
+
+   File& File::operator=(File const& other)
+   {
+      if (this != &other)
+      {
+         m_is_file_open.store(other.m_is_file_open.load());
+         m_has_first_write = other.m_has_first_write;
+         m_apx_file_type = other.m_apx_file_type;
+         m_file_info = other.m_file_info;
+         m_file_manager = other.m_file_manager;
+         m_notification_handler = other.m_notification_handler;
+         m_dirty_ranges = other.m_dirty_ranges;
+      }
+      return *this;
+   }
+
    bool File::less_than(File const& a, File const& b)
    {
       return a.get_address_without_flags() < b.get_address_without_flags();
@@ -102,6 +129,53 @@ namespace apx
       }
    }
 
+   error_t File::resume_notify(std::vector<ByteRange> const& dirty_ranges)
+   {
+      if (m_notification_handler != nullptr)
+      {
+         return m_notification_handler->file_resume_notify(this, dirty_ranges);
+      }
+      return APX_NO_ERROR;
+   }
+
+   void File::mark_dirty(std::uint32_t offset, std::uint32_t size)
+   {
+      if ( (size == 0u) || (offset >= m_file_info.size) )
+      {
+         return;
+      }
+      std::uint32_t begin = offset;
+      std::uint32_t end = std::min(offset + size, m_file_info.size);
+      auto it = m_dirty_ranges.begin();
+      while ( (it != m_dirty_ranges.end()) && (it->offset + it->size < begin) )
+      {
+         it++;
+      }
+      //Merge all ranges that overlap or touch [begin, end)
+      auto first_merged = it;
+      while ( (it != m_dirty_ranges.end()) && (it->offset <= end) )
+      {
+         begin = std::min(begin, it->offset);
+         end = std::max(end, it->offset + it->size);
+         it++;
+      }
+      it = m_dirty_ranges.erase(first_merged, it);
+      m_dirty_ranges.insert(it, ByteRange{ begin, end - begin });
+      if (m_dirty_ranges.size() > FILE_DIRTY_RANGES_MAX)
+      {
+         begin = m_dirty_ranges.front().offset;
+         end = m_dirty_ranges.back().offset + m_dirty_ranges.back().size;
+         m_dirty_ranges.clear();
+         m_dirty_ranges.push_back(ByteRange{ begin, end - begin });
+      }
+   }
+
+   void File::take_dirty_ranges(std::vector<ByteRange>& dest)
+   {
+      dest.clear();
+      std::swap(dest, m_dirty_ranges);
+   }
+
    error_t File::write_notify(std::uint32_t offset, std::uint8_t const* data, std::size_t size)
    {
       if (m_notification_handler != nullptr)
@@ -22,9 +22,11 @@
 *
 ******************************************************************************/
 
+#include <algorithm>
 #include <cassert>
 #include "cpp-apx/pack.h"
 #include "cpp-apx/file_manager.h"
+#include "cpp-apx/trace.h"
 
 namespace apx
 {
@@ -42,11 +44,15 @@ namespace apx
    }
    void FileManager::connected()
    {
+      m_shared.connected();
       publish_local_files();
    }
    void FileManager::disconnected()
    {
-      //TODO: close_local_files();
+      m_shared.disconnected();
+      m_receiver.reset();
+      m_is_reassembling = false;
+      m_worker.discard_pending_commands();
    }
 
    File* FileManager::create_local_file(rmf::FileInfo const& file_info)
@@ -59,6 +65,23 @@ namespace apx
       return file;
    }
 
+   /*
+   * Publishes a local file that was created after the connection was established.
+   * Files that exist when the connection is established are published automatically.
+   */
+   error_t FileManager::publish_local_file(File* file)
+   {
+      if (file == nullptr)
+      {
+         return APX_NULL_PTR_ERROR;
+      }
+      if (m_shared.is_connected())
+      {
+         m_worker.prepare_publish_local_file(file->clone_file_info());
+      }
+      return APX_NO_ERROR;
+   }
+
    error_t FileManager::message_received(std::uint8_t const* msg_data, std::size_t msg_len)
    {
       std::uint32_t address{ rmf::INVALID_ADDRESS };
@@ -67,13 +90,25 @@ namespace apx
       if (header_size > 0)
       {
          assert(msg_len >= header_size);
+         if (more_bit)
+         {
+            m_metrics.fragments_received.add();
+            m_is_reassembling = true;
+         }
          auto const result = m_receiver.write(address, msg_data + header_size, msg_len - header_size, more_bit);
          if (result.error != APX_NO_ERROR)
          {
+            m_metrics.reception_errors.add();
+            m_is_reassembling = false;
             return result.error;
          }
          else if (result.is_complete)
          {
+            if (m_is_reassembling)
+            {
+               m_metrics.reassembled_messages.add();
+               m_is_reassembling = false;
+            }
             return process_message(result.address, result.data, result.size);
          }
          else
@@ -83,6 +118,7 @@ namespace apx
       }
       else
       {
+         m_metrics.reception_errors.add();
          return APX_INVALID_MSG_ERROR;
       }
       return APX_NO_ERROR;
@@ -118,6 +154,45 @@ namespace apx
       return APX_NO_ERROR;
    }
 
+   error_t FileManager::send_local_data_copy(std::uint32_t address, std::uint8_t const* data, std::size_t size, CoalesceSlot* slot)
+   {
+      auto* file = m_shared.find_file_by_address(address);
+      if (file == nullptr)
+      {
+         return APX_FILE_NOT_FOUND_ERROR;
+      }
+      if (!file->is_open())
+      {
+         return APX_FILE_NOT_OPEN_ERROR;
+      }
+      return m_worker.prepare_send_local_data_copy(address, data, static_cast<std::uint32_t>(size), slot);
+   }
+
+   error_t FileManager::send_local_shared_data(std::uint32_t address, SharedBuffer* buffer, std::uint8_t const* data, std::size_t size)
+   {
+      auto* file = m_shared.find_file_by_address(address);
+      if (file == nullptr)
+      {
+         return APX_FILE_NOT_FOUND_ERROR;
+      }
+      if (!file->is_open())
+      {
+         return APX_FILE_NOT_OPEN_ERROR;
+      }
+      return m_worker.prepare_send_local_shared_data(address, buffer, data, static_cast<std::uint32_t>(size));
+   }
+
+   error_t FileManager::send_resume_file_request(std::uint32_t address)
+   {
+      m_worker.prepare_send_resume_file_request(address);
+      return APX_NO_ERROR;
+   }
+
+   void FileManager::mark_local_data_dirty(std::uint32_t address, std::size_t size)
+   {
+      m_shared.mark_local_data_dirty(address, static_cast<std::uint32_t>(size));
+   }
+
    error_t FileManager::send_open_file_request(std::uint32_t address)
    {
       m_worker.prepare_send_open_file_request(address);
@@ -143,6 +218,7 @@ namespace apx
 
    error_t FileManager::process_message(std::uint32_t address, std::uint8_t const* data, std::size_t size)
    {
+      APX_TRACE_SCOPE_ARG("FileManager::process_message", size);
       if (address == rmf::CMD_AREA_START_ADDRESS)
       {
          return process_command_message(data, size);
@@ -192,6 +268,17 @@ namespace apx
             retval = APX_INVALID_MSG_ERROR;
          }
          break;
+      case rmf::CMD_RESUME_FILE_MSG:
+         if (cmd_size == rmf::FILE_RESUME_CMD_SIZE)
+         {
+            std::uint32_t const address = apx::unpackLE<std::uint32_t>(next);
+            retval = process_resume_file_request(address);
+         }
+         else
+         {
+            retval = APX_INVALID_MSG_ERROR;
+         }
+         break;
       case rmf::CMD_CLOSE_FILE_MSG:
          if (cmd_size == rmf::FILE_CLOSE_CMD_SIZE)
          {
@@ -238,11 +325,29 @@ namespace apx
       {
          return APX_FILE_NOT_FOUND_ERROR;
       }
+      std::vector<ByteRange> dirty_ranges;
+      m_shared.take_dirty_ranges(file, dirty_ranges); //Not needed since the entire file content is sent
       file->open();
       file->open_notify();
       return APX_NO_ERROR;
    }
 
+   /*
+   * The remote side still has the content from our previous connection. Only send what changed since then.
+   */
+   error_t FileManager::process_resume_file_request(std::uint32_t start_address)
+   {
+      auto* file = m_shared.find_file_by_address(start_address);
+      if (file == nullptr)
+      {
+         return APX_FILE_NOT_FOUND_ERROR;
+      }
+      std::vector<ByteRange> dirty_ranges;
+      m_shared.take_dirty_ranges(file, dirty_ranges);
+      file->open();
+      return file->resume_notify(dirty_ranges);
+   }
+
    error_t FileManager::process_close_file_request(std::uint32_t start_address)
    {
       (void)start_address;
@@ -256,6 +361,8 @@ namespace apx
       {
          return APX_FILE_CREATE_ERROR;
       }
+      //A write to the file can be as large as the file itself. The receive buffer grows when such a write arrives.
+      m_receiver.set_max_buffer_size(std::max(m_receiver.max_buffer_size(), static_cast<std::size_t>(file_info.size)));
       return m_shared.connection()->remote_file_published_notification(file);
    }
 }
\ No newline at end of file
@@ -22,6 +22,7 @@
 *
 ******************************************************************************/
 #include <cstring>
+#include <algorithm>
 #include <cassert>
 #include "cpp-apx/file_manager_receiver.h"
 
@@ -45,6 +46,15 @@ namespace apx
       {
          m_receive_buffer.resize(size);
       }
+      m_max_buffer_size = std::max(m_max_buffer_size, m_receive_buffer.size());
+   }
+
+   /*
+   * Allows the buffer to grow up to size bytes. Memory is only allocated once a write needs it.
+   */
+   void FileManagerReceiver::set_max_buffer_size(std::size_t size)
+   {
+      m_max_buffer_size = std::max(std::min(size, MAX_FILE_SIZE), m_receive_buffer.size());
    }
 
    FileManagerReceptionResult FileManagerReceiver::write(std::uint32_t address, std::uint8_t const* data, std::size_t size, bool more_bit)
@@ -81,7 +91,7 @@ namespace apx
       {
          result.error = APX_MISSING_BUFFER_ERROR;
       }
-      else if (size > m_receive_buffer.size())
+      else if (!grow_buffer(size))
       {
          result.error = APX_BUFFER_FULL_ERROR;
       }
@@ -109,7 +119,7 @@ namespace apx
       {
          result.error = APX_MISSING_BUFFER_ERROR;
       }
-      else if ((m_buf_pos + size) > m_receive_buffer.size())
+      else if (!grow_buffer(m_buf_pos + size))
       {
          result.error = APX_BUFFER_FULL_ERROR;
       }
@@ -123,6 +133,24 @@ namespace apx
          process_more_bit(result, more_bit);
       }
    }
+   /*
+   * Doubles the buffer size until required_size fits, without going above m_max_buffer_size.
+   */
+   bool FileManagerReceiver::grow_buffer(std::size_t required_size)
+   {
+      if (required_size <= m_receive_buffer.size())
+      {
+         return true;
+      }
+      if (required_size > m_max_buffer_size)
+      {
+         return false;
+      }
+      std::size_t const new_size = std::min(std::max(required_size, m_receive_buffer.size() * 2u), m_max_buffer_size);
+      m_receive_buffer.resize(new_size);
+      return true;
+   }
+
    void FileManagerReceiver::process_more_bit(FileManagerReceptionResult& result, bool more_bit)
    {
       if (more_bit)
@@ -25,10 +25,19 @@
 
 namespace apx
 {
-    File* FileManagerShared::create_local_file(rmf::FileInfo const& file_info)
+   /*
+   * The entire content of a new local file is dirty since no remote side has received it yet.
+   * This makes a resume request for a file we never sent behave like a regular open request.
+   */
+   File* FileManagerShared::create_local_file(rmf::FileInfo const& file_info)
    {
       std::lock_guard lock(m_mutex);
-      return m_local_file_map.create_file(file_info);
+      auto* file = m_local_file_map.create_file(file_info);
+      if (file != nullptr)
+      {
+         file->mark_dirty(0u, file->get_file_info().size);
+      }
+      return file;
    }
 
    File* FileManagerShared::create_remote_file(rmf::FileInfo const& file_info)
@@ -73,10 +82,19 @@ namespace apx
       m_is_connected = true;
    }
 
+   /*
+   * Local files are closed but kept (including their addresses and digests) so they can be resumed on next connect.
+   * Remote files are forgotten since the remote side publishes them again.
+   */
    void FileManagerShared::disconnected()
    {
       std::lock_guard lock(m_mutex);
       m_is_connected = false;
+      for (auto& file : m_local_file_map.list())
+      {
+         file->close();
+      }
+      m_remote_file_map.clear();
    }
 
    bool FileManagerShared::is_connected()
@@ -85,6 +103,35 @@ namespace apx
       return m_is_connected;
    }
 
+   void FileManagerShared::mark_local_data_dirty(std::uint32_t address, std::uint32_t size)
+   {
+      std::lock_guard lock(m_mutex);
+      auto* file = m_local_file_map.find_by_address(address);
+      if (file != nullptr)
+      {
+         file->mark_dirty(address - file->get_address_without_flags(), size);
+      }
+   }
+
+   void FileManagerShared::take_dirty_ranges(File* file, std::vector<ByteRange>& dest)
+   {
+      std::lock_guard lock(m_mutex);
+      file->take_dirty_ranges(dest);
+   }
+
+   void FileManagerShared::list_dirty_open_local_files(std::vector<File*>& dest)
+   {
+      std::lock_guard lock(m_mutex);
+      dest.clear();
+      for (auto& file : m_local_file_map.list())
+      {
+         if (file->is_open() && file->has_dirty_ranges())
+         {
+            dest.push_back(file);
+         }
+      }
+   }
+
    void FileManagerShared::copy_local_file_info(std::vector<rmf::FileInfo*>& dest)
    {
       std::lock_guard lock(m_mutex);
@@ -21,85 +21,207 @@
 * CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
 *
 ******************************************************************************/
+#include <algorithm>
 #include <array>
+#include <atomic>
+#include <cassert>
+#include <cstring>
 #include <memory>
-#if APX_DEBUG_ENABLE
-#include <iostream>
-#endif
 #include "cpp-apx/file_manager_worker.h"
+#include "cpp-apx/numheader.h"
+#include "cpp-apx/trace.h"
 
 namespace apx
 {
-   void FileManagerWorker::prepare_publish_local_file(rmf::FileInfo* file_info)
+   /*
+   * Generations are unique across all workers in the process.
+   * A CoalesceSlot left behind by a destroyed worker can therefore never match a new worker created at the same address.
+   */
+   static std::atomic<std::uint64_t> queue_generation_counter{ 0u };
+
+   std::uint64_t FileManagerWorker::next_queue_generation()
+   {
+      return queue_generation_counter.fetch_add(1u, std::memory_order_relaxed) + 1u;
+   }
+
+   FileManagerWorker::~FileManagerWorker()
    {
-      std::scoped_lock lock{ m_mutex } ;
-      Command cmd{CmdType::PublishLocalFile, 0u, 0u, reinterpret_cast<void*>(file_info), nullptr };
-#if APX_DEBUG_ENABLE
-      std::cout << "Preparing to publish local files" << std::endl;
-#endif
-      m_queue.push(cmd);
 #ifndef UNIT_TEST
-      m_cond.notify_one();
+      stop();
 #endif
+      while (!m_queue.empty())
+      {
+         dispose_command(m_queue.front());
+         m_queue.pop();
+      }
+   }
+
+   void FileManagerWorker::prepare_publish_local_file(rmf::FileInfo* file_info)
+   {
+      Command cmd{CmdType::PublishLocalFile, 0u, 0u, reinterpret_cast<void*>(file_info), nullptr };
+      push_command(cmd);
    }
 
    void FileManagerWorker::prepare_send_local_const_data(std::uint32_t address, std::uint8_t const* data, std::uint32_t size)
    {
-      std::scoped_lock lock{ m_mutex };
       Command cmd{ CmdType::SendLocalConstData, address, size, reinterpret_cast<void*>(const_cast<std::uint8_t*>(data)), nullptr };
-      m_queue.push(cmd);
-#ifndef UNIT_TEST
-      m_cond.notify_one();
-#endif
+      push_command(cmd);
    }
 
    void FileManagerWorker::prepare_send_local_data(std::uint32_t address, std::uint8_t* data, std::uint32_t size)
    {
-      std::scoped_lock lock{ m_mutex };
       Command cmd{ CmdType::SendLocalData, address, size, reinterpret_cast<void*>(const_cast<std::uint8_t*>(data)), nullptr };
-      m_queue.push(cmd);
+      push_command(cmd);
+   }
+
+   /*
+   * Queues a copy of data for transmission.
+   * Returns APX_QUEUE_FULL_ERROR when the high-water mark would be exceeded. Nothing is queued in that case,
+   * instead the range is marked dirty and its latest value is queued once the queue has drained below the high-water mark.
+   * When slot is given, a previous write still waiting in the queue is overwritten (latest value wins).
+   * Coalesced writes are never rejected since each slot occupies at most one record in the queue.
+   */
+   error_t FileManagerWorker::prepare_send_local_data_copy(std::uint32_t address, std::uint8_t const* data, std::uint32_t size, CoalesceSlot* slot)
+   {
+      {
+         std::scoped_lock lock{ m_mutex };
+         if (try_coalesce(slot, data, size))
+         {
+            m_metrics.coalesced_writes.add();
+            return APX_NO_ERROR;
+         }
+         if ( (slot == nullptr) && is_above_high_water_mark(size) )
+         {
+            reject_write(address, size);
+            return APX_QUEUE_FULL_ERROR;
+         }
+         std::size_t record_offset;
+         if (size <= COMMAND_INLINE_DATA_MAX_SIZE)
+         {
+            record_offset = m_queue.push(make_data_command(CmdType::SendLocalData, address, size, nullptr, nullptr), data, size);
+         }
+         else
+         {
+            auto* copy = new std::uint8_t[size];
+            std::memcpy(copy, data, size);
+            record_offset = m_queue.push(make_data_command(CmdType::SendLocalData, address, size, copy, nullptr));
+         }
+         m_queued_bytes += size;
+         command_queued();
+         if (slot != nullptr)
+         {
+            slot->owner = this;
+            slot->generation = m_queue_generation;
+            slot->record_offset = record_offset;
+         }
+      }
 #ifndef UNIT_TEST
       m_cond.notify_one();
 #endif
+      return APX_NO_ERROR;
    }
 
-   void FileManagerWorker::prepare_send_open_file_request(std::uint32_t address)
+   /*
+   * Queues a range of a shared buffer for transmission. The worker holds its own reference to the buffer
+   * until the data has been transmitted. data must point inside the buffer.
+   * Returns APX_QUEUE_FULL_ERROR when the high-water mark would be exceeded. The range is then handled as in prepare_send_local_data_copy.
+   */
+   error_t FileManagerWorker::prepare_send_local_shared_data(std::uint32_t address, SharedBuffer* buffer, std::uint8_t const* data, std::uint32_t size)
    {
-      std::scoped_lock lock{ m_mutex };
-      Command cmd{ CmdType::OpenRemoteFile, address, 0u, (void*) nullptr, nullptr };
-      m_queue.push(cmd);
+      assert( (data >= buffer->data()) && (data + size <= buffer->data() + buffer->size()) );
+      {
+         std::scoped_lock lock{ m_mutex };
+         if (is_above_high_water_mark(size))
+         {
+            reject_write(address, size);
+            return APX_QUEUE_FULL_ERROR;
+         }
+         buffer->acquire();
+         m_queue.push(make_data_command(CmdType::SendLocalSharedData, address, size, buffer, const_cast<std::uint8_t*>(data)));
+         m_queued_bytes += size;
+         command_queued();
+      }
 #ifndef UNIT_TEST
       m_cond.notify_one();
 #endif
+      return APX_NO_ERROR;
    }
 
-#ifdef UNIT_TEST
-   bool FileManagerWorker::run()
+   void FileManagerWorker::prepare_send_open_file_request(std::uint32_t address)
    {
-      auto* connection = m_shared.connection();
-      if (connection != nullptr)
+      Command cmd{ CmdType::OpenRemoteFile, address, 0u, (void*) nullptr, nullptr };
+      push_command(cmd);
+   }
+
+   void FileManagerWorker::prepare_send_resume_file_request(std::uint32_t address)
+   {
+      Command cmd{ CmdType::ResumeRemoteFile, address, 0u, (void*) nullptr, nullptr };
+      push_command(cmd);
+   }
+
+   void FileManagerWorker::set_high_water_mark(std::size_t num_bytes)
+   {
+      std::scoped_lock lock{ m_mutex };
+      m_high_water_mark = num_bytes;
+   }
+
+   std::size_t FileManagerWorker::high_water_mark()
+   {
+      std::scoped_lock lock{ m_mutex };
+      return m_high_water_mark;
+   }
+
+   /*
+   * When enabled, port data written through prepare_send_local_data_copy and prepare_send_local_shared_data is timestamped
+   * and the time until its send_packet call returned is recorded in the queue_to_send histogram.
+   */
+   void FileManagerWorker::set_latency_tracing(bool enabled)
+   {
+      std::scoped_lock lock{ m_mutex };
+      m_latency_tracing = enabled;
+   }
+
+   std::size_t FileManagerWorker::queued_bytes()
+   {
+      std::scoped_lock lock{ m_mutex };
+      return m_queued_bytes + m_in_flight_bytes;
+   }
+
+   /*
+   * Throws away all commands not yet picked up by the worker.
+   * Local data that never got transmitted is marked as dirty in its file so it can be sent when the file is resumed.
+   */
+   void FileManagerWorker::discard_pending_commands()
+   {
+      apx::CommandQueue discarded{ 0u };
       {
-         connection->transmit_begin();
+         std::scoped_lock lock{ m_mutex };
+         discarded.swap(m_queue);
+         m_queued_bytes = 0u;
+         m_metrics.queue_depth.set(0u);
+         m_queue_generation = next_queue_generation();
       }
-      while (m_queue.size() > 0u)
+      while (!discarded.empty())
       {
-         auto const& cmd = m_queue.front();
-         auto result = process_single_command(cmd);
-         m_queue.pop();
-         if (!result)
-         {
-            if (connection != nullptr)
-            {
-               connection->transmit_end();
-            }
-            return result;
-         }
+         discard_command(discarded.front());
+         discarded.pop();
       }
-      if (connection != nullptr)
+   }
+
+#ifdef UNIT_TEST
+   bool FileManagerWorker::run()
+   {
       {
-         connection->transmit_end();
+         std::scoped_lock lock{ m_mutex };
+         swap_queues();
       }
-      return true;
+      bool const retval = process_commands(m_pending);
+      processing_complete();
+      if (retval)
+      {
+         flush_rejected_writes();
+      }
+      return retval;
    }
 #else
    void FileManagerWorker::start()
@@ -109,38 +231,278 @@ namespace apx
 
    void FileManagerWorker::stop()
    {
-      //TODO: Trigger worker exit event
-      m_worker_thread.join();
+      if (m_worker_thread.joinable())
+      {
+         push_command(Command{ CmdType::Exit, 0u, 0u, (void*) nullptr, nullptr });
+         m_worker_thread.join();
+      }
    }
 
 #endif
 
+   void FileManagerWorker::push_command(apx::Command const& cmd)
+   {
+      {
+         std::scoped_lock lock{ m_mutex };
+         m_queue.push(cmd);
+         m_queued_bytes += command_data_size(cmd);
+         command_queued();
+      }
+#ifndef UNIT_TEST
+      m_cond.notify_one();
+#endif
+   }
+
+   void FileManagerWorker::push_command(apx::Command const& cmd, std::uint8_t const* data, std::uint32_t size)
+   {
+      {
+         std::scoped_lock lock{ m_mutex };
+         m_queue.push(cmd, data, size);
+         m_queued_bytes += command_data_size(cmd);
+         command_queued();
+      }
+#ifndef UNIT_TEST
+      m_cond.notify_one();
+#endif
+   }
+
+   void FileManagerWorker::command_queued()
+   {
+      if (m_queue.size() == 1u)
+      {
+         m_first_queued_time = std::chrono::steady_clock::now();
+      }
+      m_metrics.queue_depth.set(m_queue.size());
+   }
+
+   void FileManagerWorker::swap_queues()
+   {
+      if (!m_queue.empty())
+      {
+         auto const wait_time = std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - m_first_queued_time);
+         m_metrics.queue_wait_ns.add(static_cast<std::uint64_t>(wait_time.count()));
+         m_metrics.last_queue_wait_ns.set(static_cast<std::uint64_t>(wait_time.count()));
+         m_metrics.commands_processed.add(m_queue.size());
+      }
+      m_metrics.queue_depth.set(0u);
+      m_pending.swap(m_queue);
+      m_in_flight_bytes = m_queued_bytes;
+      m_queued_bytes = 0u;
+      m_queue_generation = next_queue_generation();
+   }
+
+   Command FileManagerWorker::make_data_command(CmdType cmd_type, std::uint32_t address, std::uint32_t size, void* data3, void* data4) const
+   {
+      Command cmd{ cmd_type, address, size, data3, data4 };
+      if (m_latency_tracing)
+      {
+         cmd.queued_time = std::chrono::steady_clock::now();
+      }
+      return cmd;
+   }
+
+   void FileManagerWorker::processing_complete()
+   {
+      std::scoped_lock lock{ m_mutex };
+      m_in_flight_bytes = 0u;
+   }
+
+   /*
+   * A write is always accepted when nothing is waiting, otherwise a write larger than the high-water mark could never be sent.
+   */
+   bool FileManagerWorker::is_above_high_water_mark(std::uint32_t size) const
+   {
+      std::size_t const waiting_bytes = m_queued_bytes + m_in_flight_bytes;
+      return (m_high_water_mark > 0u) && (waiting_bytes > 0u) && (waiting_bytes + size > m_high_water_mark);
+   }
+
+   void FileManagerWorker::reject_write(std::uint32_t address, std::uint32_t size)
+   {
+      m_metrics.rejected_writes.add();
+      m_shared.mark_local_data_dirty(address, size);
+      m_has_rejected_writes = true;
+   }
+
+   /*
+   * Queues the dirty ranges of open files once the queue is below the high-water mark again.
+   * The data is read back from the file's owner so the latest value of each rejected write is sent.
+   * Ranges that get rejected again stay dirty until the next time the queue drains.
+   */
+   void FileManagerWorker::flush_rejected_writes()
+   {
+      {
+         std::scoped_lock lock{ m_mutex };
+         if ( !m_has_rejected_writes || ( (m_high_water_mark > 0u) && (m_queued_bytes >= m_high_water_mark) ) )
+         {
+            return;
+         }
+         m_has_rejected_writes = false;
+      }
+      m_shared.list_dirty_open_local_files(m_dirty_files);
+      for (auto* file : m_dirty_files)
+      {
+         m_shared.take_dirty_ranges(file, m_dirty_ranges);
+         file->resume_notify(m_dirty_ranges);
+      }
+   }
+
+   bool FileManagerWorker::try_coalesce(CoalesceSlot const* slot, std::uint8_t const* data, std::uint32_t size)
+   {
+      if ( (slot == nullptr) || (slot->owner != this) || (slot->generation != m_queue_generation) )
+      {
+         return false;
+      }
+      auto* cmd = m_queue.at(slot->record_offset);
+      if ( (cmd == nullptr) || (cmd->cmd_type != CmdType::SendLocalData) || (cmd->data2 != size) )
+      {
+         return false;
+      }
+      auto* dest = cmd->has_inline_data() ? cmd->inline_data() : reinterpret_cast<std::uint8_t*>(cmd->data3);
+      std::memcpy(dest, data, size);
+      return true;
+   }
+
+   std::size_t FileManagerWorker::command_data_size(apx::Command const& cmd)
+   {
+      switch (cmd.cmd_type)
+      {
+      case CmdType::SendLocalConstData:
+      case CmdType::SendLocalData:
+      case CmdType::SendLocalSharedData:
+         return cmd.data2;
+      default:
+         return 0u;
+      }
+   }
+
+   /*
+   * Processes all commands in queue without holding m_mutex.
+   * Returns false when the worker should exit. Commands left in the queue at that point are disposed.
+   */
+   bool FileManagerWorker::process_commands(apx::CommandQueue& queue)
+   {
+      APX_TRACE_SCOPE_ARG("FileManagerWorker::process_commands", queue.size());
+      bool retval = true;
+      bool const is_connected = m_shared.is_connected();
+      auto* connection = is_connected ? m_shared.connection() : nullptr;
+      if (connection != nullptr)
+      {
+         connection->transmit_begin();
+      }
+      while (!queue.empty())
+      {
+         auto const& cmd = queue.front();
+         if (!retval)
+         {
+            dispose_command(cmd);
+         }
+         else if ( is_connected || (cmd.cmd_type == CmdType::Exit) )
+         {
+            retval = process_single_command(cmd);
+         }
+         else
+         {
+            discard_command(cmd);
+         }
+         queue.pop();
+      }
+      if (connection != nullptr)
+      {
+         connection->transmit_end();
+      }
+      record_queue_to_send_latency();
+      return retval;
+   }
+
    bool FileManagerWorker::process_single_command(apx::Command const& cmd)
    {
+      APX_TRACE_SCOPE_ARG("FileManagerWorker::process_single_command", cmd.cmd_type);
       error_t result;
-#if APX_DEBUG_ENABLE
-      std::cout << "Processing command" << std::endl;
-#endif
       switch (cmd.cmd_type)
       {
+      case CmdType::Exit:
+         return false;
       case CmdType::PublishLocalFile:
-         result = run_publish_local_file(reinterpret_cast<rmf::FileInfo*>(cmd.data3.ptr));
+         result = run_publish_local_file(reinterpret_cast<rmf::FileInfo*>(cmd.data3));
          break;
       case CmdType::OpenRemoteFile:
          result = run_open_remote_file(cmd.data1);
          break;
+      case CmdType::ResumeRemoteFile:
+         result = run_resume_remote_file(cmd.data1);
+         break;
       case CmdType::SendLocalConstData:
-         result = run_send_local_const_data(cmd.data1, reinterpret_cast<std::uint8_t const*>(cmd.data3.ptr), cmd.data2);
+         result = run_send_local_const_data(cmd.data1, reinterpret_cast<std::uint8_t const*>(cmd.data3), cmd.data2);
          break;
       case CmdType::SendLocalData:
-         result = run_send_local_data(cmd.data1, reinterpret_cast<std::uint8_t*>(cmd.data3.ptr), cmd.data2);
+         if (cmd.has_inline_data())
+         {
+            result = run_send_local_const_data(cmd.data1, cmd.inline_data(), cmd.data2);
+         }
+         else
+         {
+            result = run_send_local_data(cmd.data1, reinterpret_cast<std::uint8_t*>(cmd.data3), cmd.data2);
+         }
+         break;
+      case CmdType::SendLocalSharedData:
+         result = run_send_local_shared_data(cmd.data1, reinterpret_cast<SharedBuffer*>(cmd.data3), reinterpret_cast<std::uint8_t const*>(cmd.data4), cmd.data2);
          break;
       default:
          return false;
       }
+      if ( (result == APX_NO_ERROR) && (cmd.queued_time != std::chrono::steady_clock::time_point{}) )
+      {
+         m_transmitted_queue_times.push_back(cmd.queued_time);
+      }
       return true;
    }
 
+   /*
+   * Data is not guaranteed to have left through send_packet until transmit_end has been called, so latencies are recorded per batch.
+   */
+   void FileManagerWorker::record_queue_to_send_latency()
+   {
+      if (!m_transmitted_queue_times.empty())
+      {
+         auto const now = std::chrono::steady_clock::now();
+         for (auto const& queued_time : m_transmitted_queue_times)
+         {
+            m_metrics.queue_to_send.record(now - queued_time);
+         }
+         m_transmitted_queue_times.clear();
+      }
+   }
+
+   void FileManagerWorker::dispose_command(apx::Command const& cmd)
+   {
+      switch (cmd.cmd_type)
+      {
+      case CmdType::PublishLocalFile:
+         delete reinterpret_cast<rmf::FileInfo*>(cmd.data3);
+         break;
+      case CmdType::SendLocalData:
+         if (!cmd.has_inline_data())
+         {
+            delete[] reinterpret_cast<std::uint8_t*>(cmd.data3);
+         }
+         break;
+      case CmdType::SendLocalSharedData:
+         reinterpret_cast<SharedBuffer*>(cmd.data3)->release();
+         break;
+      default:
+         break;
+      }
+   }
+
+   void FileManagerWorker::discard_command(apx::Command const& cmd)
+   {
+      if ( (cmd.cmd_type == CmdType::SendLocalData) || (cmd.cmd_type == CmdType::SendLocalSharedData) )
+      {
+         m_shared.mark_local_data_dirty(cmd.data1, cmd.data2);
+      }
+      dispose_command(cmd);
+   }
+
    error_t FileManagerWorker::run_publish_local_file(rmf::FileInfo* file_info)
    {
       std::array<std::uint8_t, rmf::FILE_INFO_HEADER_SIZE + rmf::FILE_NAME_MAX_SIZE + 1> buffer; //add 1 byte for null-terminator
@@ -172,18 +534,25 @@ namespace apx
       auto* connection = m_shared.connection();
       if (connection != nullptr)
       {
-         std::int32_t bytes_available{ 0 };
-         auto rc = connection->transmit_data_message(address, false, data, static_cast<std::int32_t>(size), bytes_available);
-         if (rc < 0)
-         {
-            return APX_TRANSMIT_ERROR;
-         }
+         return transmit_file_data(connection, address, nullptr, data, size);
+      }
+      return APX_NOT_CONNECTED_ERROR;
+   }
+
+   error_t FileManagerWorker::run_send_local_shared_data(std::uint32_t address, SharedBuffer* buffer, std::uint8_t const* data, std::uint32_t size)
+   {
+      error_t retval = APX_NO_ERROR;
+      auto* connection = m_shared.connection();
+      if (connection != nullptr)
+      {
+         retval = transmit_file_data(connection, address, buffer, data, size);
       }
       else
       {
-         return APX_NOT_CONNECTED_ERROR;
+         retval = APX_NOT_CONNECTED_ERROR;
       }
-      return APX_NO_ERROR;
+      buffer->release();
+      return retval;
    }
 
    error_t FileManagerWorker::run_send_local_data(std::uint32_t address, std::uint8_t* data, std::uint32_t size)
@@ -192,18 +561,9 @@ namespace apx
       auto* connection = m_shared.connection();
       if (connection != nullptr)
       {
-         std::int32_t bytes_available{ 0 };
-         auto rc = connection->transmit_data_message(address, false, ptr.get(), static_cast<std::int32_t>(size), bytes_available);
-         if (rc < 0)
-         {
-            return APX_TRANSMIT_ERROR;
-         }
-      }
-      else
-      {
-         return APX_NOT_CONNECTED_ERROR;
+         return transmit_file_data(connection, address, nullptr, ptr.get(), size);
       }
-      return APX_NO_ERROR;
+      return APX_NOT_CONNECTED_ERROR;
    }
 
    error_t FileManagerWorker::run_open_remote_file(std::uint32_t address)
@@ -214,53 +574,90 @@ namespace apx
       {
          return APX_BUFFER_TOO_SMALL_ERROR;
       }
+      return transmit_command(buffer.data(), encoded_size);
+   }
+
+   error_t FileManagerWorker::run_resume_remote_file(std::uint32_t address)
+   {
+      std::array<std::uint8_t, rmf::CMD_TYPE_SIZE + rmf::FILE_RESUME_CMD_SIZE> buffer;
+      std::size_t const encoded_size = rmf::encode_resume_file_cmd(buffer.data(), buffer.size(), address);
+      if (encoded_size == 0u)
+      {
+         return APX_BUFFER_TOO_SMALL_ERROR;
+      }
+      return transmit_command(buffer.data(), encoded_size);
+   }
+
+   error_t FileManagerWorker::transmit_command(std::uint8_t const* data, std::size_t size)
+   {
       auto* connection = m_shared.connection();
-      if (connection != nullptr)
+      if (connection == nullptr)
+      {
+         return APX_NOT_CONNECTED_ERROR;
+      }
+      std::int32_t bytes_available{ 0 };
+      auto rc = connection->transmit_data_message(rmf::CMD_AREA_START_ADDRESS, false, data, static_cast<std::int32_t>(size), bytes_available);
+      if (rc < 0)
+      {
+         return APX_TRANSMIT_ERROR;
+      }
+      return APX_NO_ERROR;
+   }
+
+   /*
+   * Writes that don't fit in a single message are split into fragments.
+   * Every fragment except the last one has the more-bit set, the receiver reassembles them before processing.
+   */
+   error_t FileManagerWorker::transmit_file_data(ConnectionInterface* connection, std::uint32_t address, SharedBuffer* buffer, std::uint8_t const* data, std::uint32_t size)
+   {
+      assert(connection != nullptr);
+      std::int32_t const max_bytes = connection->transmit_max_bytes_avaiable() - static_cast<std::int32_t>(numheader::LONG32_SIZE + rmf::HIGH_ADDR_SIZE);
+      if (max_bytes <= 0)
+      {
+         return APX_TRANSMIT_ERROR;
+      }
+      std::uint32_t const max_fragment_size = static_cast<std::uint32_t>(max_bytes);
+      std::uint32_t offset{ 0u };
+      do
       {
+         std::uint32_t const fragment_size = std::min(size - offset, max_fragment_size);
+         bool const more_bit = (offset + fragment_size) < size;
          std::int32_t bytes_available{ 0 };
-         auto rc = connection->transmit_data_message(rmf::CMD_AREA_START_ADDRESS, false, buffer.data(), static_cast<std::int32_t>(encoded_size), bytes_available);
-         if (rc < 0)
+         error_t rc;
+         if (buffer != nullptr)
+         {
+            rc = connection->transmit_shared_data_message(address + offset, more_bit, buffer, data + offset, static_cast<std::int32_t>(fragment_size), bytes_available);
+         }
+         else
+         {
+            rc = connection->transmit_data_message(address + offset, more_bit, data + offset, static_cast<std::int32_t>(fragment_size), bytes_available);
+         }
+         if (rc != APX_NO_ERROR)
          {
             return APX_TRANSMIT_ERROR;
          }
-      }
-      else
-      {
-         return APX_NOT_CONNECTED_ERROR;
-      }
+         offset += fragment_size;
+      } while (offset < size);
       return APX_NO_ERROR;
    }
 
    void FileManagerWorker::worker_main()
    {
-      std::unique_lock lock{ m_mutex };
+      APX_TRACE_THREAD_NAME("FileManagerWorker");
       for (;;)
       {
-         m_cond.wait(lock, [this] {return !m_queue.empty(); });
-         auto* connection = m_shared.connection();
-         if (connection != nullptr)
-         {
-            connection->transmit_begin();
-         }
-         while (m_queue.size() > 0u)
          {
-            auto const& cmd = m_queue.front();
-            bool success = process_single_command(cmd);
-            m_queue.pop();
-            if (!success)
-            {
-               if (connection != nullptr)
-               {
-                  connection->transmit_end();
-               }
-               lock.unlock();
-               return;
-            }
+            std::unique_lock lock{ m_mutex };
+            m_cond.wait(lock, [this] {return !m_queue.empty(); });
+            swap_queues();
          }
-         if (connection != nullptr)
+         bool const result = process_commands(m_pending);
+         processing_complete();
+         if (!result)
          {
-            connection->transmit_end();
+            return;
          }
+         flush_rejected_writes();
       }
    }
 }
\ No newline at end of file
@@ -29,11 +29,18 @@
 namespace apx
 {
    FileMap::~FileMap()
+   {
+      clear();
+   }
+
+   void FileMap::clear()
    {
       for (auto& it : m_list)
       {
          delete it;
       }
+      m_list.clear();
+      m_last_found_file = nullptr;
    }
 
    File* FileMap::create_file(rmf::FileInfo const& file_info)
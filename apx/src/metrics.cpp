@@ -0,0 +1,128 @@
+/*****************************************************************************
+* \file      metrics.cpp
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Latency histograms
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#include <bit>
+#include "cpp-apx/metrics.h"
+
+namespace apx
+{
+   void LatencyHistogram::record(std::uint64_t value_ns)
+   {
+      m_buckets[bucket_index(value_ns)].fetch_add(1u, std::memory_order_relaxed);
+      m_count.add();
+      m_sum.add(value_ns);
+      m_max.set(value_ns);
+   }
+
+   void LatencyHistogram::record(std::chrono::steady_clock::duration elapsed)
+   {
+      auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count();
+      record(ns > 0 ? static_cast<std::uint64_t>(ns) : 0u);
+   }
+
+   /*
+   * Buckets are read one by one while writers may be active, so count can differ slightly from the sum of the buckets.
+   */
+   void LatencyHistogram::read(LatencyHistogramSnapshot& snapshot) const
+   {
+      for (std::size_t i = 0u; i < NUM_BUCKETS; i++)
+      {
+         snapshot.buckets[i] = m_buckets[i].load(std::memory_order_relaxed);
+      }
+      snapshot.count = m_count.get();
+      snapshot.sum_ns = m_sum.get();
+      snapshot.max_ns = m_max.max();
+   }
+
+   /*
+   * Values below SUB_BUCKETS map directly to their own bucket.
+   * Larger values use the most significant SUB_BUCKET_BITS + 1 bits: the bit width selects the group and the remaining bits the linear bucket inside it.
+   */
+   std::size_t LatencyHistogram::bucket_index(std::uint64_t value_ns)
+   {
+      if (value_ns < SUB_BUCKETS)
+      {
+         return static_cast<std::size_t>(value_ns);
+      }
+      unsigned const width = static_cast<unsigned>(std::bit_width(value_ns));
+      if (width > MAX_BITS)
+      {
+         return NUM_BUCKETS - 1u;
+      }
+      unsigned const shift = width - SUB_BUCKET_BITS - 1u;
+      std::size_t const group = width - SUB_BUCKET_BITS;
+      return group * SUB_BUCKETS + static_cast<std::size_t>((value_ns >> shift) - SUB_BUCKETS);
+   }
+
+   std::uint64_t LatencyHistogram::bucket_lower_bound(std::size_t index)
+   {
+      if (index < SUB_BUCKETS)
+      {
+         return index;
+      }
+      std::size_t const group = index / SUB_BUCKETS;
+      std::uint64_t const sub_bucket = index % SUB_BUCKETS;
+      return (SUB_BUCKETS + sub_bucket) << (group - 1u);
+   }
+
+   std::uint64_t LatencyHistogram::bucket_upper_bound(std::size_t index)
+   {
+      if (index < SUB_BUCKETS)
+      {
+         return index;
+      }
+      std::size_t const group = index / SUB_BUCKETS;
+      return bucket_lower_bound(index) + (std::uint64_t{ 1u } << (group - 1u)) - 1u;
+   }
+
+   std::uint64_t LatencyHistogramSnapshot::percentile(double p) const
+   {
+      std::uint64_t total{ 0u };
+      for (auto bucket_count : buckets)
+      {
+         total += bucket_count;
+      }
+      if (total == 0u)
+      {
+         return 0u;
+      }
+      if (p < 0.0) p = 0.0;
+      if (p > 100.0) p = 100.0;
+      auto rank = static_cast<std::uint64_t>(p / 100.0 * static_cast<double>(total) + 0.5);
+      if (rank == 0u)
+      {
+         rank = 1u;
+      }
+      std::uint64_t seen{ 0u };
+      for (std::size_t i = 0u; i < buckets.size(); i++)
+      {
+         seen += buckets[i];
+         if (seen >= rank)
+         {
+            auto const upper = LatencyHistogram::bucket_upper_bound(i);
+            return (upper < max_ns) ? upper : max_ns;
+         }
+      }
+      return max_ns;
+   }
+}
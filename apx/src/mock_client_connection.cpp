@@ -130,6 +130,27 @@ namespace apx
       return m_file_manager.message_received(buffer.data(), buffer.size());
    }
 
+   error_t MockClientConnection::request_resume_local_file(char const* file_name)
+   {
+      auto* file = m_file_manager.find_local_file_by_name(file_name);
+      if (file == nullptr)
+      {
+         return APX_FILE_NOT_FOUND_ERROR;
+      }
+      std::array<std::uint8_t, rmf::HIGH_ADDR_SIZE + rmf::CMD_TYPE_SIZE + rmf::FILE_RESUME_CMD_SIZE> buffer;
+      if (rmf::address_encode(buffer.data(), rmf::HIGH_ADDR_SIZE, rmf::CMD_AREA_START_ADDRESS, false) != rmf::HIGH_ADDR_SIZE)
+      {
+         return APX_INTERNAL_ERROR;
+      }
+      std::size_t const cmd_size = rmf::CMD_TYPE_SIZE + rmf::FILE_RESUME_CMD_SIZE;
+      auto result = rmf::encode_resume_file_cmd(buffer.data() + rmf::HIGH_ADDR_SIZE, cmd_size, file->get_address_without_flags());
+      if (result == 0)
+      {
+         return APX_INTERNAL_ERROR;
+      }
+      return m_file_manager.message_received(buffer.data(), buffer.size());
+   }
+
    error_t MockClientConnection::publish_remote_file(std::uint32_t address, char const* file_name, std::size_t file_size)
    {
       rmf::FileInfo file_info{ file_name, static_cast<std::uint32_t>(file_size), address };
@@ -147,10 +168,10 @@ namespace apx
       return m_file_manager.message_received(buffer.data(), rmf::HIGH_ADDR_SIZE + cmd_size);
    }
 
-   error_t MockClientConnection::write_remote_data(std::uint32_t address, std::uint8_t const* payload_data, std::size_t payload_size)
+   error_t MockClientConnection::write_remote_data(std::uint32_t address, std::uint8_t const* payload_data, std::size_t payload_size, bool more_bit)
    {
       std::array<std::uint8_t, rmf::HIGH_ADDR_SIZE> header;
-      auto header_size = rmf::address_encode(header.data(), header.size(), address, false);
+      auto header_size = rmf::address_encode(header.data(), header.size(), address, more_bit);
       if (header_size == 0u)
       {
          return APX_INTERNAL_ERROR;
@@ -173,7 +194,6 @@ namespace apx
    {
       apx::ByteArray packet(m_transmit_buffer.data(), m_transmit_buffer.data() + m_pending_bytes);
       m_transmit_log.push_back(packet);
-      m_transmit_buffer.clear();
       m_pending_bytes = 0u;
    }
 
@@ -0,0 +1,127 @@
+/*****************************************************************************
+* \file      mock_server_connection.cpp
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     A server connection used for unit testing
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#include <array>
+#include <cstring>
+#include "cpp-apx/remotefile.h"
+#include "cpp-apx/mock_server_connection.h"
+
+namespace apx
+{
+   std::int32_t MockServerConnection::transmit_max_bytes_avaiable() const
+   {
+      return static_cast<std::int32_t>(m_default_buffer_size);
+   }
+
+   std::int32_t MockServerConnection::transmit_current_bytes_avaiable() const
+   {
+      return static_cast<std::int32_t>(m_default_buffer_size);
+   }
+
+   error_t MockServerConnection::transmit_data_message(std::uint32_t write_address, bool more_bit, std::uint8_t const* msg_data, std::int32_t msg_size, std::int32_t& bytes_available)
+   {
+      (void)write_address;
+      (void)more_bit;
+      (void)msg_data;
+      if (msg_size > transmit_max_bytes_avaiable())
+      {
+         return APX_MSG_TOO_LARGE_ERROR;
+      }
+      m_num_transmitted_messages++;
+      bytes_available = transmit_current_bytes_avaiable();
+      return APX_NO_ERROR;
+   }
+
+   error_t MockServerConnection::transmit_direct_message(std::uint8_t const* msg_data, std::int32_t msg_size, std::int32_t& bytes_available)
+   {
+      (void)msg_data;
+      if (msg_size > transmit_max_bytes_avaiable())
+      {
+         return APX_MSG_TOO_LARGE_ERROR;
+      }
+      m_num_transmitted_messages++;
+      bytes_available = transmit_current_bytes_avaiable();
+      return APX_NO_ERROR;
+   }
+
+   /*
+   * Does what the connection does after it has received a valid greeting from the client.
+   */
+   void MockServerConnection::accept_greeting()
+   {
+      m_is_greeting_accepted = true;
+      m_file_manager.connected();
+   }
+
+   error_t MockServerConnection::request_open_local_file(char const* file_name)
+   {
+      auto* file = m_file_manager.find_local_file_by_name(file_name);
+      if (file == nullptr)
+      {
+         return APX_FILE_NOT_FOUND_ERROR;
+      }
+      std::array<std::uint8_t, rmf::HIGH_ADDR_SIZE + rmf::CMD_TYPE_SIZE + rmf::FILE_OPEN_CMD_SIZE> buffer;
+      if (rmf::address_encode(buffer.data(), rmf::HIGH_ADDR_SIZE, rmf::CMD_AREA_START_ADDRESS, false) != rmf::HIGH_ADDR_SIZE)
+      {
+         return APX_INTERNAL_ERROR;
+      }
+      std::size_t const cmd_size = rmf::CMD_TYPE_SIZE + rmf::FILE_OPEN_CMD_SIZE;
+      auto result = rmf::encode_open_file_cmd(buffer.data() + rmf::HIGH_ADDR_SIZE, cmd_size, file->get_address_without_flags());
+      if (result == 0)
+      {
+         return APX_INTERNAL_ERROR;
+      }
+      return m_file_manager.message_received(buffer.data(), buffer.size());
+   }
+
+   error_t MockServerConnection::publish_remote_file(std::uint32_t address, char const* file_name, std::size_t file_size)
+   {
+      rmf::FileInfo file_info{ file_name, static_cast<std::uint32_t>(file_size), address };
+      std::array<std::uint8_t, rmf::HIGH_ADDR_SIZE + rmf::CMD_TYPE_SIZE + rmf::FILE_INFO_HEADER_SIZE + rmf::FILE_NAME_MAX_SIZE> buffer;
+      if (rmf::address_encode(buffer.data(), rmf::HIGH_ADDR_SIZE, rmf::CMD_AREA_START_ADDRESS, false) != rmf::HIGH_ADDR_SIZE)
+      {
+         return APX_INTERNAL_ERROR;
+      }
+      std::size_t const max_cmd_size = buffer.size() - rmf::HIGH_ADDR_SIZE;
+      std::size_t const cmd_size = rmf::encode_publish_file_cmd(buffer.data() + rmf::HIGH_ADDR_SIZE, max_cmd_size, &file_info);
+      if (cmd_size == 0)
+      {
+         return APX_INTERNAL_ERROR;
+      }
+      return m_file_manager.message_received(buffer.data(), rmf::HIGH_ADDR_SIZE + cmd_size);
+   }
+
+   error_t MockServerConnection::write_remote_data(std::uint32_t address, std::uint8_t const* payload_data, std::size_t payload_size, bool more_bit)
+   {
+      std::array<std::uint8_t, rmf::HIGH_ADDR_SIZE> header;
+      auto header_size = rmf::address_encode(header.data(), header.size(), address, more_bit);
+      if (header_size == 0u)
+      {
+         return APX_INTERNAL_ERROR;
+      }
+      apx::ByteArray msg(header_size + payload_size);
+      std::memcpy(msg.data(), header.data(), header_size);
+      std::memcpy(msg.data() + header_size, payload_data, payload_size);
+      return m_file_manager.message_received(msg.data(), msg.size());
+   }
+}
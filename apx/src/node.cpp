@@ -107,13 +107,18 @@ namespace apx
       return nullptr;
    }
 
-   apx::error_t apx::Node::finalize()
+   /*
+   * When statistics is given, the time spent in each step is written to it.
+   */
+   apx::error_t apx::Node::finalize(BuildNodeStatistics* statistics)
    {
+      using Clock = std::chrono::steady_clock;
       if (m_is_finalized)
       {
          return APX_NO_ERROR;
       }
       m_last_error_line = -1;
+      auto const start_time = Clock::now();
       apx::error_t result = derive_types_on_ports(m_provide_ports);
       if (result != APX_NO_ERROR)
       {
@@ -124,6 +129,7 @@ namespace apx
       {
          return result;
       }
+      auto const types_derived_time = Clock::now();
       result = expand_data_elements_on_ports(m_provide_ports);
       if (result != APX_NO_ERROR)
       {
@@ -134,6 +140,7 @@ namespace apx
       {
          return result;
       }
+      auto const elements_expanded_time = Clock::now();
       result = derive_proper_init_values_on_ports(m_provide_ports);
       if (result != APX_NO_ERROR)
       {
@@ -144,6 +151,12 @@ namespace apx
       {
          return result;
       }
+      if (statistics != nullptr)
+      {
+         statistics->type_derivation_time = types_derived_time - start_time;
+         statistics->element_expansion_time = elements_expanded_time - types_derived_time;
+         statistics->init_value_derivation_time = Clock::now() - elements_expanded_time;
+      }
       m_is_finalized = true;
       return APX_NO_ERROR;
    }
@@ -91,6 +91,7 @@ namespace apx
          return APX_INVALID_ARGUMENT_ERROR;
       }
       std::memcpy(m_provide_port_data.get() + offset, src, size);
+      m_metrics.provide_port_writes.add();
       return APX_NO_ERROR;
    }
 
@@ -113,6 +114,7 @@ namespace apx
          return APX_INVALID_ARGUMENT_ERROR;
       }
       std::memcpy(m_require_port_data.get() + offset, src, size);
+      m_metrics.require_port_writes.add();
       return APX_NO_ERROR;
    }
 
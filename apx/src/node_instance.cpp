@@ -270,6 +270,7 @@ namespace apx
             return APX_FILE_CREATE_ERROR;
          }
          provide_port_data_file->set_notification_handler(this);
+         m_provide_port_data_file = provide_port_data_file;
       }
       if (has_require_port_data())
       {
@@ -289,6 +290,32 @@ namespace apx
       return APX_NO_ERROR;
    }
 
+   error_t NodeInstance::write_provide_port_data(std::uint32_t offset, std::uint8_t const* data, std::size_t size, CoalesceSlot* slot)
+   {
+      if (m_node_data == nullptr)
+      {
+         return APX_NULL_PTR_ERROR;
+      }
+      auto retval = m_node_data->write_provide_port_data(offset, data, size);
+      if ( (retval == APX_NO_ERROR) && (m_provide_port_data_file != nullptr) )
+      {
+         auto* file_manager = m_provide_port_data_file->get_file_manager();
+         std::uint32_t const address = m_provide_port_data_file->get_address_without_flags() + offset;
+         if (file_manager != nullptr)
+         {
+            if (m_provide_port_data_file->is_open())
+            {
+               retval = file_manager->send_local_data_copy(address, data, size, slot);
+            }
+            else
+            {
+               file_manager->mark_local_data_dirty(address, size);
+            }
+         }
+      }
+      return retval;
+   }
+
    error_t NodeInstance::file_open_notify(File* file)
    {
 
@@ -329,6 +356,42 @@ namespace apx
       return retval;
    }
 
+   error_t NodeInstance::file_resume_notify(File* file, std::vector<ByteRange> const& dirty_ranges)
+   {
+      auto* file_manager = file->get_file_manager();
+      assert(file_manager != nullptr);
+      error_t result = APX_NO_ERROR;
+      switch (file->get_apx_file_type())
+      {
+      case FileType::Definition:
+         break; //Definition data never changes
+      case FileType::ProvidePortData:
+         for (auto const& range : dirty_ranges)
+         {
+            std::uint32_t const address = file->get_address_without_flags() + range.offset;
+            std::vector<std::uint8_t> data(range.size);
+            auto retval = m_node_data->read_provide_port_data(range.offset, data.data(), data.size());
+            if (retval == APX_NO_ERROR)
+            {
+               retval = file_manager->send_local_data_copy(address, data.data(), data.size());
+            }
+            if ( (retval != APX_NO_ERROR) && (retval != APX_QUEUE_FULL_ERROR) )
+            {
+               //Keep the range so it's sent the next time the file is resumed. Rejected writes are already marked by the worker.
+               file_manager->mark_local_data_dirty(address, range.size);
+               if (result == APX_NO_ERROR)
+               {
+                  result = retval;
+               }
+            }
+         }
+         break;
+      default:
+         return APX_UNSUPPORTED_ERROR;
+      }
+      return result;
+   }
+
    port_id_t NodeInstance::lookup_require_port_id(std::size_t byte_offset)
    {
       if (m_require_port_byte_map != nullptr)
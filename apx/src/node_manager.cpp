@@ -22,6 +22,7 @@
 *
 ******************************************************************************/
 
+#include <algorithm>
 #include <cassert>
 #include <cstring>
 #include "cpp-apx/node_manager.h"
@@ -30,42 +31,48 @@
 namespace apx
 {
 
-   apx::error_t NodeManager::build_node(char const* definition_text)
+   apx::error_t NodeManager::build_node(char const* definition_text, BuildNodeStatistics* statistics)
    {
-      std::size_t definition_size = std::strlen(definition_text);
-      apx::error_t result = m_parser.parse(definition_text);
-      if (result != APX_NO_ERROR)
+      BuildNodeStatistics build_statistics;
+      auto const start_time = Clock::now();
+      apx::error_t result = m_parser.parse_declarations(definition_text);
+      build_statistics.parse_time = Clock::now() - start_time;
+      if (result == APX_NO_ERROR)
       {
-         return result;
+         result = finalize_and_create_node_instance(reinterpret_cast<std::uint8_t const*>(definition_text), std::strlen(definition_text), build_statistics);
       }
-      auto node{ m_parser.take_last_node() };
+      update_statistics(build_statistics, start_time, result, statistics);
+      return result;
+   }
 
-      result = create_node_instance(node.get(), reinterpret_cast<std::uint8_t const*>(definition_text), definition_size);
-      if (result != APX_NO_ERROR)
+   apx::error_t NodeManager::build_node(std::string const& definition_text, BuildNodeStatistics* statistics)
+   {
+      BuildNodeStatistics build_statistics;
+      auto const start_time = Clock::now();
+      apx::error_t result = m_parser.parse_declarations(definition_text);
+      build_statistics.parse_time = Clock::now() - start_time;
+      if (result == APX_NO_ERROR)
       {
-         return result;
+         result = finalize_and_create_node_instance(reinterpret_cast<std::uint8_t const*>(definition_text.data()), definition_text.size(), build_statistics);
       }
-      return APX_NO_ERROR;
+      update_statistics(build_statistics, start_time, result, statistics);
+      return result;
    }
 
-   apx::error_t NodeManager::build_node(std::string const& definition_text)
+   void NodeManager::reset_statistics()
    {
-      apx::error_t result = m_parser.parse(definition_text);
-      if (result != APX_NO_ERROR)
-      {
-         return result;
-      }
-      auto node{ m_parser.take_last_node() };
-      result = create_node_instance(node.get(), reinterpret_cast<std::uint8_t const*>(definition_text.data()), definition_text.size());
-      if (result != APX_NO_ERROR)
-      {
-         return result;
-      }
-      return APX_NO_ERROR;
+      m_statistics = NodeManagerStatistics{};
+   }
+
+   std::size_t NodeManager::size()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_instance_map.size();
    }
 
    std::vector<apx::NodeInstance*> NodeManager::get_nodes()
    {
+       std::lock_guard<std::mutex> lock(m_mutex);
        std::vector<apx::NodeInstance*> nodes;
        for (auto& it : m_instance_map)
        {
@@ -76,6 +83,7 @@ namespace apx
 
    apx::NodeInstance* NodeManager::find(char const* name)
    {
+      std::lock_guard<std::mutex> lock(m_mutex);
       auto it = m_instance_map.find(name);
       if (it != m_instance_map.end())
       {
@@ -86,6 +94,7 @@ namespace apx
 
    apx::NodeInstance* NodeManager::find(std::string const& name)
    {
+      std::lock_guard<std::mutex> lock(m_mutex);
       auto it = m_instance_map.find(name);
       if (it != m_instance_map.end())
       {
@@ -108,7 +117,62 @@ namespace apx
       //m_computation_element_map.clear();
    }
 
-   apx::error_t NodeManager::create_node_instance(Node const* node, std::uint8_t const* definition_data, std::size_t definition_size)
+   apx::error_t NodeManager::finalize_and_create_node_instance(std::uint8_t const* definition_data, std::size_t definition_size, BuildNodeStatistics& statistics)
+   {
+      auto node{ m_parser.take_last_node() };
+      if (node == nullptr)
+      {
+         return APX_NULL_PTR_ERROR;
+      }
+      statistics.definition_size = definition_size;
+      auto result = node->finalize(&statistics);
+      if (result == APX_NO_ERROR)
+      {
+         result = create_node_instance(node.get(), definition_data, definition_size, &statistics);
+      }
+      return result;
+   }
+
+   void NodeManager::update_statistics(BuildNodeStatistics& build_statistics, Clock::time_point start_time, apx::error_t result, BuildNodeStatistics* statistics)
+   {
+      build_statistics.total_time = Clock::now() - start_time;
+      m_statistics.num_builds++;
+      if (result != APX_NO_ERROR)
+      {
+         m_statistics.num_failed_builds++;
+      }
+      m_statistics.total.add(build_statistics);
+      m_statistics.max_total_time = std::max(m_statistics.max_total_time, build_statistics.total_time);
+      if (statistics != nullptr)
+      {
+         *statistics = build_statistics;
+      }
+   }
+
+   /*
+   * Counts programs and init data of a newly built node instance.
+   */
+   static void count_node_instance_size(apx::NodeInstance const* node_instance, BuildNodeStatistics& statistics)
+   {
+      auto const num_provide_ports = static_cast<port_id_t>(node_instance->get_num_provide_ports());
+      auto const num_require_ports = static_cast<port_id_t>(node_instance->get_num_require_ports());
+      statistics.num_ports = static_cast<std::size_t>(num_provide_ports) + static_cast<std::size_t>(num_require_ports);
+      for (port_id_t port_id = 0u; port_id < num_provide_ports; port_id++)
+      {
+         auto const* port_instance = node_instance->get_provide_port(port_id);
+         statistics.num_programs++;
+         statistics.program_bytes += port_instance->pack_program().size();
+      }
+      for (port_id_t port_id = 0u; port_id < num_require_ports; port_id++)
+      {
+         auto const* port_instance = node_instance->get_require_port(port_id);
+         statistics.num_programs += 2u;
+         statistics.program_bytes += port_instance->pack_program().size() + port_instance->unpack_program().size();
+      }
+      statistics.init_data_size = node_instance->get_provide_port_init_data_size() + node_instance->get_require_port_init_data_size();
+   }
+
+   apx::error_t NodeManager::create_node_instance(Node const* node, std::uint8_t const* definition_data, std::size_t definition_size, BuildNodeStatistics* statistics)
    {
       if ( (node == nullptr) || (definition_data == nullptr) || (definition_size == 0u) )
       {
@@ -119,16 +183,24 @@ namespace apx
       std::size_t expected_provide_port_data_size{ 0u };
       std::size_t expected_require_port_data_size{ 0u };
       auto* node_instance = node_instance_ptr.get();
+      auto const start_time = Clock::now();
       result = create_ports_on_node_instance(node_instance, node, expected_provide_port_data_size, expected_require_port_data_size);
       if (result != APX_NO_ERROR)
       {
          return result;
       }
+      auto const compiled_time = Clock::now();
       result = create_init_data_on_node_instance(node_instance, node, expected_provide_port_data_size, expected_require_port_data_size);
       if (result != APX_NO_ERROR)
       {
          return result;
       }
+      if (statistics != nullptr)
+      {
+         statistics->compile_time = compiled_time - start_time;
+         statistics->init_data_time = Clock::now() - compiled_time;
+         count_node_instance_size(node_instance, *statistics);
+      }
       result = node_instance->create_node_data(definition_data, definition_size);
       if (result != APX_NO_ERROR)
       {
@@ -144,9 +216,16 @@ namespace apx
 
    void NodeManager::attach_node(apx::NodeInstance* node_instance)
    {
-      m_instance_map.insert(std::make_pair(node_instance->get_name(), std::unique_ptr<apx::NodeInstance>(node_instance)));
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto result = m_instance_map.insert(std::make_pair(node_instance->get_name(), std::unique_ptr<apx::NodeInstance>(node_instance)));
       node_instance->set_node_manager(this);
       m_last_attached = node_instance;
+      if (result.second)
+      {
+         //Writers are serialized by m_mutex, the release store publishes the fully built node to lock-free readers
+         node_instance->set_next_attached(m_attached_list.load(std::memory_order_relaxed));
+         m_attached_list.store(node_instance, std::memory_order_release);
+      }
    }
 
    apx::error_t NodeManager::create_ports_on_node_instance(apx::NodeInstance* node_instance, Node const* node,
@@ -13,6 +13,25 @@ namespace apx
 
    }
    bool Parser::parse(std::basic_istream<char> &is)
+   {
+      if (!parse_declarations(is))
+      {
+         return false;
+      }
+      auto error_code = m_state.node->finalize();
+      if (error_code != APX_NO_ERROR)
+      {
+         set_error(error_code);
+         return false;
+      }
+      return true;
+   }
+
+   /*
+   * Parses all lines without finalizing the node.
+   * Node::finalize() must be called on the node before it can be used to build a node instance.
+   */
+   bool Parser::parse_declarations(std::basic_istream<char>& is)
    {
       reset();
       for (std::string line; std::getline(is, line); )
@@ -39,19 +58,7 @@ namespace apx
             return false;
          }
       }
-      if (auto node = m_state.node.get(); node != nullptr)
-      {
-         auto error_code = node->finalize();
-         if (error_code != APX_NO_ERROR)
-         {
-            set_error(error_code);
-         }
-         else
-         {
-            return true;
-         }
-      }
-      return false;
+      return m_state.node.get() != nullptr;
    }
 
    apx::error_t Parser::parse(char const* str)
@@ -76,6 +83,28 @@ namespace apx
       return APX_NO_ERROR;
    }
 
+   apx::error_t Parser::parse_declarations(char const* str)
+   {
+      std::stringstream ss;
+      ss.str(str);
+      if (!parse_declarations(ss))
+      {
+         return get_last_error();
+      }
+      return APX_NO_ERROR;
+   }
+
+   apx::error_t Parser::parse_declarations(std::string const& str)
+   {
+      std::stringstream ss;
+      ss.str(str);
+      if (!parse_declarations(ss))
+      {
+         return get_last_error();
+      }
+      return APX_NO_ERROR;
+   }
+
    void Parser::reset()
    {
       m_state.accept_next = FileSection::Version;
@@ -8,7 +8,7 @@ namespace apx
 {
    namespace vm
    {
-      static std::uint8_t encode_program_byte(apx::ProgramType program_type, bool is_dynamic, bool is_queued, std::uint8_t data_size_variant)
+      static std::uint8_t encode_program_byte(apx::ProgramType program_type, bool is_dynamic, bool is_queued, bool has_nesting_depth, std::uint8_t data_size_variant)
       {
          std::uint8_t retval = (program_type == apx::ProgramType::Pack)? HEADER_PROG_TYPE_PACK : HEADER_PROG_TYPE_UNPACK;
          retval |= (data_size_variant & HEADER_DATA_VARIANT_MASK);
@@ -20,6 +20,10 @@ namespace apx
          {
             retval |= HEADER_FLAG_QUEUED_DATA;
          }
+         if (has_nesting_depth)
+         {
+            retval |= HEADER_FLAG_NESTING_DEPTH;
+         }
          return retval;
       }
 
@@ -142,7 +146,7 @@ namespace apx
          return parse_uint32_by_variant(begin, end, variant, number);
       }
 
-      apx::error_t create_program_header(apx::vm::Program& header, apx::ProgramType program_type, std::uint32_t element_size, std::uint32_t queue_size, bool is_dynamic)
+      apx::error_t create_program_header(apx::vm::Program& header, apx::ProgramType program_type, std::uint32_t element_size, std::uint32_t queue_size, bool is_dynamic, std::uint32_t nesting_depth)
       {
          const std::array < std::uint8_t, MAGIC_NUMBER_SIZE + VERSION_SIZE> fixed_data = {
             HEADER_MAGIC_NUMBER_0 , HEADER_MAGIC_NUMBER_1, MAJOR_VERSION, MINOR_VERSION };
@@ -153,6 +157,11 @@ namespace apx
          std::uint8_t queue_variant = 0u; //Only used when is_queued is true
          std::uint8_t element_variant = 0u; //Only used when is_queued is true
          bool const is_queued = queue_size > 0u;
+         bool const has_nesting_depth = nesting_depth > 0u;
+         if (nesting_depth > UINT8_MAX)
+         {
+            nesting_depth = UINT8_MAX; //The nesting depth is only a preallocation hint, deeper records grow the VM states on demand
+         }
 
          header.insert(header.end(), fixed_data.begin(), fixed_data.end());
          if (is_queued)
@@ -190,7 +199,7 @@ namespace apx
             p += UINT32_SIZE;
          }
          assert((p > encoded_size.data()) && ((p - encoded_size.data()) <= sizeof(encoded_size)));
-         std::uint8_t program_byte = encode_program_byte(program_type, is_dynamic, is_queued, data_size_variant);
+         std::uint8_t program_byte = encode_program_byte(program_type, is_dynamic, is_queued, has_nesting_depth, data_size_variant);
          header.push_back(program_byte);
          header.insert(header.end(), encoded_size.data(), p);
          if (is_queued)
@@ -221,6 +230,10 @@ namespace apx
             assert((p > encoded_size.data()) && ((p - encoded_size.data()) <= sizeof(encoded_size)));
             header.insert(header.end(), encoded_size.data(), p);
          }
+         if (has_nesting_depth)
+         {
+            header.push_back(static_cast<std::uint8_t>(nesting_depth));
+         }
          return APX_NO_ERROR;
       }
 
@@ -231,6 +244,7 @@ namespace apx
             header.element_size = 0u;
             header.is_dynamic_data = false;
             header.queue_length = 0u;
+            header.nesting_depth = 0u;
             std::size_t size = (end - begin);
             if (size < FIXED_HEADER_SIZE)
             {
@@ -243,13 +257,14 @@ namespace apx
             }
             header.major_version = begin[2];
             header.minor_version = begin[3];
-            if (header.major_version != MAJOR_VERSION || header.minor_version != MINOR_VERSION)
+            if (header.major_version != MAJOR_VERSION || header.minor_version > MINOR_VERSION)
             {
                return APX_VERSION_ERROR;
             }
             std::uint8_t const data_variant = begin[4] & HEADER_DATA_VARIANT_MASK;
             header.prog_type = ((begin[4] & HEADER_PROG_TYPE_PACK) == HEADER_PROG_TYPE_PACK) ? ProgramType::Pack : ProgramType::Unpack;
             bool const is_queued_data = ((begin[4] & HEADER_FLAG_QUEUED_DATA) == HEADER_FLAG_QUEUED_DATA);
+            bool const has_nesting_depth = ((begin[4] & HEADER_FLAG_NESTING_DEPTH) == HEADER_FLAG_NESTING_DEPTH);
             header.is_dynamic_data = ((begin[4] & HEADER_FLAG_DYNAMIC_DATA) == HEADER_FLAG_DYNAMIC_DATA);
             next = begin + FIXED_HEADER_SIZE;
             if (auto result = parse_uint32_by_variant(next, end, data_variant, header.data_size); (result > next) && (result <= end) )
@@ -318,6 +333,14 @@ namespace apx
                }
                header.queue_length = tmp / header.element_size;
             }
+            if (has_nesting_depth)
+            {
+               if (next >= end)
+               {
+                  return APX_PARSE_ERROR;
+               }
+               header.nesting_depth = *next++;
+            }
             return APX_NO_ERROR;
          }
          return APX_INVALID_ARGUMENT_ERROR;
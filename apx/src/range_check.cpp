@@ -0,0 +1,256 @@
+/*****************************************************************************
+* \file      range_check.cpp
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Range checks over contiguous integer arrays (SSE2/AVX2 with scalar fallback)
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#include <type_traits>
+#include "cpp-apx/range_check.h"
+
+#if defined(__x86_64__) || defined(_M_X64)
+#define APX_RANGE_CHECK_X86 1
+#include <immintrin.h>
+#if defined(_MSC_VER) && !defined(__clang__)
+#include <intrin.h>
+#define APX_TARGET_AVX2
+#else
+#define APX_TARGET_AVX2 __attribute__((target("avx2")))
+#endif
+#endif
+
+namespace apx
+{
+   namespace vm
+   {
+      template <typename T> static bool in_range_scalar(T const* data, std::size_t length, T lower_limit, T upper_limit)
+      {
+         for (std::size_t i = 0u; i < length; i++)
+         {
+            if ((data[i] < lower_limit) || (data[i] > upper_limit))
+            {
+               return false;
+            }
+         }
+         return true;
+      }
+
+#ifdef APX_RANGE_CHECK_X86
+
+      static bool cpu_has_avx2()
+      {
+#if defined(_MSC_VER) && !defined(__clang__)
+         int info[4];
+         __cpuid(info, 0);
+         if (info[0] < 7)
+         {
+            return false;
+         }
+         __cpuid(info, 1);
+         bool const has_avx = (info[2] & (1 << 28)) != 0;
+         bool const os_saves_ymm = has_avx && ((info[2] & (1 << 27)) != 0) && ((_xgetbv(0) & 0x6u) == 0x6u);
+         __cpuidex(info, 7, 0);
+         return os_saves_ymm && ((info[1] & (1 << 5)) != 0);
+#else
+         __builtin_cpu_init();
+         return __builtin_cpu_supports("avx2") != 0;
+#endif
+      }
+
+      static bool const has_avx2 = cpu_has_avx2();
+
+      /*
+      * Only signed compare instructions exist. Unsigned elements and limits are XOR:ed with the sign bit
+      * which maps them onto the signed range while keeping their order.
+      */
+      template <typename T> static constexpr std::make_signed_t<T> sign_bias()
+      {
+         using S = std::make_signed_t<T>;
+         return std::is_signed_v<T> ? S{ 0 } : static_cast<S>(static_cast<std::make_unsigned_t<T>>(1u) << (sizeof(T) * 8u - 1u));
+      }
+
+      template <std::size_t ElementSize> struct Sse2Ops;
+      template <> struct Sse2Ops<1>
+      {
+         static __m128i set1(std::int64_t v) { return _mm_set1_epi8(static_cast<char>(v)); }
+         static __m128i cmpgt(__m128i a, __m128i b) { return _mm_cmpgt_epi8(a, b); }
+      };
+      template <> struct Sse2Ops<2>
+      {
+         static __m128i set1(std::int64_t v) { return _mm_set1_epi16(static_cast<short>(v)); }
+         static __m128i cmpgt(__m128i a, __m128i b) { return _mm_cmpgt_epi16(a, b); }
+      };
+      template <> struct Sse2Ops<4>
+      {
+         static __m128i set1(std::int64_t v) { return _mm_set1_epi32(static_cast<int>(v)); }
+         static __m128i cmpgt(__m128i a, __m128i b) { return _mm_cmpgt_epi32(a, b); }
+      };
+
+      template <typename T> static bool in_range_sse2(T const* data, std::size_t length, T lower_limit, T upper_limit)
+      {
+         using Ops = Sse2Ops<sizeof(T)>;
+         constexpr std::size_t lanes = sizeof(__m128i) / sizeof(T);
+         __m128i const bias = Ops::set1(sign_bias<T>());
+         __m128i const lower = _mm_xor_si128(Ops::set1(static_cast<std::int64_t>(lower_limit)), bias);
+         __m128i const upper = _mm_xor_si128(Ops::set1(static_cast<std::int64_t>(upper_limit)), bias);
+         __m128i outside = _mm_setzero_si128();
+         std::size_t i = 0u;
+         for (; i + lanes <= length; i += lanes)
+         {
+            __m128i const x = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<__m128i const*>(data + i)), bias);
+            outside = _mm_or_si128(outside, _mm_or_si128(Ops::cmpgt(lower, x), Ops::cmpgt(x, upper)));
+         }
+         return (_mm_movemask_epi8(outside) == 0) && in_range_scalar(data + i, length - i, lower_limit, upper_limit);
+      }
+
+      template <std::size_t ElementSize> struct Avx2Ops;
+      template <> struct Avx2Ops<1>
+      {
+         APX_TARGET_AVX2 static __m256i set1(std::int64_t v) { return _mm256_set1_epi8(static_cast<char>(v)); }
+         APX_TARGET_AVX2 static __m256i cmpgt(__m256i a, __m256i b) { return _mm256_cmpgt_epi8(a, b); }
+      };
+      template <> struct Avx2Ops<2>
+      {
+         APX_TARGET_AVX2 static __m256i set1(std::int64_t v) { return _mm256_set1_epi16(static_cast<short>(v)); }
+         APX_TARGET_AVX2 static __m256i cmpgt(__m256i a, __m256i b) { return _mm256_cmpgt_epi16(a, b); }
+      };
+      template <> struct Avx2Ops<4>
+      {
+         APX_TARGET_AVX2 static __m256i set1(std::int64_t v) { return _mm256_set1_epi32(static_cast<int>(v)); }
+         APX_TARGET_AVX2 static __m256i cmpgt(__m256i a, __m256i b) { return _mm256_cmpgt_epi32(a, b); }
+      };
+      template <> struct Avx2Ops<8>
+      {
+         APX_TARGET_AVX2 static __m256i set1(std::int64_t v) { return _mm256_set1_epi64x(static_cast<long long>(v)); }
+         APX_TARGET_AVX2 static __m256i cmpgt(__m256i a, __m256i b) { return _mm256_cmpgt_epi64(a, b); }
+      };
+
+      template <typename T> APX_TARGET_AVX2 static bool in_range_avx2(T const* data, std::size_t length, T lower_limit, T upper_limit)
+      {
+         using Ops = Avx2Ops<sizeof(T)>;
+         constexpr std::size_t lanes = sizeof(__m256i) / sizeof(T);
+         __m256i const bias = Ops::set1(sign_bias<T>());
+         __m256i const lower = _mm256_xor_si256(Ops::set1(static_cast<std::int64_t>(lower_limit)), bias);
+         __m256i const upper = _mm256_xor_si256(Ops::set1(static_cast<std::int64_t>(upper_limit)), bias);
+         __m256i outside = _mm256_setzero_si256();
+         std::size_t i = 0u;
+         for (; i + lanes <= length; i += lanes)
+         {
+            __m256i const x = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<__m256i const*>(data + i)), bias);
+            outside = _mm256_or_si256(outside, _mm256_or_si256(Ops::cmpgt(lower, x), Ops::cmpgt(x, upper)));
+         }
+         return (_mm256_testz_si256(outside, outside) != 0) && in_range_scalar(data + i, length - i, lower_limit, upper_limit);
+      }
+
+#endif
+
+#ifdef UNIT_TEST
+      static RangeCheckKernel forced_kernel = RangeCheckKernel::Auto;
+
+      bool set_range_check_kernel(RangeCheckKernel kernel)
+      {
+         switch (kernel)
+         {
+         case RangeCheckKernel::Auto:
+         case RangeCheckKernel::Scalar:
+            break;
+#ifdef APX_RANGE_CHECK_X86
+         case RangeCheckKernel::Sse2:
+            break;
+         case RangeCheckKernel::Avx2:
+            if (!has_avx2)
+            {
+               return false;
+            }
+            break;
+#endif
+         default:
+            return false;
+         }
+         forced_kernel = kernel;
+         return true;
+      }
+#endif
+
+      template <typename T> static bool in_range(T const* data, std::size_t length, T lower_limit, T upper_limit)
+      {
+#ifdef APX_RANGE_CHECK_X86
+#ifdef UNIT_TEST
+         bool const use_avx2 = (forced_kernel == RangeCheckKernel::Auto) ? has_avx2 : (forced_kernel == RangeCheckKernel::Avx2);
+         bool const use_sse2 = (forced_kernel == RangeCheckKernel::Auto) || (forced_kernel == RangeCheckKernel::Sse2);
+#else
+         bool const use_avx2 = has_avx2;
+         bool const use_sse2 = true;
+#endif
+         if (use_avx2)
+         {
+            return in_range_avx2(data, length, lower_limit, upper_limit);
+         }
+         if constexpr (sizeof(T) < 8u) //SSE2 has no 64-bit compare
+         {
+            if (use_sse2)
+            {
+               return in_range_sse2(data, length, lower_limit, upper_limit);
+            }
+         }
+#endif
+         return in_range_scalar(data, length, lower_limit, upper_limit);
+      }
+
+      bool elements_in_range(std::uint8_t const* data, std::size_t length, std::uint8_t lower_limit, std::uint8_t upper_limit)
+      {
+         return in_range(data, length, lower_limit, upper_limit);
+      }
+
+      bool elements_in_range(std::uint16_t const* data, std::size_t length, std::uint16_t lower_limit, std::uint16_t upper_limit)
+      {
+         return in_range(data, length, lower_limit, upper_limit);
+      }
+
+      bool elements_in_range(std::uint32_t const* data, std::size_t length, std::uint32_t lower_limit, std::uint32_t upper_limit)
+      {
+         return in_range(data, length, lower_limit, upper_limit);
+      }
+
+      bool elements_in_range(std::uint64_t const* data, std::size_t length, std::uint64_t lower_limit, std::uint64_t upper_limit)
+      {
+         return in_range(data, length, lower_limit, upper_limit);
+      }
+
+      bool elements_in_range(std::int8_t const* data, std::size_t length, std::int8_t lower_limit, std::int8_t upper_limit)
+      {
+         return in_range(data, length, lower_limit, upper_limit);
+      }
+
+      bool elements_in_range(std::int16_t const* data, std::size_t length, std::int16_t lower_limit, std::int16_t upper_limit)
+      {
+         return in_range(data, length, lower_limit, upper_limit);
+      }
+
+      bool elements_in_range(std::int32_t const* data, std::size_t length, std::int32_t lower_limit, std::int32_t upper_limit)
+      {
+         return in_range(data, length, lower_limit, upper_limit);
+      }
+
+      bool elements_in_range(std::int64_t const* data, std::size_t length, std::int64_t lower_limit, std::int64_t upper_limit)
+      {
+         return in_range(data, length, lower_limit, upper_limit);
+      }
+   }
+}
@@ -105,6 +105,19 @@ namespace rmf
       return required_size;
    }
 
+   std::size_t encode_resume_file_cmd(std::uint8_t* buf, std::size_t buf_size, std::uint32_t address)
+   {
+      std::size_t const required_size = rmf::CMD_TYPE_SIZE + rmf::FILE_RESUME_CMD_SIZE;
+      if ( (address > HIGH_ADDR_MAX) || (required_size > buf_size) )
+      {
+         return 0;
+      }
+      std::uint8_t* p{ buf };
+      apx::packLE<std::uint32_t>(p, rmf::CMD_RESUME_FILE_MSG); p += sizeof(std::uint32_t);
+      apx::packLE<std::uint32_t>(p, address); p += sizeof(std::uint32_t);
+      return required_size;
+   }
+
    std::size_t encode_acknowledge_cmd(std::uint8_t* buf, std::size_t buf_size)
    {
       std::size_t const required_size = CMD_TYPE_SIZE;
@@ -0,0 +1,211 @@
+/*****************************************************************************
+* \file      routing_table.cpp
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Precomputed port data routing for APX servers
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#include <algorithm>
+#include <cassert>
+#include "cpp-apx/routing_table.h"
+
+namespace apx
+{
+   bool is_connectable(PortInstance const* provide_port, PortInstance const* require_port)
+   {
+      return (provide_port != nullptr) && (require_port != nullptr) &&
+         (provide_port->port_type() == PortType::ProvidePort) &&
+         (require_port->port_type() == PortType::RequirePort) &&
+         (provide_port->data_size() == require_port->data_size()) &&
+         (provide_port->pack_program() == require_port->pack_program());
+   }
+
+   void RoutingTable::attach(ServerConnection* connection, NodeInstance* node_instance)
+   {
+      assert(node_instance != nullptr);
+      if (is_attached(node_instance))
+      {
+         return;
+      }
+      auto& entry = m_nodes[node_instance];
+      entry.connection = connection;
+      std::size_t const num_provide_ports = node_instance->get_num_provide_ports();
+      entry.provide_routes.resize(num_provide_ports);
+      for (std::size_t i = 0u; i < num_provide_ports; i++)
+      {
+         auto* provide_port = node_instance->get_provide_port(static_cast<port_id_t>(i));
+         auto& routes = entry.provide_routes[i];
+         routes.offset = provide_port->data_offset();
+         routes.size = static_cast<std::uint32_t>(provide_port->data_size());
+         auto it = m_requirers.find(provide_port->name());
+         if (it != m_requirers.end())
+         {
+            for (auto& ref : it->second)
+            {
+               //Require ports already connected to an earlier provider keep it
+               if ( (ref.provider == nullptr) && is_connectable(provide_port, ref.port_instance) )
+               {
+                  add_route(routes, m_nodes[ref.node_instance].connection, ref.node_instance, ref.port_instance);
+                  ref.provider = provide_port;
+               }
+            }
+         }
+         m_providers[provide_port->name()].push_back(PortRef{ node_instance, provide_port, nullptr });
+      }
+      for (std::size_t i = 0u; i < node_instance->get_num_require_ports(); i++)
+      {
+         auto* require_port = node_instance->get_require_port(static_cast<port_id_t>(i));
+         auto& requirers = m_requirers[require_port->name()];
+         requirers.push_back(PortRef{ node_instance, require_port, nullptr });
+         connect_to_first_provider(requirers.back());
+      }
+   }
+
+   void RoutingTable::detach(NodeInstance* node_instance)
+   {
+      auto node_it = m_nodes.find(node_instance);
+      if (node_it == m_nodes.end())
+      {
+         return;
+      }
+      for (std::size_t i = 0u; i < node_instance->get_num_require_ports(); i++)
+      {
+         auto* require_port = node_instance->get_require_port(static_cast<port_id_t>(i));
+         auto it = m_requirers.find(require_port->name());
+         if (it == m_requirers.end())
+         {
+            continue;
+         }
+         for (auto const& ref : it->second)
+         {
+            if ( (ref.port_instance == require_port) && (ref.provider != nullptr) )
+            {
+               auto& actions = m_nodes[ref.provider->node_instance()].provide_routes[ref.provider->port_id()].actions;
+               actions.erase(std::remove_if(actions.begin(), actions.end(),
+                  [node_instance](RouteAction const& action) { return action.node_instance == node_instance; }), actions.end());
+            }
+         }
+         remove_port_ref(it->second, node_instance);
+         if (it->second.empty())
+         {
+            m_requirers.erase(it);
+         }
+      }
+      for (std::size_t i = 0u; i < node_instance->get_num_provide_ports(); i++)
+      {
+         auto* provide_port = node_instance->get_provide_port(static_cast<port_id_t>(i));
+         auto it = m_providers.find(provide_port->name());
+         if (it != m_providers.end())
+         {
+            remove_port_ref(it->second, node_instance);
+            if (it->second.empty())
+            {
+               m_providers.erase(it);
+            }
+         }
+      }
+      m_nodes.erase(node_it);
+      //Reconnect require ports that lost their provider
+      for (std::size_t i = 0u; i < node_instance->get_num_provide_ports(); i++)
+      {
+         auto* provide_port = node_instance->get_provide_port(static_cast<port_id_t>(i));
+         auto it = m_requirers.find(provide_port->name());
+         if (it == m_requirers.end())
+         {
+            continue;
+         }
+         for (auto& ref : it->second)
+         {
+            if (ref.provider == provide_port)
+            {
+               ref.provider = nullptr;
+               connect_to_first_provider(ref);
+            }
+         }
+      }
+   }
+
+   void RoutingTable::detach_connection(ServerConnection* connection)
+   {
+      std::vector<NodeInstance*> node_instances;
+      for (auto const& it : m_nodes)
+      {
+         if (it.second.connection == connection)
+         {
+            node_instances.push_back(const_cast<NodeInstance*>(it.first));
+         }
+      }
+      for (auto* node_instance : node_instances)
+      {
+         detach(node_instance);
+      }
+   }
+
+   PortInstance* RoutingTable::find_provider(PortInstance const* require_port) const
+   {
+      auto it = m_requirers.find(require_port->name());
+      if (it != m_requirers.end())
+      {
+         for (auto const& ref : it->second)
+         {
+            if (ref.port_instance == require_port)
+            {
+               return ref.provider;
+            }
+         }
+      }
+      return nullptr;
+   }
+
+   std::vector<PortRoutes> const* RoutingTable::get_routes(NodeInstance const* node_instance) const
+   {
+      auto it = m_nodes.find(node_instance);
+      return (it != m_nodes.end()) ? &it->second.provide_routes : nullptr;
+   }
+
+   void RoutingTable::add_route(PortRoutes& routes, ServerConnection* connection, NodeInstance* node_instance, PortInstance const* require_port)
+   {
+      routes.actions.push_back(RouteAction{ connection, node_instance, require_port->data_offset(), static_cast<std::uint32_t>(require_port->data_size()) });
+   }
+
+   void RoutingTable::connect_to_first_provider(PortRef& requirer)
+   {
+      auto it = m_providers.find(requirer.port_instance->name());
+      if (it == m_providers.end())
+      {
+         return;
+      }
+      for (auto const& ref : it->second)
+      {
+         if ( (ref.node_instance != requirer.node_instance) && is_connectable(ref.port_instance, requirer.port_instance) )
+         {
+            auto& routes = m_nodes[ref.node_instance].provide_routes[ref.port_instance->port_id()];
+            add_route(routes, m_nodes[requirer.node_instance].connection, requirer.node_instance, requirer.port_instance);
+            requirer.provider = ref.port_instance;
+            return;
+         }
+      }
+   }
+
+   void RoutingTable::remove_port_ref(std::vector<PortRef>& refs, NodeInstance const* node_instance)
+   {
+      refs.erase(std::remove_if(refs.begin(), refs.end(),
+         [node_instance](PortRef const& ref) { return ref.node_instance == node_instance; }), refs.end());
+   }
+}
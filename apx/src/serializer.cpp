@@ -3,6 +3,7 @@
 #include "cpp-apx/serializer.h"
 #include "cpp-apx/pack.h"
 #include "cpp-apx/program.h"
+#include "cpp-apx/typed_array.h"
 
 namespace apx
 {
@@ -11,7 +12,7 @@ namespace apx
       void Serializer::State::reset(dtl::ValueType vt)
       {
          value_type = vt;
-         field_name.clear();
+         field_key = dtl::HashedKey{};
          index = 0u;
          array_len = 0u;
          max_array_len = 0u;
@@ -41,6 +42,9 @@ namespace apx
          case dtl::ValueType::Hash:
             value.hv = dynamic_cast<dtl::Hash const*>(dv);
             break;
+         case dtl::ValueType::TypedArray:
+            value.ta = dynamic_cast<dtl::TypedArrayBase const*>(dv);
+            break;
          }
       }
 
@@ -73,7 +77,7 @@ namespace apx
          return read_scalar_value(sv, type_code_arg);
       }
 
-      dtl::Value const* Serializer::State::get_child_value(const char* key)
+      dtl::Value const* Serializer::State::get_child_value(dtl::HashedKey const& key)
       {
          if (value_type == dtl::ValueType::Hash)
          {
@@ -104,13 +108,16 @@ namespace apx
             }
             else if (sv_type == dtl::ScalarType::ByteArray)
             {
-               auto tmp = value.sv->get_byte_array();
+               auto const& tmp = value.sv->get_bytes();
                array_len = tmp.size();
             }
             break;
          case dtl::ValueType::Array:
             array_len = value.av->length();
             break;
+         case dtl::ValueType::TypedArray:
+            array_len = value.ta->length();
+            break;
          case dtl::ValueType::NoneType: //NOT ARRAY-COMPATIBLE
          case dtl::ValueType::Hash:     //NOT ARRAY-COMPATIBLE
          default:
@@ -191,25 +198,23 @@ namespace apx
          return retval;
       }
 
-      Serializer::~Serializer()
+      void Serializer::reset()
       {
-         reset();
-         if (m_state != nullptr)
-         {
-            delete m_state;
-         }
+         m_depth = 0u;
+         m_state = &m_states[m_depth];
+         clear_value();
       }
 
-      void Serializer::reset()
+      /*
+      * Preallocates states for nesting_depth nested records (see ProgramHeader::nesting_depth).
+      */
+      void Serializer::reserve_nesting_depth(std::size_t nesting_depth)
       {
-         while (m_stack.size() > 0)
+         if (m_states.size() <= nesting_depth)
          {
-            delete m_state;
-            m_state = m_stack.top();
-            assert(m_state != nullptr);
-            m_stack.pop();
+            m_states.resize(nesting_depth + 1u);
+            m_state = &m_states[m_depth];
          }
-         clear_value();
       }
 
       apx::error_t Serializer::set_write_buffer(std::uint8_t* buf, std::size_t len)
@@ -248,6 +253,11 @@ namespace apx
          return set_value(hv.get());
       }
 
+      apx::error_t Serializer::set_value(dtl::TypedArrayValue ta)
+      {
+         return set_value(ta.get());
+      }
+
       void Serializer::clear_value()
       {
          m_state->value_type = dtl::ValueType::NoneType;
@@ -501,6 +511,18 @@ namespace apx
                m_state->range_check_state = RangeCheckState::CheckFail;
             }
          }
+         else if (m_state->value_type == dtl::ValueType::TypedArray)
+         {
+            if (typed_array_in_range(m_state->value.ta, lower_limit, upper_limit))
+            {
+               m_state->range_check_state = RangeCheckState::CheckOK;
+            }
+            else
+            {
+               m_state->range_check_state = RangeCheckState::CheckFail;
+               retval = APX_VALUE_RANGE_ERROR;
+            }
+         }
          else if (m_state->value_type == dtl::ValueType::Array)
          {
             std::size_t length = m_state->value.av->length();
@@ -556,6 +578,18 @@ namespace apx
                m_state->range_check_state = RangeCheckState::CheckFail;
             }
          }
+         else if (m_state->value_type == dtl::ValueType::TypedArray)
+         {
+            if (typed_array_in_range(m_state->value.ta, lower_limit, upper_limit))
+            {
+               m_state->range_check_state = RangeCheckState::CheckOK;
+            }
+            else
+            {
+               m_state->range_check_state = RangeCheckState::CheckFail;
+               retval = APX_VALUE_RANGE_ERROR;
+            }
+         }
          else if (m_state->value_type == dtl::ValueType::Array)
          {
             std::size_t length = m_state->value.av->length();
@@ -612,6 +646,18 @@ namespace apx
                m_state->range_check_state = RangeCheckState::CheckFail;
             }
          }
+         else if (m_state->value_type == dtl::ValueType::TypedArray)
+         {
+            if (typed_array_in_range(m_state->value.ta, lower_limit, upper_limit))
+            {
+               m_state->range_check_state = RangeCheckState::CheckOK;
+            }
+            else
+            {
+               m_state->range_check_state = RangeCheckState::CheckFail;
+               retval = APX_VALUE_RANGE_ERROR;
+            }
+         }
          else if (m_state->value_type == dtl::ValueType::Array)
          {
             std::size_t length = m_state->value.av->length();
@@ -668,6 +714,18 @@ namespace apx
                m_state->range_check_state = RangeCheckState::CheckFail;
             }
          }
+         else if (m_state->value_type == dtl::ValueType::TypedArray)
+         {
+            if (typed_array_in_range(m_state->value.ta, lower_limit, upper_limit))
+            {
+               m_state->range_check_state = RangeCheckState::CheckOK;
+            }
+            else
+            {
+               m_state->range_check_state = RangeCheckState::CheckFail;
+               retval = APX_VALUE_RANGE_ERROR;
+            }
+         }
          else if (m_state->value_type == dtl::ValueType::Array)
          {
             std::size_t length = m_state->value.av->length();
@@ -699,9 +757,9 @@ namespace apx
          return retval;
       }
 
-      apx::error_t Serializer::record_select(const char* key, bool is_last_field)
+      apx::error_t Serializer::record_select(dtl::HashedKey const& key, bool is_last_field)
       {
-         if (key != nullptr)
+         if (!key.key.empty())
          {
             if (m_state->value_type == dtl::ValueType::Hash)
             {
@@ -710,7 +768,7 @@ namespace apx
                {
                   return APX_NOT_FOUND_ERROR;
                }
-               m_state->set_field_name(key, is_last_field);
+               m_state->set_field_key(key, is_last_field);
                enter_new_child_state();
                m_state->set_value(child_value); //m_state on this line is the newly entered child_state
                return APX_NO_ERROR;
@@ -957,6 +1015,10 @@ namespace apx
 
       apx::error_t Serializer::pack_array_of_scalar()
       {
+         if (m_state->value_type == dtl::ValueType::TypedArray)
+         {
+            return pack_typed_array();
+         }
          if (m_state->value_type != dtl::ValueType::Array)
          {
             return APX_VALUE_TYPE_ERROR;
@@ -995,6 +1057,73 @@ namespace apx
          return APX_NO_ERROR;
       }
 
+      apx::error_t Serializer::pack_typed_array()
+      {
+         assert(m_state->value.ta != nullptr);
+         std::size_t const length = m_state->value.ta->length();
+         if ((m_state->dynamic_size_type == apx::SizeType::None) && (length != m_state->array_len))
+         {
+            return APX_VALUE_LENGTH_ERROR; //For non-dynamic arrays the array length of the value must match exactly.
+         }
+         if (m_state->range_check_state == RangeCheckState::NotChecked)
+         {
+            auto result = default_range_check_typed_array();
+            if (result != APX_NO_ERROR)
+            {
+               return result;
+            }
+         }
+         else if (m_state->range_check_state == RangeCheckState::CheckFail)
+         {
+            return APX_VALUE_RANGE_ERROR;
+         }
+         std::size_t const data_size = length * m_state->element_size;
+         if ((m_buffer.next + data_size) > m_buffer.end)
+         {
+            return APX_BUFFER_BOUNDARY_ERROR;
+         }
+         apx::error_t retval = APX_NO_ERROR;
+         std::uint8_t* dst = m_buffer.next;
+         TypeCode const type_code = m_state->type_code;
+         bool const is_known_type = dtl::visit_ta(m_state->value.ta, [&](auto const& array)
+            {
+               auto const* src = array.data();
+               switch (type_code)
+               {
+               case TypeCode::UInt8:
+               case TypeCode::Int8:
+                  pack_typed_elements<std::uint8_t>(dst, src, length);
+                  break;
+               case TypeCode::UInt16:
+               case TypeCode::Int16:
+                  pack_typed_elements<std::uint16_t>(dst, src, length);
+                  break;
+               case TypeCode::UInt32:
+               case TypeCode::Int32:
+                  pack_typed_elements<std::uint32_t>(dst, src, length);
+                  break;
+               case TypeCode::UInt64:
+               case TypeCode::Int64:
+                  pack_typed_elements<std::uint64_t>(dst, src, length);
+                  break;
+               case TypeCode::Bool:
+                  pack_typed_elements<std::uint8_t, true>(dst, src, length);
+                  break;
+               default:
+                  retval = APX_UNSUPPORTED_ERROR;
+               }
+            });
+         if (!is_known_type)
+         {
+            retval = APX_VALUE_TYPE_ERROR;
+         }
+         if (retval == APX_NO_ERROR)
+         {
+            m_buffer.next += data_size;
+         }
+         return retval;
+      }
+
       apx::error_t Serializer::pack_scalar_value_internal()
       {
          apx::error_t retval = APX_NO_ERROR;
@@ -1129,7 +1258,7 @@ namespace apx
             return APX_VALUE_TYPE_ERROR;
          }
          auto const array_len{ m_state->array_len };
-         auto const byte_array = m_state->value.sv->get_byte_array();
+         auto const& byte_array = m_state->value.sv->get_bytes();
          if ( (m_state->dynamic_size_type == apx::SizeType::None) && (array_len > 0u) )
          {
             if (array_len != byte_array.size()) //For non-dynamic arrays the length of the value must match exactly.
@@ -1224,6 +1353,45 @@ namespace apx
          return retval;
       }
 
+      apx::error_t Serializer::default_range_check_typed_array()
+      {
+         bool in_range{ false };
+         auto const* ta = m_state->value.ta;
+         switch (m_state->type_code)
+         {
+         case TypeCode::UInt8:
+            in_range = typed_array_in_range<std::uint64_t>(ta, 0u, UINT8_MAX);
+            break;
+         case TypeCode::UInt16:
+            in_range = typed_array_in_range<std::uint64_t>(ta, 0u, UINT16_MAX);
+            break;
+         case TypeCode::UInt32:
+            in_range = typed_array_in_range<std::uint64_t>(ta, 0u, UINT32_MAX);
+            break;
+         case TypeCode::UInt64:
+            in_range = typed_array_in_range<std::uint64_t>(ta, 0u, UINT64_MAX);
+            break;
+         case TypeCode::Int8:
+            in_range = typed_array_in_range<std::int64_t>(ta, INT8_MIN, INT8_MAX);
+            break;
+         case TypeCode::Int16:
+            in_range = typed_array_in_range<std::int64_t>(ta, INT16_MIN, INT16_MAX);
+            break;
+         case TypeCode::Int32:
+            in_range = typed_array_in_range<std::int64_t>(ta, INT32_MIN, INT32_MAX);
+            break;
+         case TypeCode::Int64:
+            in_range = typed_array_in_range<std::int64_t>(ta, INT64_MIN, INT64_MAX);
+            break;
+         case TypeCode::Bool:
+            in_range = true; //Any integer can be stored as bool
+            break;
+         default:
+            return APX_UNSUPPORTED_ERROR;
+         }
+         return in_range ? APX_NO_ERROR : APX_VALUE_RANGE_ERROR;
+      }
+
       apx::error_t apx::vm::Serializer::default_range_check_scalar()
       {
          if (m_state->type_code == TypeCode::Bool)
@@ -1367,12 +1535,9 @@ namespace apx
       void Serializer::pop_state()
       {
          assert(m_state != nullptr);
-         while (m_stack.size() > 0)
+         while (m_depth > 0u)
          {
-            delete m_state;
-            m_state = m_stack.top();
-            assert(m_state != nullptr);
-            m_stack.pop();
+            m_state = &m_states[--m_depth];
             if (!m_state->is_last_field)
             {
                break;
@@ -1382,10 +1547,13 @@ namespace apx
 
       void Serializer::enter_new_child_state()
       {
-         auto child_state = new Serializer::State();
-         child_state->parent = m_state;
-         m_stack.push(m_state);
-         m_state = child_state;
+         if (++m_depth == m_states.size())
+         {
+            m_states.resize(m_depth + 1u); //Only needed when the program header did not reserve enough states
+         }
+         m_state = &m_states[m_depth];
+         m_state->reset(dtl::ValueType::NoneType);
+         m_state->value.dv = nullptr;
       }
 
       apx::error_t Serializer::write_dynamic_value_to_buffer(std::size_t value, apx::SizeType size_type)
@@ -0,0 +1,356 @@
+/*****************************************************************************
+* \file      server.cpp
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     APX server
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include "cpp-apx/server.h"
+
+namespace apx
+{
+   Server::~Server()
+   {
+#ifndef UNIT_TEST
+      stop();
+#endif
+   }
+
+   ServerConnection* Server::attach_connection(std::unique_ptr<ServerConnection> connection)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto* retval = connection.get();
+      retval->set_connection_id(m_next_connection_id++);
+      m_connections.push_back(std::move(connection));
+      return retval;
+   }
+
+   std::size_t Server::num_connections()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_connections.size();
+   }
+
+   std::size_t Server::num_attached_nodes()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_routing_table.num_nodes();
+   }
+
+#ifdef UNIT_TEST
+   SocketServerConnection* Server::accept_test_socket(testsocket_t* test_socket)
+   {
+      auto connection = std::make_unique<SocketServerConnection>(test_socket, this);
+      auto* retval = connection.get();
+      attach_connection(std::move(connection));
+      return retval;
+   }
+
+   void Server::run()
+   {
+      std::vector<ServerConnection*> connections;
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         m_closed_connections.clear();
+         for (auto& connection : m_connections)
+         {
+            connections.push_back(connection.get());
+         }
+      }
+      for (auto* connection : connections)
+      {
+         connection->run();
+      }
+   }
+#else
+   error_t Server::start_tcp(std::uint16_t port)
+   {
+      auto* socket_server = msocket_server_new(AF_INET, nullptr);
+      if (socket_server == nullptr)
+      {
+         return APX_MEM_ERROR;
+      }
+      start_housekeeping();
+      msocket_server_set_new_connection_cb(socket_server, on_new_connection, this);
+      msocket_server_start(socket_server, nullptr, 0u, port);
+      m_socket_servers.push_back(socket_server);
+      return APX_NO_ERROR;
+   }
+
+# ifndef _WIN32
+   error_t Server::start_unix(char const* path)
+   {
+      auto* socket_server = msocket_server_new(AF_LOCAL, nullptr);
+      if (socket_server == nullptr)
+      {
+         return APX_MEM_ERROR;
+      }
+      start_housekeeping();
+      msocket_server_set_new_connection_cb(socket_server, on_new_connection, this);
+      msocket_server_start(socket_server, path, static_cast<std::uint16_t>(std::strlen(path)), 0u);
+      m_socket_servers.push_back(socket_server);
+      return APX_NO_ERROR;
+   }
+
+   error_t Server::start_unix(std::string const& path)
+   {
+      return start_unix(path.data());
+   }
+# endif
+
+   void Server::stop()
+   {
+      for (auto* socket_server : m_socket_servers)
+      {
+         msocket_server_delete(socket_server);
+      }
+      m_socket_servers.clear();
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         m_is_housekeeping_running = false;
+      }
+      m_housekeeping_cond.notify_one();
+      if (m_housekeeping_thread.joinable())
+      {
+         m_housekeeping_thread.join();
+      }
+      std::vector<std::unique_ptr<ServerConnection>> connections;
+      {
+         std::lock_guard<std::mutex> lock(m_mutex);
+         connections.swap(m_connections);
+         for (auto& connection : m_closed_connections)
+         {
+            connections.push_back(std::move(connection));
+         }
+         m_closed_connections.clear();
+         m_routing_table = RoutingTable{};
+      }
+      for (auto& connection : connections)
+      {
+         connection->stop();
+      }
+   }
+
+   void Server::start_housekeeping()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      if (!m_is_housekeeping_running)
+      {
+         m_is_housekeeping_running = true;
+         m_housekeeping_thread = std::thread([this] { housekeeping_main(); });
+      }
+   }
+
+   /*
+   * Event loop of the server itself. Wakes up when a connection closes, and at least once every SERVER_HOUSEKEEPING_INTERVAL.
+   */
+   void Server::housekeeping_main()
+   {
+      std::unique_lock<std::mutex> lock(m_mutex);
+      while (m_is_housekeeping_running)
+      {
+         m_housekeeping_cond.wait_for(lock, SERVER_HOUSEKEEPING_INTERVAL,
+            [this] { return !m_is_housekeeping_running || !m_closed_connections.empty(); });
+         delete_closed_connections(lock);
+      }
+   }
+
+   /*
+   * Stopping a connection joins its worker thread and deleting it joins its socket thread, so neither can be done
+   * from the socket thread that reported the disconnect. m_mutex is released while doing it.
+   */
+   void Server::delete_closed_connections(std::unique_lock<std::mutex>& lock)
+   {
+      if (m_closed_connections.empty())
+      {
+         return;
+      }
+      std::vector<std::unique_ptr<ServerConnection>> closed_connections;
+      closed_connections.swap(m_closed_connections);
+      lock.unlock();
+      for (auto& connection : closed_connections)
+      {
+         connection->stop();
+      }
+      closed_connections.clear();
+      lock.lock();
+   }
+
+   void Server::on_new_connection(void* arg, msocket_t* socket)
+   {
+      auto* self = reinterpret_cast<Server*>(arg);
+      if (self != nullptr)
+      {
+         self->accept_socket(socket);
+      }
+   }
+
+   void Server::accept_socket(msocket_t* socket)
+   {
+      auto* connection = attach_connection(std::make_unique<SocketServerConnection>(socket, this));
+      connection->connected();
+      connection->start();
+      msocket_start_io(socket);
+   }
+#endif
+
+   /*
+   * Called from the connection's own context. The connection object is kept alive until it's safe to delete it.
+   */
+   void Server::connection_disconnected(ServerConnection* connection)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_routing_table.detach_connection(connection);
+      auto it = std::find_if(m_connections.begin(), m_connections.end(),
+         [connection](std::unique_ptr<ServerConnection> const& item) { return item.get() == connection; });
+      if (it != m_connections.end())
+      {
+         m_closed_connections.push_back(std::move(*it));
+         m_connections.erase(it);
+      }
+#ifndef UNIT_TEST
+      m_housekeeping_cond.notify_one();
+#endif
+   }
+
+   /*
+   * Connects the new node to nodes that are already attached.
+   * Require ports of the new node receive the current value of their provider.
+   * Require ports of other nodes receive the initial value of the new node's provide ports.
+   */
+   void Server::node_attached(ServerConnection* connection, NodeInstance* node_instance)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_routing_table.attach(connection, node_instance);
+      for (std::size_t i = 0u; i < node_instance->get_num_require_ports(); i++)
+      {
+         auto* require_port = node_instance->get_require_port(static_cast<port_id_t>(i));
+         auto* provide_port = m_routing_table.find_provider(require_port);
+         if (provide_port != nullptr)
+         {
+            //The provider's connection may be writing to its node data concurrently, copy the value under its lock
+            auto* provider_node_data = provide_port->node_instance()->get_node_data();
+            assert(provider_node_data != nullptr);
+            m_attach_buffer.resize(require_port->data_size());
+            if (provider_node_data->read_provide_port_data(provide_port->data_offset(), m_attach_buffer.data(), m_attach_buffer.size()) == APX_NO_ERROR)
+            {
+               connection->write_require_port_data(node_instance, require_port->data_offset(), m_attach_buffer.data(), m_attach_buffer.size());
+            }
+         }
+      }
+      auto* node_data = node_instance->get_node_data();
+      if ( (node_data != nullptr) && (node_data->provide_port_data_size() > 0u) )
+      {
+         m_attach_buffer.resize(node_data->provide_port_data_size());
+         if (node_data->read_provide_port_data(0u, m_attach_buffer.data(), m_attach_buffer.size()) == APX_NO_ERROR)
+         {
+            route_provide_port_data(node_instance, 0u, m_attach_buffer.data(), m_attach_buffer.size());
+         }
+      }
+   }
+
+   /*
+   * Called by a connection when it closes, once for every node whose definition was fully received.
+   */
+   void Server::store_resume_data(std::string const& node_name, NodeResumeData&& data)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto it = m_resume_cache.find(node_name);
+      if (it != m_resume_cache.end())
+      {
+         it->second = std::move(data);
+         return;
+      }
+      if (m_resume_cache.size() >= SERVER_RESUME_CACHE_MAX_NODES)
+      {
+         m_resume_cache.erase(m_resume_cache_order.front());
+         m_resume_cache_order.pop_front();
+      }
+      m_resume_cache.emplace(node_name, std::move(data));
+      m_resume_cache_order.push_back(node_name);
+   }
+
+   /*
+   * Moves the cached data of node_name into data if its definition digest matches.
+   * The entry is removed in both cases since the connection that published the node now owns its state.
+   */
+   bool Server::take_resume_data(std::string const& node_name, std::uint8_t const* definition_digest, NodeResumeData& data)
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      auto it = m_resume_cache.find(node_name);
+      if (it == m_resume_cache.end())
+      {
+         return false;
+      }
+      bool const is_match = std::memcmp(it->second.definition_digest.data(), definition_digest, rmf::SHA256_SIZE) == 0;
+      if (is_match)
+      {
+         data = std::move(it->second);
+      }
+      m_resume_cache.erase(it);
+      m_resume_cache_order.erase(std::find(m_resume_cache_order.begin(), m_resume_cache_order.end(), node_name));
+      return is_match;
+   }
+
+   std::size_t Server::num_resume_entries()
+   {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      return m_resume_cache.size();
+   }
+
+   void Server::provide_port_data_written(ServerConnection* connection, NodeInstance* node_instance, std::uint32_t offset, std::uint8_t const* data, std::size_t size)
+   {
+      (void)connection;
+      std::lock_guard<std::mutex> lock(m_mutex);
+      route_provide_port_data(node_instance, offset, data, size);
+   }
+
+   /*
+   * Forwards the written byte range to all require ports connected to an affected provide port.
+   * Small writes are copied into each connection's command queue. Larger writes are copied once into
+   * a shared buffer which is then referenced by all connections.
+   */
+   REQUIRES_LOCK_HELD(m_mutex)
+   void Server::route_provide_port_data(NodeInstance const* source, std::uint32_t offset, std::uint8_t const* data, std::size_t size)
+   {
+      SharedBuffer* shared_buffer{ nullptr };
+      m_routing_table.for_each_route(source, offset, size, [data, size, &shared_buffer](RouteAction const& action, std::uint32_t dest_offset, std::size_t data_offset, std::uint32_t write_size)
+         {
+            if (write_size <= COMMAND_INLINE_DATA_MAX_SIZE)
+            {
+               action.connection->write_require_port_data(action.node_instance, dest_offset, data + data_offset, write_size);
+            }
+            else
+            {
+               if (shared_buffer == nullptr)
+               {
+                  shared_buffer = SharedBuffer::create(data, size);
+               }
+               action.connection->write_require_port_data(action.node_instance, dest_offset, shared_buffer, shared_buffer->data() + data_offset, write_size);
+            }
+         });
+      if (shared_buffer != nullptr)
+      {
+         shared_buffer->release();
+      }
+   }
+}
@@ -0,0 +1,569 @@
+/*****************************************************************************
+* \file      server_connection.cpp
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Server connection (abstract) base class
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#include <cassert>
+#include <cstring>
+#include <array>
+#include <iostream>
+#include "cpp-apx/server_connection.h"
+#include "cpp-apx/server.h"
+#include "cpp-apx/numheader.h"
+#include "cpp-apx/trace.h"
+
+namespace apx
+{
+   void ServerConnection::connected()
+   {
+      m_is_greeting_accepted = false;
+   }
+
+   void ServerConnection::disconnected()
+   {
+      m_is_greeting_accepted = false;
+      if (m_parent_server != nullptr)
+      {
+         store_resume_data(); //Must run before the file manager deletes the definition files
+      }
+      m_file_manager.disconnected();
+      if (m_parent_server != nullptr)
+      {
+         m_parent_server->connection_disconnected(this);
+      }
+   }
+
+   error_t ServerConnection::write_require_port_data(NodeInstance* node_instance, std::uint32_t offset, std::uint8_t const* data, std::size_t size)
+   {
+      auto* node_data = node_instance->get_node_data();
+      if (node_data == nullptr)
+      {
+         return APX_NULL_PTR_ERROR;
+      }
+      auto retval = node_data->write_require_port_data(offset, data, size);
+      auto* file = node_instance->get_require_port_data_file();
+      if ( (retval == APX_NO_ERROR) && (file != nullptr) )
+      {
+         if (file->is_open())
+         {
+            retval = m_file_manager.send_local_data_copy(file->get_address_without_flags() + offset, data, size);
+         }
+         else
+         {
+            m_file_manager.mark_local_data_dirty(file->get_address_without_flags() + offset, size);
+         }
+      }
+      return retval;
+   }
+
+   /*
+   * Same as above but transmits data directly from buffer instead of making a private copy.
+   * data must point inside buffer.
+   */
+   error_t ServerConnection::write_require_port_data(NodeInstance* node_instance, std::uint32_t offset, SharedBuffer* buffer, std::uint8_t const* data, std::size_t size)
+   {
+      auto* node_data = node_instance->get_node_data();
+      if (node_data == nullptr)
+      {
+         return APX_NULL_PTR_ERROR;
+      }
+      auto retval = node_data->write_require_port_data(offset, data, size);
+      auto* file = node_instance->get_require_port_data_file();
+      if ( (retval == APX_NO_ERROR) && (file != nullptr) )
+      {
+         if (file->is_open())
+         {
+            retval = m_file_manager.send_local_shared_data(file->get_address_without_flags() + offset, buffer, data, size);
+         }
+         else
+         {
+            m_file_manager.mark_local_data_dirty(file->get_address_without_flags() + offset, size);
+         }
+      }
+      return retval;
+   }
+
+   error_t ServerConnection::remote_file_published_notification(File* file)
+   {
+      auto const base_name = file->get_file_info().base_name();
+      switch (file->get_apx_file_type())
+      {
+      case FileType::Definition:
+      {
+         if (file->get_file_info().size > MAX_FILE_SIZE)
+         {
+            return APX_FILE_TOO_LARGE_ERROR; //The definition buffer is allocated up front from the announced size
+         }
+         auto& node_files = m_node_files[base_name];
+         if (node_files.definition_file != nullptr)
+         {
+            return APX_NODE_ALREADY_EXISTS_ERROR;
+         }
+         node_files.definition_file = file;
+         register_node_file(file, &node_files);
+         file->open();
+         auto const& file_info = file->get_file_info();
+         NodeResumeData resume_data;
+         if ( (m_parent_server != nullptr) && (file_info.digest_type == rmf::DigestType::SHA256) &&
+            m_parent_server->take_resume_data(base_name, file_info.digest_data.data(), resume_data) )
+         {
+            return resume_definition_file(node_files, std::move(resume_data));
+         }
+         node_files.definition_data.resize(file_info.size);
+         return m_file_manager.send_open_file_request(file->get_address_without_flags());
+      }
+      case FileType::ProvidePortData:
+      {
+         auto& node_files = m_node_files[base_name];
+         node_files.provide_port_data_file = file;
+         register_node_file(file, &node_files);
+         if (node_files.node_instance != nullptr)
+         {
+            return open_provide_port_data_file(node_files);
+         }
+         break; //File is opened once the definition has been processed
+      }
+      default:
+         break; //Ignore files we don't know how to handle
+      }
+      return APX_NO_ERROR;
+   }
+
+   error_t ServerConnection::remote_file_write_notification(File* file, std::uint32_t offset, std::uint8_t const* data, std::size_t size)
+   {
+      auto* node_files_ptr = find_node_files(file);
+      if (node_files_ptr == nullptr)
+      {
+         return APX_NO_ERROR;
+      }
+      auto& node_files = *node_files_ptr;
+      switch (file->get_apx_file_type())
+      {
+      case FileType::Definition:
+         return process_definition_data(node_files, offset, data, size);
+      case FileType::ProvidePortData:
+         if (node_files.node_instance != nullptr)
+         {
+            return process_provide_port_data(node_files.node_instance, offset, data, size);
+         }
+         break;
+      default:
+         break;
+      }
+      return APX_NO_ERROR;
+   }
+
+   error_t ServerConnection::file_open_notify(File* file)
+   {
+      auto* node_files = find_node_files(file);
+      if ( (node_files == nullptr) || (file->get_apx_file_type() != FileType::RequirePortData) )
+      {
+         return APX_UNSUPPORTED_ERROR;
+      }
+      auto* node_data = node_files->node_instance->get_node_data();
+      assert(node_data != nullptr);
+      std::size_t const data_size = node_data->require_port_data_size();
+      std::unique_ptr<std::uint8_t[]> snapshot{ new std::uint8_t[data_size] };
+      auto retval = node_data->read_require_port_data(0u, snapshot.get(), data_size);
+      if (retval == APX_NO_ERROR)
+      {
+         retval = m_file_manager.send_local_data(file->get_address_without_flags(), snapshot.release(), data_size);
+      }
+      return retval;
+   }
+
+   error_t ServerConnection::file_close_notify(File* file)
+   {
+      (void)file;
+      return APX_NO_ERROR;
+   }
+
+   error_t ServerConnection::file_write_notify(File* file, std::uint32_t offset, std::uint8_t const* data, std::size_t size)
+   {
+      (void)file;
+      (void)offset;
+      (void)data;
+      (void)size;
+      return APX_NO_ERROR;
+   }
+
+   /*
+   * Besides file resume requests from the client, this is called from the file manager worker thread
+   * when it resends writes that were rejected by the transmit high-water mark.
+   */
+   error_t ServerConnection::file_resume_notify(File* file, std::vector<ByteRange> const& dirty_ranges)
+   {
+      auto* node_files = find_node_files(file);
+      if ( (node_files == nullptr) || (file->get_apx_file_type() != FileType::RequirePortData) )
+      {
+         return APX_UNSUPPORTED_ERROR;
+      }
+      auto* node_data = node_files->node_instance->get_node_data();
+      assert(node_data != nullptr);
+      for (auto const& range : dirty_ranges)
+      {
+         std::unique_ptr<std::uint8_t[]> snapshot{ new std::uint8_t[range.size] };
+         auto retval = node_data->read_require_port_data(range.offset, snapshot.get(), range.size);
+         if (retval == APX_NO_ERROR)
+         {
+            retval = m_file_manager.send_local_data(file->get_address_without_flags() + range.offset, snapshot.release(), range.size);
+         }
+         if (retval != APX_NO_ERROR)
+         {
+            return retval;
+         }
+      }
+      return APX_NO_ERROR;
+   }
+
+   int ServerConnection::on_data_received(std::uint8_t const* data, std::size_t data_size, std::size_t& parse_len)
+   {
+      if (data == nullptr)
+      {
+         set_data_reception_error(APX_NULL_PTR_ERROR);
+         return -1;
+      }
+      std::size_t total_parse_len = 0u;
+      std::uint8_t const* next = data;
+      std::uint8_t const* end = data + data_size;
+      while (next < end)
+      {
+         std::uint8_t const* result;
+         apx::error_t error_code{ APX_NO_ERROR };
+         result = parse_message(next, end, error_code);
+         if (error_code == APX_NO_ERROR)
+         {
+            assert((result >= next) && (result <= end));
+            if (result == next)
+            {
+               break; //Wait for more data to arrive
+            }
+            next = result;
+            total_parse_len = next - data;
+            assert(total_parse_len <= data_size);
+         }
+         else
+         {
+            set_data_reception_error(error_code);
+            return -1;
+         }
+      }
+      parse_len = total_parse_len;
+      return 0;
+   }
+
+   std::uint8_t const* ServerConnection::parse_message(std::uint8_t const* begin, std::uint8_t const* end, apx::error_t& error_code)
+   {
+      APX_TRACE_SCOPE_ARG("ServerConnection::parse_message", end - begin);
+      error_code = APX_NO_ERROR;
+      if (begin >= end)
+      {
+         error_code = APX_PARSE_ERROR;
+         return nullptr;
+      }
+      std::uint32_t msg_size{ 0u };
+      auto header_size = numheader::decode32(begin, end, msg_size);
+      if (header_size == 0)
+      {
+         return begin; //Header is incomplete
+      }
+      std::uint8_t const* msg_data = begin + header_size;
+      std::uint8_t const* msg_end = msg_data + msg_size;
+      if (msg_end > end)
+      {
+         return begin; //Message is incomplete
+      }
+      if (m_is_greeting_accepted)
+      {
+         error_code = m_file_manager.message_received(msg_data, msg_size);
+      }
+      else
+      {
+         error_code = process_greeting(msg_data, msg_size);
+         if (error_code == APX_NO_ERROR)
+         {
+            m_is_greeting_accepted = true;
+            send_acknowledge();
+            m_file_manager.connected();
+         }
+      }
+      return (error_code == APX_NO_ERROR) ? msg_end : nullptr;
+   }
+
+   void ServerConnection::set_data_reception_error(apx::error_t error_code)
+   {
+      std::cout << "Data reception error: " << static_cast<int>(error_code) << std::endl;
+   }
+
+   /*
+   * The greeting is a text message with one header per line, terminated by an empty line.
+   * The first line must be the protocol identifier.
+   */
+   error_t ServerConnection::process_greeting(std::uint8_t const* msg_data, std::size_t msg_size)
+   {
+      std::string const greeting{ reinterpret_cast<char const*>(msg_data), msg_size };
+      std::size_t line_begin = 0u;
+      bool is_first_line = true;
+      while (line_begin < greeting.size())
+      {
+         std::size_t line_end = greeting.find('\n', line_begin);
+         if (line_end == std::string::npos)
+         {
+            line_end = greeting.size();
+         }
+         std::string const line = greeting.substr(line_begin, line_end - line_begin);
+         line_begin = line_end + 1;
+         if (is_first_line)
+         {
+            if (line != "RMFP/1.0")
+            {
+               return APX_INVALID_MSG_ERROR;
+            }
+            is_first_line = false;
+         }
+         else if (line.empty())
+         {
+            break;
+         }
+         else
+         {
+            auto const separator = line.find(':');
+            if (separator == std::string::npos)
+            {
+               return APX_INVALID_MSG_ERROR;
+            }
+            if ( (line.compare(0, separator, "NumHeader-Format") == 0) && (line.compare(separator + 1, std::string::npos, "32") != 0) )
+            {
+               return APX_UNSUPPORTED_ERROR;
+            }
+         }
+      }
+      return is_first_line ? APX_INVALID_MSG_ERROR : APX_NO_ERROR;
+   }
+
+   void ServerConnection::send_acknowledge()
+   {
+      std::array<std::uint8_t, rmf::CMD_TYPE_SIZE> buffer;
+      std::size_t const encoded_size = rmf::encode_acknowledge_cmd(buffer.data(), buffer.size());
+      assert(encoded_size == buffer.size());
+      std::int32_t bytes_available{ 0 };
+      transmit_begin();
+      transmit_data_message(rmf::CMD_AREA_START_ADDRESS, false, buffer.data(), static_cast<std::int32_t>(encoded_size), bytes_available);
+      transmit_end();
+   }
+
+   /*
+   * The definition is identical to the one cached from the previous connection so the client doesn't need to send it again.
+   * Provide port data is restored from the cache and only the ranges the client changed since then are requested.
+   */
+   error_t ServerConnection::resume_definition_file(NodeFiles& node_files, NodeResumeData&& resume_data)
+   {
+      node_files.is_resumed = true;
+      node_files.resumed_provide_port_data = std::move(resume_data.provide_port_data);
+      auto retval = m_file_manager.send_resume_file_request(node_files.definition_file->get_address_without_flags());
+      if (retval == APX_NO_ERROR)
+      {
+         retval = build_node_instance(node_files, resume_data.definition_text);
+      }
+      return retval;
+   }
+
+   error_t ServerConnection::process_definition_data(NodeFiles& node_files, std::uint32_t offset, std::uint8_t const* data, std::size_t size)
+   {
+      if (node_files.node_instance != nullptr)
+      {
+         return APX_NO_ERROR; //Definition has already been processed
+      }
+      if (offset + size > node_files.definition_data.size())
+      {
+         return APX_INVALID_WRITE_ERROR;
+      }
+      std::memcpy(node_files.definition_data.data() + offset, data, size);
+      node_files.definition_bytes_received += size;
+      if (node_files.definition_bytes_received < node_files.definition_data.size())
+      {
+         return APX_NO_ERROR; //Wait for more data to arrive
+      }
+      std::string const definition_text{ reinterpret_cast<char const*>(node_files.definition_data.data()), node_files.definition_data.size() };
+      apx::ByteArray().swap(node_files.definition_data); //Node data keeps its own copy of the definition
+      return build_node_instance(node_files, definition_text);
+   }
+
+   error_t ServerConnection::build_node_instance(NodeFiles& node_files, std::string const& definition_text)
+   {
+      auto retval = m_node_manager.build_node(definition_text);
+      if (retval != APX_NO_ERROR)
+      {
+         return retval;
+      }
+      node_files.node_instance = m_node_manager.get_last_attached();
+      assert(node_files.node_instance != nullptr);
+      if (node_files.is_resumed)
+      {
+         auto* node_data = node_files.node_instance->get_node_data();
+         auto const& cached_data = node_files.resumed_provide_port_data;
+         if ( (node_data != nullptr) && (cached_data.size() > 0u) && (cached_data.size() == node_data->provide_port_data_size()) )
+         {
+            node_data->write_provide_port_data(0u, cached_data.data(), cached_data.size());
+         }
+         apx::ByteArray().swap(node_files.resumed_provide_port_data);
+      }
+      return attach_node_instance(node_files);
+   }
+
+   error_t ServerConnection::process_provide_port_data(NodeInstance* node_instance, std::uint32_t offset, std::uint8_t const* data, std::size_t size)
+   {
+      auto* node_data = node_instance->get_node_data();
+      if (node_data == nullptr)
+      {
+         return APX_NULL_PTR_ERROR;
+      }
+      auto retval = node_data->write_provide_port_data(offset, data, size);
+      if ( (retval == APX_NO_ERROR) && (m_parent_server != nullptr) )
+      {
+         m_parent_server->provide_port_data_written(this, node_instance, offset, data, size);
+      }
+      return retval;
+   }
+
+   error_t ServerConnection::attach_node_instance(NodeFiles& node_files)
+   {
+      auto* node_instance = node_files.node_instance;
+      error_t retval = APX_NO_ERROR;
+      if (node_instance->has_require_port_data())
+      {
+         retval = create_require_port_data_file(node_files);
+         if (retval != APX_NO_ERROR)
+         {
+            return retval;
+         }
+      }
+      if (m_parent_server != nullptr)
+      {
+         m_parent_server->node_attached(this, node_instance);
+      }
+      if (node_instance->has_require_port_data())
+      {
+         retval = m_file_manager.publish_local_file(node_files.require_port_data_file);
+      }
+      if ( (retval == APX_NO_ERROR) && (node_files.provide_port_data_file != nullptr) )
+      {
+         retval = open_provide_port_data_file(node_files);
+      }
+      return retval;
+   }
+
+   error_t ServerConnection::open_provide_port_data_file(NodeFiles& node_files)
+   {
+      auto* file = node_files.provide_port_data_file;
+      assert(file != nullptr);
+      file->open();
+      if (node_files.is_resumed)
+      {
+         return m_file_manager.send_resume_file_request(file->get_address_without_flags());
+      }
+      return m_file_manager.send_open_file_request(file->get_address_without_flags());
+   }
+
+   error_t ServerConnection::create_require_port_data_file(NodeFiles& node_files)
+   {
+      auto* node_instance = node_files.node_instance;
+      rmf::FileInfo file_info{ node_instance->get_name() + ".in", static_cast<std::uint32_t>(node_instance->get_require_port_init_data_size()) };
+      auto* file = m_file_manager.create_local_file(file_info);
+      if (file == nullptr)
+      {
+         return APX_FILE_CREATE_ERROR;
+      }
+      file->set_notification_handler(this);
+      node_files.require_port_data_file = file;
+      node_instance->set_require_port_data_file(file);
+      register_node_file(file, &node_files);
+      return APX_NO_ERROR;
+   }
+
+   /*
+   * NodeFiles entries are never erased from m_node_files, the returned pointers stay valid for the lifetime of the connection.
+   * The node_instance of a NodeFiles is assigned before its require port data file is registered.
+   */
+   void ServerConnection::register_node_file(File const* file, NodeFiles* node_files)
+   {
+      std::scoped_lock lock{ m_file_lookup_mutex };
+      m_file_lookup[file] = node_files;
+   }
+
+   ServerConnection::NodeFiles* ServerConnection::find_node_files(File const* file)
+   {
+      std::scoped_lock lock{ m_file_lookup_mutex };
+      auto it = m_file_lookup.find(file);
+      return (it != m_file_lookup.end()) ? it->second : nullptr;
+   }
+
+   /*
+   * Hands the definition and current provide port data of each attached node to the server
+   * so that the client can resume where it left off if it reconnects.
+   */
+   void ServerConnection::store_resume_data()
+   {
+      for (auto& [node_name, node_files] : m_node_files)
+      {
+         auto* node_instance = node_files.node_instance;
+         if ( (node_instance == nullptr) || (node_files.definition_file == nullptr) )
+         {
+            continue;
+         }
+         auto const& file_info = node_files.definition_file->get_file_info();
+         if (file_info.digest_type != rmf::DigestType::SHA256)
+         {
+            continue;
+         }
+         NodeResumeData resume_data;
+         resume_data.definition_digest = file_info.digest_data;
+         resume_data.definition_text.assign(reinterpret_cast<char const*>(node_instance->get_definition_data()), node_instance->get_definition_size());
+         auto* node_data = node_instance->get_node_data();
+         if ( (node_data != nullptr) && (node_data->provide_port_data_size() > 0u) )
+         {
+            resume_data.provide_port_data.resize(node_data->provide_port_data_size());
+            if (node_data->read_provide_port_data(0u, resume_data.provide_port_data.data(), resume_data.provide_port_data.size()) != APX_NO_ERROR)
+            {
+               continue;
+            }
+         }
+         m_parent_server->store_resume_data(node_name, std::move(resume_data));
+      }
+   }
+
+#ifdef UNIT_TEST
+   void ServerConnection::run()
+   {
+      m_file_manager.run();
+   }
+#else
+   void ServerConnection::start()
+   {
+      m_file_manager.start();
+   }
+
+   void ServerConnection::stop()
+   {
+      m_file_manager.stop();
+   }
+#endif
+}
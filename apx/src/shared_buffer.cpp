@@ -0,0 +1,52 @@
+/*****************************************************************************
+* \file      shared_buffer.cpp
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Reference counted immutable byte buffer
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#include <cstring>
+#include <new>
+#include "cpp-apx/shared_buffer.h"
+
+namespace apx
+{
+   /*
+   * Header and data are stored in a single allocation. The data starts directly after the header.
+   */
+   SharedBuffer* SharedBuffer::create(std::uint8_t const* data, std::size_t size)
+   {
+      void* memory = ::operator new(sizeof(SharedBuffer) + size);
+      auto* self = new (memory) SharedBuffer(size);
+      if ( (data != nullptr) && (size > 0u) )
+      {
+         std::memcpy(reinterpret_cast<std::uint8_t*>(self + 1), data, size);
+      }
+      return self;
+   }
+
+   void SharedBuffer::release() noexcept
+   {
+      if (m_ref_count.fetch_sub(1u, std::memory_order_acq_rel) == 1u)
+      {
+         this->~SharedBuffer();
+         ::operator delete(static_cast<void*>(this));
+      }
+   }
+}
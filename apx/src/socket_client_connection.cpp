@@ -1,10 +1,8 @@
 #include <cassert>
 #include <cstring>
-#if APX_DEBUG_ENABLE
-#include <iostream>
-#endif
 #include "cpp-apx/remotefile.h"
 #include "cpp-apx/numheader.h"
+#include "cpp-apx/trace.h"
 #include "cpp-apx/socket_client_connection.h"
 #include "cpp-apx/client.h"
 
@@ -54,6 +52,21 @@ namespace apx
       return APX_NO_ERROR;
    }
 
+   /*
+   * Continues on a new socket after the previous one was disconnected.
+   * Local files and node data are kept, same as when reconnecting with connect_tcp.
+   */
+   error_t SocketClientConnection::reconnect(SOCKET_TYPE* socket)
+   {
+      if (m_socket != nullptr)
+      {
+         SOCKET_DELETE(m_socket);
+      }
+      m_socket = socket;
+      SOCKET_SET_HANDLER(m_socket, this);
+      return connect();
+   }
+
    void SocketClientConnection::run()
    {
       testsocket_run(m_socket);
@@ -139,10 +152,14 @@ namespace apx
 
    int SocketClientConnection::socket_data_received(const std::uint8_t* data, std::size_t data_size, std::size_t& parse_len)
    {
-#if APX_DEBUG_ENABLE
-      std::cout << "Received " << std::to_string(data_size) << " bytes" << std::endl;
-#endif
-      return on_data_received(data, data_size, parse_len);
+      APX_TRACE_SCOPE_ARG("SocketClientConnection::socket_data_received", data_size);
+      auto const result = on_data_received(data, data_size, parse_len);
+      auto* capture = m_capture.load(std::memory_order_acquire);
+      if ( (capture != nullptr) && (result == 0) && (parse_len > 0u) )
+      {
+         capture->write_frame(CaptureDirection::Received, data, parse_len);
+      }
+      return result;
    }
 
    std::int32_t SocketClientConnection::transmit_max_bytes_avaiable() const
@@ -180,14 +197,14 @@ namespace apx
    REQUIRES_LOCK_HELD(m_mutex)
    error_t SocketClientConnection::transmit_data_message(std::uint32_t write_address, bool more_bit, std::uint8_t const* msg_data, std::int32_t msg_size, std::int32_t& bytes_available)
    {
-      std::array<std::uint8_t, numheader::LONG16_SIZE + rmf::HIGH_ADDR_SIZE> header;
+      std::array<std::uint8_t, numheader::LONG32_SIZE + rmf::HIGH_ADDR_SIZE> header;
       std::size_t const address_size = rmf::needed_encoding_size(write_address);
       std::size_t const payload_size = address_size + msg_size;
       if (payload_size > transmit_max_bytes_avaiable())
       {
          return APX_MSG_TOO_LARGE_ERROR;
       }
-      std::size_t const header1_size = numheader::encode16(header.data(), header.data() + header.size(), static_cast<std::uint16_t>(payload_size));
+      std::size_t const header1_size = numheader::encode32(header.data(), header.data() + header.size(), static_cast<std::uint32_t>(payload_size));
       assert(header1_size > 0);
       std::size_t const header2_size = rmf::address_encode(header.data() + header1_size, header.size(), write_address, more_bit);
       assert(header2_size == address_size);
@@ -203,6 +220,7 @@ namespace apx
       std::memcpy(m_transmit_buffer.data() + m_pending_bytes, msg_data, msg_size);
       m_pending_bytes += msg_size;
       bytes_available = static_cast<std::int32_t>(m_transmit_buffer.size() - m_pending_bytes);
+      m_metrics.messages_sent.add();
       return APX_NO_ERROR;
    }
 
@@ -213,7 +231,7 @@ namespace apx
       {
          return APX_MSG_TOO_LARGE_ERROR;
       }
-      std::size_t const header_size = numheader::encode32(header.data(), header.data() + header.size(), static_cast<std::uint16_t>(msg_size));
+      std::size_t const header_size = numheader::encode32(header.data(), header.data() + header.size(), static_cast<std::uint32_t>(msg_size));
       std::size_t const bytes_to_send = header_size + msg_size;
       std::size_t const buffer_available = m_transmit_buffer.size() - m_pending_bytes;
       if (bytes_to_send > buffer_available)
@@ -226,6 +244,7 @@ namespace apx
       std::memcpy(m_transmit_buffer.data() + m_pending_bytes, msg_data, msg_size);
       m_pending_bytes += msg_size;
       bytes_available = static_cast<std::int32_t>(m_transmit_buffer.size() - m_pending_bytes);
+      m_metrics.messages_sent.add();
       return APX_NO_ERROR;
    }
 
@@ -233,10 +252,16 @@ namespace apx
    {
       if (m_socket != nullptr)
       {
-#ifdef APX_DEBUG_ENABLE
-         std::cout << "Sending " << m_pending_bytes << " bytes" << std::endl;
-#endif
+         APX_TRACE_SCOPE_ARG("SocketClientConnection::send_packet", m_pending_bytes);
+         auto* capture = m_capture.load(std::memory_order_acquire);
+         if (capture != nullptr)
+         {
+            capture->write_frame(CaptureDirection::Sent, m_transmit_buffer.data(), m_pending_bytes);
+         }
          SOCKET_SEND(m_socket, m_transmit_buffer.data(), static_cast<std::uint32_t>(m_pending_bytes));
+         m_metrics.send_packet_calls.add();
+         m_metrics.bytes_sent.add(m_pending_bytes);
       }
+      m_pending_bytes = 0u;
    }
 }
\ No newline at end of file
@@ -0,0 +1,216 @@
+#include <array>
+#include <cassert>
+#include <cstring>
+#include "cpp-apx/remotefile.h"
+#include "cpp-apx/numheader.h"
+#include "cpp-apx/trace.h"
+#include "cpp-apx/socket_server_connection.h"
+
+#ifdef UNIT_TEST
+#define SOCKET_DELETE(x) //The test socket is owned by the client side of the test
+#define SOCKET_SET_HANDLER(x, y) msocket::set_server_handler(x,y)
+#define SOCKET_SEND testsocket_serverSend
+#else
+#define SOCKET_DELETE msocket_delete
+#define SOCKET_SET_HANDLER(x, y) msocket::set_handler(x,y)
+#define SOCKET_SEND msocket_send
+#endif
+
+namespace apx
+{
+   SocketServerConnection::SocketServerConnection(SOCKET_TYPE* socket) :
+      ServerConnection{ nullptr }, m_socket(socket)
+   {
+      if (m_socket != nullptr)
+      {
+         SOCKET_SET_HANDLER(m_socket, this);
+      }
+   }
+
+   SocketServerConnection::SocketServerConnection(SOCKET_TYPE* socket, Server* parent_server) :
+      ServerConnection{ parent_server }, m_socket(socket)
+   {
+      if (m_socket != nullptr)
+      {
+         SOCKET_SET_HANDLER(m_socket, this);
+      }
+   }
+
+   SocketServerConnection::~SocketServerConnection()
+   {
+      if (m_socket != nullptr)
+      {
+         SOCKET_DELETE(m_socket);
+      }
+   }
+
+#ifdef UNIT_TEST
+   void SocketServerConnection::run()
+   {
+      testsocket_run(m_socket);
+      for (int i = 0; i < 10; i++)
+      {
+         ServerConnection::run();
+         testsocket_run(m_socket);
+      }
+   }
+#endif
+
+   void SocketServerConnection::socket_connected(const std::string& address, std::uint16_t port)
+   {
+      (void)address;
+      (void)port;
+      connected();
+   }
+
+   void SocketServerConnection::socket_disconnected()
+   {
+      disconnected();
+   }
+
+   int SocketServerConnection::socket_data_received(const std::uint8_t* data, std::size_t data_size, std::size_t& parse_len)
+   {
+      APX_TRACE_SCOPE_ARG("SocketServerConnection::socket_data_received", data_size);
+      return on_data_received(data, data_size, parse_len);
+   }
+
+   std::int32_t SocketServerConnection::transmit_max_bytes_avaiable() const
+   {
+      return static_cast<std::int32_t>(m_default_buffer_size);
+   }
+
+   std::int32_t SocketServerConnection::transmit_current_bytes_avaiable() const
+   {
+      return static_cast<std::int32_t>(m_transmit_buffer.size());
+   }
+
+   ACQUIRES_LOCK(m_mutex)
+   void SocketServerConnection::transmit_begin()
+   {
+      m_mutex.lock();
+      if (m_transmit_buffer.size() < m_default_buffer_size)
+      {
+         m_transmit_buffer.resize(m_default_buffer_size);
+      }
+      m_pending_bytes = 0u;
+      assert(m_transmit_buffer.size() >= m_default_buffer_size);
+   }
+
+   RELEASES_LOCK(m_mutex)
+   void SocketServerConnection::transmit_end()
+   {
+      if (m_pending_bytes > 0u)
+      {
+         send_packet();
+      }
+      m_mutex.unlock();
+   }
+
+   REQUIRES_LOCK_HELD(m_mutex)
+   error_t SocketServerConnection::transmit_data_message(std::uint32_t write_address, bool more_bit, std::uint8_t const* msg_data, std::int32_t msg_size, std::int32_t& bytes_available)
+   {
+      DataMessageHeader header;
+      std::size_t const header_size = encode_data_message_header(header, write_address, more_bit, msg_size);
+      if (header_size == 0u)
+      {
+         return APX_MSG_TOO_LARGE_ERROR;
+      }
+      std::size_t const bytes_to_send = header_size + msg_size;
+      std::size_t const buffer_available = m_transmit_buffer.size() - m_pending_bytes;
+      if (bytes_to_send > buffer_available)
+      {
+         send_packet();
+         assert(m_pending_bytes == 0u);
+      }
+      std::memcpy(m_transmit_buffer.data() + m_pending_bytes, header.data(), header_size);
+      m_pending_bytes += header_size;
+      std::memcpy(m_transmit_buffer.data() + m_pending_bytes, msg_data, msg_size);
+      m_pending_bytes += msg_size;
+      bytes_available = static_cast<std::int32_t>(m_transmit_buffer.size() - m_pending_bytes);
+      return APX_NO_ERROR;
+   }
+
+   /*
+   * SOCKET_SEND has copied the data when it returns, so no reference to buffer is kept.
+   * Large messages are sent directly from the shared buffer instead of being copied into the transmit buffer first.
+   */
+   REQUIRES_LOCK_HELD(m_mutex)
+   error_t SocketServerConnection::transmit_shared_data_message(std::uint32_t write_address, bool more_bit, SharedBuffer* buffer, std::uint8_t const* msg_data, std::int32_t msg_size, std::int32_t& bytes_available)
+   {
+      (void)buffer;
+      if (static_cast<std::size_t>(msg_size) < SOCKET_DIRECT_SEND_MIN_SIZE)
+      {
+         return transmit_data_message(write_address, more_bit, msg_data, msg_size, bytes_available);
+      }
+      DataMessageHeader header;
+      std::size_t const header_size = encode_data_message_header(header, write_address, more_bit, msg_size);
+      if (header_size == 0u)
+      {
+         return APX_MSG_TOO_LARGE_ERROR;
+      }
+      if (header_size > (m_transmit_buffer.size() - m_pending_bytes))
+      {
+         send_packet();
+      }
+      std::memcpy(m_transmit_buffer.data() + m_pending_bytes, header.data(), header_size);
+      m_pending_bytes += header_size;
+      send_packet();
+      if (m_socket != nullptr)
+      {
+         SOCKET_SEND(m_socket, msg_data, static_cast<std::uint32_t>(msg_size));
+      }
+      bytes_available = static_cast<std::int32_t>(m_transmit_buffer.size());
+      return APX_NO_ERROR;
+   }
+
+   error_t SocketServerConnection::transmit_direct_message(std::uint8_t const* msg_data, std::int32_t msg_size, std::int32_t& bytes_available)
+   {
+      std::array<std::uint8_t, numheader::LONG32_SIZE> header;
+      if (msg_size > transmit_max_bytes_avaiable())
+      {
+         return APX_MSG_TOO_LARGE_ERROR;
+      }
+      std::size_t const header_size = numheader::encode32(header.data(), header.data() + header.size(), static_cast<std::uint32_t>(msg_size));
+      std::size_t const bytes_to_send = header_size + msg_size;
+      std::size_t const buffer_available = m_transmit_buffer.size() - m_pending_bytes;
+      if (bytes_to_send > buffer_available)
+      {
+         send_packet();
+         assert(m_pending_bytes == 0u);
+      }
+      std::memcpy(m_transmit_buffer.data() + m_pending_bytes, header.data(), header_size);
+      m_pending_bytes += header_size;
+      std::memcpy(m_transmit_buffer.data() + m_pending_bytes, msg_data, msg_size);
+      m_pending_bytes += msg_size;
+      bytes_available = static_cast<std::int32_t>(m_transmit_buffer.size() - m_pending_bytes);
+      return APX_NO_ERROR;
+   }
+
+   /*
+   * Returns the number of bytes written to header, or 0 if the message doesn't fit in a packet.
+   */
+   std::size_t SocketServerConnection::encode_data_message_header(DataMessageHeader& header, std::uint32_t write_address, bool more_bit, std::int32_t msg_size) const
+   {
+      std::size_t const address_size = rmf::needed_encoding_size(write_address);
+      std::size_t const payload_size = address_size + static_cast<std::size_t>(msg_size);
+      if (payload_size > static_cast<std::size_t>(transmit_max_bytes_avaiable()))
+      {
+         return 0u;
+      }
+      std::size_t const header1_size = numheader::encode32(header.data(), header.data() + header.size(), static_cast<std::uint32_t>(payload_size));
+      assert(header1_size > 0);
+      std::size_t const header2_size = rmf::address_encode(header.data() + header1_size, header.size() - header1_size, write_address, more_bit);
+      assert(header2_size == address_size);
+      return header1_size + header2_size;
+   }
+
+   void SocketServerConnection::send_packet()
+   {
+      if (m_socket != nullptr)
+      {
+         APX_TRACE_SCOPE_ARG("SocketServerConnection::send_packet", m_pending_bytes);
+         SOCKET_SEND(m_socket, m_transmit_buffer.data(), static_cast<std::uint32_t>(m_pending_bytes));
+      }
+      m_pending_bytes = 0u;
+   }
+}
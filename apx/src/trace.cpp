@@ -0,0 +1,248 @@
+/*****************************************************************************
+* \file      trace.cpp
+* \author    Conny Gustafsson
+* \date      2026-10-19
+* \brief     Begin/end trace events in per-thread ring buffers, exported as Chrome trace JSON
+*
+* Copyright (c) 2026 Conny Gustafsson
+* Permission is hereby granted, free of charge, to any person obtaining a copy of
+* this software and associated documentation files (the "Software"), to deal in
+* the Software without restriction, including without limitation the rights to
+* use, copy, modify, merge, publish, distribute, sublicense, and/or sell copies of
+* the Software, and to permit persons to whom the Software is furnished to do so,
+* subject to the following conditions:
+* The above copyright notice and this permission notice shall be included in all
+* copies or substantial portions of the Software.
+* THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+* IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY, FITNESS
+* FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE AUTHORS OR
+* COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER
+* IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN
+* CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+*
+******************************************************************************/
+#include <algorithm>
+#include <deque>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+#include "cpp-apx/trace.h"
+
+namespace apx
+{
+   namespace trace
+   {
+      struct ThreadBuffer
+      {
+         ThreadBuffer(std::uint32_t thread_id) : tid{ thread_id }, events(THREAD_BUFFER_CAPACITY) {}
+         std::uint32_t const tid;
+         std::mutex mutex; //Only contended while the trace is written or cleared
+         std::string name;
+         std::vector<Event> events;
+         std::uint64_t num_recorded{ 0u };
+      };
+
+      /*
+      * Each thread owns its buffer, the registry only holds a weak reference to it.
+      * When a thread exits its buffer is retired. The last RETIRED_THREAD_BUFFERS_MAX retired buffers are kept
+      * so that events of short lived threads can still be exported.
+      */
+      class Registry
+      {
+      public:
+         std::shared_ptr<ThreadBuffer> create_thread_buffer()
+         {
+            std::scoped_lock lock{ m_mutex };
+            auto buffer = std::make_shared<ThreadBuffer>(m_next_tid++);
+            prune_expired();
+            m_buffers.push_back(buffer);
+            return buffer;
+         }
+         void retire_thread_buffer(std::shared_ptr<ThreadBuffer> buffer)
+         {
+            std::scoped_lock lock{ m_mutex };
+            m_buffers.erase(std::remove_if(m_buffers.begin(), m_buffers.end(),
+               [&buffer](std::weak_ptr<ThreadBuffer> const& item) { return item.expired() || (item.lock() == buffer); }), m_buffers.end());
+            bool has_events{ false };
+            {
+               std::scoped_lock buffer_lock{ buffer->mutex };
+               has_events = buffer->num_recorded > 0u;
+            }
+            if (has_events)
+            {
+               m_retired.push_back(std::move(buffer));
+               if (m_retired.size() > RETIRED_THREAD_BUFFERS_MAX)
+               {
+                  m_retired.pop_front();
+               }
+            }
+         }
+         void release_retired()
+         {
+            std::deque<std::shared_ptr<ThreadBuffer>> retired;
+            {
+               std::scoped_lock lock{ m_mutex };
+               retired.swap(m_retired);
+            }
+         }
+         //Retired buffers first, then live threads in creation order
+         std::vector<std::shared_ptr<ThreadBuffer>> buffers()
+         {
+            std::scoped_lock lock{ m_mutex };
+            prune_expired();
+            std::vector<std::shared_ptr<ThreadBuffer>> result(m_retired.begin(), m_retired.end());
+            for (auto const& item : m_buffers)
+            {
+               auto buffer = item.lock();
+               if (buffer != nullptr)
+               {
+                  result.push_back(std::move(buffer));
+               }
+            }
+            return result;
+         }
+         Clock::time_point const origin{ Clock::now() };
+      protected:
+         void prune_expired()
+         {
+            m_buffers.erase(std::remove_if(m_buffers.begin(), m_buffers.end(),
+               [](std::weak_ptr<ThreadBuffer> const& item) { return item.expired(); }), m_buffers.end());
+         }
+
+         std::mutex m_mutex;
+         std::vector<std::weak_ptr<ThreadBuffer>> m_buffers;
+         std::deque<std::shared_ptr<ThreadBuffer>> m_retired; //Oldest first
+         std::uint32_t m_next_tid{ 1u };
+      };
+
+      static Registry& registry()
+      {
+         static Registry instance;
+         return instance;
+      }
+
+      //Thread local owner of the calling thread's buffer, retires it when the thread exits
+      struct ThreadBufferOwner
+      {
+         ThreadBufferOwner() : buffer{ registry().create_thread_buffer() } {}
+         ~ThreadBufferOwner() { registry().retire_thread_buffer(std::move(buffer)); }
+         std::shared_ptr<ThreadBuffer> buffer;
+      };
+
+      static ThreadBuffer& thread_buffer()
+      {
+         thread_local ThreadBufferOwner owner;
+         return *owner.buffer;
+      }
+
+      static std::uint64_t to_ns(Clock::duration duration)
+      {
+         auto const ns = std::chrono::duration_cast<std::chrono::nanoseconds>(duration).count();
+         return ns > 0 ? static_cast<std::uint64_t>(ns) : 0u;
+      }
+
+      void record(char const* name, Clock::time_point begin, Clock::time_point end, std::uint64_t arg)
+      {
+         auto const origin = registry().origin;
+         auto& buffer = thread_buffer();
+         std::scoped_lock lock{ buffer.mutex };
+         auto& event = buffer.events[buffer.num_recorded % THREAD_BUFFER_CAPACITY];
+         event.name = name;
+         event.begin_ns = to_ns(begin - origin);
+         event.duration_ns = to_ns(end - begin);
+         event.arg = arg;
+         buffer.num_recorded++;
+      }
+
+      void set_thread_name(char const* name)
+      {
+         auto& buffer = thread_buffer();
+         std::scoped_lock lock{ buffer.mutex };
+         buffer.name = name;
+      }
+
+      void clear()
+      {
+         registry().release_retired();
+         for (auto& buffer : registry().buffers())
+         {
+            std::scoped_lock lock{ buffer->mutex };
+            buffer->num_recorded = 0u;
+         }
+      }
+
+      std::size_t num_thread_buffers()
+      {
+         return registry().buffers().size();
+      }
+
+      static void write_string(std::ostream& os, char const* str)
+      {
+         os << '"';
+         for (; *str != '\0'; str++)
+         {
+            if ((*str == '"') || (*str == '\\'))
+            {
+               os << '\\';
+            }
+            os << *str;
+         }
+         os << '"';
+      }
+
+      //Chrome expects microseconds, the fraction keeps nanosecond resolution
+      static void write_microseconds(std::ostream& os, std::uint64_t ns)
+      {
+         auto const fraction = ns % 1000u;
+         os << ns / 1000u << '.' << static_cast<char>('0' + fraction / 100u) << static_cast<char>('0' + (fraction / 10u) % 10u) << static_cast<char>('0' + fraction % 10u);
+      }
+
+      /*
+      * Writes all buffered events as complete ("X") events, one Chrome trace thread per traced thread.
+      * The output can be loaded into chrome://tracing or https://ui.perfetto.dev.
+      */
+      void write_chrome_trace(std::ostream& os)
+      {
+         bool first{ true };
+         os << "{\"traceEvents\":[";
+         for (auto& buffer : registry().buffers())
+         {
+            std::scoped_lock lock{ buffer->mutex };
+            if (!buffer->name.empty())
+            {
+               os << (first ? "\n" : ",\n") << "{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << buffer->tid << ",\"args\":{\"name\":";
+               write_string(os, buffer->name.c_str());
+               os << "}}";
+               first = false;
+            }
+            std::uint64_t const num_events = std::min<std::uint64_t>(buffer->num_recorded, THREAD_BUFFER_CAPACITY);
+            for (std::uint64_t i = buffer->num_recorded - num_events; i < buffer->num_recorded; i++)
+            {
+               auto const& event = buffer->events[i % THREAD_BUFFER_CAPACITY];
+               os << (first ? "\n" : ",\n") << "{\"name\":";
+               write_string(os, event.name);
+               os << ",\"cat\":\"apx\",\"ph\":\"X\",\"ts\":";
+               write_microseconds(os, event.begin_ns);
+               os << ",\"dur\":";
+               write_microseconds(os, event.duration_ns);
+               os << ",\"pid\":1,\"tid\":" << buffer->tid << ",\"args\":{\"value\":" << event.arg << "}}";
+               first = false;
+            }
+         }
+         os << "\n],\"displayTimeUnit\":\"ns\"}\n";
+      }
+
+      error_t write_chrome_trace(char const* path)
+      {
+         std::ofstream file{ path, std::ios::out | std::ios::trunc };
+         if (!file.is_open())
+         {
+            return APX_FILE_CREATE_ERROR;
+         }
+         write_chrome_trace(file);
+         return file.good() ? APX_NO_ERROR : APX_FILE_CREATE_ERROR;
+      }
+   }
+}
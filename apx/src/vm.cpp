@@ -1,4 +1,5 @@
 #include "cpp-apx/vm.h"
+#include "cpp-apx/trace.h"
 
 namespace apx
 {
@@ -11,6 +12,17 @@ namespace apx
       {
          result = m_decoder.parse_program_header(m_program_header);
       }
+      if (result == APX_NO_ERROR)
+      {
+         if (m_program_header.prog_type == apx::ProgramType::Pack)
+         {
+            m_serializer.reserve_nesting_depth(m_program_header.nesting_depth);
+         }
+         else
+         {
+            m_deserializer.reserve_nesting_depth(m_program_header.nesting_depth);
+         }
+      }
       return result;
    }
 
@@ -44,6 +56,11 @@ namespace apx
       return run_pack_program();
    }
 
+   apx::error_t VirtualMachine::pack_value(dtl::DynamicValue const& value)
+   {
+      return pack_value(value.get());
+   }
+
    apx::error_t VirtualMachine::unpack_value(dtl::ScalarValue& value)
    {
       if (m_program_header.prog_type != apx::ProgramType::Unpack)
@@ -66,8 +83,93 @@ namespace apx
       return retval;
    }
 
+   /*
+   * Unpacks scalars, arrays and records.
+   * When value already holds an object of the unpacked type it is updated in place, including array elements
+   * and record fields of matching types. Otherwise value is replaced with a newly created object.
+   * Must be called after set_read_buffer.
+   */
+   apx::error_t VirtualMachine::unpack_value(dtl::DynamicValue& value)
+   {
+      if (m_program_header.prog_type != apx::ProgramType::Unpack)
+      {
+         return APX_INVALID_PROGRAM_ERROR;
+      }
+      m_deserializer.set_reuse_value(value);
+      auto retval = run_unpack_program();
+      if (retval == APX_NO_ERROR)
+      {
+         auto tmp = m_deserializer.take_dv();
+         if (tmp != nullptr)
+         {
+            value = std::move(tmp);
+         }
+         else
+         {
+            retval = APX_VALUE_TYPE_ERROR;
+         }
+      }
+      m_deserializer.clear_value();
+      m_deserializer.set_reuse_value(nullptr);
+      return retval;
+   }
+
+   /*
+   * Unpacks a byte array or character string port without creating a value.
+   * data points into the buffer given to set_read_buffer. Limit checks in the program are not applied.
+   * Returns APX_VALUE_TYPE_ERROR for programs of any other data type.
+   */
+   apx::error_t VirtualMachine::unpack_view(std::uint8_t const*& data, std::size_t& size, TypeCode& type_code)
+   {
+      if (m_program_header.prog_type != apx::ProgramType::Unpack)
+      {
+         return APX_INVALID_PROGRAM_ERROR;
+      }
+      bool has_data = false;
+      vm::OperationType operation_type = vm::OperationType::ProgramEnd;
+      do
+      {
+         apx::error_t result = m_decoder.parse_next_operation(operation_type);
+         if (result != APX_NO_ERROR)
+         {
+            return result;
+         }
+         switch (operation_type)
+         {
+         case vm::OperationType::Unpack:
+            if (has_data)
+            {
+               return APX_VALUE_TYPE_ERROR;
+            }
+            else
+            {
+               vm::PackUnpackOperationInfo const& operation = m_decoder.get_pack_unpack_info();
+               SizeType const dynamic_size_type = operation.is_dynamic_array ? vm::size_to_size_type(operation.array_length) : SizeType::None;
+               type_code = operation.type_code;
+               result = m_deserializer.view_array_data(type_code, operation.array_length, dynamic_size_type, data, size);
+               has_data = true;
+            }
+            break;
+         case vm::OperationType::LimitCheckInt32:
+         case vm::OperationType::LimitCheckUInt32:
+         case vm::OperationType::LimitCheckInt64:
+         case vm::OperationType::LimitCheckUInt64:
+         case vm::OperationType::ProgramEnd:
+            break;
+         default:
+            result = APX_VALUE_TYPE_ERROR;
+         }
+         if (result != APX_NO_ERROR)
+         {
+            return result;
+         }
+      } while (operation_type != vm::OperationType::ProgramEnd);
+      return has_data ? APX_NO_ERROR : APX_INVALID_PROGRAM_ERROR;
+   }
+
    apx::error_t VirtualMachine::run_pack_program()
    {
+      APX_TRACE_SCOPE("VirtualMachine::run_pack_program");
       vm::OperationType operation_type = vm::OperationType::ProgramEnd;
       do
       {
@@ -114,6 +216,7 @@ namespace apx
 
    apx::error_t VirtualMachine::run_unpack_program()
    {
+      APX_TRACE_SCOPE("VirtualMachine::run_unpack_program");
       vm::OperationType operation_type = vm::OperationType::ProgramEnd;
       do
       {
@@ -143,10 +246,10 @@ namespace apx
             result = run_range_check_unpack_uint64();
             break;
          case vm::OperationType::RecordSelect:
-            result = APX_NOT_IMPLEMENTED_ERROR;
+            result = run_unpack_record_select();
             break;
          case vm::OperationType::ArrayNext:
-            result = APX_NOT_IMPLEMENTED_ERROR;
+            result = run_array_next();
             break;
          case vm::OperationType::ProgramEnd:
             break;
@@ -217,6 +320,44 @@ namespace apx
       case TypeCode::UInt8:
          retval = m_deserializer.unpack_uint8(operation.array_length, dynamic_size_type);
          break;
+      case TypeCode::UInt16:
+         retval = m_deserializer.unpack_uint16(operation.array_length, dynamic_size_type);
+         break;
+      case TypeCode::UInt32:
+         retval = m_deserializer.unpack_uint32(operation.array_length, dynamic_size_type);
+         break;
+      case TypeCode::UInt64:
+         retval = m_deserializer.unpack_uint64(operation.array_length, dynamic_size_type);
+         break;
+      case TypeCode::Int8:
+         retval = m_deserializer.unpack_int8(operation.array_length, dynamic_size_type);
+         break;
+      case TypeCode::Int16:
+         retval = m_deserializer.unpack_int16(operation.array_length, dynamic_size_type);
+         break;
+      case TypeCode::Int32:
+         retval = m_deserializer.unpack_int32(operation.array_length, dynamic_size_type);
+         break;
+      case TypeCode::Int64:
+         retval = m_deserializer.unpack_int64(operation.array_length, dynamic_size_type);
+         break;
+      case TypeCode::Char:
+      case TypeCode::Char8:
+         retval = m_deserializer.unpack_char(operation.array_length, dynamic_size_type);
+         break;
+      case TypeCode::Bool:
+         retval = m_deserializer.unpack_bool(operation.array_length, dynamic_size_type);
+         break;
+      case TypeCode::Byte:
+         retval = m_deserializer.unpack_byte_array(operation.array_length, dynamic_size_type);
+         break;
+      case TypeCode::Record:
+         retval = m_deserializer.unpack_record(operation.array_length, dynamic_size_type);
+         if (operation.array_length > 0u)
+         {
+            m_decoder.save_program_position();
+         }
+         break;
       }
       return retval;
    }
@@ -271,14 +412,12 @@ namespace apx
 
    apx::error_t VirtualMachine::run_pack_record_select()
    {
-      auto const& field_name = m_decoder.get_field_name();
-      return m_serializer.record_select(field_name.c_str(), m_decoder.is_last_field());
+      return m_serializer.record_select(dtl::HashedKey{ m_decoder.get_field_name(), m_decoder.get_field_hash() }, m_decoder.is_last_field());
    }
 
    apx::error_t VirtualMachine::run_unpack_record_select()
    {
-      auto const& field_name = m_decoder.get_field_name();
-      return m_deserializer.record_select(field_name.c_str(), m_decoder.is_last_field());
+      return m_deserializer.record_select(dtl::HashedKey{ m_decoder.get_field_name(), m_decoder.get_field_hash() }, m_decoder.is_last_field());
    }
 
    apx::error_t VirtualMachine::run_array_next()
@@ -0,0 +1,180 @@
+#include "pch.h"
+#include <array>
+#include <filesystem>
+#include <fstream>
+#include <string>
+
+#include "cpp-apx/capture.h"
+#include "cpp-apx/client.h"
+#include "cpp-apx/pack.h"
+#include "client_spy.h"
+#include "testsocket_spy.h"
+
+using namespace apx;
+using namespace std::string_literals;
+
+namespace apx_test
+{
+   static std::string capture_path(char const* name)
+   {
+      return (std::filesystem::temp_directory_path() / name).string();
+   }
+
+   TEST(Capture, FramesAreReadBackInOrder)
+   {
+      auto const path = capture_path("apx_capture_frames.bin");
+      std::array<std::uint8_t, 3> received{ 1u, 2u, 3u };
+      std::array<std::uint8_t, 2> sent{ 4u, 5u };
+      {
+         CaptureWriter writer;
+         ASSERT_EQ(writer.open(path.c_str()), APX_NO_ERROR);
+         writer.write_frame(CaptureDirection::Received, received.data(), received.size());
+         writer.write_frame(CaptureDirection::Sent, sent.data(), sent.size());
+         EXPECT_EQ(writer.num_frames(), 2u);
+         writer.close();
+         EXPECT_FALSE(writer.is_open());
+         writer.write_frame(CaptureDirection::Sent, sent.data(), sent.size());
+         EXPECT_EQ(writer.num_frames(), 2u);
+      }
+      EXPECT_EQ(std::filesystem::file_size(path), CAPTURE_HEADER_SIZE + 2 * CAPTURE_FRAME_HEADER_SIZE + received.size() + sent.size());
+      CaptureReader reader;
+      ASSERT_EQ(reader.open(path.c_str()), APX_NO_ERROR);
+      CaptureFrame frame;
+      bool has_frame{ false };
+      EXPECT_EQ(reader.read_next(frame, has_frame), APX_NO_ERROR);
+      ASSERT_TRUE(has_frame);
+      EXPECT_EQ(frame.direction, CaptureDirection::Received);
+      EXPECT_EQ(frame.data, ByteArray(received.begin(), received.end()));
+      auto const first_timestamp = frame.timestamp_ns;
+      EXPECT_EQ(reader.read_next(frame, has_frame), APX_NO_ERROR);
+      ASSERT_TRUE(has_frame);
+      EXPECT_EQ(frame.direction, CaptureDirection::Sent);
+      EXPECT_EQ(frame.data, ByteArray(sent.begin(), sent.end()));
+      EXPECT_GE(frame.timestamp_ns, first_timestamp);
+      EXPECT_EQ(reader.read_next(frame, has_frame), APX_NO_ERROR);
+      EXPECT_FALSE(has_frame);
+      std::filesystem::remove(path);
+   }
+
+   TEST(Capture, InvalidAndTruncatedFilesAreRejected)
+   {
+      auto const path = capture_path("apx_capture_invalid.bin");
+      {
+         std::ofstream file{ path, std::ios::binary };
+         file << "NOTACAPTURE";
+      }
+      CaptureReader reader1;
+      EXPECT_EQ(reader1.open(path.c_str()), APX_INVALID_HEADER_ERROR);
+      {
+         std::ofstream file{ path, std::ios::binary };
+         file.write(CAPTURE_MAGIC, CAPTURE_HEADER_SIZE);
+         file.write("\x00\x00\x00", 3);
+      }
+      CaptureReader reader2;
+      ASSERT_EQ(reader2.open(path.c_str()), APX_NO_ERROR);
+      CaptureFrame frame;
+      bool has_frame{ false };
+      EXPECT_EQ(reader2.read_next(frame, has_frame), APX_UNEXPECTED_END_ERROR);
+      EXPECT_FALSE(has_frame);
+      std::filesystem::remove(path);
+      CaptureReader reader3;
+      EXPECT_EQ(reader3.open(path.c_str()), APX_FILE_NOT_FOUND_ERROR);
+   }
+
+   TEST(Capture, FrameLengthIsValidatedBeforeReading)
+   {
+      auto const path = capture_path("apx_capture_length.bin");
+      auto write_frame_header = [&path](std::uint32_t data_size)
+      {
+         std::array<std::uint8_t, CAPTURE_FRAME_HEADER_SIZE> header{};
+         packLE<std::uint32_t>(header.data() + 9u, data_size);
+         std::ofstream file{ path, std::ios::binary };
+         file.write(CAPTURE_MAGIC, CAPTURE_HEADER_SIZE);
+         file.write(reinterpret_cast<char const*>(header.data()), header.size());
+         file.write("\x01\x02\x03", 3);
+      };
+      CaptureFrame frame;
+      bool has_frame{ false };
+      write_frame_header(0xFFFFFFFFu);
+      CaptureReader reader1;
+      ASSERT_EQ(reader1.open(path.c_str()), APX_NO_ERROR);
+      EXPECT_EQ(reader1.read_next(frame, has_frame), APX_MSG_TOO_LARGE_ERROR);
+      EXPECT_FALSE(has_frame);
+      EXPECT_TRUE(frame.data.empty());
+      write_frame_header(4u);
+      CaptureReader reader2;
+      ASSERT_EQ(reader2.open(path.c_str()), APX_NO_ERROR);
+      EXPECT_EQ(reader2.read_next(frame, has_frame), APX_UNEXPECTED_END_ERROR);
+      EXPECT_FALSE(has_frame);
+      EXPECT_TRUE(frame.data.empty());
+      write_frame_header(3u);
+      CaptureReader reader3;
+      ASSERT_EQ(reader3.open(path.c_str()), APX_NO_ERROR);
+      EXPECT_EQ(reader3.read_next(frame, has_frame), APX_NO_ERROR);
+      ASSERT_TRUE(has_frame);
+      EXPECT_EQ(frame.data, ByteArray({ 1u, 2u, 3u }));
+      std::filesystem::remove(path);
+   }
+
+   TEST(Capture, CapturedTrafficCanBeReplayed)
+   {
+      char const* apx_text = "APX/1.2\n"
+         "N\"TestNode1\"\n"
+         "R\"RequirePort1\"C(0,3):=3\n"
+         "R\"RequirePort2\"C(0,7):=7\n";
+      auto const path = capture_path("apx_capture_replay.bin");
+
+      testsocket_spy_create();
+      {
+         Client client;
+         EXPECT_EQ(client.build_node(apx_text), APX_NO_ERROR);
+         ASSERT_EQ(client.start_capture(path.c_str()), APX_NO_ERROR);
+         client.connect(testsocket_client_spy());
+         client.run();
+         client.receive_accepted_cmd();
+         client.receive_file_info_cmd(PORT_DATA_ADDRESS_START, "TestNode1.in", 2u);
+         client.run();
+         std::array<std::uint8_t, 2> port_data{ 2, 5 };
+         client.receive_data_messsage(PORT_DATA_ADDRESS_START, port_data.data(), port_data.size());
+         client.run();
+         client.stop_capture();
+      }
+      testsocket_spy_destroy();
+
+      CaptureReader reader;
+      ASSERT_EQ(reader.open(path.c_str()), APX_NO_ERROR);
+      CaptureFrame frame;
+      bool has_frame{ false };
+      std::size_t num_received{ 0u };
+      std::size_t num_sent{ 0u };
+      while ((reader.read_next(frame, has_frame) == APX_NO_ERROR) && has_frame)
+      {
+         (frame.direction == CaptureDirection::Received) ? num_received++ : num_sent++;
+      }
+      EXPECT_GT(num_received, 0u);
+      EXPECT_GT(num_sent, 0u);
+
+      testsocket_spy_create();
+      {
+         Client client;
+         ClientSpy spy;
+         client.register_event_listener(&spy);
+         EXPECT_EQ(client.build_node(apx_text), APX_NO_ERROR);
+         auto* socket = testsocket_client_spy();
+         client.connect(socket);
+         client.run();
+         ReplayResult result;
+         EXPECT_EQ(replay_capture(path.c_str(), client, socket, ReplaySpeed::Maximum, result), APX_NO_ERROR);
+         EXPECT_EQ(result.num_frames, num_received);
+         EXPECT_EQ(spy.require_port_write_count(), 2);
+         auto* port_instance = client.get_port("TestNode1", "RequirePort2");
+         ASSERT_TRUE(port_instance);
+         dtl::ScalarValue sv;
+         EXPECT_EQ(client.read_port_value(port_instance, sv), APX_NO_ERROR);
+         bool ok{ false };
+         EXPECT_EQ(sv->to_u32(ok), 5u);
+      }
+      testsocket_spy_destroy();
+      std::filesystem::remove(path);
+   }
+}
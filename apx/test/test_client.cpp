@@ -1,6 +1,11 @@
 #include "pch.h"
+#include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstring>
+#include <string>
+#include <thread>
+#include <vector>
 
 #include "cpp-apx/client.h"
 #include "client_spy.h"
@@ -8,6 +13,7 @@
 
 using namespace apx;
 using namespace std::string_literals;
+using namespace std::string_view_literals;
 
 namespace apx_test
 {
@@ -93,4 +99,261 @@ namespace apx_test
       EXPECT_EQ(read_buffer[0], 1u);
       EXPECT_EQ(read_buffer[1], 7u);
    }
+
+   TEST(Client, ReadRecordPortIntoReusedValue)
+   {
+      char const* apx_text = "APX/1.3\n"
+         "N\"TestNode1\"\n"
+         "R\"RecordPort\"{\"Id\"S\"Name\"a[8]\"Values\"C[3]}:={7, \"abc\", {1, 2, 3}}\n";
+
+      Client client;
+      EXPECT_EQ(client.build_node(apx_text), APX_NO_ERROR);
+      auto* port_instance = client.get_port("TestNode1", "RecordPort");
+      ASSERT_TRUE(port_instance);
+      dtl::DynamicValue dv;
+      EXPECT_EQ(client.read_port_value(port_instance, dv), APX_NO_ERROR);
+      auto hv = dtl::hv_cast(dv);
+      ASSERT_TRUE(hv);
+      auto name_sv = dtl::sv_cast(hv->at("Name"));
+      auto values_ta = dtl::ta_cast<std::uint8_t>(hv->at("Values"));
+      ASSERT_TRUE(name_sv && values_ta);
+      bool ok{ false };
+      EXPECT_EQ(name_sv->to_string(ok), "abc"s);
+      EXPECT_EQ(values_ta->at(2), 3u);
+
+      std::array<std::uint8_t, vm::UINT16_SIZE + 8u + 3u> port_data{ 0x34, 0x12, 'x', 'y', 0, 0, 0, 0, 0, 0, 4, 5, 6 };
+      auto* node_data = port_instance->node_instance()->get_node_data();
+      ASSERT_TRUE(node_data);
+      EXPECT_EQ(node_data->write_require_port_data(port_instance->data_offset(), port_data.data(), port_data.size()), APX_NO_ERROR);
+      EXPECT_EQ(client.read_port_value(port_instance, dv), APX_NO_ERROR);
+      EXPECT_EQ(dv.get(), hv.get());
+      EXPECT_EQ(hv->at("Name").get(), name_sv.get());
+      EXPECT_EQ(hv->at("Values").get(), values_ta.get());
+      EXPECT_EQ(dtl::sv_cast(hv->at("Id"))->to_u32(ok), 0x1234u);
+      EXPECT_TRUE(ok);
+      EXPECT_EQ(name_sv->to_string(ok), "xy"s);
+      EXPECT_EQ(values_ta->at(0), 4u);
+      EXPECT_EQ(values_ta->at(2), 6u);
+
+      dtl::ScalarValue sv;
+      EXPECT_EQ(client.read_port_value(port_instance, sv), APX_VALUE_TYPE_ERROR);
+   }
+
+   TEST(Client, ReadByteArrayAndStringPortsAsViews)
+   {
+      char const* apx_text = "APX/1.3\n"
+         "N\"TestNode1\"\n"
+         "R\"BytesPort\"B[6*]\n"
+         "R\"NamePort\"a[8]:=\"abc\"\n"
+         "R\"CountPort\"C:=0\n";
+
+      Client client;
+      EXPECT_EQ(client.build_node(apx_text), APX_NO_ERROR);
+      auto* bytes_port = client.get_port("TestNode1", "BytesPort");
+      auto* name_port = client.get_port("TestNode1", "NamePort");
+      auto* count_port = client.get_port("TestNode1", "CountPort");
+      ASSERT_TRUE(bytes_port && name_port && count_port);
+      auto* node_data = bytes_port->node_instance()->get_node_data();
+      ASSERT_TRUE(node_data);
+      std::array<std::uint8_t, vm::UINT8_SIZE + 6u> port_data{ 3u, 0xAu, 0xBu, 0xCu, 0u, 0u, 0u };
+      EXPECT_EQ(node_data->write_require_port_data(bytes_port->data_offset(), port_data.data(), port_data.size()), APX_NO_ERROR);
+
+      apx::ByteArray snapshot;
+      std::span<std::uint8_t const> bytes;
+      EXPECT_EQ(client.read_port_bytes(bytes_port, snapshot, bytes), APX_NO_ERROR);
+      ASSERT_EQ(bytes.size(), 3u);
+      EXPECT_EQ(bytes.data(), snapshot.data() + vm::UINT8_SIZE);
+      EXPECT_EQ(bytes[0], 0xAu);
+      EXPECT_EQ(bytes[2], 0xCu);
+
+      std::string_view name;
+      EXPECT_EQ(client.read_port_string(name_port, snapshot, name), APX_NO_ERROR);
+      EXPECT_EQ(name, "abc"sv);
+      EXPECT_EQ(name.data(), reinterpret_cast<char const*>(snapshot.data()));
+
+      EXPECT_EQ(client.read_port_bytes(name_port, snapshot, bytes), APX_VALUE_TYPE_ERROR);
+      EXPECT_EQ(client.read_port_string(count_port, snapshot, name), APX_VALUE_TYPE_ERROR);
+   }
+
+   TEST(Client, ProvidePortWrite_Record)
+   {
+      char const* apx_text = "APX/1.3\n"
+         "N\"TestNode1\"\n"
+         "P\"RecordPort\"{\"Id\"S\"Values\"C[2]}:={0, {0, 0}}\n";
+
+      Client client;
+      EXPECT_EQ(client.build_node(apx_text), APX_NO_ERROR);
+      auto* port_instance = client.get_port("TestNode1", "RecordPort");
+      ASSERT_TRUE(port_instance);
+      auto hv = dtl::make_hv();
+      hv->set("Id", dtl::make_sv<std::uint32_t>(0x1234u));
+      hv->set("Values", dtl::make_ta<std::uint8_t>({ 1u, 2u }));
+      EXPECT_EQ(client.write_port_value(port_instance, dtl::dv_cast(hv)), APX_NO_ERROR);
+      auto* node_data = port_instance->node_instance()->get_node_data();
+      ASSERT_TRUE(node_data);
+      std::array<std::uint8_t, vm::UINT16_SIZE + 2u> read_buffer;
+      EXPECT_EQ(node_data->read_provide_port_data(0, read_buffer.data(), read_buffer.size()), APX_NO_ERROR);
+      EXPECT_EQ(read_buffer[0], 0x34u);
+      EXPECT_EQ(read_buffer[1], 0x12u);
+      EXPECT_EQ(read_buffer[2], 1u);
+      EXPECT_EQ(read_buffer[3], 2u);
+   }
+
+   TEST(Client, MetricsSnapshot)
+   {
+      char const* apx_text = "APX/1.2\n"
+         "N\"TestNode1\"\n"
+         "R\"RequirePort1\"C(0,3):=3\n"
+         "R\"RequirePort2\"C(0,7):=7\n";
+
+      testsocket_spy_create();
+      {
+         Client client;
+         MetricsSnapshot snapshot;
+         EXPECT_EQ(client.build_node(apx_text), APX_NO_ERROR);
+         client.get_metrics(snapshot);
+         EXPECT_EQ(snapshot.messages_received, 0u);
+         ASSERT_EQ(snapshot.nodes.size(), 1u);
+         EXPECT_EQ(snapshot.nodes[0].name, "TestNode1"s);
+         EXPECT_EQ(snapshot.nodes[0].require_port_writes, 0u);
+         auto* socket = testsocket_client_spy();
+         client.connect(socket);
+         client.run();
+         client.receive_accepted_cmd();
+         client.receive_file_info_cmd(PORT_DATA_ADDRESS_START, "TestNode1.in", 2u);
+         client.run();
+         std::array<std::uint8_t, 2> port_data{ 0, 1 };
+         client.receive_data_messsage(PORT_DATA_ADDRESS_START, port_data.data(), port_data.size());
+         client.run();
+         client.get_metrics(snapshot);
+         EXPECT_EQ(snapshot.messages_received, 3u);
+         EXPECT_GT(snapshot.bytes_received, 0u);
+         EXPECT_GT(snapshot.messages_sent, 0u);
+         EXPECT_GT(snapshot.bytes_sent, 0u);
+         EXPECT_GT(snapshot.commands_processed, 0u);
+         EXPECT_GE(snapshot.max_queue_depth, 1u);
+         EXPECT_EQ(snapshot.queue_depth, 0u);
+         EXPECT_EQ(snapshot.parse_errors, 0u);
+         EXPECT_EQ(snapshot.reception_errors, 0u);
+         ASSERT_EQ(snapshot.nodes.size(), 1u);
+         EXPECT_EQ(snapshot.nodes[0].require_port_writes, 1u);
+         EXPECT_EQ(snapshot.nodes[0].provide_port_writes, 0u);
+      }
+      testsocket_spy_destroy();
+   }
+
+   TEST(Client, MetricsSnapshotReusesNodeEntries)
+   {
+      Client client;
+      MetricsSnapshot snapshot;
+      EXPECT_EQ(client.build_node("APX/1.2\nN\"TestNode1\"\nP\"Port\"C\n"), APX_NO_ERROR);
+      EXPECT_EQ(client.build_node("APX/1.2\nN\"TestNode2\"\nP\"Port\"C\n"), APX_NO_ERROR);
+      client.get_metrics(snapshot);
+      ASSERT_EQ(snapshot.nodes.size(), 2u);
+      auto const* nodes_before = snapshot.nodes.data();
+      client.get_metrics(snapshot);
+      ASSERT_EQ(snapshot.nodes.size(), 2u);
+      EXPECT_EQ(snapshot.nodes.data(), nodes_before);
+      std::vector<std::string> names{ snapshot.nodes[0].name, snapshot.nodes[1].name };
+      std::sort(names.begin(), names.end());
+      EXPECT_EQ(names[0], "TestNode1"s);
+      EXPECT_EQ(names[1], "TestNode2"s);
+      //Entries left over from a larger snapshot are dropped
+      snapshot.nodes.resize(5u);
+      client.get_metrics(snapshot);
+      EXPECT_EQ(snapshot.nodes.size(), 2u);
+   }
+
+   TEST(Client, MetricsCanBeReadWhileNodesAreBuilt)
+   {
+      Client client;
+      std::atomic<bool> is_done{ false };
+      std::thread reader([&client, &is_done]()
+         {
+            MetricsSnapshot snapshot;
+            while (!is_done.load())
+            {
+               client.get_metrics(snapshot);
+               EXPECT_LE(snapshot.nodes.size(), 20u);
+            }
+         });
+      for (int i = 0; i < 20; i++)
+      {
+         EXPECT_EQ(client.build_node("APX/1.2\nN\"TestNode" + std::to_string(i) + "\"\nP\"Port\"C\n"), APX_NO_ERROR);
+      }
+      is_done.store(true);
+      reader.join();
+      MetricsSnapshot snapshot;
+      client.get_metrics(snapshot);
+      EXPECT_EQ(snapshot.nodes.size(), 20u);
+   }
+
+   TEST(Client, MetricsCanBeReadWhileConnectionIsReplaced)
+   {
+      testsocket_spy_create();
+      {
+         Client client;
+         EXPECT_EQ(client.build_node("APX/1.2\nN\"TestNode1\"\nP\"Port\"C\n"), APX_NO_ERROR);
+         auto* port = client.get_port("TestNode1", "Port");
+         ASSERT_NE(port, nullptr);
+         client.set_latency_tracing(true);
+         std::atomic<bool> is_done{ false };
+         std::thread reader([&client, &is_done]()
+            {
+               MetricsSnapshot snapshot;
+               LatencySnapshot latency;
+               while (!is_done.load())
+               {
+                  client.get_metrics(snapshot);
+                  client.get_latency(latency);
+                  EXPECT_EQ(snapshot.nodes.size(), 1u);
+               }
+            });
+         auto* socket = testsocket_client_spy();
+         dtl::ScalarValue sv = dtl::make_sv<std::uint32_t>(1u);
+         for (int i = 0; i < 20; i++)
+         {
+            EXPECT_EQ(client.connect(socket), APX_NO_ERROR);
+            EXPECT_EQ(client.write_port_value(port, sv), APX_NO_ERROR);
+            client.run();
+         }
+         is_done.store(true);
+         reader.join();
+      }
+      testsocket_spy_destroy();
+   }
+
+   TEST(Client, RequirePortLatencyIsRecordedWhileTracingIsEnabled)
+   {
+      char const* apx_text = "APX/1.2\n"
+         "N\"TestNode1\"\n"
+         "R\"RequirePort1\"C(0,3):=3\n"
+         "R\"RequirePort2\"C(0,7):=7\n";
+
+      testsocket_spy_create();
+      {
+         Client client;
+         LatencySnapshot snapshot;
+         EXPECT_EQ(client.build_node(apx_text), APX_NO_ERROR);
+         client.set_latency_tracing(true);
+         auto* socket = testsocket_client_spy();
+         client.connect(socket);
+         client.run();
+         client.receive_accepted_cmd();
+         client.receive_file_info_cmd(PORT_DATA_ADDRESS_START, "TestNode1.in", 2u);
+         client.run();
+         std::array<std::uint8_t, 2> port_data{ 0, 1 };
+         client.receive_data_messsage(PORT_DATA_ADDRESS_START, port_data.data(), port_data.size());
+         client.run();
+         client.get_latency(snapshot);
+         EXPECT_EQ(snapshot.receive_to_notify.count, 2u);
+         EXPECT_EQ(snapshot.write_to_queue.count, 0u);
+         client.set_latency_tracing(false);
+         client.receive_data_messsage(PORT_DATA_ADDRESS_START, port_data.data(), port_data.size());
+         client.run();
+         client.get_latency(snapshot);
+         EXPECT_EQ(snapshot.receive_to_notify.count, 2u);
+      }
+      testsocket_spy_destroy();
+   }
 }
\ No newline at end of file
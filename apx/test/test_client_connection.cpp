@@ -1,6 +1,8 @@
 #include "pch.h"
 #include <array>
 #include <cstring>
+#include <string>
+#include <vector>
 
 #include "cpp-apx/mock_client_connection.h"
 #include "cpp-apx/remotefile.h"
@@ -135,6 +137,220 @@ namespace apx_test
       EXPECT_EQ(buffer2[4], 0x07u);
    }
 
+   TEST(ClientConnection, ProvidePortWriteIsSentAfterFileIsOpened)
+   {
+      char const* apx_text = "APX/1.2\n"
+         "N\"TestNode1\"\n"
+         "P\"ProvidePort1\"C(0,3):=3\n"
+         "P\"ProvidePort2\"C(0,7):=7\n";
+      MockClientConnection mock_connection;
+      EXPECT_EQ(mock_connection.build_node(apx_text), APX_NO_ERROR);
+      auto* node_instance = mock_connection.find_node("TestNode1");
+      ASSERT_TRUE(node_instance);
+      std::uint8_t value{ 1u };
+      EXPECT_EQ(node_instance->write_provide_port_data(1u, &value, sizeof(value)), APX_NO_ERROR);
+      mock_connection.greeting_header_accepted();
+      mock_connection.run();
+      mock_connection.clear_log();
+      EXPECT_EQ(mock_connection.request_open_local_file("TestNode1.out"), APX_NO_ERROR);
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.log_length(), 1u);
+      auto const& buffer1 = mock_connection.get_log_packet(0);
+      EXPECT_EQ(buffer1.size(), numheader::SHORT_SIZE + rmf::LOW_ADDR_SIZE + sizeof(std::uint8_t) * 2);
+      EXPECT_EQ(buffer1[3], 0x03u);
+      EXPECT_EQ(buffer1[4], 0x01u);
+      mock_connection.clear_log();
+      value = 2u;
+      EXPECT_EQ(node_instance->write_provide_port_data(1u, &value, sizeof(value)), APX_NO_ERROR);
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.log_length(), 1u);
+      auto const& buffer2 = mock_connection.get_log_packet(0);
+      EXPECT_EQ(buffer2.size(), numheader::SHORT_SIZE + rmf::LOW_ADDR_SIZE + sizeof(std::uint8_t));
+      std::uint32_t address{ rmf::INVALID_ADDRESS };
+      bool more_bit{ false };
+      EXPECT_EQ(rmf::address_decode(&buffer2[1], &buffer2[1] + rmf::LOW_ADDR_SIZE, address, more_bit), rmf::LOW_ADDR_SIZE);
+      EXPECT_EQ(address, PORT_DATA_ADDRESS_START + 1u);
+      EXPECT_EQ(buffer2[3], 0x02u);
+   }
+
+   TEST(ClientConnection, ProvidePortWriteIsRejectedWhenHighWaterMarkIsReached)
+   {
+      char const* apx_text = "APX/1.2\n"
+         "N\"TestNode1\"\n"
+         "P\"ProvidePort1\"C(0,3):=3\n"
+         "P\"ProvidePort2\"C(0,7):=7\n";
+      MockClientConnection mock_connection;
+      EXPECT_EQ(mock_connection.build_node(apx_text), APX_NO_ERROR);
+      auto* node_instance = mock_connection.find_node("TestNode1");
+      ASSERT_TRUE(node_instance);
+      mock_connection.greeting_header_accepted();
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.request_open_local_file("TestNode1.out"), APX_NO_ERROR);
+      mock_connection.run();
+      mock_connection.clear_log();
+      mock_connection.set_transmit_high_water_mark(2u);
+      std::uint8_t value{ 1u };
+      EXPECT_EQ(node_instance->write_provide_port_data(0u, &value, sizeof(value)), APX_NO_ERROR);
+      EXPECT_EQ(node_instance->write_provide_port_data(1u, &value, sizeof(value)), APX_NO_ERROR);
+      EXPECT_EQ(node_instance->write_provide_port_data(1u, &value, sizeof(value)), APX_QUEUE_FULL_ERROR);
+      EXPECT_EQ(mock_connection.transmit_queued_bytes(), 2u);
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.log_length(), 1u);
+      EXPECT_EQ(mock_connection.get_log_packet(0).size(), (numheader::SHORT_SIZE + rmf::LOW_ADDR_SIZE + sizeof(std::uint8_t)) * 2);
+      EXPECT_EQ(mock_connection.transmit_queued_bytes(), 1u); //The rejected write was queued again once the queue drained
+      EXPECT_EQ(node_instance->write_provide_port_data(0u, &value, sizeof(value)), APX_NO_ERROR);
+   }
+
+   TEST(ClientConnection, RejectedProvidePortWritesAreSentWhenQueueDrains)
+   {
+      char const* apx_text = "APX/1.2\n"
+         "N\"TestNode1\"\n"
+         "P\"ProvidePort1\"C(0,3):=3\n"
+         "P\"ProvidePort2\"C(0,7):=7\n"
+         "P\"ProvidePort3\"C(0,7):=7\n"
+         "P\"ProvidePort4\"C(0,7):=7\n";
+      MockClientConnection mock_connection;
+      EXPECT_EQ(mock_connection.build_node(apx_text), APX_NO_ERROR);
+      auto* node_instance = mock_connection.find_node("TestNode1");
+      ASSERT_TRUE(node_instance);
+      mock_connection.greeting_header_accepted();
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.request_open_local_file("TestNode1.out"), APX_NO_ERROR);
+      mock_connection.run();
+      mock_connection.clear_log();
+      mock_connection.set_transmit_high_water_mark(1u);
+      std::uint8_t value{ 1u };
+      EXPECT_EQ(node_instance->write_provide_port_data(0u, &value, sizeof(value)), APX_NO_ERROR);
+      value = 2u;
+      EXPECT_EQ(node_instance->write_provide_port_data(1u, &value, sizeof(value)), APX_QUEUE_FULL_ERROR);
+      value = 4u;
+      EXPECT_EQ(node_instance->write_provide_port_data(3u, &value, sizeof(value)), APX_QUEUE_FULL_ERROR);
+      value = 5u;
+      EXPECT_EQ(node_instance->write_provide_port_data(3u, &value, sizeof(value)), APX_QUEUE_FULL_ERROR);
+      EXPECT_EQ(mock_connection.transmit_queued_bytes(), 1u);
+      mock_connection.set_transmit_high_water_mark(10u);
+      mock_connection.run(); //Sends the accepted write, then queues the dirty ranges
+      EXPECT_EQ(mock_connection.log_length(), 1u);
+      EXPECT_EQ(mock_connection.get_log_packet(0)[3], 0x01u);
+      EXPECT_EQ(mock_connection.transmit_queued_bytes(), 2u);
+      mock_connection.clear_log();
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.log_length(), 1u);
+      auto const& buffer = mock_connection.get_log_packet(0);
+      //Each dirty range is sent in its own message, ProvidePort4 only once with its latest value
+      ASSERT_EQ(buffer.size(), (numheader::SHORT_SIZE + rmf::LOW_ADDR_SIZE + sizeof(std::uint8_t)) * 2);
+      std::uint32_t address{ rmf::INVALID_ADDRESS };
+      bool more_bit{ false };
+      EXPECT_EQ(rmf::address_decode(&buffer[1], &buffer[1] + rmf::LOW_ADDR_SIZE, address, more_bit), rmf::LOW_ADDR_SIZE);
+      EXPECT_EQ(address, PORT_DATA_ADDRESS_START + 1u);
+      EXPECT_EQ(buffer[3], 0x02u);
+      EXPECT_EQ(rmf::address_decode(&buffer[5], &buffer[5] + rmf::LOW_ADDR_SIZE, address, more_bit), rmf::LOW_ADDR_SIZE);
+      EXPECT_EQ(address, PORT_DATA_ADDRESS_START + 3u);
+      EXPECT_EQ(buffer[7], 0x05u);
+      EXPECT_EQ(mock_connection.transmit_queued_bytes(), 0u);
+   }
+
+   TEST(ClientConnection, ProvidePortWritesAreCoalescedWithLatestValueWinsPolicy)
+   {
+      char const* apx_text = "APX/1.2\n"
+         "N\"TestNode1\"\n"
+         "P\"ProvidePort1\"C(0,3):=3\n"
+         "P\"ProvidePort2\"C(0,7):=7\n";
+      MockClientConnection mock_connection;
+      EXPECT_EQ(mock_connection.build_node(apx_text), APX_NO_ERROR);
+      auto* node_instance = mock_connection.find_node("TestNode1");
+      ASSERT_TRUE(node_instance);
+      auto* port_instance = node_instance->find("ProvidePort2");
+      ASSERT_TRUE(port_instance);
+      EXPECT_EQ(port_instance->coalesce_slot(), nullptr);
+      port_instance->set_write_policy(WritePolicy::LatestValueWins);
+      mock_connection.greeting_header_accepted();
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.request_open_local_file("TestNode1.out"), APX_NO_ERROR);
+      mock_connection.run();
+      mock_connection.clear_log();
+      mock_connection.set_transmit_high_water_mark(1u);
+      for (std::uint8_t value = 4u; value <= 6u; value++)
+      {
+         EXPECT_EQ(node_instance->write_provide_port_data(port_instance->data_offset(), &value, sizeof(value), port_instance->coalesce_slot()), APX_NO_ERROR);
+      }
+      EXPECT_EQ(mock_connection.transmit_queued_bytes(), 1u);
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.log_length(), 1u);
+      auto const& buffer = mock_connection.get_log_packet(0);
+      EXPECT_EQ(buffer.size(), numheader::SHORT_SIZE + rmf::LOW_ADDR_SIZE + sizeof(std::uint8_t));
+      EXPECT_EQ(buffer[3], 0x06u);
+      mock_connection.clear_log();
+      std::uint8_t value{ 7u };
+      EXPECT_EQ(node_instance->write_provide_port_data(port_instance->data_offset(), &value, sizeof(value), port_instance->coalesce_slot()), APX_NO_ERROR);
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.log_length(), 1u);
+      EXPECT_EQ(mock_connection.get_log_packet(0)[3], 0x07u);
+   }
+
+   TEST(ClientConnection, ResumeSendsOnlyProvidePortDataChangedWhileDisconnected)
+   {
+      char const* apx_text = "APX/1.2\n"
+         "N\"TestNode1\"\n"
+         "P\"ProvidePort1\"C(0,3):=3\n"
+         "P\"ProvidePort2\"C(0,7):=7\n"
+         "P\"ProvidePort3\"C(0,7):=7\n";
+      MockClientConnection mock_connection;
+      EXPECT_EQ(mock_connection.build_node(apx_text), APX_NO_ERROR);
+      auto* node_instance = mock_connection.find_node("TestNode1");
+      ASSERT_TRUE(node_instance);
+      mock_connection.greeting_header_accepted();
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.request_open_local_file("TestNode1.out"), APX_NO_ERROR);
+      mock_connection.run();
+      mock_connection.disconnected();
+      std::uint8_t value{ 5u };
+      EXPECT_EQ(node_instance->write_provide_port_data(2u, &value, sizeof(value)), APX_NO_ERROR);
+      mock_connection.greeting_header_accepted();
+      mock_connection.run();
+      mock_connection.clear_log();
+      EXPECT_EQ(mock_connection.request_resume_local_file("TestNode1.apx"), APX_NO_ERROR);
+      EXPECT_EQ(mock_connection.request_resume_local_file("TestNode1.out"), APX_NO_ERROR);
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.log_length(), 1u);
+      auto const& buffer = mock_connection.get_log_packet(0);
+      EXPECT_EQ(buffer.size(), numheader::SHORT_SIZE + rmf::LOW_ADDR_SIZE + sizeof(std::uint8_t));
+      std::uint32_t address{ rmf::INVALID_ADDRESS };
+      bool more_bit{ false };
+      EXPECT_EQ(rmf::address_decode(&buffer[1], &buffer[1] + rmf::LOW_ADDR_SIZE, address, more_bit), rmf::LOW_ADDR_SIZE);
+      EXPECT_EQ(address, PORT_DATA_ADDRESS_START + 2u);
+      EXPECT_EQ(buffer[3], 0x05u);
+   }
+
+   TEST(ClientConnection, WritesQueuedAtDisconnectAreSentOnResume)
+   {
+      char const* apx_text = "APX/1.2\n"
+         "N\"TestNode1\"\n"
+         "P\"ProvidePort1\"C(0,3):=3\n"
+         "P\"ProvidePort2\"C(0,7):=7\n";
+      MockClientConnection mock_connection;
+      EXPECT_EQ(mock_connection.build_node(apx_text), APX_NO_ERROR);
+      auto* node_instance = mock_connection.find_node("TestNode1");
+      ASSERT_TRUE(node_instance);
+      mock_connection.greeting_header_accepted();
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.request_open_local_file("TestNode1.out"), APX_NO_ERROR);
+      mock_connection.run();
+      std::uint8_t value{ 1u };
+      EXPECT_EQ(node_instance->write_provide_port_data(0u, &value, sizeof(value)), APX_NO_ERROR);
+      mock_connection.disconnected();
+      EXPECT_EQ(mock_connection.transmit_queued_bytes(), 0u);
+      mock_connection.greeting_header_accepted();
+      mock_connection.run();
+      mock_connection.clear_log();
+      EXPECT_EQ(mock_connection.request_resume_local_file("TestNode1.out"), APX_NO_ERROR);
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.log_length(), 1u);
+      auto const& buffer = mock_connection.get_log_packet(0);
+      EXPECT_EQ(buffer.size(), numheader::SHORT_SIZE + rmf::LOW_ADDR_SIZE + sizeof(std::uint8_t));
+      EXPECT_EQ(buffer[3], 0x01u);
+   }
+
    TEST(ClientConnection, RequirePortFileIsRequestedWhenPublishedByServer)
    {
       char const* apx_text = "APX/1.2\n"
@@ -195,4 +411,208 @@ namespace apx_test
       EXPECT_EQ(require_port_data[0], 1u);
       EXPECT_EQ(require_port_data[1], 0u);
    }
+
+   TEST(ClientConnection, LargeProvidePortFileIsSentInFragments)
+   {
+      char const* apx_text = "APX/1.2\n"
+         "N\"TestNode1\"\n"
+         "P\"Payload\"C[2000]\n";
+      MockClientConnection mock_connection;
+      EXPECT_EQ(mock_connection.build_node(apx_text), APX_NO_ERROR);
+      mock_connection.greeting_header_accepted();
+      mock_connection.run();
+      mock_connection.clear_log();
+      EXPECT_EQ(mock_connection.request_open_local_file("TestNode1.out"), APX_NO_ERROR);
+      mock_connection.run();
+      ASSERT_EQ(mock_connection.log_length(), 2u);
+      std::uint32_t expected_address{ PORT_DATA_ADDRESS_START };
+      for (std::size_t i = 0u; i < mock_connection.log_length(); i++)
+      {
+         auto const& packet = mock_connection.get_log_packet(i);
+         std::uint32_t msg_size{ 0u };
+         auto const header1_size = numheader::decode32(packet.data(), packet.data() + packet.size(), msg_size);
+         ASSERT_GT(header1_size, 0u);
+         EXPECT_EQ(packet.size(), header1_size + msg_size);
+         std::uint32_t address{ rmf::INVALID_ADDRESS };
+         bool more_bit{ false };
+         auto const header2_size = rmf::address_decode(packet.data() + header1_size, packet.data() + packet.size(), address, more_bit);
+         ASSERT_GT(header2_size, 0u);
+         EXPECT_EQ(address, expected_address);
+         EXPECT_EQ(more_bit, i == 0u);
+         expected_address += static_cast<std::uint32_t>(msg_size - header2_size);
+      }
+      EXPECT_EQ(expected_address, PORT_DATA_ADDRESS_START + 2000u);
+   }
+
+   struct DecodedDataMessage
+   {
+      std::uint32_t address;
+      bool more_bit;
+      std::size_t data_size;
+   };
+
+   static std::vector<DecodedDataMessage> decode_data_messages(MockClientConnection& mock_connection)
+   {
+      std::vector<DecodedDataMessage> result;
+      for (std::size_t i = 0u; i < mock_connection.log_length(); i++)
+      {
+         auto const& packet = mock_connection.get_log_packet(i);
+         auto const* next = packet.data();
+         auto const* end = packet.data() + packet.size();
+         while (next < end)
+         {
+            std::uint32_t msg_size{ 0u };
+            auto const header1_size = numheader::decode32(next, end, msg_size);
+            if (header1_size == 0u)
+            {
+               return result;
+            }
+            DecodedDataMessage msg{ rmf::INVALID_ADDRESS, false, 0u };
+            auto const header2_size = rmf::address_decode(next + header1_size, end, msg.address, msg.more_bit);
+            msg.data_size = msg_size - header2_size;
+            result.push_back(msg);
+            next += header1_size + msg_size;
+         }
+      }
+      return result;
+   }
+
+   TEST(ClientConnection, MockTransmitBufferIsReusedAfterFlush)
+   {
+      MockClientConnection mock_connection;
+      std::vector<std::uint8_t> data1(600u, 0x11u);
+      std::vector<std::uint8_t> data2(600u, 0x22u);
+      std::vector<std::uint8_t> data3(10u, 0x33u);
+      std::int32_t bytes_available{ 0 };
+      mock_connection.transmit_begin();
+      EXPECT_EQ(mock_connection.transmit_data_message(0u, false, data1.data(), static_cast<std::int32_t>(data1.size()), bytes_available), APX_NO_ERROR);
+      //Does not fit, data1 is flushed first
+      EXPECT_EQ(mock_connection.transmit_data_message(600u, false, data2.data(), static_cast<std::int32_t>(data2.size()), bytes_available), APX_NO_ERROR);
+      EXPECT_EQ(mock_connection.transmit_current_bytes_avaiable(), 1024);
+      EXPECT_GT(bytes_available, 0);
+      EXPECT_LT(bytes_available, 1024 - 600);
+      EXPECT_EQ(mock_connection.transmit_data_message(1200u, false, data3.data(), static_cast<std::int32_t>(data3.size()), bytes_available), APX_NO_ERROR);
+      mock_connection.transmit_end();
+      ASSERT_EQ(mock_connection.log_length(), 2u);
+      auto const messages = decode_data_messages(mock_connection);
+      ASSERT_EQ(messages.size(), 3u);
+      EXPECT_EQ(messages[0].address, 0u);
+      EXPECT_EQ(messages[0].data_size, data1.size());
+      EXPECT_EQ(messages[1].address, 600u);
+      EXPECT_EQ(messages[1].data_size, data2.size());
+      EXPECT_EQ(messages[2].address, 1200u);
+      EXPECT_EQ(messages[2].data_size, data3.size());
+      auto const& packet = mock_connection.get_log_packet(1);
+      std::uint32_t msg_size{ 0u };
+      auto const header1_size = numheader::decode32(packet.data(), packet.data() + packet.size(), msg_size);
+      std::uint32_t address{ rmf::INVALID_ADDRESS };
+      bool more_bit{ false };
+      auto const header2_size = rmf::address_decode(packet.data() + header1_size, packet.data() + packet.size(), address, more_bit);
+      EXPECT_EQ(packet[header1_size + header2_size], 0x22u);
+      EXPECT_EQ(packet.back(), 0x33u);
+   }
+
+   TEST(ClientConnection, ProvidePortFileOfMaxFragmentSizeIsSentInOneMessage)
+   {
+      std::size_t const max_fragment_size = 1024u - (numheader::LONG32_SIZE + rmf::HIGH_ADDR_SIZE);
+      std::string const apx_text = "APX/1.2\nN\"TestNode1\"\nP\"Payload\"C[" + std::to_string(max_fragment_size) + "]\n";
+      MockClientConnection mock_connection;
+      EXPECT_EQ(mock_connection.transmit_max_bytes_avaiable(), 1024);
+      EXPECT_EQ(mock_connection.build_node(apx_text.c_str()), APX_NO_ERROR);
+      mock_connection.greeting_header_accepted();
+      mock_connection.run();
+      mock_connection.clear_log();
+      EXPECT_EQ(mock_connection.request_open_local_file("TestNode1.out"), APX_NO_ERROR);
+      mock_connection.run();
+      auto const messages = decode_data_messages(mock_connection);
+      ASSERT_EQ(messages.size(), 1u);
+      EXPECT_EQ(messages[0].address, PORT_DATA_ADDRESS_START);
+      EXPECT_FALSE(messages[0].more_bit);
+      EXPECT_EQ(messages[0].data_size, max_fragment_size);
+   }
+
+   TEST(ClientConnection, ProvidePortFileOneByteAboveMaxFragmentSizeIsSentInTwoMessages)
+   {
+      std::size_t const max_fragment_size = 1024u - (numheader::LONG32_SIZE + rmf::HIGH_ADDR_SIZE);
+      std::string const apx_text = "APX/1.2\nN\"TestNode1\"\nP\"Payload\"C[" + std::to_string(max_fragment_size + 1u) + "]\n";
+      MockClientConnection mock_connection;
+      EXPECT_EQ(mock_connection.build_node(apx_text.c_str()), APX_NO_ERROR);
+      mock_connection.greeting_header_accepted();
+      mock_connection.run();
+      mock_connection.clear_log();
+      EXPECT_EQ(mock_connection.request_open_local_file("TestNode1.out"), APX_NO_ERROR);
+      mock_connection.run();
+      auto const messages = decode_data_messages(mock_connection);
+      ASSERT_EQ(messages.size(), 2u);
+      EXPECT_EQ(messages[0].address, PORT_DATA_ADDRESS_START);
+      EXPECT_TRUE(messages[0].more_bit);
+      EXPECT_EQ(messages[0].data_size, max_fragment_size);
+      EXPECT_EQ(messages[1].address, PORT_DATA_ADDRESS_START + max_fragment_size);
+      EXPECT_FALSE(messages[1].more_bit);
+      EXPECT_EQ(messages[1].data_size, 1u);
+   }
+
+   TEST(ClientConnection, FragmentedRequirePortWriteIsReassembled)
+   {
+      char const* apx_text = "APX/1.2\n"
+         "N\"TestNode1\"\n"
+         "R\"Payload\"C[2000]\n";
+      MockClientConnection mock_connection;
+      EXPECT_EQ(mock_connection.build_node(apx_text), APX_NO_ERROR);
+      mock_connection.greeting_header_accepted();
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.publish_remote_file(PORT_DATA_ADDRESS_START, "TestNode1.in", 2000u), APX_NO_ERROR);
+      mock_connection.run();
+      auto* node_instance = mock_connection.find_node("TestNode1");
+      ASSERT_TRUE(node_instance);
+      std::vector<std::uint8_t> remote_buffer(2000u);
+      for (std::size_t i = 0u; i < remote_buffer.size(); i++)
+      {
+         remote_buffer[i] = static_cast<std::uint8_t>(i);
+      }
+      EXPECT_EQ(mock_connection.write_remote_data(PORT_DATA_ADDRESS_START, remote_buffer.data(), 1500u, true), APX_NO_ERROR);
+      EXPECT_EQ(node_instance->get_require_port_data_state(), PortDataState::WaitingForFileData);
+      EXPECT_EQ(mock_connection.write_remote_data(PORT_DATA_ADDRESS_START + 1500u, remote_buffer.data() + 1500u, 500u), APX_NO_ERROR);
+      EXPECT_EQ(node_instance->get_require_port_data_state(), PortDataState::Synchronized);
+      auto const* require_port_data = node_instance->get_node_data()->get_require_port_data();
+      EXPECT_EQ(std::memcmp(require_port_data, remote_buffer.data(), remote_buffer.size()), 0);
+   }
+
+   TEST(ClientConnection, QueueToSendLatencyIsRecordedWhileTracingIsEnabled)
+   {
+      char const* apx_text = "APX/1.2\n"
+         "N\"TestNode1\"\n"
+         "P\"ProvidePort1\"C(0,3):=3\n"
+         "P\"ProvidePort2\"C(0,7):=7\n";
+      MockClientConnection mock_connection;
+      EXPECT_EQ(mock_connection.build_node(apx_text), APX_NO_ERROR);
+      auto* node_instance = mock_connection.find_node("TestNode1");
+      ASSERT_TRUE(node_instance);
+      mock_connection.greeting_header_accepted();
+      mock_connection.run();
+      EXPECT_EQ(mock_connection.request_open_local_file("TestNode1.out"), APX_NO_ERROR);
+      mock_connection.run();
+      std::uint8_t value{ 1u };
+      EXPECT_EQ(node_instance->write_provide_port_data(1u, &value, sizeof(value)), APX_NO_ERROR);
+      mock_connection.run();
+      auto const& histogram = mock_connection.get_worker_metrics().queue_to_send;
+      LatencyHistogramSnapshot snapshot;
+      histogram.read(snapshot);
+      EXPECT_EQ(snapshot.count, 0u);
+      mock_connection.set_latency_tracing(true);
+      value = 2u;
+      EXPECT_EQ(node_instance->write_provide_port_data(1u, &value, sizeof(value)), APX_NO_ERROR);
+      value = 3u;
+      EXPECT_EQ(node_instance->write_provide_port_data(0u, &value, sizeof(value)), APX_NO_ERROR);
+      histogram.read(snapshot);
+      EXPECT_EQ(snapshot.count, 0u);
+      mock_connection.run();
+      histogram.read(snapshot);
+      EXPECT_EQ(snapshot.count, 2u);
+      mock_connection.set_latency_tracing(false);
+      EXPECT_EQ(node_instance->write_provide_port_data(1u, &value, sizeof(value)), APX_NO_ERROR);
+      mock_connection.run();
+      histogram.read(snapshot);
+      EXPECT_EQ(snapshot.count, 2u);
+   }
 }
\ No newline at end of file
@@ -0,0 +1,104 @@
+#include "pch.h"
+#include <array>
+#include <cstring>
+#include "cpp-apx/command.h"
+
+using namespace apx;
+
+namespace apx_test
+{
+   TEST(CommandQueue, PushAndPopWithoutData)
+   {
+      CommandQueue queue;
+      EXPECT_TRUE(queue.empty());
+      queue.push(Command{ CmdType::OpenRemoteFile, 0x1234u, 0u, (void*) nullptr, nullptr });
+      queue.push(Command{ CmdType::Exit, 0u, 0u, (void*) nullptr, nullptr });
+      EXPECT_EQ(queue.size(), 2u);
+      auto const& cmd1 = queue.front();
+      EXPECT_EQ(cmd1.cmd_type, CmdType::OpenRemoteFile);
+      EXPECT_EQ(cmd1.data1, 0x1234u);
+      EXPECT_FALSE(cmd1.has_inline_data());
+      queue.pop();
+      EXPECT_EQ(queue.front().cmd_type, CmdType::Exit);
+      queue.pop();
+      EXPECT_TRUE(queue.empty());
+      EXPECT_EQ(queue.bytes_used(), 0u);
+   }
+
+   TEST(CommandQueue, PushWithInlineData)
+   {
+      CommandQueue queue;
+      std::array<std::uint8_t, 5> data1{ 1u, 2u, 3u, 4u, 5u };
+      std::array<std::uint8_t, COMMAND_INLINE_DATA_MAX_SIZE> data2;
+      for (std::size_t i = 0u; i < data2.size(); i++)
+      {
+         data2[i] = static_cast<std::uint8_t>(i);
+      }
+      queue.push(Command{ CmdType::SendLocalData, 10u, static_cast<std::uint32_t>(data1.size()), (void*) nullptr, nullptr }, data1.data(), static_cast<std::uint32_t>(data1.size()));
+      queue.push(Command{ CmdType::SendLocalData, 20u, static_cast<std::uint32_t>(data2.size()), (void*) nullptr, nullptr }, data2.data(), static_cast<std::uint32_t>(data2.size()));
+      EXPECT_EQ(queue.size(), 2u);
+      auto const& cmd1 = queue.front();
+      EXPECT_EQ(cmd1.data1, 10u);
+      ASSERT_TRUE(cmd1.has_inline_data());
+      EXPECT_EQ(cmd1.inline_size, data1.size());
+      EXPECT_EQ(std::memcmp(cmd1.inline_data(), data1.data(), data1.size()), 0);
+      queue.pop();
+      auto const& cmd2 = queue.front();
+      EXPECT_EQ(cmd2.data1, 20u);
+      ASSERT_TRUE(cmd2.has_inline_data());
+      EXPECT_EQ(cmd2.inline_size, data2.size());
+      EXPECT_EQ(std::memcmp(cmd2.inline_data(), data2.data(), data2.size()), 0);
+      queue.pop();
+      EXPECT_TRUE(queue.empty());
+   }
+
+   TEST(CommandQueue, GrowsWhenCapacityIsExceeded)
+   {
+      CommandQueue queue{ COMMAND_SIZE };
+      std::array<std::uint8_t, 32> data;
+      data.fill(0xAAu);
+      for (std::uint32_t i = 0u; i < 100u; i++)
+      {
+         queue.push(Command{ CmdType::SendLocalData, i, static_cast<std::uint32_t>(data.size()), (void*) nullptr, nullptr }, data.data(), static_cast<std::uint32_t>(data.size()));
+      }
+      EXPECT_EQ(queue.size(), 100u);
+      EXPECT_GE(queue.capacity(), 100u * (COMMAND_SIZE + data.size()));
+      for (std::uint32_t i = 0u; i < 100u; i++)
+      {
+         auto const& cmd = queue.front();
+         EXPECT_EQ(cmd.data1, i);
+         EXPECT_EQ(cmd.inline_data()[31], 0xAAu);
+         queue.pop();
+      }
+      EXPECT_TRUE(queue.empty());
+   }
+
+   TEST(CommandQueue, SwapKeepsCapacity)
+   {
+      CommandQueue queue1;
+      CommandQueue queue2{ 2 * COMMAND_QUEUE_DEFAULT_CAPACITY };
+      queue1.push(Command{ CmdType::OpenRemoteFile, 1u, 0u, (void*) nullptr, nullptr });
+      queue2.swap(queue1);
+      EXPECT_TRUE(queue1.empty());
+      EXPECT_EQ(queue1.capacity(), 2 * COMMAND_QUEUE_DEFAULT_CAPACITY);
+      EXPECT_EQ(queue2.size(), 1u);
+      EXPECT_EQ(queue2.front().data1, 1u);
+   }
+
+   TEST(CommandQueue, AccessRecordByOffset)
+   {
+      CommandQueue queue;
+      std::uint8_t value{ 1u };
+      queue.push(Command{ CmdType::OpenRemoteFile, 1u, 0u, (void*) nullptr, nullptr });
+      auto const offset = queue.push(Command{ CmdType::SendLocalData, 2u, 1u, (void*) nullptr, nullptr }, &value, 1u);
+      auto* cmd = queue.at(offset);
+      ASSERT_NE(cmd, nullptr);
+      EXPECT_EQ(cmd->data1, 2u);
+      cmd->inline_data()[0] = 9u;
+      EXPECT_EQ(queue.at(queue.bytes_used()), nullptr);
+      queue.pop();
+      EXPECT_EQ(queue.front().inline_data()[0], 9u);
+      queue.pop();
+      EXPECT_EQ(queue.at(offset), nullptr);
+   }
+}
\ No newline at end of file
@@ -7,6 +7,12 @@ using namespace apx::vm;
 
 namespace apx_test
 {
+   constexpr std::uint8_t field_hash_byte(std::string_view name, unsigned int index)
+   {
+      return static_cast<std::uint8_t>(dtl::key_hash(name) >> (8u * index));
+   }
+#define FIELD_HASH(name) field_hash_byte(name, 0u), field_hash_byte(name, 1u), field_hash_byte(name, 2u), field_hash_byte(name, 3u)
+
    TEST(CompilerPack, PackU8)
    {
       const char* apx_text =
@@ -624,13 +630,15 @@ namespace apx_test
       apx::error_t error_code = APX_NO_ERROR;
       auto program = compiler.compile_port(port, apx::ProgramType::Pack, error_code);
       ASSERT_EQ(error_code, APX_NO_ERROR);
-      Program const expected{ 'V', 'M', MAJOR_VERSION, MINOR_VERSION, HEADER_PROG_TYPE_PACK | VARIANT_U8, UINT8_SIZE + UINT16_SIZE,
+      Program const expected{ 'V', 'M', MAJOR_VERSION, MINOR_VERSION, HEADER_FLAG_NESTING_DEPTH | HEADER_PROG_TYPE_PACK | VARIANT_U8, UINT8_SIZE + UINT16_SIZE, 1u,
          OPCODE_PACK | (VARIANT_RECORD << INST_VARIANT_SHIFT),
-         OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT << INST_VARIANT_SHIFT),
+         OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT_HASHED << INST_VARIANT_SHIFT),
          'F', 'i', 'r', 's', 't', '\0',
+         FIELD_HASH("First"),
          OPCODE_PACK | (VARIANT_U8 << INST_VARIANT_SHIFT),
-         LAST_FIELD_FLAG | OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT << INST_VARIANT_SHIFT),
+         LAST_FIELD_FLAG | OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT_HASHED << INST_VARIANT_SHIFT),
          'S', 'e', 'c', 'o', 'n', 'd', '\0',
+         FIELD_HASH("Second"),
          OPCODE_PACK | (VARIANT_U16 << INST_VARIANT_SHIFT),
       };
       ASSERT_EQ(*program, expected);
@@ -680,16 +688,18 @@ namespace apx_test
       apx::error_t error_code = APX_NO_ERROR;
       auto program = compiler.compile_port(port, apx::ProgramType::Pack, error_code);
       ASSERT_EQ(error_code, APX_NO_ERROR);
-      Program const expected{ 'V', 'M', MAJOR_VERSION, MINOR_VERSION, HEADER_PROG_TYPE_PACK | VARIANT_U8, UINT8_SIZE + UINT8_SIZE,
+      Program const expected{ 'V', 'M', MAJOR_VERSION, MINOR_VERSION, HEADER_FLAG_NESTING_DEPTH | HEADER_PROG_TYPE_PACK | VARIANT_U8, UINT8_SIZE + UINT8_SIZE, 1u,
          OPCODE_PACK | (VARIANT_RECORD << INST_VARIANT_SHIFT),
-         OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT << INST_VARIANT_SHIFT),
+         OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT_HASHED << INST_VARIANT_SHIFT),
          'F', 'i', 'r', 's', 't', '\0',
+         FIELD_HASH("First"),
          OPCODE_DATA_CTRL | (VARIANT_LIMIT_CHECK_U8 << INST_VARIANT_SHIFT),
          0u,
          3u,
          OPCODE_PACK | (VARIANT_U8 << INST_VARIANT_SHIFT),
-         LAST_FIELD_FLAG | OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT << INST_VARIANT_SHIFT),
+         LAST_FIELD_FLAG | OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT_HASHED << INST_VARIANT_SHIFT),
          'S', 'e', 'c', 'o', 'n', 'd', '\0',
+         FIELD_HASH("Second"),
          OPCODE_DATA_CTRL | (VARIANT_LIMIT_CHECK_U8 << INST_VARIANT_SHIFT),
          0u,
          7u,
@@ -715,21 +725,45 @@ namespace apx_test
       auto program = compiler.compile_port(port, apx::ProgramType::Pack, error_code);
       ASSERT_EQ(error_code, APX_NO_ERROR);
       constexpr std::uint8_t array_length = 2u;
-      Program const expected{ 'V', 'M', MAJOR_VERSION, MINOR_VERSION, HEADER_PROG_TYPE_PACK | VARIANT_U8, (UINT16_SIZE+UINT8_SIZE) * array_length,
+      Program const expected{ 'V', 'M', MAJOR_VERSION, MINOR_VERSION, HEADER_FLAG_NESTING_DEPTH | HEADER_PROG_TYPE_PACK | VARIANT_U8, (UINT16_SIZE+UINT8_SIZE) * array_length, 2u,
          ARRAY_FLAG | OPCODE_PACK | (VARIANT_RECORD << INST_VARIANT_SHIFT),
          OPCODE_DATA_SIZE | (VARIANT_ARRAY_SIZE_U8),
          array_length,
-         OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT << INST_VARIANT_SHIFT),
+         OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT_HASHED << INST_VARIANT_SHIFT),
          'I', 'd','\0',
+         FIELD_HASH("Id"),
          OPCODE_PACK | (VARIANT_U16 << INST_VARIANT_SHIFT),
-         LAST_FIELD_FLAG | OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT << INST_VARIANT_SHIFT),
+         LAST_FIELD_FLAG | OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT_HASHED << INST_VARIANT_SHIFT),
          'V', 'a', 'l', 'u', 'e', '\0',
+         FIELD_HASH("Value"),
          OPCODE_PACK | (VARIANT_U8 << INST_VARIANT_SHIFT),
          OPCODE_FLOW_CTRL | (VARIANT_ARRAY_NEXT << INST_VARIANT_SHIFT),
       };
       ASSERT_EQ(*program, expected);
    }
 
+   TEST(CompilerPack, NestedRecordStoresNestingDepthInHeader)
+   {
+      const char* apx_text =
+         "APX/1.3\n"
+         "N\"TestNode\"\n"
+         "R\"RecordPort\"{\"Outer\"C\"Inner\"{\"First\"C\"Second\"{\"Value\"S}[2]}}:={0, {0, {{0}, {0}}}}\n";
+
+      apx::Parser parser;
+      EXPECT_EQ(parser.parse(apx_text), APX_NO_ERROR);
+      auto node{ parser.take_last_node() };
+      auto port = node->get_require_port(0u);
+      ASSERT_NE(port, nullptr);
+      apx::Compiler compiler;
+      apx::error_t error_code = APX_NO_ERROR;
+      auto program = compiler.compile_port(port, apx::ProgramType::Unpack, error_code);
+      ASSERT_EQ(error_code, APX_NO_ERROR);
+      ProgramHeader header;
+      std::uint8_t const* next{ nullptr };
+      ASSERT_EQ(decode_program_header(program->data(), program->data() + program->size(), next, header), APX_NO_ERROR);
+      ASSERT_EQ(header.nesting_depth, 4u);
+   }
+
    TEST(CompilerPack, ArrayOfDynamicRecordWithEmptyInitializer)
    {
       const char* apx_text =
@@ -747,15 +781,17 @@ namespace apx_test
       auto program = compiler.compile_port(port, apx::ProgramType::Pack, error_code);
       ASSERT_EQ(error_code, APX_NO_ERROR);
       constexpr std::uint8_t array_length = 10u;
-      Program const expected{ 'V', 'M', MAJOR_VERSION, MINOR_VERSION, HEADER_FLAG_DYNAMIC_DATA | HEADER_PROG_TYPE_PACK | VARIANT_U8, UINT8_SIZE + (UINT16_SIZE + UINT8_SIZE) * array_length,
+      Program const expected{ 'V', 'M', MAJOR_VERSION, MINOR_VERSION, HEADER_FLAG_NESTING_DEPTH | HEADER_FLAG_DYNAMIC_DATA | HEADER_PROG_TYPE_PACK | VARIANT_U8, UINT8_SIZE + (UINT16_SIZE + UINT8_SIZE) * array_length, 2u,
          ARRAY_FLAG | OPCODE_PACK | (VARIANT_RECORD << INST_VARIANT_SHIFT),
          DYN_ARRAY_FLAG | OPCODE_DATA_SIZE | (VARIANT_ARRAY_SIZE_U8),
          array_length,
-         OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT << INST_VARIANT_SHIFT),
+         OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT_HASHED << INST_VARIANT_SHIFT),
          'I', 'd','\0',
+         FIELD_HASH("Id"),
          OPCODE_PACK | (VARIANT_U16 << INST_VARIANT_SHIFT),
-         LAST_FIELD_FLAG | OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT << INST_VARIANT_SHIFT),
+         LAST_FIELD_FLAG | OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT_HASHED << INST_VARIANT_SHIFT),
          'V', 'a', 'l', 'u', 'e', '\0',
+         FIELD_HASH("Value"),
          OPCODE_PACK | (VARIANT_U8 << INST_VARIANT_SHIFT),
          OPCODE_FLOW_CTRL | (VARIANT_ARRAY_NEXT << INST_VARIANT_SHIFT),
       };
@@ -1681,13 +1717,15 @@ namespace apx_test
       apx::error_t error_code = APX_NO_ERROR;
       auto program = compiler.compile_port(port, apx::ProgramType::Unpack, error_code);
       ASSERT_EQ(error_code, APX_NO_ERROR);
-      Program const expected{ 'V', 'M', MAJOR_VERSION, MINOR_VERSION, HEADER_PROG_TYPE_UNPACK | VARIANT_U8, UINT8_SIZE + UINT16_SIZE,
+      Program const expected{ 'V', 'M', MAJOR_VERSION, MINOR_VERSION, HEADER_FLAG_NESTING_DEPTH | HEADER_PROG_TYPE_UNPACK | VARIANT_U8, UINT8_SIZE + UINT16_SIZE, 1u,
          OPCODE_UNPACK | (VARIANT_RECORD << INST_VARIANT_SHIFT),
-         OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT << INST_VARIANT_SHIFT),
+         OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT_HASHED << INST_VARIANT_SHIFT),
          'F', 'i', 'r', 's', 't', '\0',
+         FIELD_HASH("First"),
          OPCODE_UNPACK | (VARIANT_U8 << INST_VARIANT_SHIFT),
-         LAST_FIELD_FLAG | OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT << INST_VARIANT_SHIFT),
+         LAST_FIELD_FLAG | OPCODE_DATA_CTRL | (VARIANT_RECORD_SELECT_HASHED << INST_VARIANT_SHIFT),
          'S', 'e', 'c', 'o', 'n', 'd', '\0',
+         FIELD_HASH("Second"),
          OPCODE_UNPACK | (VARIANT_U16 << INST_VARIANT_SHIFT),
       };
       ASSERT_EQ(*program, expected);
@@ -1,6 +1,7 @@
 #include "pch.h"
 #include <array>
 #include "cpp-apx/decoder.h"
+#include "dtl/dtl.hpp"
 
 using namespace std::string_literals;
 
@@ -644,8 +645,45 @@ namespace apx_test
       EXPECT_EQ(decoder.parse_next_operation(operation), APX_NO_ERROR);
       EXPECT_EQ(operation, apx::vm::OperationType::RecordSelect);
       EXPECT_EQ(decoder.get_field_name(), "First"s);
+      EXPECT_EQ(decoder.get_field_hash(), dtl::key_hash("First"));
       EXPECT_EQ(decoder.parse_next_operation(operation), APX_NO_ERROR);
       EXPECT_EQ(operation, apx::vm::OperationType::ProgramEnd);
    }
 
+   TEST(Decoder, RecordSelectHashed)
+   {
+      std::array<std::uint8_t, 11> program{ apx::vm::LAST_FIELD_FLAG | (apx::vm::VARIANT_RECORD_SELECT_HASHED << apx::vm::INST_VARIANT_SHIFT) | apx::vm::OPCODE_DATA_CTRL,
+         'F', 'i', 'r', 's', 't', '\0', 0x78, 0x56, 0x34, 0x12 };
+      apx::vm::Decoder decoder;
+      EXPECT_EQ(decoder.select_program(program.data(), program.data() + program.size()), APX_NO_ERROR);
+      apx::vm::OperationType operation{ apx::vm::OperationType::ProgramEnd };
+      EXPECT_EQ(decoder.parse_next_operation(operation), APX_NO_ERROR);
+      EXPECT_EQ(operation, apx::vm::OperationType::RecordSelect);
+      EXPECT_EQ(decoder.get_field_name(), "First"s);
+      EXPECT_EQ(decoder.get_field_hash(), 0x12345678u); //Taken from program, not recalculated
+      EXPECT_TRUE(decoder.is_last_field());
+      EXPECT_EQ(decoder.parse_next_operation(operation), APX_NO_ERROR);
+      EXPECT_EQ(operation, apx::vm::OperationType::ProgramEnd);
+      EXPECT_EQ(decoder.select_program(program.data(), program.data() + program.size() - 1), APX_NO_ERROR);
+      EXPECT_EQ(decoder.parse_next_operation(operation), APX_INVALID_INSTRUCTION_ERROR);
+   }
+
+   TEST(Decoder, RecordSelectHashedIsRejectedInOlderPrograms)
+   {
+      std::array<std::uint8_t, 17> program{ 'V', 'M', apx::vm::MAJOR_VERSION, 0u, apx::vm::HEADER_PROG_TYPE_PACK | apx::vm::VARIANT_U8, 1u,
+         apx::vm::LAST_FIELD_FLAG | (apx::vm::VARIANT_RECORD_SELECT_HASHED << apx::vm::INST_VARIANT_SHIFT) | apx::vm::OPCODE_DATA_CTRL,
+         'F', 'i', 'r', 's', 't', '\0', 0x78, 0x56, 0x34, 0x12 };
+      apx::vm::Decoder decoder;
+      apx::vm::ProgramHeader header;
+      apx::vm::OperationType operation{ apx::vm::OperationType::ProgramEnd };
+      EXPECT_EQ(decoder.select_program(program.data(), program.data() + program.size()), APX_NO_ERROR);
+      EXPECT_EQ(decoder.parse_program_header(header), APX_NO_ERROR);
+      EXPECT_EQ(decoder.parse_next_operation(operation), APX_INVALID_INSTRUCTION_ERROR);
+      program[3] = apx::vm::RECORD_SELECT_HASHED_MINOR_VERSION;
+      EXPECT_EQ(decoder.select_program(program.data(), program.data() + program.size()), APX_NO_ERROR);
+      EXPECT_EQ(decoder.parse_program_header(header), APX_NO_ERROR);
+      EXPECT_EQ(decoder.parse_next_operation(operation), APX_NO_ERROR);
+      EXPECT_EQ(operation, apx::vm::OperationType::RecordSelect);
+   }
+
 }
\ No newline at end of file
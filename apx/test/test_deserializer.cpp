@@ -1,10 +1,38 @@
 #include "pch.h"
 #include "cpp-apx/deserializer.h"
 #include <array>
+#include <atomic>
+#include <cstdlib>
+#include <memory_resource>
+#include <new>
 
 using namespace apx::vm;
 using namespace std::string_literals;
 
+//Counts global heap allocations in this test binary, used to prove that unpacking into a memory resource does not allocate elsewhere
+static std::atomic<std::size_t> global_allocation_count{ 0u };
+
+void* operator new(std::size_t size)
+{
+   global_allocation_count.fetch_add(1u, std::memory_order_relaxed);
+   void* ptr = std::malloc(size > 0u ? size : 1u);
+   if (ptr == nullptr)
+   {
+      throw std::bad_alloc();
+   }
+   return ptr;
+}
+
+void operator delete(void* ptr) noexcept
+{
+   std::free(ptr);
+}
+
+void operator delete(void* ptr, std::size_t) noexcept
+{
+   std::free(ptr);
+}
+
 namespace apx_test
 {
    TEST(Deserializer, SetInvalidBuffer)
@@ -423,24 +451,17 @@ namespace apx_test
       constexpr std::size_t array_length = 3u;
       std::array<std::uint8_t, UINT8_SIZE* array_length> buf = { 0x00u, 0x12u, 0xffu };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_uint8(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_u32(ok), 0x00u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_u32(ok), 0x12u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(2));
-      EXPECT_EQ(sv->to_u32(ok), 0xffu);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::uint8_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), 0x00u);
+      EXPECT_EQ(ta->at(1), 0x12u);
+      EXPECT_EQ(ta->at(2), 0xffu);
    }
 
    TEST(Deserializer, UnpackUInt8ArrayWithTooShortReadBuffer)
@@ -451,7 +472,7 @@ namespace apx_test
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_uint8(array_length+1, apx::SizeType::None), APX_BUFFER_BOUNDARY_ERROR);
-      EXPECT_EQ(deserializer.bytes_read(), buf.size());
+      EXPECT_EQ(deserializer.bytes_read(), 0u); //Array data is read all at once or not at all
    }
 
    TEST(Deserializer, UnpackUInt8ArrayWithRangeCheck)
@@ -459,25 +480,18 @@ namespace apx_test
       constexpr std::size_t array_length = 3u;
       std::array<std::uint8_t, UINT8_SIZE* array_length> buf = { 0x07u, 0x03u, 0x07u };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_uint8(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.check_value_range_uint32(0u, 7u), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_u32(ok), 0x07u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_u32(ok), 0x03u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(2));
-      EXPECT_EQ(sv->to_u32(ok), 0x07u);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::uint8_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), 0x07u);
+      EXPECT_EQ(ta->at(1), 0x03u);
+      EXPECT_EQ(ta->at(2), 0x07u);
 
       buf[1] = 0x08; //Value outside range
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
@@ -492,22 +506,17 @@ namespace apx_test
       constexpr std::size_t max_array_length = 3u;
       std::array<std::uint8_t, UINT8_SIZE + UINT8_SIZE* current_array_length> buf = { current_array_length, 0x07u, 0x06u };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_uint8(max_array_length, apx::SizeType::UInt8), APX_NO_ERROR);
       EXPECT_EQ(deserializer.check_value_range_uint32(0u, 7u), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), current_array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_u32(ok), 0x07u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_u32(ok), 0x06u);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::uint8_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), current_array_length);
+      EXPECT_EQ(ta->at(0), 0x07u);
+      EXPECT_EQ(ta->at(1), 0x06u);
    }
 
    TEST(Deserializer, UnpackUInt16Array)
@@ -515,24 +524,17 @@ namespace apx_test
       constexpr std::size_t array_length = 3u;
       std::array<std::uint8_t, UINT16_SIZE* array_length> buf = { 0x00, 0x00, 0x34, 0x12, 0xff, 0xff};
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_uint16(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_u32(ok), 0x0000u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_u32(ok), 0x1234u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(2));
-      EXPECT_EQ(sv->to_u32(ok), 0xffffu);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::uint16_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), 0x0000u);
+      EXPECT_EQ(ta->at(1), 0x1234u);
+      EXPECT_EQ(ta->at(2), 0xffffu);
    }
 
    TEST(Deserializer, UnpackUInt16ArrayWithRangeCheck)
@@ -540,25 +542,18 @@ namespace apx_test
       constexpr std::size_t array_length = 3u;
       std::array<std::uint8_t, UINT16_SIZE* array_length> buf = { 0x00, 0x00, 0xe8, 0x03u,  0x10u, 0x027u }; //{0, 1000, 10000)
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_uint16(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
       EXPECT_EQ(deserializer.check_value_range_uint32(0, 10000), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_u32(ok), 0u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_u32(ok), 1000u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(2));
-      EXPECT_EQ(sv->to_u32(ok), 10000u);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::uint16_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), 0u);
+      EXPECT_EQ(ta->at(1), 1000u);
+      EXPECT_EQ(ta->at(2), 10000u);
 
       buf[4]++; //force value to 10001 (outside range)
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
@@ -573,22 +568,17 @@ namespace apx_test
       constexpr std::size_t max_array_length = 3u;
       std::array<std::uint8_t, UINT8_SIZE + UINT16_SIZE* current_array_length> buf = { current_array_length, 0x00, 0x00, 0x10u, 0x027u }; //{0, 10000)
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_uint16(max_array_length, apx::SizeType::UInt8), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
       EXPECT_EQ(deserializer.check_value_range_uint32(0, 10000), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), current_array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_u32(ok), 0u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_u32(ok), 10000u);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::uint16_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), current_array_length);
+      EXPECT_EQ(ta->at(0), 0u);
+      EXPECT_EQ(ta->at(1), 10000u);
    }
 
    TEST(Deserializer, UnpackUInt32Array)
@@ -596,24 +586,28 @@ namespace apx_test
       constexpr std::size_t array_length = 3u;
       std::array<std::uint8_t, UINT32_SIZE* array_length> buf = { 0x00, 0x00, 0x00, 0x00, 0x78, 0x56, 0x34, 0x12, 0xff, 0xff, 0xff, 0xff };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_uint32(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_u32(ok), 0x00000000ul);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_u32(ok), 0x12345678ul);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(2));
-      EXPECT_EQ(sv->to_u32(ok), 0xfffffffful);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::uint32_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), 0x00000000ul);
+      EXPECT_EQ(ta->at(1), 0x12345678ul);
+      EXPECT_EQ(ta->at(2), 0xfffffffful);
+   }
+
+   TEST(Deserializer, UnpackUInt32ArrayWithSignedRangeCheck)
+   {
+      constexpr std::size_t array_length = 2u;
+      std::array<std::uint8_t, UINT32_SIZE* array_length> buf = { 0x64u, 0x00u, 0x00u, 0x00u, 0xffu, 0xffu, 0xffu, 0xffu };
+      Deserializer deserializer;
+
+      EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
+      EXPECT_EQ(deserializer.unpack_uint32(array_length, apx::SizeType::None), APX_NO_ERROR);
+      EXPECT_EQ(deserializer.check_value_range_int32(0, 100), APX_VALUE_RANGE_ERROR); //0xffffffff must not be seen as -1
    }
 
    TEST(Deserializer, UnpackUInt32ArrayWithRangeCheck)
@@ -621,22 +615,17 @@ namespace apx_test
       constexpr std::size_t array_length = 2u;
       std::array<std::uint8_t, UINT32_SIZE* array_length> buf = { 0x00u, 0x00u, 0x00u, 0x00u, 0xa0u, 0x86u, 0x01u, 0x00u };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_uint32(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
       EXPECT_EQ(deserializer.check_value_range_uint32(0u, 100000), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_u32(ok), 0u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_u32(ok), 100000u);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::uint32_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), 0u);
+      EXPECT_EQ(ta->at(1), 100000u);
    }
 
    TEST(Deserializer, UnpackUInt32DynamicArrayWithRangeCheck)
@@ -645,22 +634,17 @@ namespace apx_test
       constexpr std::size_t max_array_length = 3u;
       std::array<std::uint8_t, UINT8_SIZE + UINT32_SIZE* max_array_length> buf = { current_array_length, 0x00u, 0x00u, 0x00u, 0x00u, 0xa0u, 0x86u, 0x01u, 0x00u, 0xD, 0xE, 0xA, 0xD };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_uint32(max_array_length, apx::SizeType::UInt8), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), UINT8_SIZE + UINT32_SIZE * current_array_length);
       EXPECT_EQ(deserializer.check_value_range_uint32(0u, 100000), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), current_array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_u32(ok), 0u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_u32(ok), 100000u);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::uint32_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), current_array_length);
+      EXPECT_EQ(ta->at(0), 0u);
+      EXPECT_EQ(ta->at(1), 100000u);
    }
 
    TEST(Deserializer, UnpackUInt64Array)
@@ -669,21 +653,16 @@ namespace apx_test
       std::array<std::uint8_t, UINT64_SIZE* array_length> buf = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
          0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff, 0xff };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_uint64(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_u64(ok), 0x00000000ull);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_u64(ok), UINT64_MAX);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::uint64_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), 0x00000000ull);
+      EXPECT_EQ(ta->at(1), UINT64_MAX);
    }
 
    TEST(Deserializer, UnpackUInt64ArrayWithRangeCheck)
@@ -692,22 +671,17 @@ namespace apx_test
       std::array<std::uint8_t, UINT64_SIZE* array_length> buf = { 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
          0x00, 0xba, 0x1d, 0xd2, 0x05, 0x00, 0x00, 0x00 };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_uint64(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
       EXPECT_EQ(deserializer.check_value_range_uint64(0ull, 25000000000ull), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_u64(ok), 0x00000000ull);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_u64(ok), 25000000000ull);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::uint64_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), 0x00000000ull);
+      EXPECT_EQ(ta->at(1), 25000000000ull);
    }
 
    TEST(Deserializer, UnpackUInt64DynamicArrayWithRangeCheck)
@@ -717,22 +691,17 @@ namespace apx_test
       std::array<std::uint8_t, UINT8_SIZE + UINT64_SIZE* current_array_length> buf = { current_array_length, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
          0x00, 0xba, 0x1d, 0xd2, 0x05, 0x00, 0x00, 0x00 };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_uint64(max_array_length, apx::SizeType::UInt8), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
       EXPECT_EQ(deserializer.check_value_range_uint64(0ull, 25000000000ull), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), current_array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_u64(ok), 0x00000000ull);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_u64(ok), 25000000000ull);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::uint64_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), current_array_length);
+      EXPECT_EQ(ta->at(0), 0x00000000ull);
+      EXPECT_EQ(ta->at(1), 25000000000ull);
    }
 
    TEST(Deserializer, UnpackInt8Array)
@@ -740,27 +709,18 @@ namespace apx_test
       constexpr std::size_t array_length = 4u;
       std::array<std::uint8_t, INT8_SIZE* array_length> buf = { 0x80, 0xffu, 0x00, 0x7fu };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_int8(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_i32(ok), -128);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_i32(ok), -1);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(2));
-      EXPECT_EQ(sv->to_i32(ok), 0);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(3));
-      EXPECT_EQ(sv->to_i32(ok), 127);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::int8_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), -128);
+      EXPECT_EQ(ta->at(1), -1);
+      EXPECT_EQ(ta->at(2), 0);
+      EXPECT_EQ(ta->at(3), 127);
    }
 
    TEST(Deserializer, UnpackInt8ArrayWithRangeCheck)
@@ -768,22 +728,17 @@ namespace apx_test
       constexpr std::size_t array_length = 2u;
       std::array<std::uint8_t, INT8_SIZE* array_length> buf = { 0xf6u, 0x0au }; //{-10, 10}
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_int8(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
       EXPECT_EQ(deserializer.check_value_range_int32(-10, 10), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_i32(ok), -10);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_i32(ok), 10);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::int8_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), -10);
+      EXPECT_EQ(ta->at(1), 10);
    }
 
    TEST(Deserializer, UnpackInt8DynamicArrayWithRangeCheck)
@@ -792,22 +747,17 @@ namespace apx_test
       constexpr std::size_t max_array_length = 4u;
       std::array<std::uint8_t, UINT8_SIZE + INT8_SIZE * max_array_length> buf = { current_array_length, 0xf6u, 0x0au, 0xee, 0xee };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_int8(max_array_length, apx::SizeType::UInt8), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), UINT8_SIZE + INT8_SIZE * current_array_length);
       EXPECT_EQ(deserializer.check_value_range_int32(-10, 10), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), current_array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_i32(ok), -10);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_i32(ok), 10);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::int8_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), current_array_length);
+      EXPECT_EQ(ta->at(0), -10);
+      EXPECT_EQ(ta->at(1), 10);
    }
 
    TEST(Deserializer, UnpackInt16Array)
@@ -815,49 +765,35 @@ namespace apx_test
       constexpr std::size_t array_length = 4u;
       std::array<std::uint8_t, INT16_SIZE* array_length> buf = { 0x00, 0x80, 0xff, 0xffu, 0x00, 0x00, 0xff, 0x7fu };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_int16(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_i32(ok), INT16_MIN);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_i32(ok), -1);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(2));
-      EXPECT_EQ(sv->to_i32(ok), 0);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(3));
-      EXPECT_EQ(sv->to_i32(ok), INT16_MAX);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::int16_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), INT16_MIN);
+      EXPECT_EQ(ta->at(1), -1);
+      EXPECT_EQ(ta->at(2), 0);
+      EXPECT_EQ(ta->at(3), INT16_MAX);
    }
    TEST(Deserializer, UnpackInt16ArrayWithRangeCheck)
    {
       constexpr std::size_t array_length = 2u;
       std::array<std::uint8_t, INT16_SIZE* array_length> buf = { 0x18, 0xFC, 0xE8, 0x03u}; //{-1000, 1000)
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_int16(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
       EXPECT_EQ(deserializer.check_value_range_int32(-1000, 1000), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_i32(ok), -1000);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_i32(ok), 1000);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::int16_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), -1000);
+      EXPECT_EQ(ta->at(1), 1000);
 
       buf[2]++; //force value to 1001 (outside range)
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
@@ -872,22 +808,17 @@ namespace apx_test
       constexpr std::size_t max_array_length = 4u;
       std::array<std::uint8_t, UINT8_SIZE + INT16_SIZE* max_array_length> buf = { current_array_length, 0x18, 0xFC, 0xE8, 0x03u, 0xee, 0xee, 0xee, 0xee };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_int16(max_array_length, apx::SizeType::UInt8), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), UINT8_SIZE + INT16_SIZE* current_array_length);
       EXPECT_EQ(deserializer.check_value_range_int32(-1000, 1000), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), current_array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_i32(ok), -1000);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_i32(ok), 1000);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::int16_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), current_array_length);
+      EXPECT_EQ(ta->at(0), -1000);
+      EXPECT_EQ(ta->at(1), 1000);
    }
 
    TEST(Deserializer, UnpackInt32Array)
@@ -895,27 +826,18 @@ namespace apx_test
       constexpr std::size_t array_length = 4u;
       std::array<std::uint8_t, INT32_SIZE* array_length> buf = { 0x00, 0x00, 0x00, 0x80, 0xff, 0xffu, 0xff, 0xffu, 0x00, 0x00, 0x00, 0x00, 0xff, 0xff, 0xff, 0x7fu };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_int32(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_i32(ok), INT32_MIN);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_i32(ok), -1);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(2));
-      EXPECT_EQ(sv->to_i32(ok), 0);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(3));
-      EXPECT_EQ(sv->to_i32(ok), INT32_MAX);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::int32_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), INT32_MIN);
+      EXPECT_EQ(ta->at(1), -1);
+      EXPECT_EQ(ta->at(2), 0);
+      EXPECT_EQ(ta->at(3), INT32_MAX);
    }
 
    TEST(Deserializer, UnpackInt32ArrayWithRangeCheck)
@@ -923,22 +845,17 @@ namespace apx_test
       constexpr std::size_t array_length = 2u;
       std::array<std::uint8_t, INT32_SIZE* array_length> buf = { 0x60, 0x79, 0xFE, 0xFF, 0xa0, 0x86, 0x01, 0x00}; //{-100000, 100000}
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_int32(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
       EXPECT_EQ(deserializer.check_value_range_int32(-100000, 100000), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_i32(ok), -100000);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_i32(ok), 100000);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::int32_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), -100000);
+      EXPECT_EQ(ta->at(1), 100000);
    }
 
    TEST(Deserializer, UnpackInt32DynamicArrayWithRangeCheck)
@@ -947,22 +864,17 @@ namespace apx_test
       constexpr std::size_t max_array_length = 3u;
       std::array<std::uint8_t, UINT8_SIZE + INT32_SIZE* max_array_length> buf = { current_array_length, 0x60, 0x79, 0xFE, 0xFF, 0xa0, 0x86, 0x01, 0x00, 0xee, 0xee, 0xee, 0xee };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_int32(max_array_length, apx::SizeType::UInt8), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), UINT8_SIZE + INT32_SIZE * current_array_length);
       EXPECT_EQ(deserializer.check_value_range_int32(-100000, 100000), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), current_array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_i32(ok), -100000);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_i32(ok), 100000);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::int32_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), current_array_length);
+      EXPECT_EQ(ta->at(0), -100000);
+      EXPECT_EQ(ta->at(1), 100000);
    }
 
    TEST(Deserializer, UnpackInt64Array)
@@ -973,27 +885,18 @@ namespace apx_test
          0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u, 0x00u,
          0xffu, 0xffu, 0xffu, 0xffu, 0xffu, 0xffu, 0xffu, 0x7fu };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_int64(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_i64(ok), INT64_MIN);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_i64(ok), -1);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(2));
-      EXPECT_EQ(sv->to_i64(ok), 0);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(3));
-      EXPECT_EQ(sv->to_i64(ok), INT64_MAX);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::int64_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), INT64_MIN);
+      EXPECT_EQ(ta->at(1), -1);
+      EXPECT_EQ(ta->at(2), 0);
+      EXPECT_EQ(ta->at(3), INT64_MAX);
    }
 
    TEST(Deserializer, UnpackInt64ArrayWithRangeCheck)
@@ -1002,22 +905,17 @@ namespace apx_test
       std::array<std::uint8_t, INT64_SIZE* array_length> buf = { 0x00u, 0x46u, 0xe2u, 0x2du, 0xfau, 0xffu, 0xffu, 0xffu, //-25E9
          0x00u, 0xbau, 0x1du, 0xd2u, 0x05u, 0x00, 0x00, 0x00}; //+25E9
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_int64(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
       EXPECT_EQ(deserializer.check_value_range_int64(-25000000000ll, 25000000000ll), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_i64(ok), -25000000000ll);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_i64(ok), 25000000000ll);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::int64_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), -25000000000ll);
+      EXPECT_EQ(ta->at(1), 25000000000ll);
    }
 
    TEST(Deserializer, UnpackInt64DynamicArrayWithRangeCheck)
@@ -1027,22 +925,17 @@ namespace apx_test
       std::array<std::uint8_t, UINT8_SIZE + INT64_SIZE* current_array_length> buf = { current_array_length, 0x00u, 0x46u, 0xe2u, 0x2du, 0xfau, 0xffu, 0xffu, 0xffu,
          0x00u, 0xbau, 0x1du, 0xd2u, 0x05u, 0x00, 0x00, 0x00 };
       Deserializer deserializer;
-      auto ok = false;
 
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_int64(max_array_length, apx::SizeType::UInt8), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), UINT8_SIZE + INT64_SIZE * current_array_length);
       EXPECT_EQ(deserializer.check_value_range_int64(-25000000000ll, 25000000000ll), APX_NO_ERROR);
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_NE(av.get(), nullptr);
-      EXPECT_EQ(av->length(), current_array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_i64(ok), -25000000000ll);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_i64(ok), 25000000000ll);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<std::int64_t>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), current_array_length);
+      EXPECT_EQ(ta->at(0), -25000000000ll);
+      EXPECT_EQ(ta->at(1), 25000000000ll);
    }
 
    TEST(Deserializer, UnpackChar)
@@ -1156,25 +1049,31 @@ namespace apx_test
       constexpr std::size_t array_length = 4u;
       std::array<std::uint8_t, UINT8_SIZE* array_length> buf = { 0u, 1u, 1u, 0u };
       Deserializer deserializer;
-      auto ok = false;
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_bool(array_length, apx::SizeType::None), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_EQ(av->length(), array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_bool(ok), false);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_bool(ok), true);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(2));
-      EXPECT_EQ(sv->to_bool(ok), true);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(3));
-      EXPECT_EQ(sv->to_bool(ok), false);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<bool>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), array_length);
+      EXPECT_EQ(ta->at(0), false);
+      EXPECT_EQ(ta->at(1), true);
+      EXPECT_EQ(ta->at(2), true);
+      EXPECT_EQ(ta->at(3), false);
+   }
+
+   TEST(Deserializer, UnpackBooleanArrayNormalizesNonZeroValues)
+   {
+      constexpr std::size_t array_length = 3u;
+      std::array<std::uint8_t, UINT8_SIZE * array_length> buf = { 0u, 2u, 0xffu };
+      Deserializer deserializer;
+      EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
+      EXPECT_EQ(deserializer.unpack_bool(array_length, apx::SizeType::None), APX_NO_ERROR);
+      auto ta = dtl::ta_cast<bool>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->data()[0], 0u);
+      EXPECT_EQ(ta->data()[1], 1u);
+      EXPECT_EQ(ta->data()[2], 1u);
    }
 
    TEST(Deserializer, UnpackBooleanDynamicArray)
@@ -1183,22 +1082,16 @@ namespace apx_test
       constexpr std::size_t max_array_length = 8u;
       std::array<std::uint8_t, UINT8_SIZE + UINT8_SIZE * current_array_length> buf = { current_array_length,  1u, 1u, 0u };
       Deserializer deserializer;
-      auto ok = false;
       EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
       EXPECT_EQ(deserializer.unpack_bool(max_array_length, apx::SizeType::UInt8), APX_NO_ERROR);
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
-      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
-      auto av = deserializer.take_av();
-      EXPECT_EQ(av->length(), current_array_length);
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_bool(ok), true);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_bool(ok), true);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(2));
-      EXPECT_EQ(sv->to_bool(ok), false);
-      EXPECT_TRUE(ok);
+      EXPECT_EQ(deserializer.value_type(), dtl::ValueType::TypedArray);
+      auto ta = dtl::ta_cast<bool>(deserializer.take_ta());
+      ASSERT_NE(ta.get(), nullptr);
+      EXPECT_EQ(ta->length(), current_array_length);
+      EXPECT_EQ(ta->at(0), true);
+      EXPECT_EQ(ta->at(1), true);
+      EXPECT_EQ(ta->at(2), false);
    }
 
    TEST(Deserializer, UnpackByte)
@@ -1284,23 +1177,14 @@ namespace apx_test
       EXPECT_EQ(deserializer.bytes_read(), buf.size());
       EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Hash);
       auto hv = deserializer.take_hv();
-      auto av = dtl::av_cast(hv->at("First"));
-      EXPECT_TRUE(av.get());
-      EXPECT_EQ(av->length(), 3u);
+      auto ta = dtl::ta_cast<std::uint8_t>(hv->at("First"));
+      ASSERT_TRUE(ta.get());
+      EXPECT_EQ(ta->length(), 3u);
+      EXPECT_EQ(ta->at(0), 1u);
+      EXPECT_EQ(ta->at(1), 2u);
+      EXPECT_EQ(ta->at(2), 3u);
       auto ok = false;
-      auto sv = dtl::sv_cast(av->at(0));
-      EXPECT_TRUE(sv.get());
-      EXPECT_EQ(sv->to_u32(ok), 1u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_TRUE(sv.get());
-      EXPECT_EQ(sv->to_u32(ok), 2u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(2));
-      EXPECT_TRUE(sv.get());
-      EXPECT_EQ(sv->to_u32(ok), 3u);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(hv->at("Second"));
+      auto sv = dtl::sv_cast(hv->at("Second"));
       EXPECT_EQ(sv->to_u32(ok), 0x1234u);
       EXPECT_TRUE(ok);
    }
@@ -1339,6 +1223,27 @@ namespace apx_test
       ASSERT_TRUE(ok);
    }
 
+   TEST(Deserializer, UnpackRecordKeepsProgramFieldOrder)
+   {
+      std::array<std::uint8_t, UINT8_SIZE * 3> buf = { 1u, 2u, 3u };
+      Deserializer deserializer;
+      EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
+      EXPECT_EQ(deserializer.unpack_record(0u, apx::SizeType::None), APX_NO_ERROR);
+      EXPECT_EQ(deserializer.record_select("Zeta", false), APX_NO_ERROR);
+      EXPECT_EQ(deserializer.unpack_uint8(0u, apx::SizeType::None), APX_NO_ERROR);
+      EXPECT_EQ(deserializer.record_select("Alpha", false), APX_NO_ERROR);
+      EXPECT_EQ(deserializer.unpack_uint8(0u, apx::SizeType::None), APX_NO_ERROR);
+      EXPECT_EQ(deserializer.record_select("Mid", true), APX_NO_ERROR);
+      EXPECT_EQ(deserializer.unpack_uint8(0u, apx::SizeType::None), APX_NO_ERROR);
+      auto hv = deserializer.take_hv();
+      std::vector<std::string> keys;
+      for (auto const& [key, value] : *hv)
+      {
+         keys.emplace_back(key);
+      }
+      EXPECT_EQ(keys, (std::vector<std::string>{ "Zeta", "Alpha", "Mid" }));
+   }
+
    TEST(Deserializer, UnpackRecord_DynamicStringUInt32Array)
    {
       constexpr std::size_t current_string_length{ 5u };
@@ -1362,14 +1267,10 @@ namespace apx_test
       bool ok = false;
       EXPECT_EQ(sv->to_string(ok), "Data1"s);
       EXPECT_TRUE(ok);
-      auto av = dtl::av_cast(hv->at("Second"));
-      EXPECT_TRUE(av.get());
-      sv = dtl::sv_cast(av->at(0));
-      EXPECT_EQ(sv->to_u32(ok), 0ul);
-      EXPECT_TRUE(ok);
-      sv = dtl::sv_cast(av->at(1));
-      EXPECT_EQ(sv->to_u32(ok), 0xdaeaffff);
-      EXPECT_TRUE(ok);
+      auto ta = dtl::ta_cast<std::uint32_t>(hv->at("Second"));
+      ASSERT_TRUE(ta.get());
+      EXPECT_EQ(ta->at(0), 0ul);
+      EXPECT_EQ(ta->at(1), 0xdaeaffff);
    }
 
    TEST(Deserializer, UnpackRecord_BoolDynamicString)
@@ -1516,4 +1417,153 @@ namespace apx_test
       EXPECT_EQ(child_sv->to_u32(ok), 1u);
       EXPECT_TRUE(ok);
    }
+   TEST(Deserializer, UnpackRecordIntoReusedValue)
+   {
+      constexpr std::size_t str_length{ 8u };
+      constexpr std::size_t array_length{ 3u };
+      std::array<std::uint8_t, UINT16_SIZE + str_length + UINT8_SIZE * array_length> buf1 = {
+         0x07, 0x00,
+         'a', 'b', 'c', 0, 0, 0, 0, 0,
+         1, 2, 3 };
+      std::array<std::uint8_t, UINT16_SIZE + str_length + UINT8_SIZE * array_length> buf2 = {
+         0x34, 0x12,
+         'l', 'o', 'n', 'g', 'e', 'r', 0, 0,
+         4, 5, 6 };
+      auto unpack = [&](Deserializer& deserializer) {
+         EXPECT_EQ(deserializer.unpack_record(0u, apx::SizeType::None), APX_NO_ERROR);
+         EXPECT_EQ(deserializer.record_select("Id", false), APX_NO_ERROR);
+         EXPECT_EQ(deserializer.unpack_uint16(0u, apx::SizeType::None), APX_NO_ERROR);
+         EXPECT_EQ(deserializer.record_select("Name", false), APX_NO_ERROR);
+         EXPECT_EQ(deserializer.unpack_char(str_length, apx::SizeType::None), APX_NO_ERROR);
+         EXPECT_EQ(deserializer.record_select("Values", true), APX_NO_ERROR);
+         EXPECT_EQ(deserializer.unpack_uint8(array_length, apx::SizeType::None), APX_NO_ERROR);
+         EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Hash);
+      };
+      Deserializer deserializer;
+      EXPECT_EQ(deserializer.set_read_buffer(buf1.data(), buf1.size()), APX_NO_ERROR);
+      unpack(deserializer);
+      auto hv = deserializer.take_hv();
+      auto id_sv = dtl::sv_cast(hv->at("Id"));
+      auto name_sv = dtl::sv_cast(hv->at("Name"));
+      auto values_ta = dtl::ta_cast<std::uint8_t>(hv->at("Values"));
+      ASSERT_TRUE(id_sv && name_sv && values_ta);
+
+      EXPECT_EQ(deserializer.set_read_buffer(buf2.data(), buf2.size()), APX_NO_ERROR);
+      deserializer.set_reuse_value(dtl::dv_cast(hv));
+      unpack(deserializer);
+      EXPECT_EQ(deserializer.bytes_read(), buf2.size());
+      auto dv = deserializer.take_dv();
+      EXPECT_EQ(dv.get(), hv.get());
+      EXPECT_EQ(hv->length(), 3u);
+      EXPECT_EQ(hv->at("Id").get(), id_sv.get());
+      EXPECT_EQ(hv->at("Name").get(), name_sv.get());
+      EXPECT_EQ(hv->at("Values").get(), values_ta.get());
+      bool ok{ false };
+      EXPECT_EQ(id_sv->to_u32(ok), 0x1234u);
+      EXPECT_TRUE(ok);
+      EXPECT_EQ(name_sv->to_string(ok), "longer"s);
+      EXPECT_TRUE(ok);
+      ASSERT_EQ(values_ta->length(), array_length);
+      EXPECT_EQ(values_ta->at(0), 4u);
+      EXPECT_EQ(values_ta->at(1), 5u);
+      EXPECT_EQ(values_ta->at(2), 6u);
+   }
+
+   TEST(Deserializer, UnpackArrayOfRecordIntoReusedValue)
+   {
+      constexpr std::size_t array_length = 2u;
+      std::array < std::uint8_t, (UINT16_SIZE + UINT8_SIZE) * array_length> buf1 = {
+         0xE8, 0x03, 0x01,
+         0xd0, 0x07, 0x00
+      };
+      std::array < std::uint8_t, (UINT16_SIZE + UINT8_SIZE) * array_length> buf2 = {
+         0xA0, 0x0F, 0x00,
+         0x01, 0x00, 0x01
+      };
+      auto unpack = [&](Deserializer& deserializer) {
+         auto is_last{ false };
+         EXPECT_EQ(deserializer.unpack_record(array_length, apx::SizeType::None), APX_NO_ERROR);
+         while (!is_last)
+         {
+            EXPECT_EQ(deserializer.record_select("Id", false), APX_NO_ERROR);
+            EXPECT_EQ(deserializer.unpack_uint16(0u, apx::SizeType::None), APX_NO_ERROR);
+            EXPECT_EQ(deserializer.record_select("Value", true), APX_NO_ERROR);
+            EXPECT_EQ(deserializer.unpack_uint8(0u, apx::SizeType::None), APX_NO_ERROR);
+            ASSERT_EQ(deserializer.array_next(is_last), APX_NO_ERROR);
+         }
+         EXPECT_EQ(deserializer.value_type(), dtl::ValueType::Array);
+      };
+      Deserializer deserializer;
+      EXPECT_EQ(deserializer.set_read_buffer(buf1.data(), buf1.size()), APX_NO_ERROR);
+      unpack(deserializer);
+      auto av = deserializer.take_av();
+      ASSERT_EQ(av->length(), array_length);
+      auto first_hv = dtl::hv_cast(av->at(0u));
+      auto second_hv = dtl::hv_cast(av->at(1u));
+
+      EXPECT_EQ(deserializer.set_read_buffer(buf2.data(), buf2.size()), APX_NO_ERROR);
+      deserializer.set_reuse_value(dtl::dv_cast(av));
+      unpack(deserializer);
+      EXPECT_EQ(deserializer.take_dv().get(), av.get());
+      ASSERT_EQ(av->length(), array_length);
+      EXPECT_EQ(av->at(0u).get(), first_hv.get());
+      EXPECT_EQ(av->at(1u).get(), second_hv.get());
+      bool ok{ false };
+      EXPECT_EQ(dtl::sv_cast(first_hv->at("Id"))->to_u32(ok), 4000u);
+      EXPECT_EQ(dtl::sv_cast(first_hv->at("Value"))->to_u32(ok), 0u);
+      EXPECT_EQ(dtl::sv_cast(second_hv->at("Id"))->to_u32(ok), 1u);
+      EXPECT_EQ(dtl::sv_cast(second_hv->at("Value"))->to_u32(ok), 1u);
+      EXPECT_TRUE(ok);
+   }
+   TEST(Deserializer, UnpackRecordUsingMemoryResource)
+   {
+      constexpr std::size_t str_length{ 20u };
+      constexpr std::size_t array_length{ 3u };
+      std::array<std::uint8_t, UINT16_SIZE + str_length + UINT8_SIZE * array_length> buf = {
+         0x07, 0x00,
+         'A', ' ', 'l', 'o', 'n', 'g', ' ', 's', 't', 'r', 'i', 'n', 'g', ' ', 'v', 'a', 'l', 'u', 'e', 0,
+         1, 2, 3 };
+      std::array<std::byte, 4096> arena_buffer;
+      std::pmr::monotonic_buffer_resource arena{ arena_buffer.data(), arena_buffer.size(), std::pmr::null_memory_resource() };
+      auto in_arena = [&](void const* ptr) {
+         auto const* p = static_cast<std::byte const*>(ptr);
+         return (p >= arena_buffer.data()) && (p < arena_buffer.data() + arena_buffer.size());
+      };
+      dtl::HashValue hv;
+      Deserializer deserializer;
+      deserializer.set_memory_resource(&arena);
+      deserializer.reserve_nesting_depth(1u); //Done by the VM from the program header
+      EXPECT_EQ(deserializer.set_read_buffer(buf.data(), buf.size()), APX_NO_ERROR);
+      std::array<apx::error_t, 7> results;
+      auto* previous_resource = std::pmr::set_default_resource(std::pmr::null_memory_resource()); //Fallback allocations throw
+      auto const allocations_before = global_allocation_count.load();
+      results[0] = deserializer.unpack_record(0u, apx::SizeType::None);
+      results[1] = deserializer.record_select("IdentifierOfRecord", false);
+      results[2] = deserializer.unpack_uint16(0u, apx::SizeType::None);
+      results[3] = deserializer.record_select("DescriptionOfRecord", false);
+      results[4] = deserializer.unpack_char(str_length, apx::SizeType::None);
+      results[5] = deserializer.record_select("ValuesOfRecord", true);
+      results[6] = deserializer.unpack_uint8(array_length, apx::SizeType::None);
+      hv = deserializer.take_hv();
+      auto const allocations_after = global_allocation_count.load();
+      std::pmr::set_default_resource(previous_resource);
+      for (auto result : results)
+      {
+         EXPECT_EQ(result, APX_NO_ERROR);
+      }
+      EXPECT_EQ(allocations_after, allocations_before); //Nothing was allocated with global operator new
+      ASSERT_TRUE(hv);
+      EXPECT_TRUE(in_arena(hv.get()));
+      auto sv = dtl::sv_cast(hv->at("DescriptionOfRecord"));
+      ASSERT_TRUE(sv);
+      EXPECT_TRUE(in_arena(sv.get()));
+      bool ok{ false };
+      EXPECT_EQ(sv->to_string(ok), "A long string value"s);
+      EXPECT_TRUE(ok);
+      auto ta = dtl::ta_cast<std::uint8_t>(hv->at("ValuesOfRecord"));
+      ASSERT_TRUE(ta);
+      EXPECT_TRUE(in_arena(ta->data()));
+      EXPECT_EQ(ta->at(2), 3u);
+      EXPECT_EQ(dtl::sv_cast(hv->at("IdentifierOfRecord"))->to_u32(ok), 7u);
+   }
 }
\ No newline at end of file
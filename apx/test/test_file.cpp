@@ -92,4 +92,38 @@ namespace apx_test
       EXPECT_EQ(files[2].get_name(), "File1.apx"s);
       EXPECT_EQ(files[3].get_name(), "File3.apx"s);
    }
+
+   TEST(File, DirtyRangesAreMerged)
+   {
+      File file(rmf::FileInfo("TestNode.out", 100u, 0x1000u));
+      EXPECT_FALSE(file.has_dirty_ranges());
+      file.mark_dirty(10u, 2u);
+      file.mark_dirty(50u, 4u);
+      file.mark_dirty(12u, 3u);
+      file.mark_dirty(98u, 10u);
+      std::vector<ByteRange> ranges;
+      file.take_dirty_ranges(ranges);
+      EXPECT_FALSE(file.has_dirty_ranges());
+      ASSERT_EQ(ranges.size(), 3u);
+      EXPECT_EQ(ranges[0].offset, 10u);
+      EXPECT_EQ(ranges[0].size, 5u);
+      EXPECT_EQ(ranges[1].offset, 50u);
+      EXPECT_EQ(ranges[1].size, 4u);
+      EXPECT_EQ(ranges[2].offset, 98u);
+      EXPECT_EQ(ranges[2].size, 2u);
+   }
+
+   TEST(File, DirtyRangesAreCollapsedWhenLimitIsReached)
+   {
+      File file(rmf::FileInfo("TestNode.out", 100u, 0x1000u));
+      for (std::uint32_t i = 0u; i <= FILE_DIRTY_RANGES_MAX; i++)
+      {
+         file.mark_dirty(i * 4u, 1u);
+      }
+      std::vector<ByteRange> ranges;
+      file.take_dirty_ranges(ranges);
+      ASSERT_EQ(ranges.size(), 1u);
+      EXPECT_EQ(ranges[0].offset, 0u);
+      EXPECT_EQ(ranges[0].size, FILE_DIRTY_RANGES_MAX * 4u + 1u);
+   }
 }
\ No newline at end of file
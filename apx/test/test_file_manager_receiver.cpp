@@ -1,6 +1,7 @@
 #include "pch.h"
 #include <cstring>
 #include <array>
+#include <vector>
 #include "cpp-apx/file_manager_receiver.h"
 
 using namespace apx;
@@ -150,4 +151,52 @@ namespace apx_test
       result = receiver.write(write_address, msg.data() + write_size1, write_size2, false);
       EXPECT_EQ(result.error, APX_INVALID_ADDRESS_ERROR);
    }
+
+   TEST(FileManagerReceiver, BufferGrowsWhenDataArrives)
+   {
+      FileManagerReceiver receiver;
+      receiver.set_max_buffer_size(100000u);
+      EXPECT_EQ(receiver.buffer_size(), rmf::CMD_AREA_SIZE);
+      EXPECT_EQ(receiver.max_buffer_size(), 100000u);
+      std::uint32_t const write_address = 0x10000;
+      std::vector<std::uint8_t> msg(3000u);
+      for (std::size_t i = 0u; i < msg.size(); i++)
+      {
+         msg[i] = static_cast<std::uint8_t>(i);
+      }
+      auto result = receiver.write(write_address, msg.data(), 1500u, true);
+      EXPECT_EQ(result.error, APX_NO_ERROR);
+      EXPECT_FALSE(result.is_complete);
+      EXPECT_EQ(receiver.buffer_size(), 2u * rmf::CMD_AREA_SIZE);
+      result = receiver.write(write_address + 1500u, msg.data() + 1500u, 1500u, false);
+      EXPECT_EQ(result.error, APX_NO_ERROR);
+      EXPECT_TRUE(result.is_complete);
+      EXPECT_EQ(result.size, msg.size());
+      EXPECT_EQ(std::memcmp(result.data, msg.data(), msg.size()), 0);
+      EXPECT_EQ(receiver.buffer_size(), 4u * rmf::CMD_AREA_SIZE);
+   }
+
+   TEST(FileManagerReceiver, WriteLargerThanMaxBufferSizeIsRejected)
+   {
+      FileManagerReceiver receiver;
+      receiver.set_max_buffer_size(2000u);
+      std::vector<std::uint8_t> msg(2001u);
+      auto result = receiver.write(0x10000, msg.data(), msg.size(), false);
+      EXPECT_EQ(result.error, APX_BUFFER_FULL_ERROR);
+      EXPECT_EQ(receiver.buffer_size(), rmf::CMD_AREA_SIZE);
+      receiver.reset();
+      result = receiver.write(0x10000, msg.data(), 1500u, true);
+      EXPECT_EQ(result.error, APX_NO_ERROR);
+      result = receiver.write(0x10000 + 1500u, msg.data() + 1500u, 501u, false);
+      EXPECT_EQ(result.error, APX_BUFFER_FULL_ERROR);
+      EXPECT_EQ(receiver.buffer_size(), 2000u);
+   }
+
+   TEST(FileManagerReceiver, MaxBufferSizeIsLimitedToMaxFileSize)
+   {
+      FileManagerReceiver receiver;
+      receiver.set_max_buffer_size(MAX_FILE_SIZE + 1u);
+      EXPECT_EQ(receiver.max_buffer_size(), MAX_FILE_SIZE);
+      EXPECT_EQ(receiver.buffer_size(), rmf::CMD_AREA_SIZE);
+   }
 }
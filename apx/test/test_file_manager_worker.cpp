@@ -0,0 +1,41 @@
+#include "pch.h"
+#include <cstdint>
+#include <optional>
+#include "cpp-apx/file_manager_worker.h"
+
+using namespace apx;
+namespace apx_test
+{
+   TEST(FileManagerWorker, WritesToSameSlotAreCoalesced)
+   {
+      FileManagerShared shared;
+      FileManagerWorker worker{ shared };
+      CoalesceSlot slot;
+      std::uint8_t value{ 1u };
+      EXPECT_EQ(worker.prepare_send_local_data_copy(0u, &value, sizeof(value), &slot), APX_NO_ERROR);
+      value = 2u;
+      EXPECT_EQ(worker.prepare_send_local_data_copy(0u, &value, sizeof(value), &slot), APX_NO_ERROR);
+      EXPECT_EQ(worker.num_pending_commands(), 1u);
+      worker.run();
+      EXPECT_EQ(worker.prepare_send_local_data_copy(0u, &value, sizeof(value), &slot), APX_NO_ERROR);
+      EXPECT_EQ(worker.num_pending_commands(), 1u); //Slot from previous queue is not reused
+   }
+
+   TEST(FileManagerWorker, SlotOfDestroyedWorkerDoesNotMatchNewWorkerAtSameAddress)
+   {
+      FileManagerShared shared;
+      std::optional<FileManagerWorker> worker;
+      CoalesceSlot stale_slot;
+      std::uint8_t value{ 1u };
+      worker.emplace(shared);
+      auto const* first_worker = &worker.value();
+      EXPECT_EQ(worker->prepare_send_local_data_copy(0u, &value, sizeof(value), &stale_slot), APX_NO_ERROR);
+      worker.reset();
+      worker.emplace(shared);
+      ASSERT_EQ(&worker.value(), first_worker);
+      std::uint8_t const other_value{ 7u };
+      EXPECT_EQ(worker->prepare_send_local_data_copy(4u, &other_value, sizeof(other_value)), APX_NO_ERROR);
+      EXPECT_EQ(worker->prepare_send_local_data_copy(0u, &value, sizeof(value), &stale_slot), APX_NO_ERROR);
+      EXPECT_EQ(worker->num_pending_commands(), 2u);
+   }
+}
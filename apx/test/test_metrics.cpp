@@ -0,0 +1,74 @@
+#include "pch.h"
+#include "cpp-apx/metrics.h"
+
+using namespace apx;
+
+namespace apx_test
+{
+   TEST(MetricGauge, TracksMaximum)
+   {
+      MetricGauge gauge;
+      gauge.set(3u);
+      gauge.set(10u);
+      gauge.set(4u);
+      EXPECT_EQ(gauge.get(), 4u);
+      EXPECT_EQ(gauge.max(), 10u);
+   }
+
+   TEST(LatencyHistogram, SmallValuesHaveExactBuckets)
+   {
+      for (std::uint64_t value = 0u; value < 32u; value++)
+      {
+         auto const index = LatencyHistogram::bucket_index(value);
+         EXPECT_EQ(index, value);
+         EXPECT_EQ(LatencyHistogram::bucket_lower_bound(index), value);
+         EXPECT_EQ(LatencyHistogram::bucket_upper_bound(index), value);
+      }
+   }
+
+   TEST(LatencyHistogram, BucketsAreContiguous)
+   {
+      for (std::size_t index = 1u; index < LatencyHistogram::NUM_BUCKETS; index++)
+      {
+         EXPECT_EQ(LatencyHistogram::bucket_lower_bound(index), LatencyHistogram::bucket_upper_bound(index - 1) + 1u);
+         EXPECT_EQ(LatencyHistogram::bucket_index(LatencyHistogram::bucket_lower_bound(index)), index);
+         EXPECT_EQ(LatencyHistogram::bucket_index(LatencyHistogram::bucket_upper_bound(index)), index);
+      }
+      EXPECT_EQ(LatencyHistogram::bucket_upper_bound(LatencyHistogram::NUM_BUCKETS - 1), (std::uint64_t{ 1u } << LatencyHistogram::MAX_BITS) - 1u);
+      EXPECT_EQ(LatencyHistogram::bucket_index(UINT64_MAX), LatencyHistogram::NUM_BUCKETS - 1);
+   }
+
+   TEST(LatencyHistogram, RelativeErrorIsBounded)
+   {
+      for (std::uint64_t value = 1000u; value < 1000000000u; value = value * 3u + 7u)
+      {
+         auto const upper = LatencyHistogram::bucket_upper_bound(LatencyHistogram::bucket_index(value));
+         EXPECT_GE(upper, value);
+         EXPECT_LE(static_cast<double>(upper - value) / static_cast<double>(value), 1.0 / LatencyHistogram::SUB_BUCKETS);
+      }
+   }
+
+   TEST(LatencyHistogram, Percentiles)
+   {
+      LatencyHistogram histogram;
+      LatencyHistogramSnapshot snapshot;
+      histogram.read(snapshot);
+      EXPECT_EQ(snapshot.percentile(50.0), 0u);
+      for (std::uint64_t value = 1u; value <= 100u; value++)
+      {
+         histogram.record(value * 1000u);
+      }
+      histogram.read(snapshot);
+      EXPECT_EQ(snapshot.count, 100u);
+      EXPECT_EQ(snapshot.max_ns, 100000u);
+      EXPECT_EQ(snapshot.mean(), 50500u);
+      auto const p50 = snapshot.percentile(50.0);
+      EXPECT_GE(p50, 50000u);
+      EXPECT_LE(p50, 50000u + 50000u / LatencyHistogram::SUB_BUCKETS);
+      auto const p99 = snapshot.percentile(99.0);
+      EXPECT_GE(p99, 99000u);
+      EXPECT_LE(p99, 100000u);
+      EXPECT_EQ(snapshot.percentile(100.0), 100000u);
+      EXPECT_LE(snapshot.percentile(0.0), 1000u + 1000u / LatencyHistogram::SUB_BUCKETS);
+   }
+}
@@ -436,4 +436,43 @@ namespace apx_test
          EXPECT_EQ(port_map->lookup(offset), expected_map[offset]);
       }
    }
+
+   TEST(NodeManager, BuildNodeStatistics)
+   {
+      const char* apx_text =
+         "APX/1.3\n"
+         "N\"TestNode\"\n"
+         "T\"OnOff_T\"C(0,3):VT(\"Off\",\"On\",\"Error\",\"NotAvailable\")\n"
+         "P\"ProvidePort\"T[\"OnOff_T\"]:=3\n"
+         "R\"RequirePort\"S:=0xFFFF\n";
+      apx::NodeManager manager;
+      apx::BuildNodeStatistics statistics;
+      EXPECT_EQ(manager.build_node(apx_text, &statistics), APX_NO_ERROR);
+      EXPECT_EQ(statistics.definition_size, std::strlen(apx_text));
+      EXPECT_EQ(statistics.num_ports, 2u);
+      EXPECT_EQ(statistics.num_programs, 3u);
+      EXPECT_GT(statistics.program_bytes, 0u);
+      EXPECT_EQ(statistics.init_data_size, 3u);
+      EXPECT_GT(statistics.total_time.count(), 0);
+      auto const sum_of_phases = statistics.parse_time + statistics.type_derivation_time + statistics.element_expansion_time +
+         statistics.init_value_derivation_time + statistics.compile_time + statistics.init_data_time;
+      EXPECT_LE(sum_of_phases, statistics.total_time);
+   }
+
+   TEST(NodeManager, BuildStatisticsAreAggregatedPerManager)
+   {
+      apx::NodeManager manager;
+      EXPECT_EQ(manager.build_node("APX/1.3\nN\"Node1\"\nP\"Port\"C:=0\n"), APX_NO_ERROR);
+      EXPECT_EQ(manager.build_node("APX/1.3\nN\"Node2\"\nP\"Port\"S:=0\nR\"Port2\"L:=0\n"s), APX_NO_ERROR);
+      EXPECT_NE(manager.build_node("APX/1.3\nN\"Node3\"\nP\"Port\"T[\"Missing_T\"]\n"), APX_NO_ERROR);
+      auto const& statistics = manager.get_statistics();
+      EXPECT_EQ(statistics.num_builds, 3u);
+      EXPECT_EQ(statistics.num_failed_builds, 1u);
+      EXPECT_EQ(statistics.total.num_ports, 3u);
+      EXPECT_EQ(statistics.total.init_data_size, 7u);
+      EXPECT_LE(statistics.max_total_time, statistics.total.total_time);
+      EXPECT_FALSE(statistics.to_string().empty());
+      manager.reset_statistics();
+      EXPECT_EQ(manager.get_statistics().num_builds, 0u);
+   }
 }
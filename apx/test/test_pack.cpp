@@ -1,5 +1,6 @@
 #include "pch.h"
 #include <array>
+#include <vector>
 #include "cpp-apx/pack.h"
 
 namespace apx_test
@@ -198,4 +199,86 @@ namespace apx_test
       value = apx::unpackLE<std::uint32_t>(buf.data());
       ASSERT_EQ(value, 0xffffffffu);
    }
+
+   TEST(Pack, ByteSwap)
+   {
+      ASSERT_EQ(apx::byteSwap<std::uint16_t>(0x1234u), 0x3412u);
+      ASSERT_EQ(apx::byteSwap<std::uint32_t>(0x12345678u), 0x78563412u);
+      ASSERT_EQ(apx::byteSwap<std::uint64_t>(0x0102030405060708ull), 0x0807060504030201ull);
+      ASSERT_EQ(apx::byteSwap<std::int16_t>(static_cast<std::int16_t>(0x80FF)), static_cast<std::int16_t>(0xFF80));
+      ASSERT_EQ(apx::byteSwap<std::int8_t>(-1), -1);
+   }
+
+   template <typename T> static std::vector<T> make_test_array(std::size_t length)
+   {
+      std::vector<T> values(length);
+      for (std::size_t i = 0u; i < length; i++)
+      {
+         values[i] = static_cast<T>(0x0102030405060708ull * (i + 1u) + (i << 7u));
+      }
+      return values;
+   }
+
+   template <typename T> static void verify_native_array_kernels(std::size_t length)
+   {
+      auto const values = make_test_array<T>(length);
+      std::vector<std::uint8_t> packed(length * sizeof(T), 0u);
+      std::vector<std::uint8_t> expected(length * sizeof(T), 0u);
+      for (std::size_t i = 0u; i < length; i++)
+      {
+         apx::packLE<T>(expected.data() + i * sizeof(T), values[i]);
+      }
+      apx::pack_array_le<T>(packed.data(), values.data(), length);
+      EXPECT_EQ(packed, expected);
+      std::vector<T> unpacked(length);
+      apx::unpack_array_le<T>(unpacked.data(), packed.data(), length);
+      EXPECT_EQ(unpacked, values);
+   }
+
+   //Forces the big-endian kernel, whatever the host byte order is
+   template <typename T> static void verify_byte_swap_array_kernels(std::size_t length)
+   {
+      auto const values = make_test_array<T>(length);
+      std::vector<std::uint8_t> packed(length * sizeof(T), 0u);
+      std::vector<std::uint8_t> expected(length * sizeof(T), 0u);
+      for (std::size_t i = 0u; i < length; i++)
+      {
+         T const swapped = apx::byteSwap(values[i]);
+         std::memcpy(expected.data() + i * sizeof(T), &swapped, sizeof(T));
+      }
+      apx::pack_array_le<T, true>(packed.data(), values.data(), length);
+      EXPECT_EQ(packed, expected);
+      std::vector<T> unpacked(length);
+      apx::unpack_array_le<T, true>(unpacked.data(), packed.data(), length);
+      EXPECT_EQ(unpacked, values);
+   }
+
+   template <typename T> static void verify_array_kernels()
+   {
+      for (std::size_t length : { 0u, 1u, 3u, 4u, 17u, 4096u })
+      {
+         verify_native_array_kernels<T>(length);
+         verify_byte_swap_array_kernels<T>(length);
+      }
+   }
+
+   TEST(Pack, PackAndUnpackArrayLE)
+   {
+      verify_array_kernels<std::uint8_t>();
+      verify_array_kernels<std::uint16_t>();
+      verify_array_kernels<std::uint32_t>();
+      verify_array_kernels<std::uint64_t>();
+      verify_array_kernels<std::int8_t>();
+      verify_array_kernels<std::int16_t>();
+      verify_array_kernels<std::int32_t>();
+      verify_array_kernels<std::int64_t>();
+   }
+
+   TEST(Pack, PackArrayLEByteOrder)
+   {
+      std::uint32_t const values[] = { 0x12345678u, 0xAABBCCDDu };
+      std::array<std::uint8_t, sizeof(values)> buf;
+      apx::pack_array_le(buf.data(), values, 2u);
+      ASSERT_EQ(buf, (std::array<std::uint8_t, sizeof(values)>{ 0x78u, 0x56u, 0x34u, 0x12u, 0xDDu, 0xCCu, 0xBBu, 0xAAu }));
+   }
 }
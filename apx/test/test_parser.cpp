@@ -490,4 +490,24 @@ namespace apx_test
 
    }
 
+   TEST(Parser, ParseDeclarationsLeavesFinalizeToCaller)
+   {
+      const char* apx_text =
+         "APX/1.3\n"
+         "N\"TestNode\"\n"
+         "T\"Percentage_T\"C(0,255)\n"
+         "R\"FuelLevel\"T[\"Percentage_T\"]:=255\n";
+      apx::Parser parser;
+      EXPECT_EQ(parser.parse_declarations(std::string{ apx_text }), APX_NO_ERROR);
+      auto node{ parser.take_last_node() };
+      ASSERT_TRUE(node);
+      auto port = node->get_require_port(0u);
+      ASSERT_NE(port, nullptr);
+      EXPECT_EQ(port->get_data_element()->get_type_code(), apx::TypeCode::TypeRefName);
+      EXPECT_FALSE(port->proper_init_value);
+      EXPECT_EQ(node->finalize(), APX_NO_ERROR);
+      EXPECT_EQ(port->get_data_element()->get_type_code(), apx::TypeCode::TypeRefPtr);
+      EXPECT_TRUE(port->proper_init_value);
+   }
+
 }
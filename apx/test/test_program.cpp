@@ -154,5 +154,43 @@ namespace apx_test
       ASSERT_EQ(header.queue_length, 1000u);
    }
 
+   TEST(Program, EncodeAndDecodeNestingDepth)
+   {
+      Program program;
+      ASSERT_EQ(create_program_header(program, apx::ProgramType::Unpack, UINT8_SIZE + UINT16_SIZE, 0, false, 2u), APX_NO_ERROR);
+      Program const expected{ 'V', 'M', apx::vm::MAJOR_VERSION, apx::vm::MINOR_VERSION, HEADER_FLAG_NESTING_DEPTH | HEADER_PROG_TYPE_UNPACK | VARIANT_U8, UINT8_SIZE + UINT16_SIZE, 2u };
+      ASSERT_EQ(program, expected);
+
+      ProgramHeader header;
+      std::uint8_t const* begin = program.data();
+      std::uint8_t const* end = begin + program.size();
+      std::uint8_t const* next{ nullptr };
+      ASSERT_EQ(decode_program_header(begin, end, next, header), APX_NO_ERROR);
+      ASSERT_EQ(next, end);
+      ASSERT_EQ(header.prog_type, apx::ProgramType::Unpack);
+      ASSERT_EQ(header.data_size, UINT8_SIZE + UINT16_SIZE);
+      ASSERT_EQ(header.nesting_depth, 2u);
+      ASSERT_EQ(decode_program_header(begin, end - 1, next, header), APX_PARSE_ERROR);
+   }
+
+   TEST(Program, NestingDepthIsClampedToMaxValue)
+   {
+      Program program;
+      ASSERT_EQ(create_program_header(program, apx::ProgramType::Pack, UINT8_SIZE, 0, false, UINT8_MAX + 1u), APX_NO_ERROR);
+      Program const expected{ 'V', 'M', apx::vm::MAJOR_VERSION, apx::vm::MINOR_VERSION, HEADER_FLAG_NESTING_DEPTH | HEADER_PROG_TYPE_PACK | VARIANT_U8, UINT8_SIZE, UINT8_MAX };
+      ASSERT_EQ(program, expected);
+   }
 
+   TEST(Program, DecodeProgramWithVersion)
+   {
+      Program const older{ 'V', 'M', apx::vm::MAJOR_VERSION, 0u, HEADER_PROG_TYPE_PACK | VARIANT_U8, UINT8_SIZE };
+      Program const newer{ 'V', 'M', apx::vm::MAJOR_VERSION, apx::vm::MINOR_VERSION + 1u, HEADER_PROG_TYPE_PACK | VARIANT_U8, UINT8_SIZE };
+      Program const other_major{ 'V', 'M', apx::vm::MAJOR_VERSION + 1u, 0u, HEADER_PROG_TYPE_PACK | VARIANT_U8, UINT8_SIZE };
+      ProgramHeader header;
+      std::uint8_t const* next{ nullptr };
+      ASSERT_EQ(decode_program_header(older.data(), older.data() + older.size(), next, header), APX_NO_ERROR);
+      EXPECT_EQ(header.minor_version, 0u);
+      EXPECT_EQ(decode_program_header(newer.data(), newer.data() + newer.size(), next, header), APX_VERSION_ERROR);
+      EXPECT_EQ(decode_program_header(other_major.data(), other_major.data() + other_major.size(), next, header), APX_VERSION_ERROR);
+   }
 }
\ No newline at end of file
@@ -0,0 +1,135 @@
+#include "pch.h"
+#include <cstdint>
+#include <limits>
+#include <string>
+#include <vector>
+#include "cpp-apx/typed_array.h"
+
+namespace apx_test
+{
+   using apx::vm::RangeCheckKernel;
+
+   //Lengths chosen to cover empty input, scalar tail only, one full vector and full vectors followed by a tail
+   static std::size_t const test_lengths[] = { 0u, 1u, 3u, 7u, 8u, 15u, 16u, 17u, 31u, 32u, 33u, 63u, 64u, 100u, 257u };
+
+   //Runs test once per kernel supported by this CPU, then restores automatic kernel selection
+   template <typename Fn> static void for_each_kernel(Fn&& test)
+   {
+      for (RangeCheckKernel kernel : { RangeCheckKernel::Scalar, RangeCheckKernel::Sse2, RangeCheckKernel::Avx2 })
+      {
+         if (apx::vm::set_range_check_kernel(kernel))
+         {
+            SCOPED_TRACE("kernel=" + std::to_string(static_cast<int>(kernel)));
+            test();
+         }
+      }
+      ASSERT_TRUE(apx::vm::set_range_check_kernel(RangeCheckKernel::Auto));
+   }
+
+   template <typename T> static void verify_elements_in_range(T lower_limit, T upper_limit)
+   {
+      for (std::size_t length : test_lengths)
+      {
+         std::vector<T> data(length);
+         for (std::size_t i = 0u; i < length; i++)
+         {
+            data[i] = (i % 2u == 0u) ? lower_limit : upper_limit;
+         }
+         EXPECT_TRUE(apx::vm::elements_in_range(data.data(), length, lower_limit, upper_limit)) << "length=" << length;
+         for (std::size_t pos = 0u; pos < length; pos++)
+         {
+            T const saved = data[pos];
+            if (lower_limit > std::numeric_limits<T>::min())
+            {
+               data[pos] = static_cast<T>(lower_limit - 1);
+               EXPECT_FALSE(apx::vm::elements_in_range(data.data(), length, lower_limit, upper_limit)) << "length=" << length << ", pos=" << pos;
+               data[pos] = std::numeric_limits<T>::min();
+               EXPECT_FALSE(apx::vm::elements_in_range(data.data(), length, lower_limit, upper_limit)) << "length=" << length << ", pos=" << pos;
+            }
+            if (upper_limit < std::numeric_limits<T>::max())
+            {
+               data[pos] = static_cast<T>(upper_limit + 1);
+               EXPECT_FALSE(apx::vm::elements_in_range(data.data(), length, lower_limit, upper_limit)) << "length=" << length << ", pos=" << pos;
+               data[pos] = std::numeric_limits<T>::max();
+               EXPECT_FALSE(apx::vm::elements_in_range(data.data(), length, lower_limit, upper_limit)) << "length=" << length << ", pos=" << pos;
+            }
+            data[pos] = saved;
+         }
+      }
+   }
+
+   TEST(RangeCheck, KernelSelection)
+   {
+      EXPECT_TRUE(apx::vm::set_range_check_kernel(RangeCheckKernel::Scalar));
+#if defined(__x86_64__) || defined(_M_X64)
+      EXPECT_TRUE(apx::vm::set_range_check_kernel(RangeCheckKernel::Sse2));
+#endif
+      EXPECT_TRUE(apx::vm::set_range_check_kernel(RangeCheckKernel::Auto));
+   }
+
+   TEST(RangeCheck, UnsignedElements)
+   {
+      for_each_kernel([]()
+         {
+            verify_elements_in_range<std::uint8_t>(3u, 200u);
+            verify_elements_in_range<std::uint16_t>(1000u, 0xFDFFu);
+            verify_elements_in_range<std::uint32_t>(7u, 0x80000010u);
+            verify_elements_in_range<std::uint64_t>(0x1000u, 0x8000000000000010ull);
+         });
+   }
+
+   TEST(RangeCheck, SignedElements)
+   {
+      for_each_kernel([]()
+         {
+            verify_elements_in_range<std::int8_t>(-100, 100);
+            verify_elements_in_range<std::int16_t>(-3, 30000);
+            verify_elements_in_range<std::int32_t>(INT32_MIN + 1, -5);
+            verify_elements_in_range<std::int64_t>(-1, INT64_MAX - 1);
+         });
+   }
+
+   TEST(RangeCheck, FullRangeLimitsAcceptEverything)
+   {
+      for_each_kernel([]()
+         {
+            std::vector<std::uint8_t> u8_data{ 0u, 1u, 127u, 128u, 255u };
+            EXPECT_TRUE(apx::vm::elements_in_range(u8_data.data(), u8_data.size(), std::uint8_t{ 0u }, std::uint8_t{ UINT8_MAX }));
+            std::vector<std::int32_t> s32_data(40u, INT32_MIN);
+            s32_data.back() = INT32_MAX;
+            EXPECT_TRUE(apx::vm::elements_in_range(s32_data.data(), s32_data.size(), std::int32_t{ INT32_MIN }, std::int32_t{ INT32_MAX }));
+         });
+   }
+
+   TEST(RangeCheck, ClampLimitsToElementType)
+   {
+      std::vector<std::uint8_t> u8_data(20u, 250u);
+      EXPECT_TRUE(apx::vm::elements_in_range_clamped(u8_data.data(), u8_data.size(), std::int64_t{ -1000 }, std::int64_t{ 1000 }));
+      EXPECT_FALSE(apx::vm::elements_in_range_clamped(u8_data.data(), u8_data.size(), std::int64_t{ -1000 }, std::int64_t{ 249 }));
+      EXPECT_FALSE(apx::vm::elements_in_range_clamped(u8_data.data(), u8_data.size(), std::uint64_t{ 256u }, std::uint64_t{ 1000u }));
+      EXPECT_FALSE(apx::vm::elements_in_range_clamped(u8_data.data(), u8_data.size(), std::int64_t{ -10 }, std::int64_t{ -1 }));
+      EXPECT_TRUE(apx::vm::elements_in_range_clamped(u8_data.data(), 0u, std::int64_t{ -10 }, std::int64_t{ -1 }));
+      std::vector<std::int16_t> s16_data(20u, -5);
+      EXPECT_TRUE(apx::vm::elements_in_range_clamped(s16_data.data(), s16_data.size(), std::int64_t{ -5 }, std::int64_t{ INT64_MAX }));
+      EXPECT_FALSE(apx::vm::elements_in_range_clamped(s16_data.data(), s16_data.size(), std::uint64_t{ 0u }, std::uint64_t{ UINT64_MAX }));
+   }
+
+   TEST(RangeCheck, TypedArray)
+   {
+      dtl::TypedArray<std::uint16_t> array;
+      for (std::uint16_t i = 0u; i < 50u; i++)
+      {
+         array.push(static_cast<std::uint16_t>(i * 100u));
+      }
+      EXPECT_TRUE(apx::vm::typed_array_in_range<std::uint32_t>(&array, 0u, 4900u));
+      EXPECT_FALSE(apx::vm::typed_array_in_range<std::uint32_t>(&array, 0u, 4899u));
+      EXPECT_FALSE(apx::vm::typed_array_in_range<std::int32_t>(&array, 1, 65535));
+      dtl::TypedArray<bool> bool_array;
+      for (int i = 0; i < 20; i++)
+      {
+         bool_array.push((i % 3) == 0);
+      }
+      EXPECT_TRUE(apx::vm::typed_array_in_range<std::uint32_t>(&bool_array, 0u, 1u));
+      EXPECT_FALSE(apx::vm::typed_array_in_range<std::uint32_t>(&bool_array, 1u, 1u));
+   }
+}
@@ -0,0 +1,190 @@
+#include "pch.h"
+#include <vector>
+#include "cpp-apx/routing_table.h"
+#include "cpp-apx/node_manager.h"
+
+using namespace apx;
+using namespace std::string_literals;
+
+namespace apx_test
+{
+   static char const* provide_node_text = "APX/1.2\n"
+      "N\"ProvideNode\"\n"
+      "P\"VehicleSpeed\"S:=65535\n"
+      "P\"EngineSpeed\"S:=65535\n"
+      "P\"GearSelection\"C(0,15):=15\n";
+
+   static char const* require_node_text = "APX/1.2\n"
+      "N\"RequireNode\"\n"
+      "R\"GearSelection\"C(0,15):=15\n"
+      "R\"EngineSpeed\"S:=65535\n"
+      "R\"VehicleSpeed\"S:=65535\n";
+
+   struct RecordedCopy
+   {
+      NodeInstance* node_instance;
+      std::uint32_t dest_offset;
+      std::size_t data_offset;
+      std::uint32_t size;
+   };
+
+   static std::vector<RecordedCopy> collect_routes(RoutingTable const& table, NodeInstance const* source, std::uint32_t offset, std::size_t size)
+   {
+      std::vector<RecordedCopy> result;
+      table.for_each_route(source, offset, size, [&result](RouteAction const& action, std::uint32_t dest_offset, std::size_t data_offset, std::uint32_t write_size)
+         {
+            result.push_back(RecordedCopy{ action.node_instance, dest_offset, data_offset, write_size });
+         });
+      return result;
+   }
+
+   TEST(RoutingTable, RoutesAreCreatedWhenProviderAttachesFirst)
+   {
+      NodeManager manager;
+      ASSERT_EQ(manager.build_node(provide_node_text), APX_NO_ERROR);
+      auto* provide_node = manager.get_last_attached();
+      ASSERT_EQ(manager.build_node(require_node_text), APX_NO_ERROR);
+      auto* require_node = manager.get_last_attached();
+      RoutingTable table;
+      table.attach(nullptr, provide_node);
+      auto const* routes = table.get_routes(provide_node);
+      ASSERT_NE(routes, nullptr);
+      ASSERT_EQ(routes->size(), 3u);
+      EXPECT_TRUE(routes->at(0).actions.empty());
+      table.attach(nullptr, require_node);
+      EXPECT_EQ(table.num_nodes(), 2u);
+      ASSERT_EQ(routes->at(0).actions.size(), 1u);
+      EXPECT_EQ(routes->at(0).offset, 0u);
+      EXPECT_EQ(routes->at(0).actions[0].node_instance, require_node);
+      EXPECT_EQ(routes->at(0).actions[0].offset, 3u);
+      EXPECT_EQ(routes->at(0).actions[0].size, 2u);
+      ASSERT_EQ(routes->at(2).actions.size(), 1u);
+      EXPECT_EQ(routes->at(2).offset, 4u);
+      EXPECT_EQ(routes->at(2).actions[0].offset, 0u);
+      EXPECT_EQ(routes->at(2).actions[0].size, 1u);
+   }
+
+   TEST(RoutingTable, RoutesAreCreatedWhenRequirerAttachesFirst)
+   {
+      NodeManager manager;
+      ASSERT_EQ(manager.build_node(provide_node_text), APX_NO_ERROR);
+      auto* provide_node = manager.get_last_attached();
+      ASSERT_EQ(manager.build_node(require_node_text), APX_NO_ERROR);
+      auto* require_node = manager.get_last_attached();
+      RoutingTable table;
+      table.attach(nullptr, require_node);
+      EXPECT_EQ(table.find_provider(require_node->find("EngineSpeed")), nullptr);
+      table.attach(nullptr, provide_node);
+      EXPECT_EQ(table.find_provider(require_node->find("EngineSpeed")), provide_node->find("EngineSpeed"));
+      auto const* routes = table.get_routes(provide_node);
+      ASSERT_NE(routes, nullptr);
+      ASSERT_EQ(routes->at(1).actions.size(), 1u);
+      EXPECT_EQ(routes->at(1).actions[0].offset, 1u);
+   }
+
+   TEST(RoutingTable, WriteIsSplitPerProvidePort)
+   {
+      NodeManager manager;
+      ASSERT_EQ(manager.build_node(provide_node_text), APX_NO_ERROR);
+      auto* provide_node = manager.get_last_attached();
+      ASSERT_EQ(manager.build_node(require_node_text), APX_NO_ERROR);
+      auto* require_node = manager.get_last_attached();
+      RoutingTable table;
+      table.attach(nullptr, provide_node);
+      table.attach(nullptr, require_node);
+      //Write last byte of VehicleSpeed and all of EngineSpeed
+      auto copies = collect_routes(table, provide_node, 1u, 3u);
+      ASSERT_EQ(copies.size(), 2u);
+      EXPECT_EQ(copies[0].node_instance, require_node);
+      EXPECT_EQ(copies[0].dest_offset, 4u);
+      EXPECT_EQ(copies[0].data_offset, 0u);
+      EXPECT_EQ(copies[0].size, 1u);
+      EXPECT_EQ(copies[1].dest_offset, 1u);
+      EXPECT_EQ(copies[1].data_offset, 1u);
+      EXPECT_EQ(copies[1].size, 2u);
+      copies = collect_routes(table, provide_node, 4u, 1u);
+      ASSERT_EQ(copies.size(), 1u);
+      EXPECT_EQ(copies[0].dest_offset, 0u);
+      EXPECT_TRUE(collect_routes(table, require_node, 0u, 1u).empty());
+   }
+
+   TEST(RoutingTable, PortsWithDifferentSignatureAreNotConnected)
+   {
+      char const* other_node_text = "APX/1.2\n"
+         "N\"OtherNode\"\n"
+         "R\"VehicleSpeed\"L:=0\n"
+         "R\"GearSelection\"C(0,7):=7\n";
+      NodeManager manager;
+      ASSERT_EQ(manager.build_node(provide_node_text), APX_NO_ERROR);
+      auto* provide_node = manager.get_last_attached();
+      ASSERT_EQ(manager.build_node(other_node_text), APX_NO_ERROR);
+      auto* other_node = manager.get_last_attached();
+      RoutingTable table;
+      table.attach(nullptr, provide_node);
+      table.attach(nullptr, other_node);
+      EXPECT_TRUE(collect_routes(table, provide_node, 0u, 5u).empty());
+   }
+
+   TEST(RoutingTable, RoutesAreRemovedWhenNodeDetaches)
+   {
+      NodeManager manager;
+      ASSERT_EQ(manager.build_node(provide_node_text), APX_NO_ERROR);
+      auto* provide_node = manager.get_last_attached();
+      ASSERT_EQ(manager.build_node(require_node_text), APX_NO_ERROR);
+      auto* require_node = manager.get_last_attached();
+      RoutingTable table;
+      table.attach(nullptr, provide_node);
+      table.attach(nullptr, require_node);
+      EXPECT_EQ(collect_routes(table, provide_node, 0u, 5u).size(), 3u);
+      table.detach(require_node);
+      EXPECT_EQ(table.num_nodes(), 1u);
+      EXPECT_TRUE(collect_routes(table, provide_node, 0u, 5u).empty());
+      table.attach(nullptr, require_node);
+      EXPECT_EQ(collect_routes(table, provide_node, 0u, 5u).size(), 3u);
+      table.detach(provide_node);
+      EXPECT_EQ(table.get_routes(provide_node), nullptr);
+      EXPECT_EQ(table.find_provider(require_node->find("VehicleSpeed")), nullptr);
+   }
+
+   TEST(RoutingTable, RequirePortIsConnectedToFirstAttachedProvider)
+   {
+      char const* second_provide_node_text = "APX/1.2\n"
+         "N\"SecondProvideNode\"\n"
+         "P\"EngineSpeed\"S:=65535\n"
+         "P\"VehicleSpeed\"S:=65535\n";
+      NodeManager manager;
+      ASSERT_EQ(manager.build_node(provide_node_text), APX_NO_ERROR);
+      auto* first_node = manager.get_last_attached();
+      ASSERT_EQ(manager.build_node(second_provide_node_text), APX_NO_ERROR);
+      auto* second_node = manager.get_last_attached();
+      ASSERT_EQ(manager.build_node(require_node_text), APX_NO_ERROR);
+      auto* require_node = manager.get_last_attached();
+      RoutingTable table;
+      table.attach(nullptr, first_node);
+      table.attach(nullptr, require_node);
+      table.attach(nullptr, second_node);
+      EXPECT_EQ(table.find_provider(require_node->find("EngineSpeed")), first_node->find("EngineSpeed"));
+      EXPECT_EQ(table.find_provider(require_node->find("VehicleSpeed")), first_node->find("VehicleSpeed"));
+      EXPECT_EQ(collect_routes(table, first_node, 0u, 5u).size(), 3u);
+      EXPECT_TRUE(collect_routes(table, second_node, 0u, 4u).empty());
+      //Same result when the requirer attaches after both providers
+      table.detach(require_node);
+      table.attach(nullptr, require_node);
+      EXPECT_EQ(table.find_provider(require_node->find("EngineSpeed")), first_node->find("EngineSpeed"));
+      EXPECT_EQ(collect_routes(table, first_node, 0u, 5u).size(), 3u);
+      EXPECT_TRUE(collect_routes(table, second_node, 0u, 4u).empty());
+      //The second provider takes over when the first one detaches
+      table.detach(first_node);
+      EXPECT_EQ(table.find_provider(require_node->find("EngineSpeed")), second_node->find("EngineSpeed"));
+      EXPECT_EQ(table.find_provider(require_node->find("VehicleSpeed")), second_node->find("VehicleSpeed"));
+      EXPECT_EQ(table.find_provider(require_node->find("GearSelection")), nullptr);
+      auto copies = collect_routes(table, second_node, 0u, 4u);
+      ASSERT_EQ(copies.size(), 2u);
+      EXPECT_EQ(copies[0].node_instance, require_node);
+      EXPECT_EQ(copies[0].dest_offset, 1u);
+      EXPECT_EQ(copies[1].dest_offset, 3u);
+      table.attach(nullptr, first_node);
+      EXPECT_EQ(table.find_provider(require_node->find("EngineSpeed")), second_node->find("EngineSpeed"));
+      EXPECT_TRUE(collect_routes(table, first_node, 0u, 4u).empty());
+   }
+}
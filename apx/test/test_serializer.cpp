@@ -1405,4 +1405,73 @@ namespace apx_test
       EXPECT_EQ(buf, expected);
    }
 
+   TEST(Serializer, PackUInt16TypedArray)
+   {
+      std::array<std::uint8_t, UINT16_SIZE * 3> buf = { 0, 0, 0, 0, 0, 0 };
+      Serializer serializer;
+      ASSERT_EQ(serializer.set_write_buffer(buf.data(), buf.size()), APX_NO_ERROR);
+      auto ta = dtl::make_ta<std::uint16_t>({ 0u, 0x1234u, 0xffffu });
+      ASSERT_EQ(serializer.set_value(ta), APX_NO_ERROR);
+      ASSERT_EQ(serializer.pack_uint16(3u, apx::SizeType::None), APX_NO_ERROR);
+      ASSERT_EQ(serializer.bytes_written(), buf.size());
+      std::array<std::uint8_t, buf.size()> expected = { 0x00, 0x00, 0x34, 0x12, 0xff, 0xff };
+      EXPECT_EQ(buf, expected);
+   }
+
+   TEST(Serializer, PackInt8ArrayFromTypedArrayOfWiderType)
+   {
+      std::array<std::uint8_t, INT8_SIZE * 3> buf = { 0, 0, 0 };
+      Serializer serializer;
+      ASSERT_EQ(serializer.set_write_buffer(buf.data(), buf.size()), APX_NO_ERROR);
+      auto ta = dtl::make_ta<std::int32_t>({ -128, -1, 127 });
+      ASSERT_EQ(serializer.set_value(ta), APX_NO_ERROR);
+      ASSERT_EQ(serializer.pack_int8(3u, apx::SizeType::None), APX_NO_ERROR);
+      ASSERT_EQ(serializer.bytes_written(), buf.size());
+      std::array<std::uint8_t, buf.size()> expected = { 0x80, 0xff, 0x7f };
+      EXPECT_EQ(buf, expected);
+      ta->set(2, 128);
+      ASSERT_EQ(serializer.set_write_buffer(buf.data(), buf.size()), APX_NO_ERROR);
+      ASSERT_EQ(serializer.set_value(ta), APX_NO_ERROR);
+      ASSERT_EQ(serializer.pack_int8(3u, apx::SizeType::None), APX_VALUE_RANGE_ERROR);
+   }
+
+   TEST(Serializer, PackTypedArrayWithWrongLength)
+   {
+      std::array<std::uint8_t, UINT32_SIZE * 2> buf = { 0, 0, 0, 0, 0, 0, 0, 0 };
+      Serializer serializer;
+      ASSERT_EQ(serializer.set_write_buffer(buf.data(), buf.size()), APX_NO_ERROR);
+      auto ta = dtl::make_ta<std::uint32_t>({ 1u, 2u, 3u });
+      ASSERT_EQ(serializer.set_value(ta), APX_NO_ERROR);
+      ASSERT_EQ(serializer.pack_uint32(2u, apx::SizeType::None), APX_VALUE_LENGTH_ERROR);
+   }
+
+   TEST(Serializer, RangeCheckUInt32TypedArray)
+   {
+      std::array<std::uint8_t, UINT32_SIZE * 2> buf = { 0, 0, 0, 0, 0, 0, 0, 0 };
+      Serializer serializer;
+      ASSERT_EQ(serializer.set_write_buffer(buf.data(), buf.size()), APX_NO_ERROR);
+      auto ta = dtl::make_ta<std::uint32_t>({ 0u, 100000u });
+      ASSERT_EQ(serializer.set_value(ta), APX_NO_ERROR);
+      ASSERT_EQ(serializer.check_value_range_uint32(0u, 100000u), APX_NO_ERROR);
+      ASSERT_EQ(serializer.pack_uint32(2u, apx::SizeType::None), APX_NO_ERROR);
+      ta->set(1, 100001u);
+      ASSERT_EQ(serializer.set_write_buffer(buf.data(), buf.size()), APX_NO_ERROR);
+      ASSERT_EQ(serializer.set_value(ta), APX_NO_ERROR);
+      ASSERT_EQ(serializer.check_value_range_uint32(0u, 100000u), APX_VALUE_RANGE_ERROR);
+      ASSERT_EQ(serializer.pack_uint32(2u, apx::SizeType::None), APX_VALUE_RANGE_ERROR);
+   }
+
+   TEST(Serializer, PackDynamicBoolTypedArrayWithUint8Length)
+   {
+      std::array<std::uint8_t, UINT8_SIZE + UINT8_SIZE * 4> buf = { 0, 0, 0, 0, 0 };
+      Serializer serializer;
+      ASSERT_EQ(serializer.set_write_buffer(buf.data(), buf.size()), APX_NO_ERROR);
+      auto ta = dtl::make_ta<bool>({ true, false, true });
+      ASSERT_EQ(serializer.set_value(ta), APX_NO_ERROR);
+      ASSERT_EQ(serializer.pack_bool(4u, apx::SizeType::UInt8), APX_NO_ERROR);
+      ASSERT_EQ(serializer.bytes_written(), UINT8_SIZE + UINT8_SIZE * 3);
+      std::array<std::uint8_t, buf.size()> expected = { 3u, 1u, 0u, 1u, 0u };
+      EXPECT_EQ(buf, expected);
+   }
+
 }
\ No newline at end of file
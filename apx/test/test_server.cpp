@@ -0,0 +1,377 @@
+#include "pch.h"
+#include <array>
+#include <cstring>
+#include <string>
+#include <thread>
+
+#include "cpp-apx/server.h"
+#include "cpp-apx/client.h"
+#include "cpp-apx/mock_server_connection.h"
+
+using namespace apx;
+using namespace std::string_literals;
+
+namespace apx_test
+{
+   static char const* provide_node_text = "APX/1.2\n"
+      "N\"ProvideNode\"\n"
+      "P\"VehicleSpeed\"C:=255\n"
+      "P\"EngineSpeed\"C:=255\n";
+
+   static char const* require_node_text = "APX/1.2\n"
+      "N\"RequireNode\"\n"
+      "R\"EngineSpeed\"C:=0\n"
+      "R\"VehicleSpeed\"C:=0\n";
+
+   static void run_all(Server& server, Client& client1, Client& client2)
+   {
+      for (int i = 0; i < 5; i++)
+      {
+         client1.run();
+         client2.run();
+         server.run();
+      }
+   }
+
+   static std::uint32_t read_u32(Client& client, char const* node_name, char const* port_name)
+   {
+      auto* port = client.get_port(node_name, port_name);
+      EXPECT_NE(port, nullptr);
+      dtl::ScalarValue sv;
+      EXPECT_EQ(client.read_port_value(port, sv), APX_NO_ERROR);
+      bool ok{ false };
+      auto const value = sv->to_u32(ok);
+      EXPECT_TRUE(ok);
+      return value;
+   }
+
+   TEST(Server, NodesAreAttachedAfterDefinitionIsReceived)
+   {
+      Server server;
+      Client client1;
+      Client client2;
+      EXPECT_EQ(client1.build_node(provide_node_text), APX_NO_ERROR);
+      EXPECT_EQ(client2.build_node(require_node_text), APX_NO_ERROR);
+      auto* socket1 = testsocket_new();
+      auto* socket2 = testsocket_new();
+      server.accept_test_socket(socket1);
+      server.accept_test_socket(socket2);
+      EXPECT_EQ(server.num_connections(), 2u);
+      EXPECT_EQ(server.num_attached_nodes(), 0u);
+      client1.connect(socket1);
+      client2.connect(socket2);
+      run_all(server, client1, client2);
+      EXPECT_EQ(server.num_attached_nodes(), 2u);
+   }
+
+   TEST(Server, RequirePortReceivesCurrentValueOfProvidePort)
+   {
+      Server server;
+      Client client1;
+      Client client2;
+      EXPECT_EQ(client1.build_node(provide_node_text), APX_NO_ERROR);
+      EXPECT_EQ(client2.build_node(require_node_text), APX_NO_ERROR);
+      auto* socket1 = testsocket_new();
+      auto* socket2 = testsocket_new();
+      server.accept_test_socket(socket1);
+      server.accept_test_socket(socket2);
+      client1.connect(socket1);
+      run_all(server, client1, client2);
+      client2.connect(socket2);
+      run_all(server, client1, client2);
+      EXPECT_EQ(read_u32(client2, "RequireNode", "VehicleSpeed"), 255u);
+      EXPECT_EQ(read_u32(client2, "RequireNode", "EngineSpeed"), 255u);
+   }
+
+   TEST(Server, ProvidePortWriteIsRoutedToRequirePort)
+   {
+      Server server;
+      Client client1;
+      Client client2;
+      EXPECT_EQ(client1.build_node(provide_node_text), APX_NO_ERROR);
+      EXPECT_EQ(client2.build_node(require_node_text), APX_NO_ERROR);
+      auto* socket1 = testsocket_new();
+      auto* socket2 = testsocket_new();
+      server.accept_test_socket(socket2);
+      server.accept_test_socket(socket1);
+      client2.connect(socket2);
+      client1.connect(socket1);
+      run_all(server, client1, client2);
+      EXPECT_EQ(read_u32(client2, "RequireNode", "VehicleSpeed"), 255u);
+      auto sv = dtl::make_sv<std::uint32_t>(100u);
+      EXPECT_EQ(client1.write_port_value(client1.get_port("ProvideNode", "VehicleSpeed"), sv), APX_NO_ERROR);
+      run_all(server, client1, client2);
+      EXPECT_EQ(read_u32(client2, "RequireNode", "VehicleSpeed"), 100u);
+      EXPECT_EQ(read_u32(client2, "RequireNode", "EngineSpeed"), 255u);
+   }
+
+   TEST(Server, LargeProvidePortWriteIsSentToAllRequirers)
+   {
+      char const* provide_text = "APX/1.2\n"
+         "N\"ProvideNode\"\n"
+         "P\"Payload\"C[100]\n";
+      char const* require_text1 = "APX/1.2\n"
+         "N\"RequireNode1\"\n"
+         "R\"Payload\"C[100]\n";
+      char const* require_text2 = "APX/1.2\n"
+         "N\"RequireNode2\"\n"
+         "R\"Other\"C:=0\n"
+         "R\"Payload\"C[100]\n";
+      Server server;
+      Client client1;
+      Client client2;
+      Client client3;
+      ASSERT_EQ(client1.build_node(provide_text), APX_NO_ERROR);
+      ASSERT_EQ(client2.build_node(require_text1), APX_NO_ERROR);
+      ASSERT_EQ(client3.build_node(require_text2), APX_NO_ERROR);
+      auto* socket1 = testsocket_new();
+      auto* socket2 = testsocket_new();
+      auto* socket3 = testsocket_new();
+      server.accept_test_socket(socket1);
+      server.accept_test_socket(socket2);
+      server.accept_test_socket(socket3);
+      client1.connect(socket1);
+      client2.connect(socket2);
+      client3.connect(socket3);
+      for (int i = 0; i < 5; i++)
+      {
+         client1.run();
+         client2.run();
+         client3.run();
+         server.run();
+      }
+      EXPECT_EQ(server.num_attached_nodes(), 3u);
+      std::array<std::uint8_t, 100> payload;
+      for (std::size_t i = 0u; i < payload.size(); i++)
+      {
+         payload[i] = static_cast<std::uint8_t>(i);
+      }
+      auto* provide_port = client1.get_port("ProvideNode", "Payload");
+      ASSERT_NE(provide_port, nullptr);
+      auto* provide_node = provide_port->node_instance();
+      ASSERT_EQ(provide_node->write_provide_port_data(provide_port->data_offset(), payload.data(), payload.size()), APX_NO_ERROR);
+      for (int i = 0; i < 5; i++)
+      {
+         client1.run();
+         server.run();
+         client2.run();
+         client3.run();
+      }
+      std::array<std::uint8_t, 100> received;
+      auto* require_port = client2.get_port("RequireNode1", "Payload");
+      ASSERT_NE(require_port, nullptr);
+      EXPECT_EQ(require_port->node_instance()->get_node_data()->read_require_port_data(require_port->data_offset(), received.data(), received.size()), APX_NO_ERROR);
+      EXPECT_EQ(received, payload);
+      received.fill(0u);
+      require_port = client3.get_port("RequireNode2", "Payload");
+      ASSERT_NE(require_port, nullptr);
+      EXPECT_EQ(require_port->node_instance()->get_node_data()->read_require_port_data(require_port->data_offset(), received.data(), received.size()), APX_NO_ERROR);
+      EXPECT_EQ(received, payload);
+   }
+
+   TEST(Server, ProvidePortWriteLargerThanTransmitBufferIsSentToAllRequirers)
+   {
+      char const* provide_text = "APX/1.2\n"
+         "N\"ProvideNode\"\n"
+         "P\"Payload\"C[3000]\n";
+      char const* require_text1 = "APX/1.2\n"
+         "N\"RequireNode1\"\n"
+         "R\"Payload\"C[3000]\n";
+      char const* require_text2 = "APX/1.2\n"
+         "N\"RequireNode2\"\n"
+         "R\"Other\"C:=0\n"
+         "R\"Payload\"C[3000]\n";
+      Server server;
+      Client client1;
+      Client client2;
+      Client client3;
+      ASSERT_EQ(client1.build_node(provide_text), APX_NO_ERROR);
+      ASSERT_EQ(client2.build_node(require_text1), APX_NO_ERROR);
+      ASSERT_EQ(client3.build_node(require_text2), APX_NO_ERROR);
+      auto* socket1 = testsocket_new();
+      auto* socket2 = testsocket_new();
+      auto* socket3 = testsocket_new();
+      server.accept_test_socket(socket1);
+      server.accept_test_socket(socket2);
+      server.accept_test_socket(socket3);
+      client1.connect(socket1);
+      client2.connect(socket2);
+      client3.connect(socket3);
+      for (int i = 0; i < 5; i++)
+      {
+         client1.run();
+         client2.run();
+         client3.run();
+         server.run();
+      }
+      EXPECT_EQ(server.num_attached_nodes(), 3u);
+      std::vector<std::uint8_t> payload(3000u);
+      for (std::size_t i = 0u; i < payload.size(); i++)
+      {
+         payload[i] = static_cast<std::uint8_t>(i * 7u);
+      }
+      auto* provide_port = client1.get_port("ProvideNode", "Payload");
+      ASSERT_NE(provide_port, nullptr);
+      auto* provide_node = provide_port->node_instance();
+      ASSERT_EQ(provide_node->write_provide_port_data(provide_port->data_offset(), payload.data(), payload.size()), APX_NO_ERROR);
+      for (int i = 0; i < 5; i++)
+      {
+         client1.run();
+         server.run();
+         client2.run();
+         client3.run();
+      }
+      std::vector<std::uint8_t> received(payload.size());
+      auto* require_port = client2.get_port("RequireNode1", "Payload");
+      ASSERT_NE(require_port, nullptr);
+      EXPECT_EQ(require_port->node_instance()->get_node_data()->read_require_port_data(require_port->data_offset(), received.data(), received.size()), APX_NO_ERROR);
+      EXPECT_EQ(received, payload);
+      std::fill(received.begin(), received.end(), 0u);
+      require_port = client3.get_port("RequireNode2", "Payload");
+      ASSERT_NE(require_port, nullptr);
+      EXPECT_EQ(require_port->node_instance()->get_node_data()->read_require_port_data(require_port->data_offset(), received.data(), received.size()), APX_NO_ERROR);
+      EXPECT_EQ(received, payload);
+   }
+
+   TEST(Server, NodesAreDetachedWhenConnectionCloses)
+   {
+      Server server;
+      Client client1;
+      Client client2;
+      EXPECT_EQ(client1.build_node(provide_node_text), APX_NO_ERROR);
+      EXPECT_EQ(client2.build_node(require_node_text), APX_NO_ERROR);
+      auto* socket1 = testsocket_new();
+      auto* socket2 = testsocket_new();
+      server.accept_test_socket(socket1);
+      server.accept_test_socket(socket2);
+      client1.connect(socket1);
+      client2.connect(socket2);
+      run_all(server, client1, client2);
+      EXPECT_EQ(server.num_attached_nodes(), 2u);
+      testsocket_onDisconnect(socket1);
+      EXPECT_EQ(server.num_connections(), 1u);
+      EXPECT_EQ(server.num_attached_nodes(), 1u);
+      run_all(server, client1, client2);
+   }
+
+   TEST(Server, ReconnectingClientOnlySendsDataChangedWhileDisconnected)
+   {
+      Server server;
+      Client client1;
+      Client client2;
+      EXPECT_EQ(client1.build_node(provide_node_text), APX_NO_ERROR);
+      EXPECT_EQ(client2.build_node(require_node_text), APX_NO_ERROR);
+      auto* socket1 = testsocket_new();
+      auto* socket2 = testsocket_new();
+      server.accept_test_socket(socket1);
+      server.accept_test_socket(socket2);
+      client1.connect(socket1);
+      client2.connect(socket2);
+      run_all(server, client1, client2);
+      auto vehicle_speed = dtl::make_sv<std::uint32_t>(100u);
+      EXPECT_EQ(client1.write_port_value(client1.get_port("ProvideNode", "VehicleSpeed"), vehicle_speed), APX_NO_ERROR);
+      run_all(server, client1, client2);
+      EXPECT_EQ(read_u32(client2, "RequireNode", "VehicleSpeed"), 100u);
+      MetricsSnapshot first_connection;
+      client1.get_metrics(first_connection);
+      testsocket_onDisconnect(socket1);
+      EXPECT_EQ(server.num_attached_nodes(), 1u);
+      EXPECT_EQ(server.num_resume_entries(), 1u);
+      auto engine_speed = dtl::make_sv<std::uint32_t>(50u);
+      EXPECT_EQ(client1.write_port_value(client1.get_port("ProvideNode", "EngineSpeed"), engine_speed), APX_NO_ERROR);
+      auto* socket3 = testsocket_new();
+      server.accept_test_socket(socket3);
+      EXPECT_EQ(client1.reconnect(socket3), APX_NO_ERROR);
+      run_all(server, client1, client2);
+      EXPECT_EQ(server.num_attached_nodes(), 2u);
+      EXPECT_EQ(server.num_resume_entries(), 0u);
+      EXPECT_EQ(read_u32(client2, "RequireNode", "VehicleSpeed"), 100u);
+      EXPECT_EQ(read_u32(client2, "RequireNode", "EngineSpeed"), 50u);
+      MetricsSnapshot second_connection;
+      client1.get_metrics(second_connection);
+      //Neither the definition nor the unchanged VehicleSpeed value is sent again
+      std::uint64_t const resumed_bytes = second_connection.bytes_sent - first_connection.bytes_sent;
+      EXPECT_LT(resumed_bytes, first_connection.bytes_sent - std::strlen(provide_node_text));
+   }
+
+   TEST(Server, RestartedClientSendsAllProvidePortData)
+   {
+      Server server;
+      auto client1 = std::make_unique<Client>();
+      Client client2;
+      EXPECT_EQ(client1->build_node(provide_node_text), APX_NO_ERROR);
+      EXPECT_EQ(client2.build_node(require_node_text), APX_NO_ERROR);
+      auto* socket1 = testsocket_new();
+      auto* socket2 = testsocket_new();
+      server.accept_test_socket(socket1);
+      server.accept_test_socket(socket2);
+      client1->connect(socket1);
+      client2.connect(socket2);
+      run_all(server, *client1, client2);
+      auto vehicle_speed = dtl::make_sv<std::uint32_t>(100u);
+      EXPECT_EQ(client1->write_port_value(client1->get_port("ProvideNode", "VehicleSpeed"), vehicle_speed), APX_NO_ERROR);
+      run_all(server, *client1, client2);
+      EXPECT_EQ(read_u32(client2, "RequireNode", "VehicleSpeed"), 100u);
+      testsocket_onDisconnect(socket1);
+      EXPECT_EQ(server.num_resume_entries(), 1u);
+      client1 = std::make_unique<Client>();
+      EXPECT_EQ(client1->build_node(provide_node_text), APX_NO_ERROR);
+      auto* socket3 = testsocket_new();
+      server.accept_test_socket(socket3);
+      client1->connect(socket3);
+      run_all(server, *client1, client2);
+      EXPECT_EQ(server.num_attached_nodes(), 2u);
+      EXPECT_EQ(read_u32(client2, "RequireNode", "VehicleSpeed"), 255u);
+      EXPECT_EQ(read_u32(client2, "RequireNode", "EngineSpeed"), 255u);
+   }
+
+   static void attach_require_node(MockServerConnection& connection)
+   {
+      std::size_t const definition_size = std::strlen(require_node_text);
+      connection.accept_greeting();
+      ASSERT_EQ(connection.publish_remote_file(DEFINITION_ADDRESS_START, "RequireNode.apx", definition_size), APX_NO_ERROR);
+      ASSERT_EQ(connection.write_remote_data(DEFINITION_ADDRESS_START, reinterpret_cast<std::uint8_t const*>(require_node_text), definition_size), APX_NO_ERROR);
+      ASSERT_NE(connection.find_node("RequireNode"), nullptr);
+      ASSERT_EQ(connection.request_open_local_file("RequireNode.in"), APX_NO_ERROR);
+      connection.run();
+   }
+
+   TEST(ServerConnection, DefinitionLargerThanMaxFileSizeIsRejected)
+   {
+      MockServerConnection connection;
+      connection.accept_greeting();
+      std::size_t const definition_size = std::strlen(require_node_text);
+      EXPECT_EQ(connection.publish_remote_file(DEFINITION_ADDRESS_START, "RequireNode.apx", definition_size), APX_NO_ERROR);
+      EXPECT_EQ(connection.publish_remote_file(DEFINITION_ADDRESS_START + MAX_FILE_SIZE, "LargeNode.apx", MAX_FILE_SIZE + 1u), APX_FILE_TOO_LARGE_ERROR);
+   }
+
+   TEST(ServerConnection, RejectedWritesAreResentWhileRemoteFilesArePublished)
+   {
+      MockServerConnection connection;
+      attach_require_node(connection);
+      auto* node_instance = connection.find_node("RequireNode");
+      ASSERT_NE(node_instance, nullptr);
+      connection.get_file_manager()->set_transmit_high_water_mark(1u);
+      constexpr std::uint32_t num_nodes = 100u;
+      std::thread receive_thread{ [&connection]()
+         {
+            for (std::uint32_t i = 1u; i <= num_nodes; i++)
+            {
+               auto const file_name = "Node" + std::to_string(i) + ".apx";
+               EXPECT_EQ(connection.publish_remote_file(DEFINITION_ADDRESS_START + i * DEFINITION_ADDRESS_ALIGNMENT, file_name.c_str(), 100u), APX_NO_ERROR);
+            }
+         } };
+      for (std::uint8_t i = 0u; i < num_nodes; i++)
+      {
+         std::array<std::uint8_t, 2> const data{ i, i };
+         EXPECT_EQ(connection.write_require_port_data(node_instance, 0u, data.data(), data.size()), APX_NO_ERROR);
+         EXPECT_EQ(connection.write_require_port_data(node_instance, 0u, data.data(), data.size()), APX_QUEUE_FULL_ERROR);
+         connection.run(); //Sends the first write, then queues the rejected range again from the worker
+         connection.run();
+      }
+      receive_thread.join();
+      connection.run();
+      EXPECT_EQ(connection.get_file_manager()->get_worker_metrics().rejected_writes.get(), num_nodes);
+      EXPECT_EQ(connection.get_file_manager()->transmit_queued_bytes(), 0u);
+   }
+}
@@ -0,0 +1,37 @@
+#include "pch.h"
+#include <array>
+#include <cstring>
+#include "cpp-apx/shared_buffer.h"
+
+using namespace apx;
+
+namespace apx_test
+{
+   TEST(SharedBuffer, CreateCopiesData)
+   {
+      std::array<std::uint8_t, 4> data{ 1u, 2u, 3u, 4u };
+      auto* buffer = SharedBuffer::create(data.data(), data.size());
+      ASSERT_NE(buffer, nullptr);
+      data[0] = 0u;
+      EXPECT_EQ(buffer->size(), 4u);
+      EXPECT_EQ(buffer->data()[0], 1u);
+      EXPECT_EQ(buffer->data()[3], 4u);
+      EXPECT_EQ(buffer->use_count(), 1u);
+      buffer->release();
+   }
+
+   TEST(SharedBuffer, BufferIsKeptAliveUntilLastRelease)
+   {
+      std::array<std::uint8_t, 100> data;
+      data.fill(0x55u);
+      auto* buffer = SharedBuffer::create(data.data(), data.size());
+      buffer->acquire();
+      buffer->acquire();
+      EXPECT_EQ(buffer->use_count(), 3u);
+      buffer->release();
+      buffer->release();
+      EXPECT_EQ(buffer->use_count(), 1u);
+      EXPECT_EQ(std::memcmp(buffer->data(), data.data(), data.size()), 0);
+      buffer->release();
+   }
+}
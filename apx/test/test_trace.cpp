@@ -0,0 +1,102 @@
+#include "pch.h"
+#include <sstream>
+#include <string>
+#include <thread>
+#include "cpp-apx/trace.h"
+
+using namespace apx;
+
+namespace apx_test
+{
+   static std::size_t count_occurrences(std::string const& text, std::string const& pattern)
+   {
+      std::size_t count{ 0u };
+      for (auto pos = text.find(pattern); pos != std::string::npos; pos = text.find(pattern, pos + pattern.size()))
+      {
+         count++;
+      }
+      return count;
+   }
+
+   TEST(Trace, EventsAreWrittenAsCompleteEvents)
+   {
+      trace::clear();
+      auto const begin = trace::Clock::now();
+      trace::record("Test::operation", begin, begin + std::chrono::microseconds(5), 42u);
+      {
+         trace::Scope scope{ "Test::scope" };
+      }
+      std::ostringstream ss;
+      trace::write_chrome_trace(ss);
+      auto const json = ss.str();
+      EXPECT_EQ(json.rfind("{\"traceEvents\":[", 0), 0u);
+      EXPECT_NE(json.find("{\"name\":\"Test::operation\",\"cat\":\"apx\",\"ph\":\"X\",\"ts\":"), std::string::npos);
+      EXPECT_NE(json.find(",\"dur\":5.000,"), std::string::npos);
+      EXPECT_NE(json.find("\"args\":{\"value\":42}"), std::string::npos);
+      EXPECT_EQ(count_occurrences(json, "\"name\":\"Test::scope\""), 1u);
+      trace::clear();
+      std::ostringstream empty;
+      trace::write_chrome_trace(empty);
+      EXPECT_EQ(count_occurrences(empty.str(), "\"ph\":\"X\""), 0u);
+   }
+
+   TEST(Trace, EachThreadHasItsOwnBuffer)
+   {
+      trace::clear();
+      std::thread other([] {
+         trace::set_thread_name("OtherThread");
+         auto const now = trace::Clock::now();
+         trace::record("Test::other", now, now);
+         });
+      other.join();
+      auto const now = trace::Clock::now();
+      trace::record("Test::main", now, now);
+      std::ostringstream ss;
+      trace::write_chrome_trace(ss);
+      auto const json = ss.str();
+      EXPECT_EQ(count_occurrences(json, "\"name\":\"Test::other\""), 1u);
+      EXPECT_EQ(count_occurrences(json, "\"name\":\"Test::main\""), 1u);
+      EXPECT_NE(json.find("\"ph\":\"M\""), std::string::npos);
+      EXPECT_NE(json.find("\"args\":{\"name\":\"OtherThread\"}"), std::string::npos);
+   }
+
+   TEST(Trace, RingBufferKeepsNewestEvents)
+   {
+      trace::clear();
+      auto const now = trace::Clock::now();
+      trace::record("Test::oldest", now, now);
+      for (std::size_t i = 0u; i < trace::THREAD_BUFFER_CAPACITY; i++)
+      {
+         trace::record("Test::newer", now, now);
+      }
+      std::ostringstream ss;
+      trace::write_chrome_trace(ss);
+      auto const json = ss.str();
+      EXPECT_EQ(count_occurrences(json, "\"name\":\"Test::oldest\""), 0u);
+      EXPECT_EQ(count_occurrences(json, "\"name\":\"Test::newer\""), trace::THREAD_BUFFER_CAPACITY);
+      trace::clear();
+   }
+
+   TEST(Trace, OnlyTheNewestBuffersOfExitedThreadsAreKept)
+   {
+      trace::clear();
+      std::size_t const num_threads = trace::RETIRED_THREAD_BUFFERS_MAX * 2u;
+      for (std::size_t i = 0u; i < num_threads; i++)
+      {
+         std::thread other([] {
+            auto const now = trace::Clock::now();
+            trace::record("Test::exited", now, now);
+            });
+         other.join();
+      }
+      std::ostringstream ss;
+      trace::write_chrome_trace(ss);
+      EXPECT_EQ(count_occurrences(ss.str(), "\"name\":\"Test::exited\""), trace::RETIRED_THREAD_BUFFERS_MAX);
+      EXPECT_LE(trace::num_thread_buffers(), trace::RETIRED_THREAD_BUFFERS_MAX + 1u);
+      trace::clear();
+      EXPECT_LE(trace::num_thread_buffers(), 1u);
+      std::ostringstream empty;
+      trace::write_chrome_trace(empty);
+      EXPECT_EQ(count_occurrences(empty.str(), "\"name\":\"Test::exited\""), 0u);
+   }
+}
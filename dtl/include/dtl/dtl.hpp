@@ -1,13 +1,19 @@
 #pragma once
 
 #include <cstdint>
+#include <cstddef>
 #include <memory>
+#include <memory_resource>
+#include <type_traits>
 #include <variant>
 #include <optional>
 #include <string>
+#include <string_view>
 #include <vector>
 #include <unordered_map>
+#include <utility>
 #include <initializer_list>
+#include "dtl/small_vector.hpp"
 
 
 namespace dtl
@@ -16,15 +22,20 @@ namespace dtl
    class Scalar;
    class Array;
    class Hash;
+   class TypedArrayBase;
+   template <typename T> class TypedArray;
 
+   constexpr std::size_t SCALAR_INLINE_SIZE = 32u; //Strings and byte arrays up to this length are stored inside the Scalar
    using ByteArray = std::vector<std::uint8_t>;
+   using SmallByteArray = SmallVector<std::uint8_t, SCALAR_INLINE_SIZE>; //Storage type of byte array scalars
 
    enum class ValueType : uint8_t
    {
       NoneType,
       Scalar,
       Array,
-      Hash
+      Hash,
+      TypedArray
    };
 
    /* Value */
@@ -62,17 +73,18 @@ namespace dtl
    class Scalar : public dtl::Value
    {
    public:
+      using String = SmallVector<char, SCALAR_INLINE_SIZE>;
       using ScalarData = std::optional < std::variant <
          int32_t,             //storage id 0
          uint32_t,            //storage id 1
          int64_t,             //storage id 2
          uint64_t,            //storage id 3
          char,                //storage id 4
-         std::string,         //storage id 5
+         String,              //storage id 5
          bool,                //storage id 6
-         ByteArray            //storage id 7
+         SmallByteArray       //storage id 7
       > >;
-      Scalar() : Value{ dtl::ValueType::Scalar } {}
+      Scalar(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : Value{ dtl::ValueType::Scalar }, m_resource{ resource } {}
       ~Scalar() {}
       ScalarType sv_type() const;
       bool has_value() { return m_sv_data.has_value(); }
@@ -86,6 +98,7 @@ namespace dtl
       void set(const char* begin, const char* end);
       void set(bool value);
       void set(const ByteArray&value);
+      void set(const std::uint8_t* begin, const std::uint8_t* end);
       void set(char value);
       int32_t to_i32(bool& ok) const;
       uint32_t to_u32(bool& ok) const;
@@ -94,15 +107,19 @@ namespace dtl
       char to_char(bool& ok) const;
       std::string to_string(bool& ok) const;
       bool to_bool(bool& ok) const;
-      ByteArray const& get_byte_array() const;
+      ByteArray get_byte_array() const; //Returns a copy, use get_bytes() to read the stored bytes without copying
+      SmallByteArray const& get_bytes() const;
    protected:
       ScalarData m_sv_data;
+      std::pmr::memory_resource* m_resource; //Used for string and byte array storage
    };
 
    using ScalarValue = std::shared_ptr<Scalar>;
 
    std::shared_ptr<Scalar> make_sv();
-   template <typename T> ScalarValue make_sv(T value)
+   ScalarValue make_sv(std::pmr::memory_resource* resource);
+   template <typename T, std::enable_if_t<!std::is_convertible_v<T, std::pmr::memory_resource*>, int> = 0>
+   ScalarValue make_sv(T value)
    {
       auto sv = std::make_shared<Scalar>();
       sv->set(value);
@@ -122,49 +139,232 @@ namespace dtl
    class Array : public dtl::Value
    {
    public:
-      Array(std::size_t initial_length = 0u);
+      Array(std::size_t initial_length = 0u, std::pmr::memory_resource* resource = std::pmr::get_default_resource());
       std::size_t length() const { return m_av_data.size(); }
       void push(std::shared_ptr<dtl::Value> dv) { m_av_data.push_back(dv); }
+      void set(std::size_t pos, std::shared_ptr<dtl::Value> dv) { m_av_data.at(pos) = dv; }
+      void resize(std::size_t length) { m_av_data.resize(length); }
       DynamicValue at(std::size_t pos) { return m_av_data.at(pos); }
       DynamicValue const at(std::size_t pos) const { return m_av_data.at(pos); }
       dtl::Value const* const_get(std::size_t pos);
       bool is_empty() const { return m_av_data.empty(); }
    protected:
-      std::vector<std::shared_ptr<dtl::Value>> m_av_data;
+      std::pmr::vector<std::shared_ptr<dtl::Value>> m_av_data;
    };
 
    using ArrayValue = std::shared_ptr<dtl::Array>;
    ArrayValue make_av(std::size_t length = 0u);
+   ArrayValue make_av(std::size_t length, std::pmr::memory_resource* resource);
    ArrayValue make_av(std::initializer_list<DynamicValue> initializer);
    DynamicValue make_av_dv(std::initializer_list<DynamicValue> initializer);
 
+   /* TypedArray */
+
+   enum class ElementType : uint8_t
+   {
+      None,
+      UInt8,
+      UInt16,
+      UInt32,
+      UInt64,
+      Int8,
+      Int16,
+      Int32,
+      Int64,
+      Bool
+   };
+
+   template <typename T> struct element_type_of { static constexpr ElementType value = ElementType::None; };
+   template <> struct element_type_of<std::uint8_t> { static constexpr ElementType value = ElementType::UInt8; };
+   template <> struct element_type_of<std::uint16_t> { static constexpr ElementType value = ElementType::UInt16; };
+   template <> struct element_type_of<std::uint32_t> { static constexpr ElementType value = ElementType::UInt32; };
+   template <> struct element_type_of<std::uint64_t> { static constexpr ElementType value = ElementType::UInt64; };
+   template <> struct element_type_of<std::int8_t> { static constexpr ElementType value = ElementType::Int8; };
+   template <> struct element_type_of<std::int16_t> { static constexpr ElementType value = ElementType::Int16; };
+   template <> struct element_type_of<std::int32_t> { static constexpr ElementType value = ElementType::Int32; };
+   template <> struct element_type_of<std::int64_t> { static constexpr ElementType value = ElementType::Int64; };
+   template <> struct element_type_of<bool> { static constexpr ElementType value = ElementType::Bool; };
+
+   /*
+   * Array of integers (or bools) stored in one contiguous buffer instead of one Scalar object per element.
+   * Bool elements are stored as std::uint8_t (0 or 1) so that data() is available for every element type.
+   */
+   class TypedArrayBase : public dtl::Value
+   {
+   public:
+      TypedArrayBase(ElementType element_type) : Value{ dtl::ValueType::TypedArray }, m_element_type{ element_type } {}
+      ElementType element_type() const { return m_element_type; }
+      virtual std::size_t length() const = 0;
+      bool is_empty() const { return length() == 0u; }
+   protected:
+      ElementType m_element_type;
+   };
+
+   template <typename T> class TypedArray : public TypedArrayBase
+   {
+   public:
+      static_assert(element_type_of<T>::value != ElementType::None, "Element type must be a fixed-size integer or bool");
+      using value_type = T;
+      using storage_type = std::conditional_t<std::is_same_v<T, bool>, std::uint8_t, T>;
+      TypedArray(std::size_t initial_length = 0u, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) :
+         TypedArrayBase{ element_type_of<T>::value }, m_ta_data(initial_length, resource) {}
+      TypedArray(std::initializer_list<T> initializer) : TypedArrayBase{ element_type_of<T>::value }
+      {
+         m_ta_data.reserve(initializer.size());
+         for (auto value : initializer)
+         {
+            push(value);
+         }
+      }
+      std::size_t length() const override { return m_ta_data.size(); }
+      void resize(std::size_t length) { m_ta_data.resize(length); }
+      void reserve(std::size_t capacity) { m_ta_data.reserve(capacity); }
+      void clear() { m_ta_data.clear(); }
+      void push(T value) { m_ta_data.push_back(static_cast<storage_type>(value)); }
+      T at(std::size_t pos) const { return static_cast<T>(m_ta_data.at(pos)); }
+      void set(std::size_t pos, T value) { m_ta_data.at(pos) = static_cast<storage_type>(value); }
+      storage_type* data() { return m_ta_data.data(); }
+      storage_type const* data() const { return m_ta_data.data(); }
+   protected:
+      std::pmr::vector<storage_type> m_ta_data;
+   };
+
+   using TypedArrayValue = std::shared_ptr<dtl::TypedArrayBase>;
+
+   template <typename T> std::shared_ptr<TypedArray<T>> make_ta(std::size_t length = 0u)
+   {
+      return std::make_shared<TypedArray<T>>(length);
+   }
+
+   template <typename T> std::shared_ptr<TypedArray<T>> make_ta(std::initializer_list<T> initializer)
+   {
+      return std::make_shared<TypedArray<T>>(initializer);
+   }
+
+   template <typename T> std::shared_ptr<TypedArray<T>> make_ta(std::size_t length, std::pmr::memory_resource* resource)
+   {
+      return std::allocate_shared<TypedArray<T>>(std::pmr::polymorphic_allocator<TypedArray<T>>{ resource }, length, resource);
+   }
+
+   /*
+   * Calls visitor with the TypedArray<T> matching the element type of ta.
+   * Returns false if the element type is unknown.
+   */
+   template <typename Visitor> bool visit_ta(TypedArrayBase const* ta, Visitor&& visitor)
+   {
+      switch (ta->element_type())
+      {
+      case ElementType::UInt8:
+         visitor(static_cast<TypedArray<std::uint8_t> const&>(*ta));
+         break;
+      case ElementType::UInt16:
+         visitor(static_cast<TypedArray<std::uint16_t> const&>(*ta));
+         break;
+      case ElementType::UInt32:
+         visitor(static_cast<TypedArray<std::uint32_t> const&>(*ta));
+         break;
+      case ElementType::UInt64:
+         visitor(static_cast<TypedArray<std::uint64_t> const&>(*ta));
+         break;
+      case ElementType::Int8:
+         visitor(static_cast<TypedArray<std::int8_t> const&>(*ta));
+         break;
+      case ElementType::Int16:
+         visitor(static_cast<TypedArray<std::int16_t> const&>(*ta));
+         break;
+      case ElementType::Int32:
+         visitor(static_cast<TypedArray<std::int32_t> const&>(*ta));
+         break;
+      case ElementType::Int64:
+         visitor(static_cast<TypedArray<std::int64_t> const&>(*ta));
+         break;
+      case ElementType::Bool:
+         visitor(static_cast<TypedArray<bool> const&>(*ta));
+         break;
+      default:
+         return false;
+      }
+      return true;
+   }
+
    /* Hash*/
 
+   /*
+   * 32-bit FNV-1a hash of a Hash key.
+   * The result does not depend on platform or standard library so it can be precomputed and stored.
+   */
+   constexpr std::uint32_t key_hash(std::string_view key)
+   {
+      std::uint32_t hash = 2166136261u;
+      for (char c : key)
+      {
+         hash ^= static_cast<std::uint8_t>(c);
+         hash *= 16777619u;
+      }
+      return hash;
+   }
+
+   /*
+   * Hash key with precomputed key_hash. Lookups using a HashedKey skip hashing the key string.
+   */
+   struct HashedKey
+   {
+      std::string_view key;
+      std::uint32_t hash{ key_hash(std::string_view{}) };
+
+      constexpr HashedKey() = default;
+      constexpr explicit HashedKey(std::string_view key_arg) : key{ key_arg }, hash{ key_hash(key_arg) } {}
+      constexpr HashedKey(std::string_view key_arg, std::uint32_t hash_arg) : key{ key_arg }, hash{ hash_arg } {}
+   };
+
+   /*
+   * Keys are stored in insertion order in a flat vector, which is what APX records need:
+   * few fields, always added in the same order. Iteration follows insertion order.
+   * Small hashes are looked up by scanning the stored key hashes, starting from an optional position hint.
+   * Once a hash reaches INDEX_MIN_SIZE entries it also maintains an index from key hash to position.
+   * API change: iterators yield Entry, whose key is a std::pmr::string allocated from the hash's memory resource.
+   * Earlier versions yielded std::string keys, so "std::string const& key = it->first" no longer compiles.
+   * Bind keys as std::string_view, or copy them with std::string{ it->first }.
+   */
    class Hash : public dtl::Value
    {
    public:
       using value_type = std::pair<std::string, DynamicValue>;
-      Hash();
-      std::size_t length() { return m_hv_data.size(); }
+      using Entry = std::pair<std::pmr::string const, DynamicValue>;
+      using Entries = std::pmr::vector<Entry>;
+      static constexpr std::size_t npos = static_cast<std::size_t>(-1);
+      static constexpr std::size_t INDEX_MIN_SIZE = 16u;
+      Hash(std::pmr::memory_resource* resource = std::pmr::get_default_resource());
+      std::size_t length() { return m_entries.size(); }
+      void reserve(std::size_t capacity);
       void insert(value_type& v);
       void insert(value_type&& v);
-      void set(std::string const& key, DynamicValue value);
-      DynamicValue at(std::string const& key) { return m_hv_data.at(key); }
-      dtl::Value const* const_get(std::string const& key) const;
-      dtl::Value const* const_get(char const* key) const;
+      void set(std::string_view key, DynamicValue value) { set(HashedKey{ key }, std::move(value)); }
+      void set(HashedKey const& key, DynamicValue value, std::size_t hint = 0u);
+      DynamicValue at(std::string const& key);
+      DynamicValue get(std::string_view key) const { return get(HashedKey{ key }); } //Returns nullptr when key is missing
+      DynamicValue get(HashedKey const& key, std::size_t hint = 0u) const;
+      dtl::Value const* const_get(std::string_view key) const { return const_get(HashedKey{ key }); }
+      dtl::Value const* const_get(HashedKey const& key) const;
+      std::size_t find(HashedKey const& key, std::size_t hint = 0u) const; //Returns npos when key is missing
 
-      bool is_empty() const { return m_hv_data.empty(); }
-      std::unordered_map<std::string, DynamicValue>::iterator begin() { return m_hv_data.begin(); }
-      std::unordered_map<std::string, DynamicValue>::const_iterator cbegin() { return m_hv_data.cbegin(); }
-      std::unordered_map<std::string, DynamicValue>::iterator end() { return m_hv_data.end(); }
-      std::unordered_map<std::string, DynamicValue>::const_iterator cend() { return m_hv_data.end(); }
+      bool is_empty() const { return m_entries.empty(); }
+      Entries::iterator begin() { return m_entries.begin(); }
+      Entries::const_iterator cbegin() { return m_entries.cbegin(); }
+      Entries::iterator end() { return m_entries.end(); }
+      Entries::const_iterator cend() { return m_entries.end(); }
 
    protected:
-      std::unordered_map<std::string, DynamicValue> m_hv_data;
+      Entries m_entries;
+      std::pmr::vector<std::uint32_t> m_hashes; //m_hashes[i] is key_hash of m_entries[i].first
+      std::pmr::unordered_multimap<std::uint32_t, std::size_t> m_index; //Empty until the hash reaches INDEX_MIN_SIZE entries
+      void emplace_back(std::string_view key, std::uint32_t hash, DynamicValue value);
+      std::size_t find_in_index(HashedKey const& key) const;
    };
 
    using HashValue = std::shared_ptr<dtl::Hash>;
    HashValue make_hv();
+   HashValue make_hv(std::pmr::memory_resource* resource);
    HashValue make_hv(std::initializer_list<std::pair<std::string, DynamicValue>> initializer);
    DynamicValue make_hv_dv(std::initializer_list<std::pair<std::string, DynamicValue>> initializer);
 
@@ -185,6 +385,21 @@ namespace dtl
       return std::dynamic_pointer_cast<Hash>(dv);
    }
 
+   inline TypedArrayValue ta_cast(DynamicValue const& dv)
+   {
+      return std::dynamic_pointer_cast<TypedArrayBase>(dv);
+   }
+
+   template <typename T> std::shared_ptr<TypedArray<T>> ta_cast(DynamicValue const& dv)
+   {
+      return std::dynamic_pointer_cast<TypedArray<T>>(dv);
+   }
+
+   template <typename T> std::shared_ptr<TypedArray<T>> ta_cast(TypedArrayValue const& ta)
+   {
+      return std::dynamic_pointer_cast<TypedArray<T>>(ta);
+   }
+
    inline DynamicValue dv_cast(ScalarValue const& sv)
    {
       return std::dynamic_pointer_cast<Value>(sv);
@@ -200,4 +415,9 @@ namespace dtl
       return std::dynamic_pointer_cast<Value>(hv);
    }
 
+   inline DynamicValue dv_cast(TypedArrayValue const& ta)
+   {
+      return std::dynamic_pointer_cast<Value>(ta);
+   }
+
 }
\ No newline at end of file
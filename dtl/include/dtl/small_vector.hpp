@@ -0,0 +1,174 @@
+#pragma once
+
+#include <cstddef>
+#include <cstring>
+#include <initializer_list>
+#include <memory_resource>
+#include <type_traits>
+
+namespace dtl
+{
+   /*
+   * Vector of trivially copyable elements which stores up to N elements inside the object itself.
+   * Longer contents are allocated from the memory resource given at construction.
+   * Capacity is kept when contents shrink so that repeated assignments of similar size never allocate.
+   * Copies use the default memory resource, moves keep the resource of the source (same as std::pmr containers).
+   */
+   template <typename T, std::size_t N>
+   class SmallVector
+   {
+      static_assert(std::is_trivially_copyable_v<T>, "SmallVector only supports trivially copyable elements");
+   public:
+      using value_type = T;
+      using size_type = std::size_t;
+      using iterator = T*;
+      using const_iterator = T const*;
+      static constexpr std::size_t inline_capacity = N;
+
+      SmallVector(std::pmr::memory_resource* resource = std::pmr::get_default_resource()) noexcept : m_resource{ resource } {}
+      explicit SmallVector(std::size_t count, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : m_resource{ resource } { resize(count); }
+      SmallVector(std::initializer_list<T> init, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : m_resource{ resource } { assign(init.begin(), init.end()); }
+      SmallVector(T const* first, T const* last, std::pmr::memory_resource* resource = std::pmr::get_default_resource()) : m_resource{ resource } { assign(first, last); }
+      SmallVector(SmallVector const& other) : m_resource{ std::pmr::get_default_resource() } { assign(other.begin(), other.end()); }
+      SmallVector(SmallVector&& other) noexcept : m_resource{ other.m_resource } { take(other); }
+      ~SmallVector() { release(); }
+
+      SmallVector& operator=(SmallVector const& other)
+      {
+         if (this != &other)
+         {
+            assign(other.begin(), other.end());
+         }
+         return *this;
+      }
+
+      SmallVector& operator=(SmallVector&& other) noexcept
+      {
+         if (this != &other)
+         {
+            if (*m_resource == *other.m_resource)
+            {
+               release();
+               take(other);
+            }
+            else
+            {
+               assign(other.begin(), other.end());
+            }
+         }
+         return *this;
+      }
+
+      T* data() { return (m_heap != nullptr) ? m_heap : m_inline; }
+      T const* data() const { return (m_heap != nullptr) ? m_heap : m_inline; }
+      std::size_t size() const { return m_size; }
+      std::size_t capacity() const { return m_capacity; }
+      bool empty() const { return m_size == 0u; }
+      bool is_inline() const { return m_heap == nullptr; }
+      iterator begin() { return data(); }
+      iterator end() { return data() + m_size; }
+      const_iterator begin() const { return data(); }
+      const_iterator end() const { return data() + m_size; }
+      const_iterator cbegin() const { return data(); }
+      const_iterator cend() const { return data() + m_size; }
+      T& operator[](std::size_t pos) { return data()[pos]; }
+      T const& operator[](std::size_t pos) const { return data()[pos]; }
+      std::pmr::memory_resource* resource() const { return m_resource; }
+
+      void clear() { m_size = 0u; }
+
+      void reserve(std::size_t new_capacity)
+      {
+         if (new_capacity > m_capacity)
+         {
+            auto* new_heap = static_cast<T*>(m_resource->allocate(new_capacity * sizeof(T), alignof(T)));
+            if (m_size > 0u)
+            {
+               std::memcpy(new_heap, data(), m_size * sizeof(T));
+            }
+            release();
+            m_heap = new_heap;
+            m_capacity = new_capacity;
+         }
+      }
+
+      void resize(std::size_t new_size)
+      {
+         if (new_size > m_size)
+         {
+            grow_to(new_size);
+            std::memset(static_cast<void*>(data() + m_size), 0, (new_size - m_size) * sizeof(T));
+         }
+         m_size = new_size;
+      }
+
+      void assign(T const* first, T const* last)
+      {
+         std::size_t const count = static_cast<std::size_t>(last - first);
+         if (count > m_capacity)
+         {
+            m_size = 0u; //Nothing to preserve
+            grow_to(count);
+         }
+         if (count > 0u)
+         {
+            std::memmove(static_cast<void*>(data()), first, count * sizeof(T));
+         }
+         m_size = count;
+      }
+
+      void push_back(T value)
+      {
+         grow_to(m_size + 1u);
+         data()[m_size++] = value;
+      }
+
+      friend bool operator==(SmallVector const& lhs, SmallVector const& rhs)
+      {
+         return (lhs.m_size == rhs.m_size) && ((lhs.m_size == 0u) || (std::memcmp(lhs.data(), rhs.data(), lhs.m_size * sizeof(T)) == 0));
+      }
+
+   protected:
+      std::pmr::memory_resource* m_resource;
+      T* m_heap{ nullptr };
+      std::size_t m_size{ 0u };
+      std::size_t m_capacity{ N };
+      T m_inline[N];
+
+      void grow_to(std::size_t min_capacity)
+      {
+         if (min_capacity > m_capacity)
+         {
+            reserve((min_capacity > 2u * m_capacity) ? min_capacity : 2u * m_capacity);
+         }
+      }
+
+      void release()
+      {
+         if (m_heap != nullptr)
+         {
+            m_resource->deallocate(m_heap, m_capacity * sizeof(T), alignof(T));
+            m_heap = nullptr;
+            m_capacity = N;
+         }
+      }
+
+      void take(SmallVector& other)
+      {
+         m_resource = other.m_resource;
+         m_size = other.m_size;
+         if (other.m_heap != nullptr)
+         {
+            m_heap = other.m_heap;
+            m_capacity = other.m_capacity;
+            other.m_heap = nullptr;
+            other.m_capacity = N;
+         }
+         else if (m_size > 0u)
+         {
+            std::memcpy(m_inline, other.m_inline, m_size * sizeof(T));
+         }
+         other.m_size = 0u;
+      }
+   };
+}
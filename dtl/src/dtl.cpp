@@ -3,6 +3,8 @@
 #include <algorithm>
 #include <typeinfo>
 #include <climits>
+#include <cstring>
+#include <tuple>
 #include "dtl/dtl.hpp"
 
 namespace dtl
@@ -29,6 +31,16 @@ namespace dtl
          });
    }
 
+   static std::string_view to_string_view(Scalar::String const& str)
+   {
+      return std::string_view{ str.data(), str.size() };
+   }
+
+   static std::string to_std_string(Scalar::String const& str)
+   {
+      return std::string{ str.data(), str.size() };
+   }
+
    ScalarType Scalar::sv_type() const
    {
       dtl::ScalarType retval{ dtl::ScalarType::None };
@@ -94,18 +106,24 @@ namespace dtl
 
    void Scalar::set(const std::string& value)
    {
-      m_sv_data = value;
+      set(value.data(), value.data() + value.size());
    }
 
    void Scalar::set(const char* value)
    {
-      m_sv_data = std::string{ value };
+      set(value, value + std::strlen(value));
    }
 
    void Scalar::set(const char* begin, const char* end)
    {
-      std::size_t count = std::distance(begin, end);
-      m_sv_data = std::string{ begin, count };
+      if (m_sv_data.has_value() && (m_sv_data.value().index() == STR_STORAGE_ID))
+      {
+         std::get<String>(m_sv_data.value()).assign(begin, end); //Reuses previous string capacity
+      }
+      else
+      {
+         m_sv_data.emplace(std::in_place_type<String>, begin, end, m_resource);
+      }
    }
 
    void Scalar::set(bool value)
@@ -115,9 +133,17 @@ namespace dtl
 
    void Scalar::set(const ByteArray& value)
    {
-       m_sv_data = ByteArray();
-       auto& tmp = std::get<ByteArray>(m_sv_data.value());
-       tmp.assign(value.begin(), value.end());
+      set(value.data(), value.data() + value.size());
+   }
+
+   void Scalar::set(const std::uint8_t* begin, const std::uint8_t* end)
+   {
+      if (!m_sv_data.has_value() || (m_sv_data.value().index() != BYTEARRAY_STORAGE_ID))
+      {
+         m_sv_data.emplace(std::in_place_type<SmallByteArray>, m_resource);
+      }
+      auto& tmp = std::get<SmallByteArray>(m_sv_data.value());
+      tmp.assign(begin, end); //Reuses previous array capacity
    }
 
    void Scalar::set(char value)
@@ -174,7 +200,7 @@ namespace dtl
          case STR_STORAGE_ID:
             try
             {
-               retval = static_cast<std::int32_t>(std::stol(std::get<std::string>(m_sv_data.value())));
+               retval = static_cast<std::int32_t>(std::stol(to_std_string(std::get<String>(m_sv_data.value()))));
                ok = true;
             }
             catch (std::invalid_argument)
@@ -251,7 +277,7 @@ namespace dtl
          case STR_STORAGE_ID:
             try
             {
-               retval = static_cast<uint32_t>(std::stoul(std::get<std::string>(m_sv_data.value())));
+               retval = static_cast<uint32_t>(std::stoul(to_std_string(std::get<String>(m_sv_data.value()))));
                ok = true;
             }
             catch (std::invalid_argument)
@@ -315,7 +341,7 @@ namespace dtl
          case STR_STORAGE_ID:
             try
             {
-               retval = static_cast<int64_t>(std::stoll(std::get<std::string>(m_sv_data.value())));
+               retval = static_cast<int64_t>(std::stoll(to_std_string(std::get<String>(m_sv_data.value()))));
                ok = true;
             }
             catch (std::invalid_argument)
@@ -391,7 +417,7 @@ namespace dtl
          case STR_STORAGE_ID:
             try
             {
-               retval = static_cast<uint64_t>(std::stoull(std::get<std::string>(m_sv_data.value())));
+               retval = static_cast<uint64_t>(std::stoull(to_std_string(std::get<String>(m_sv_data.value()))));
                ok = true;
             }
             catch (std::invalid_argument)
@@ -472,7 +498,7 @@ namespace dtl
             break;
          case STR_STORAGE_ID:
          {
-            std::string value = std::get<std::string>(m_sv_data.value());
+            std::string_view value = to_string_view(std::get<String>(m_sv_data.value()));
             if ( (value.size() == 1u) )
             {
                retval = value[0];
@@ -517,7 +543,7 @@ namespace dtl
             retval = std::to_string(std::get<uint64_t>(m_sv_data.value()));
             break;
          case STR_STORAGE_ID:
-            retval = std::get<std::string>(m_sv_data.value());
+            retval = to_std_string(std::get<String>(m_sv_data.value()));
             break;
          case BOOL_STORAGE_ID:
             retval = std::get<bool>(m_sv_data.value()) ? std::string("true") : std::string("false");
@@ -559,7 +585,7 @@ namespace dtl
             retval = std::get<uint64_t>(m_sv_data.value()) == 0 ? false : true;
             break;
          case STR_STORAGE_ID:
-            tmp = std::get<std::string>(m_sv_data.value());
+            tmp = to_std_string(std::get<String>(m_sv_data.value()));
             if (string_iequals(tmp, true_string))
             {
                retval = true;
@@ -590,13 +616,19 @@ namespace dtl
       return retval;
    }
 
-   dtl::ByteArray const & Scalar::get_byte_array() const
+   dtl::ByteArray Scalar::get_byte_array() const
+   {
+      auto const& bytes = get_bytes();
+      return dtl::ByteArray(bytes.data(), bytes.data() + bytes.size());
+   }
+
+   dtl::SmallByteArray const& Scalar::get_bytes() const
    {
       if (!m_sv_data.has_value() || (m_sv_data.value().index() != BYTEARRAY_STORAGE_ID) )
       {
          throw std::bad_typeid();
       }
-      return std::get<dtl::ByteArray>(m_sv_data.value());
+      return std::get<dtl::SmallByteArray>(m_sv_data.value());
    }
 
    DynamicValue make_dv()
@@ -609,6 +641,11 @@ namespace dtl
       return std::make_shared<Scalar>();
    }
 
+   ScalarValue make_sv(std::pmr::memory_resource* resource)
+   {
+      return std::allocate_shared<Scalar>(std::pmr::polymorphic_allocator<Scalar>{ resource }, resource);
+   }
+
    ScalarValue make_sv(const char* begin, const char* end)
    {
       auto sv = std::make_shared<Scalar>();
@@ -616,7 +653,7 @@ namespace dtl
       return sv;
    }
 
-   Array::Array(std::size_t initial_length) :dtl::Value(ValueType::Array)
+   Array::Array(std::size_t initial_length, std::pmr::memory_resource* resource) :dtl::Value(ValueType::Array), m_av_data(resource)
    {
       if (initial_length > 0u)
       {
@@ -638,6 +675,11 @@ namespace dtl
       return std::make_shared<Array>(length);
    }
 
+   ArrayValue make_av(std::size_t length, std::pmr::memory_resource* resource)
+   {
+      return std::allocate_shared<Array>(std::pmr::polymorphic_allocator<Array>{ resource }, length, resource);
+   }
+
    ArrayValue make_av(std::initializer_list<DynamicValue> initializer)
    {
       auto av = std::make_shared<Array>();
@@ -654,43 +696,140 @@ namespace dtl
       return dv_cast(av);
    }
 
-   Hash::Hash() : dtl::Value(ValueType::Hash)
+   Hash::Hash(std::pmr::memory_resource* resource) : dtl::Value(ValueType::Hash), m_entries(resource), m_hashes(resource), m_index(resource)
    {
    }
 
+   void Hash::reserve(std::size_t capacity)
+   {
+      m_entries.reserve(capacity);
+      m_hashes.reserve(capacity);
+      if (capacity >= INDEX_MIN_SIZE)
+      {
+         m_index.reserve(capacity);
+      }
+   }
+
    void Hash::insert(value_type& v)
    {
-      m_hv_data.insert(v);
+      HashedKey const key{ v.first };
+      if (find(key) == npos)
+      {
+         emplace_back(key.key, key.hash, v.second);
+      }
    }
 
    void Hash::insert(value_type&& v)
    {
-      m_hv_data.insert(v);
+      HashedKey const key{ v.first };
+      if (find(key) == npos)
+      {
+         emplace_back(key.key, key.hash, std::move(v.second));
+      }
    }
 
-   void Hash::set(std::string const& key, DynamicValue value)
+   DynamicValue Hash::at(std::string const& key)
    {
-      insert(std::make_pair(key, value));
+      auto const pos = find(HashedKey{ key });
+      if (pos == npos)
+      {
+         throw std::out_of_range("dtl::Hash::at");
+      }
+      return m_entries[pos].second;
    }
 
-   dtl::Value const* Hash::const_get(std::string const& key) const
+   void Hash::set(HashedKey const& key, DynamicValue value, std::size_t hint)
    {
-      auto it = m_hv_data.find(key);
-      if (it != m_hv_data.end())
+      auto const pos = find(key, hint);
+      if (pos != npos)
       {
-         return it->second.get();
+         m_entries[pos].second = std::move(value);
       }
-      return nullptr;
+      else
+      {
+         emplace_back(key.key, key.hash, std::move(value));
+      }
+   }
+
+   DynamicValue Hash::get(HashedKey const& key, std::size_t hint) const
+   {
+      auto const pos = find(key, hint);
+      return (pos != npos) ? m_entries[pos].second : nullptr;
+   }
+
+   dtl::Value const* Hash::const_get(HashedKey const& key) const
+   {
+      auto const pos = find(key);
+      return (pos != npos) ? m_entries[pos].second.get() : nullptr;
    }
 
-   dtl::Value const* Hash::const_get(char const* key) const
+   /*
+   * Checks the hinted position first. Small hashes are then scanned from hint to the end and from the start to hint,
+   * larger ones use the index.
+   * Passing the expected position (such as the field index of a record) usually finds the key on the first compare.
+   */
+   std::size_t Hash::find(HashedKey const& key, std::size_t hint) const
    {
-      auto it = m_hv_data.find(key);
-      if (it != m_hv_data.end())
+      std::size_t const size = m_hashes.size();
+      if (hint > size)
       {
-         return it->second.get();
+         hint = size;
+      }
+      if (!m_index.empty())
+      {
+         if ((hint < size) && (m_hashes[hint] == key.hash) && (m_entries[hint].first == key.key))
+         {
+            return hint;
+         }
+         return find_in_index(key);
+      }
+      for (std::size_t i = hint; i < size; i++)
+      {
+         if ((m_hashes[i] == key.hash) && (m_entries[i].first == key.key))
+         {
+            return i;
+         }
+      }
+      for (std::size_t i = 0u; i < hint; i++)
+      {
+         if ((m_hashes[i] == key.hash) && (m_entries[i].first == key.key))
+         {
+            return i;
+         }
+      }
+      return npos;
+   }
+
+   std::size_t Hash::find_in_index(HashedKey const& key) const
+   {
+      auto const [first, last] = m_index.equal_range(key.hash);
+      for (auto it = first; it != last; ++it)
+      {
+         if (m_entries[it->second].first == key.key)
+         {
+            return it->second;
+         }
+      }
+      return npos;
+   }
+
+   void Hash::emplace_back(std::string_view key, std::uint32_t hash, DynamicValue value)
+   {
+      m_entries.emplace_back(std::piecewise_construct, std::forward_as_tuple(key), std::forward_as_tuple(std::move(value)));
+      m_hashes.push_back(hash);
+      std::size_t const size = m_hashes.size();
+      if (size == INDEX_MIN_SIZE)
+      {
+         m_index.reserve(size);
+         for (std::size_t i = 0u; i < size; i++)
+         {
+            m_index.emplace(m_hashes[i], i);
+         }
+      }
+      else if (size > INDEX_MIN_SIZE)
+      {
+         m_index.emplace(hash, size - 1u);
       }
-      return nullptr;
    }
 
    std::shared_ptr<Hash> make_hv()
@@ -698,6 +837,11 @@ namespace dtl
       return std::make_shared<Hash>();
    }
 
+   HashValue make_hv(std::pmr::memory_resource* resource)
+   {
+      return std::allocate_shared<Hash>(std::pmr::polymorphic_allocator<Hash>{ resource }, resource);
+   }
+
    HashValue make_hv(std::initializer_list<std::pair<std::string, DynamicValue>> initializer)
    {
       auto hv = std::make_shared<Hash>();
@@ -1,5 +1,9 @@
 #include "pch.h"
+#include <array>
 #include <iostream>
+#include <memory_resource>
+#include <string>
+#include <type_traits>
 #include "dtl/dtl.hpp"
 
 using namespace std;
@@ -46,4 +50,117 @@ namespace dtl
       EXPECT_EQ(sv->to_u32(ok), (uint32_t)20u);
       EXPECT_TRUE(ok);
    }
+
+   TEST(HashTest, SetOverwritesExistingKey)
+   {
+      auto ok = false;
+      auto hv = dtl::make_hv();
+      hv->set("First", dtl::make_sv<std::uint32_t>(1u));
+      hv->set("First", dtl::make_sv<std::uint32_t>(2u));
+      EXPECT_EQ(hv->length(), 1);
+      auto sv = dtl::sv_cast(hv->get("First"s));
+      ASSERT_TRUE(sv);
+      EXPECT_EQ(sv->to_u32(ok), (uint32_t)2u);
+      EXPECT_TRUE(ok);
+      EXPECT_EQ(hv->get("Second"s), nullptr);
+   }
+
+   TEST(HashTest, LookupUsingPrehashedKey)
+   {
+      auto ok = false;
+      constexpr dtl::HashedKey first_key{ "First", dtl::key_hash("First") };
+      static_assert(dtl::key_hash("First") == 0xEE3D49E1u); //FNV-1a, must not vary between platforms
+      auto hv = dtl::make_hv();
+      hv->set(first_key, dtl::make_sv<std::uint32_t>(1u));
+      auto sv = dtl::sv_cast(hv->get("First"));
+      ASSERT_TRUE(sv);
+      EXPECT_EQ(sv->to_u32(ok), (uint32_t)1u);
+      EXPECT_TRUE(ok);
+      EXPECT_EQ(hv->const_get(first_key), sv.get());
+      EXPECT_EQ(hv->get(dtl::HashedKey{ "Second" }), nullptr);
+   }
+
+   TEST(HashTest, IterateInInsertionOrder)
+   {
+      auto hv = dtl::make_hv({ {"Third", dtl::make_sv<std::uint32_t>(3u)}, {"First", dtl::make_sv<std::uint32_t>(1u)} });
+      hv->set("Second", dtl::make_sv<std::uint32_t>(2u));
+      hv->set("Third", dtl::make_sv<std::uint32_t>(0u));
+      std::vector<std::string> keys;
+      for (auto const& [key, value] : *hv)
+      {
+         keys.emplace_back(key);
+      }
+      EXPECT_EQ(keys, (std::vector<std::string>{ "Third", "First", "Second" }));
+   }
+
+   TEST(HashTest, FindUsingPositionHint)
+   {
+      auto hv = dtl::make_hv({ {"First", dtl::make_sv<std::uint32_t>(1u)}, {"Second", dtl::make_sv<std::uint32_t>(2u)} });
+      EXPECT_EQ(hv->find(dtl::HashedKey{ "Second" }, 1u), 1u);
+      EXPECT_EQ(hv->find(dtl::HashedKey{ "First" }, 1u), 0u);
+      EXPECT_EQ(hv->find(dtl::HashedKey{ "First" }, 5u), 0u);
+      EXPECT_EQ(hv->find(dtl::HashedKey{ "Third" }, 1u), dtl::Hash::npos);
+   }
+
+   TEST(HashTest, LookupInHashLargerThanIndexThreshold)
+   {
+      auto ok = false;
+      auto hv = dtl::make_hv();
+      std::size_t const size = dtl::Hash::INDEX_MIN_SIZE * 4u;
+      for (std::size_t i = 0u; i < size; i++)
+      {
+         hv->set("Key" + std::to_string(i), dtl::make_sv<std::uint32_t>(static_cast<std::uint32_t>(i)));
+      }
+      hv->set("Key3", dtl::make_sv<std::uint32_t>(1000u));
+      EXPECT_EQ(hv->length(), size);
+      for (std::size_t i = 0u; i < size; i++)
+      {
+         EXPECT_EQ(hv->find(dtl::HashedKey{ "Key" + std::to_string(i) }), i);
+         EXPECT_EQ(hv->find(dtl::HashedKey{ "Key" + std::to_string(i) }, size - 1u - i), i);
+      }
+      EXPECT_EQ(hv->find(dtl::HashedKey{ "Key" + std::to_string(size) }), dtl::Hash::npos);
+      auto sv = dtl::sv_cast(hv->get("Key3"));
+      ASSERT_TRUE(sv);
+      EXPECT_EQ(sv->to_u32(ok), 1000u);
+      EXPECT_TRUE(ok);
+      std::size_t i = 0u;
+      for (auto const& [key, value] : *hv)
+      {
+         EXPECT_EQ(std::string_view{ key }, "Key" + std::to_string(i++));
+      }
+   }
+
+   TEST(HashTest, IteratorKeysAreConst)
+   {
+      auto hv = dtl::make_hv({ {"First", dtl::make_sv<std::uint32_t>(1u)} });
+      static_assert(std::is_const_v<std::remove_reference_t<decltype(hv->begin()->first)>>);
+      hv->begin()->second = dtl::make_sv<std::uint32_t>(2u);
+      auto ok = false;
+      EXPECT_EQ(dtl::sv_cast(hv->get("First"))->to_u32(ok), 2u);
+   }
+
+   TEST(HashTest, IteratorKeysBindAsStringView)
+   {
+      auto hv = dtl::make_hv({ {"First", dtl::make_sv<std::uint32_t>(1u)} });
+      std::string_view const key = hv->begin()->first;
+      std::string const copy{ hv->begin()->first };
+      EXPECT_EQ(key, "First"sv);
+      EXPECT_EQ(copy, "First"s);
+   }
+
+   TEST(HashTest, CreateHashUsingMemoryResource)
+   {
+      std::array<std::byte, 2048> buffer;
+      std::pmr::monotonic_buffer_resource resource{ buffer.data(), buffer.size(), std::pmr::null_memory_resource() };
+      auto ok = false;
+      auto hv = dtl::make_hv(&resource);
+      hv->set("AFieldNameLongerThanSmallStringBuffer", dtl::make_sv(&resource));
+      auto sv = dtl::sv_cast(hv->get("AFieldNameLongerThanSmallStringBuffer"s));
+      ASSERT_TRUE(sv);
+      sv->set("A string value longer than the small string buffer");
+      EXPECT_EQ(sv->to_string(ok), "A string value longer than the small string buffer"s);
+      EXPECT_TRUE(ok);
+      auto const* p = reinterpret_cast<std::byte const*>(sv.get());
+      EXPECT_TRUE((p >= buffer.data()) && (p < buffer.data() + buffer.size()));
+   }
 }
\ No newline at end of file
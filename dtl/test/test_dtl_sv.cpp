@@ -1,4 +1,6 @@
 #include "pch.h"
+#include <array>
+#include <vector>
 #include <iostream>
 #include "dtl/dtl.hpp"
 
@@ -217,6 +219,36 @@ namespace dtl
       EXPECT_EQ(tmp, data);
    }
 
+   TEST(ScalarTest, ShortStringsAndByteArraysAreStoredInline)
+   {
+      auto ok = false;
+      dtl::Scalar sv{ std::pmr::null_memory_resource() }; //Any allocation throws std::bad_alloc
+      std::string const text(dtl::SCALAR_INLINE_SIZE, 'a');
+      sv.set(text);
+      EXPECT_EQ(sv.to_string(ok), text);
+      EXPECT_TRUE(ok);
+      std::array<std::uint8_t, 8> const bytes{ 1u, 2u, 3u, 4u, 5u, 6u, 7u, 8u };
+      sv.set(bytes.data(), bytes.data() + bytes.size());
+      EXPECT_TRUE(sv.get_bytes().is_inline());
+      EXPECT_EQ(sv.get_byte_array(), dtl::ByteArray(bytes.data(), bytes.data() + bytes.size()));
+      EXPECT_THROW(sv.set(std::string(dtl::SCALAR_INLINE_SIZE + 1u, 'b')), std::bad_alloc);
+   }
+
+   TEST(ScalarTest, LongByteArrayKeepsCapacity)
+   {
+      std::vector<std::uint8_t> long_data(dtl::SCALAR_INLINE_SIZE * 2u, 0x55u);
+      dtl::SmallByteArray data{ long_data.data(), long_data.data() + long_data.size() };
+      EXPECT_FALSE(data.is_inline());
+      auto const capacity = data.capacity();
+      data.assign(long_data.data(), long_data.data() + 3u);
+      EXPECT_EQ(data.size(), 3u);
+      EXPECT_EQ(data.capacity(), capacity);
+      dtl::SmallByteArray moved{ std::move(data) };
+      EXPECT_EQ(moved.size(), 3u);
+      EXPECT_EQ(moved[2], 0x55u);
+      EXPECT_TRUE(data.empty());
+   }
+
    TEST(ScalarTest, CreateCharValue)
    {
       auto sv = dtl::make_sv<char>('b');
@@ -0,0 +1,77 @@
+#include "pch.h"
+#include <iostream>
+#include "dtl/dtl.hpp"
+
+using namespace std;
+
+namespace dtl
+{
+   TEST(TypedArrayTest, CreateEmptyArray)
+   {
+      auto ta = dtl::make_ta<std::uint16_t>();
+      EXPECT_EQ(ta->dv_type(), dtl::ValueType::TypedArray);
+      EXPECT_EQ(ta->element_type(), dtl::ElementType::UInt16);
+      EXPECT_EQ(ta->length(), 0u);
+      EXPECT_TRUE(ta->is_empty());
+   }
+
+   TEST(TypedArrayTest, CreateArrayWithLength)
+   {
+      auto ta = dtl::make_ta<std::int32_t>(4u);
+      EXPECT_EQ(ta->element_type(), dtl::ElementType::Int32);
+      EXPECT_EQ(ta->length(), 4u);
+      EXPECT_EQ(ta->at(3), 0);
+      ta->set(3, -7);
+      EXPECT_EQ(ta->at(3), -7);
+      EXPECT_EQ(ta->data()[3], -7);
+   }
+
+   TEST(TypedArrayTest, CreateArrayUsingInitializer)
+   {
+      auto ta = dtl::make_ta<std::uint64_t>({ 10u, 20u, UINT64_MAX });
+      EXPECT_EQ(ta->length(), 3u);
+      EXPECT_EQ(ta->at(0), 10u);
+      EXPECT_EQ(ta->at(1), 20u);
+      EXPECT_EQ(ta->at(2), UINT64_MAX);
+      ta->push(30u);
+      EXPECT_EQ(ta->length(), 4u);
+      EXPECT_EQ(ta->at(3), 30u);
+   }
+
+   TEST(TypedArrayTest, BoolArrayUsesByteStorage)
+   {
+      auto ta = dtl::make_ta<bool>({ true, false, true });
+      EXPECT_EQ(ta->element_type(), dtl::ElementType::Bool);
+      EXPECT_TRUE(ta->at(0));
+      EXPECT_FALSE(ta->at(1));
+      std::uint8_t const* data = ta->data();
+      EXPECT_EQ(data[0], 1u);
+      EXPECT_EQ(data[1], 0u);
+      EXPECT_EQ(data[2], 1u);
+   }
+
+   TEST(TypedArrayTest, CastFromDynamicValue)
+   {
+      dtl::DynamicValue dv = dtl::dv_cast(dtl::TypedArrayValue{ dtl::make_ta<std::int8_t>({ -1, 1 }) });
+      EXPECT_EQ(dv->dv_type(), dtl::ValueType::TypedArray);
+      EXPECT_EQ(dtl::ta_cast<std::uint8_t>(dv), nullptr);
+      auto ta = dtl::ta_cast<std::int8_t>(dv);
+      ASSERT_NE(ta, nullptr);
+      EXPECT_EQ(ta->at(0), -1);
+      EXPECT_EQ(dtl::ta_cast(dv)->length(), 2u);
+   }
+
+   TEST(TypedArrayTest, VisitTypedArray)
+   {
+      dtl::TypedArrayValue ta = dtl::make_ta<std::int16_t>({ -3, 4, 5 });
+      std::int64_t sum{ 0 };
+      EXPECT_TRUE(dtl::visit_ta(ta.get(), [&sum](auto const& array)
+         {
+            for (std::size_t i = 0u; i < array.length(); i++)
+            {
+               sum += static_cast<std::int64_t>(array.at(i));
+            }
+         }));
+      EXPECT_EQ(sum, 6);
+   }
+}